@@ -0,0 +1,89 @@
+/*
+ * Software License Agreement (GPLv3 License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * This file is part of godel. https://github.com/ros-industrial-consortium/godel
+ *
+ *  godel_polygon_offset is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  godel_polygon_offset is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with godel_polygon_offset.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * clipper_polygon_offset.h
+ *
+ * Offset engine based on Clipper's integer-coordinate polygon offsetting. Produces the same output
+ * as PolygonOffset (discretized loops in machining order) without building a voronoi diagram.
+ */
+
+#ifndef CLIPPER_POLYGON_OFFSET_H_
+#define CLIPPER_POLYGON_OFFSET_H_
+
+#include <limits>
+#include <clipper.hpp>
+#include "godel_process_path_generation/polygon_pts.hpp"
+
+namespace godel_polygon_offset
+{
+
+/**@brief ClipperPolygonOffset creates offset paths for closed polygon boundaries.
+ * Coordinates are rounded to a 1 um integer grid, so offsets are exact and do not depend on
+ * input degeneracies that can make the voronoi diagram check fail. Each level is offset directly
+ * from the input, so errors do not accumulate from level to level.
+ * Interface and output ordering are the same as PolygonOffset.
+ */
+class ClipperPolygonOffset
+{
+public:
+  ClipperPolygonOffset()
+      : verbose_(false), round_joins_(true), init_ok_(false), offset_(0.), initial_offset_(0.),
+        discretization_(std::numeric_limits<double>::max()){};
+  virtual ~ClipperPolygonOffset(){};
+
+  /**@brief Convert polygons to integer paths
+   * @param pbc Collection of polygons. CCW(+) ordered points are external boundaries.
+   * @return True if the polygons are non-degenerate and parameters are valid.
+   */
+  bool init(const godel_process_path::PolygonBoundaryCollection& pbc, double _offset,
+            double _initial_offset, double _discretization);
+
+  /**@brief Change offset parameters without converting the polygons again. */
+  bool setParameters(double _offset, double _initial_offset, double _discretization);
+
+  /**@brief Select round (default) or miter joins at convex corners.
+   * Round joins reproduce the arcs of voronoi offsets; miter joins keep sharp corners. */
+  void setRoundJoins(bool round_joins) { round_joins_ = round_joins; }
+
+  /**@brief Perform offsets on polygons and arrange in a logical order.
+   * Same ordering as PolygonOffset: smallest path grows outwards, then jumps to next smallest path.
+   * @param pbc Resultant polygons.
+   * @param offsets List of offset distances corresponding to polygons.
+   * @return True if successfully performed offsets.
+   */
+  bool generateOrderedOffsets(godel_process_path::PolygonBoundaryCollection& pbc,
+                              std::vector<double>& offsets);
+
+  bool verbose_; /**<Flag to display additional debug messages */
+
+private:
+  /**@brief Convert an integer path to a metric polygon with at most discretization_ between points */
+  godel_process_path::PolygonBoundary pathToPolygon(const ClipperLib::Path& path) const;
+
+  ClipperLib::Paths paths_;        /**<Input polygons on the integer grid */
+  bool round_joins_;               /**<Round (true) or miter (false) joins */
+  bool init_ok_;                   /**<Flag to represent that init() completed successfully */
+  double offset_, initial_offset_; /**<Typical offset and initial offset distance. */
+  double discretization_;          /**<Max distance between adjacent points in resultant. */
+};
+
+} /* namespace godel_polygon_offset */
+#endif /* CLIPPER_POLYGON_OFFSET_H_ */
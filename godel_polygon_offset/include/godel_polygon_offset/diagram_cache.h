@@ -0,0 +1,81 @@
+/*
+ * Software License Agreement (GPLv3 License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * This file is part of godel. https://github.com/ros-industrial-consortium/godel
+ *
+ *  godel_polygon_offset is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  godel_polygon_offset is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with godel_polygon_offset.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * diagram_cache.h
+ *
+ * Bounded LRU cache of initialized PolygonOffset objects, so that repeated offset requests for the
+ * same boundaries (e.g. while tuning blending parameters) do not rebuild the voronoi diagram.
+ */
+
+#ifndef DIAGRAM_CACHE_H_
+#define DIAGRAM_CACHE_H_
+
+#include <list>
+#include <map>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include "godel_polygon_offset/polygon_offset.h"
+
+namespace godel_polygon_offset
+{
+
+/* Not copyable: the index holds iterators into the entry list */
+class DiagramCache : private boost::noncopyable
+{
+public:
+  typedef boost::shared_ptr<PolygonOffset> PolygonOffsetPtr;
+
+  /**@param capacity Maximum number of diagrams kept; 0 disables caching. */
+  DiagramCache(size_t capacity = 8) : capacity_(capacity), hits_(0), misses_(0){};
+
+  /**@brief Get a PolygonOffset initialized with pbc and the given parameters.
+   * A cached diagram for identical polygons is reused and only its parameters are updated;
+   * otherwise a new diagram is built and cached, evicting the least recently used one.
+   * @return Null pointer if the diagram could not be built or the parameters are invalid.
+   */
+  PolygonOffsetPtr get(const PolygonBoundaryCollection& pbc, double offset, double initial_offset,
+                       double discretization);
+
+  void clear();
+  size_t size() const { return entries_.size(); }
+  size_t hits() const { return hits_; }
+  size_t misses() const { return misses_; }
+
+  /**@brief Hash of all point coordinates and boundary sizes */
+  static size_t hash(const PolygonBoundaryCollection& pbc);
+
+private:
+  struct Entry
+  {
+    size_t key;
+    PolygonBoundaryCollection polygons; /**<Kept to rule out hash collisions */
+    PolygonOffsetPtr offsetter;
+  };
+  typedef std::list<Entry> EntryList; /**<Most recently used first */
+
+  size_t capacity_;
+  size_t hits_, misses_;
+  EntryList entries_;
+  std::multimap<size_t, EntryList::iterator> index_;
+};
+
+} /* namespace godel_polygon_offset */
+#endif /* DIAGRAM_CACHE_H_ */
@@ -0,0 +1,62 @@
+/*
+ * Software License Agreement (GPLv3 License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * This file is part of godel. https://github.com/ros-industrial-consortium/godel
+ *
+ *  godel_polygon_offset is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  godel_polygon_offset is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with godel_polygon_offset.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * loop_ordering.h
+ *
+ * Machining order for offset loops. Loops are arranged in a nesting tree where the parent of a
+ * loop is the adjacent loop one offset level further out (the loop the tool steps out to).
+ * Emission takes the deepest remaining loop from a priority queue and then climbs its parents
+ * until reaching one that has already been emitted.
+ */
+
+#ifndef LOOP_ORDERING_H_
+#define LOOP_ORDERING_H_
+
+#include <vector>
+#include "godel_process_path_generation/polygon_pts.hpp"
+
+namespace godel_polygon_offset
+{
+
+/**@brief Builds the nesting tree of a set of offset loops
+ * Candidate parents are the loops on the next level out that enclose the loop's first point (with
+ * bounding boxes as a pre-filter); of these the nearest to that point is chosen, so a loop inside an
+ * island that sits in a hole steps out to the island rather than the surrounding boundary.
+ * Loops around holes (those enclosed by an odd number of loops of their level) instead step out to
+ * the nearest hole loop they enclose, never to the outer boundary.
+ * @param loops Discretized offset loops
+ * @param offsets Offset distance of each loop
+ * @param step Distance between successive offset levels
+ * @return Parent index of each loop, -1 for loops on the outermost level (or with no enclosing loop)
+ */
+std::vector<int> buildLoopTree(const godel_process_path::PolygonBoundaryCollection& loops,
+                               const std::vector<double>& offsets, double step);
+
+/**@brief Orders loops for machining: deepest first, then outwards through its parents.
+ * Ties in depth are broken by index, so the result is deterministic.
+ * @param parents Nesting tree from buildLoopTree
+ * @param offsets Offset distance of each loop
+ * @return Loop indices in machining order
+ */
+std::vector<size_t> orderLoops(const std::vector<int>& parents, const std::vector<double>& offsets);
+
+} /* namespace godel_polygon_offset */
+#endif /* LOOP_ORDERING_H_ */
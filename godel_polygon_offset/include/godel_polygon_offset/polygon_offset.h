@@ -31,10 +31,11 @@
 #include <limits>
 #include <boost/shared_ptr.hpp>
 #include <openvoronoi/voronoidiagram.hpp>
-#include <openvoronoi/offset_sorter.hpp>
+#include <openvoronoi/offset.hpp>
 #include "godel_process_path_generation/polygon_pts.hpp"
 
 using godel_process_path::PolygonBoundaryCollection;
+using godel_process_path::PolygonPt;
 
 namespace godel_polygon_offset
 {
@@ -51,16 +52,25 @@ class PolygonOffset
 public:
   PolygonOffset()
       : verbose_(false), init_ok_(false), offset_(0.), initial_offset_(0.),
-        discretization_(std::numeric_limits<double>::max()){};
+        discretization_(std::numeric_limits<double>::max()), center_(0., 0.), scale_(1.),
+        max_threads_(0){};
   virtual ~PolygonOffset(){};
 
   /**@brief Initialize voronoi diagram with polygon points
+   * Geometry is translated and scaled into the unit circle before it is added to the diagram;
+   * all other inputs and outputs remain in metric units.
    * @param pbc Collection of polygons. CCW(+) ordered points are external boundaries.
    * @return True if voronoi diagram created successfully.
    */
   bool init(const PolygonBoundaryCollection& pbc, double _offset, double _initial_offset,
             double _discretization);
 
+  /**@brief Change offset parameters without rebuilding the voronoi diagram.
+   * Lets an initialized PolygonOffset be reused for new offsets of the same polygons.
+   * @return False (parameters unchanged) if any parameter is not positive.
+   */
+  bool setParameters(double _offset, double _initial_offset, double _discretization);
+
   /**@brief Perform offsets on polygons and arrange in a logical order.
    * Order of polygons is convenient for godel sanding. Smallest path grows outwards, then jumps to
    * next smallest path.
@@ -70,27 +80,54 @@ public:
    */
   bool generateOrderedOffsets(PolygonBoundaryCollection& pbc, std::vector<double>& offsets);
 
+  /**@brief Limit the number of threads used by generateOrderedOffsets.
+   * @param max_threads Thread count; 0 uses one thread per hardware core.
+   */
+  void setMaxThreads(size_t max_threads) { max_threads_ = max_threads; }
+
   bool verbose_; /**<Flag to display additional debug messages */
 
 private:
-  /**@brief Convert ovd::OffsetLoops (lines/arcs) to PolygonBoundaries (lines)
+  /**@brief Convert an ovd::OffsetLoop (lines/arcs) to a PolygonBoundary (lines)
    * All lines and arcs are discretized (TODO should only arcs be discretized here?)
-   * @param polygons Collection of polygons resulting from conversion.
-   * @param offset_loops Ordered OffsetLoops by machining order.
+   * @param loop Offset loop in the normalized diagram frame.
+   * @return Discretized polygon in metric units.
    */
+  godel_process_path::PolygonBoundary loopToPolygon(const ovd::OffsetLoop& loop) const;
+
+  /**@brief Largest clearance of the filtered medial axis, i.e. the deepest possible offset (m) */
+  double maxInscribedDistance() const;
+
+  /**@brief Offset and discretize levels first, first + stride, ... of distances.
+   * Safe to run concurrently: each call uses its own ovd::Offset and writes only its own levels.
+   * @param distances Offset distance of each level (m).
+   * @param results Polygons of each level; must have the same size as distances.
+   */
+  void offsetLevels(const std::vector<double>& distances, size_t first, size_t stride,
+                    std::vector<PolygonBoundaryCollection>& results) const;
 
   double offset_, initial_offset_; /**<Typical offset and initial offset distance. */
   double discretization_;          /**<Max linear or arc-length distance between adjacent points in
                                       resultant. */
 
-  /*ovd::VoronoiDiagram* vd = new ovd::VoronoiDiagram(1,100); // (r, bins)
+  /**@brief Map a point in the normalized diagram frame back to metric units */
+  PolygonPt toMetric(const ovd::Point& p) const
+  {
+    return PolygonPt(p.x / scale_ + center_.x, p.y / scale_ + center_.y);
+  }
+
+  PolygonPt center_; /**<Center of the input geometry's bounding box (m) */
+  double scale_;     /**<Factor from metric units to the normalized diagram frame */
+
+  /*ovd::VoronoiDiagram(r, bins)
    * double r: radius of circle within which all input geometry must fall. use 1 (unit-circle).
-   * Scale geometry if necessary.
+   * Geometry is scaled by scale_ to fit.
    * int bins:  bins for face-grid search. roughly sqrt(n), where n is the number of sites is good
    * according to Held. */
   boost::shared_ptr<ovd::VoronoiDiagram> vd_;
 
   bool init_ok_; /**<Flag to represent that init() completed successfully */
+  size_t max_threads_; /**<Worker threads for offset extraction, 0 for hardware concurrency */
 };
 
 } /* namespace godel_polygon_offset */
@@ -0,0 +1,187 @@
+/*
+ * Software License Agreement (GPLv3 License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * This file is part of godel. https://github.com/ros-industrial-consortium/godel
+ *
+ *  godel_polygon_offset is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  godel_polygon_offset is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with godel_polygon_offset.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * clipper_polygon_offset.cpp
+ */
+
+#include <cmath>
+#include <ros/ros.h>
+#include <boost/foreach.hpp>
+#include <godel_process_path_generation/utils.h>
+#include "godel_polygon_offset/clipper_polygon_offset.h"
+#include "godel_polygon_offset/loop_ordering.h"
+
+using godel_process_path::PolygonBoundaryCollection;
+using godel_process_path::PolygonBoundary;
+using godel_process_path::PolygonPt;
+
+// Integer units per meter (1 um grid)
+const static double CLIPPER_SCALE = 1e6;
+
+// Miter joins are squared off beyond this multiple of the offset distance
+const static double MITER_LIMIT = 2.;
+
+// (m) Lower bound on the deviation of round joins from a true arc
+const static double MIN_ARC_TOLERANCE = 1e-6;
+
+static inline ClipperLib::cInt toGrid(double v)
+{
+  return static_cast<ClipperLib::cInt>(std::floor(v * CLIPPER_SCALE + .5));
+}
+
+namespace godel_polygon_offset
+{
+
+bool ClipperPolygonOffset::setParameters(double _offset, double _initial_offset,
+                                         double _discretization)
+{
+  if (_offset <= 0. || _initial_offset <= 0. || _discretization <= 0)
+  {
+    ROS_ERROR("Cannot initialize ClipperPolygonOffset with negative offset parameters.");
+    return false;
+  }
+  offset_ = _offset;
+  initial_offset_ = _initial_offset;
+  discretization_ = _discretization;
+  return true;
+}
+
+bool ClipperPolygonOffset::init(const PolygonBoundaryCollection& pbc, double _offset,
+                                double _initial_offset, double _discretization)
+{
+  init_ok_ = false;
+  if (!setParameters(_offset, _initial_offset, _discretization))
+  {
+    return false;
+  }
+
+  paths_.clear();
+  double area(0.);
+  BOOST_FOREACH (const PolygonBoundary& bnd, pbc)
+  {
+    ClipperLib::Path path;
+    path.reserve(bnd.size());
+    BOOST_FOREACH (const PolygonPt& pt, bnd)
+    {
+      path.push_back(ClipperLib::IntPoint(toGrid(pt.x), toGrid(pt.y)));
+    }
+    ClipperLib::CleanPolygon(path);
+    if (path.size() < 3)
+    {
+      ROS_WARN_COND(verbose_, "Skipping degenerate boundary with %li points", bnd.size());
+      continue;
+    }
+    area += std::abs(ClipperLib::Area(path));
+    paths_.push_back(path);
+  }
+
+  if (paths_.empty() || area <= 0.)
+  {
+    ROS_ERROR("Cannot initialize ClipperPolygonOffset with empty or degenerate polygons.");
+    return false;
+  }
+  ROS_INFO_COND(verbose_, "Converted %li boundaries to integer paths", paths_.size());
+
+  init_ok_ = true;
+  return init_ok_;
+}
+
+bool ClipperPolygonOffset::generateOrderedOffsets(PolygonBoundaryCollection& polygons,
+                                                  std::vector<double>& offsets)
+{
+  if (!init_ok_)
+  {
+    ROS_ERROR("Cannot use ClipperPolygonOffset without calling init() first.");
+    return false;
+  }
+
+  ClipperLib::ClipperOffset offsetter(MITER_LIMIT);
+  offsetter.AddPaths(paths_, round_joins_ ? ClipperLib::jtRound : ClipperLib::jtMiter,
+                     ClipperLib::etClosedPolygon);
+
+  /* Perform offsets:
+   * Start with initial_offset, and proceed with offset distance until no further offsets are
+   * generated. Negative deltas shrink external boundaries and grow holes. */
+  PolygonBoundaryCollection unordered_polygons;
+  std::vector<double> unordered_offsets;
+  for (double offset_distance = initial_offset_;; offset_distance += offset_)
+  {
+    // Chord error of a discretization_ long step on an arc of radius offset_distance
+    offsetter.ArcTolerance =
+        std::max(MIN_ARC_TOLERANCE, discretization_ * discretization_ / (8. * offset_distance)) *
+        CLIPPER_SCALE;
+
+    ROS_INFO_COND(verbose_, "Creating offset with distance %f", offset_distance);
+    ClipperLib::Paths solution;
+    offsetter.Execute(solution, -offset_distance * CLIPPER_SCALE);
+    if (solution.empty())
+    {
+      break;
+    }
+    BOOST_FOREACH (const ClipperLib::Path& path, solution)
+    {
+      unordered_polygons.push_back(pathToPolygon(path));
+      unordered_offsets.push_back(offset_distance);
+    }
+  }
+  if (unordered_polygons.empty())
+  {
+    ROS_WARN_STREAM("No offsets were generated: " << std::endl
+                                                  << "Initial Offset: " << initial_offset_
+                                                  << " (m)");
+    return false;
+  }
+  ROS_INFO_COND(verbose_, "Created %li offset loops", unordered_polygons.size());
+
+  std::vector<int> parents = buildLoopTree(unordered_polygons, unordered_offsets, offset_);
+  std::vector<size_t> order = orderLoops(parents, unordered_offsets);
+
+  polygons.clear();
+  offsets.clear();
+  polygons.reserve(order.size());
+  offsets.reserve(order.size());
+  BOOST_FOREACH (size_t idx, order)
+  {
+    polygons.push_back(PolygonBoundary());
+    polygons.back().swap(unordered_polygons[idx]);
+    offsets.push_back(unordered_offsets[idx]);
+  }
+
+  return true;
+}
+
+PolygonBoundary ClipperPolygonOffset::pathToPolygon(const ClipperLib::Path& path) const
+{
+  PolygonBoundary polygon;
+  for (size_t ii = 0; ii < path.size(); ++ii)
+  {
+    const ClipperLib::IntPoint& a = path[ii];
+    const ClipperLib::IntPoint& b = path[(ii + 1) % path.size()];
+    PolygonPt prior(a.X / CLIPPER_SCALE, a.Y / CLIPPER_SCALE);
+    PolygonPt current(b.X / CLIPPER_SCALE, b.Y / CLIPPER_SCALE);
+    std::vector<PolygonPt> pts =
+        godel_process_path::utils::geometry::discretizeLinear(prior, current, discretization_);
+    polygon.insert(polygon.end(), pts.begin(), pts.end());
+  }
+  return polygon;
+}
+
+} /* namespace godel_polygon_offset */
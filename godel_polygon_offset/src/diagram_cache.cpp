@@ -0,0 +1,140 @@
+/*
+ * Software License Agreement (GPLv3 License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * This file is part of godel. https://github.com/ros-industrial-consortium/godel
+ *
+ *  godel_polygon_offset is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  godel_polygon_offset is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with godel_polygon_offset.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * diagram_cache.cpp
+ */
+
+#include <ros/ros.h>
+#include <boost/foreach.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/next_prior.hpp>
+#include "godel_polygon_offset/diagram_cache.h"
+
+using godel_process_path::PolygonBoundary;
+using godel_process_path::PolygonPt;
+
+namespace
+{
+
+bool samePolygons(const PolygonBoundaryCollection& a, const PolygonBoundaryCollection& b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (size_t ii = 0; ii < a.size(); ++ii)
+  {
+    if (a[ii].size() != b[ii].size())
+      return false;
+    for (size_t jj = 0; jj < a[ii].size(); ++jj)
+    {
+      if (a[ii][jj].x != b[ii][jj].x || a[ii][jj].y != b[ii][jj].y)
+        return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+namespace godel_polygon_offset
+{
+
+size_t DiagramCache::hash(const PolygonBoundaryCollection& pbc)
+{
+  size_t seed(0);
+  BOOST_FOREACH (const PolygonBoundary& bnd, pbc)
+  {
+    boost::hash_combine(seed, bnd.size());
+    BOOST_FOREACH (const PolygonPt& pt, bnd)
+    {
+      boost::hash_combine(seed, pt.x);
+      boost::hash_combine(seed, pt.y);
+    }
+  }
+  return seed;
+}
+
+DiagramCache::PolygonOffsetPtr DiagramCache::get(const PolygonBoundaryCollection& pbc,
+                                                 double offset, double initial_offset,
+                                                 double discretization)
+{
+  size_t key = hash(pbc);
+  typedef std::multimap<size_t, EntryList::iterator>::iterator IndexIterator;
+  std::pair<IndexIterator, IndexIterator> range = index_.equal_range(key);
+  for (IndexIterator it = range.first; it != range.second; ++it)
+  {
+    if (!samePolygons(it->second->polygons, pbc))
+      continue;
+
+    // Hit: move to front and re-parameterize
+    entries_.splice(entries_.begin(), entries_, it->second);
+    ++hits_;
+    ROS_INFO("Reusing cached voronoi diagram (%li hits, %li misses)", hits_, misses_);
+    PolygonOffsetPtr offsetter = entries_.front().offsetter;
+    if (!offsetter->setParameters(offset, initial_offset, discretization))
+    {
+      return PolygonOffsetPtr();
+    }
+    return offsetter;
+  }
+
+  ++misses_;
+  PolygonOffsetPtr offsetter(new PolygonOffset());
+  if (!offsetter->init(pbc, offset, initial_offset, discretization))
+  {
+    return PolygonOffsetPtr();
+  }
+  if (capacity_ == 0)
+  {
+    return offsetter;
+  }
+
+  Entry entry;
+  entry.key = key;
+  entry.polygons = pbc;
+  entry.offsetter = offsetter;
+  entries_.push_front(entry);
+  index_.insert(std::make_pair(key, entries_.begin()));
+
+  // Evict least recently used
+  while (entries_.size() > capacity_)
+  {
+    EntryList::iterator last = boost::prior(entries_.end());
+    range = index_.equal_range(last->key);
+    for (IndexIterator it = range.first; it != range.second; ++it)
+    {
+      if (it->second == last)
+      {
+        index_.erase(it);
+        break;
+      }
+    }
+    entries_.erase(last);
+  }
+  return offsetter;
+}
+
+void DiagramCache::clear()
+{
+  entries_.clear();
+  index_.clear();
+}
+
+} /* namespace godel_polygon_offset */
@@ -0,0 +1,227 @@
+/*
+ * Software License Agreement (GPLv3 License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * This file is part of godel. https://github.com/ros-industrial-consortium/godel
+ *
+ *  godel_polygon_offset is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  godel_polygon_offset is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with godel_polygon_offset.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * loop_ordering.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <boost/foreach.hpp>
+#include "godel_polygon_offset/loop_ordering.h"
+
+using godel_process_path::PolygonBoundary;
+using godel_process_path::PolygonBoundaryCollection;
+using godel_process_path::PolygonPt;
+
+namespace
+{
+
+struct Box
+{
+  Box()
+      : min_x(std::numeric_limits<double>::max()), min_y(std::numeric_limits<double>::max()),
+        max_x(-std::numeric_limits<double>::max()), max_y(-std::numeric_limits<double>::max()){};
+  double min_x, min_y, max_x, max_y;
+
+  bool contains(const PolygonPt& pt) const
+  {
+    return pt.x >= min_x && pt.x <= max_x && pt.y >= min_y && pt.y <= max_y;
+  }
+};
+
+Box boundingBox(const PolygonBoundary& bnd)
+{
+  Box box;
+  BOOST_FOREACH (const PolygonPt& pt, bnd)
+  {
+    box.min_x = std::min(box.min_x, pt.x);
+    box.min_y = std::min(box.min_y, pt.y);
+    box.max_x = std::max(box.max_x, pt.x);
+    box.max_y = std::max(box.max_y, pt.y);
+  }
+  return box;
+}
+
+/* Squared distance from pt to the closed polyline bnd */
+double distance2(const PolygonPt& pt, const PolygonBoundary& bnd)
+{
+  double best = std::numeric_limits<double>::max();
+  for (size_t ii = 0; ii < bnd.size(); ++ii)
+  {
+    const PolygonPt& a = bnd[ii];
+    const PolygonPt& b = bnd[(ii + 1) % bnd.size()];
+    PolygonPt ab = b - a;
+    double len2 = ab.norm2();
+    double t = len2 > 0. ? std::max(0., std::min(1., (pt - a).dot(ab) / len2)) : 0.;
+    best = std::min(best, pt.dist2(a + ab * t));
+  }
+  return best;
+}
+
+/* Even-odd test of pt against the closed polyline bnd */
+bool inside(const PolygonPt& pt, const PolygonBoundary& bnd)
+{
+  bool in = false;
+  for (size_t ii = 0, jj = bnd.size() - 1; ii < bnd.size(); jj = ii++)
+  {
+    const PolygonPt& a = bnd[ii];
+    const PolygonPt& b = bnd[jj];
+    if ((a.y > pt.y) != (b.y > pt.y) && pt.x < a.x + (pt.y - a.y) * (b.x - a.x) / (b.y - a.y))
+    {
+      in = !in;
+    }
+  }
+  return in;
+}
+
+struct DepthCompare
+{
+  const std::vector<double>* offsets;
+  /* Max-heap on depth; among equal depths the lowest index comes out first */
+  bool operator()(size_t a, size_t b) const
+  {
+    if ((*offsets)[a] != (*offsets)[b])
+      return (*offsets)[a] < (*offsets)[b];
+    return a > b;
+  }
+};
+
+} // namespace
+
+namespace godel_polygon_offset
+{
+
+std::vector<int> buildLoopTree(const PolygonBoundaryCollection& loops,
+                               const std::vector<double>& offsets, double step)
+{
+  std::vector<int> parents(loops.size(), -1);
+  if (loops.empty() || step <= 0.)
+  {
+    return parents;
+  }
+
+  // Group loops by offset level
+  const double min_offset = *std::min_element(offsets.begin(), offsets.end());
+  std::vector<std::vector<size_t> > levels;
+  std::vector<Box> boxes(loops.size());
+  for (size_t ii = 0; ii < loops.size(); ++ii)
+  {
+    size_t level = static_cast<size_t>(std::floor((offsets[ii] - min_offset) / step + .5));
+    if (level >= levels.size())
+    {
+      levels.resize(level + 1);
+    }
+    levels[level].push_back(ii);
+    boxes[ii] = boundingBox(loops[ii]);
+  }
+
+  // Loops around holes are enclosed by an odd number of loops of their own level (even-odd, so
+  // that islands in holes count as outer loops again). This does not rely on the winding order,
+  // which differs between offset engines.
+  std::vector<bool> hole_side(loops.size(), false);
+  BOOST_FOREACH (const std::vector<size_t>& level, levels)
+  {
+    BOOST_FOREACH (size_t loop, level)
+    {
+      if (loops[loop].empty())
+        continue;
+
+      const PolygonPt& pt = loops[loop].front();
+      BOOST_FOREACH (size_t other, level)
+      {
+        if (other != loop && boxes[other].contains(pt) && inside(pt, loops[other]))
+          hole_side[loop] = !hole_side[loop];
+      }
+    }
+  }
+
+  for (size_t level = 1; level < levels.size(); ++level)
+  {
+    const std::vector<size_t>& outer = levels[level - 1];
+    BOOST_FOREACH (size_t child, levels[level])
+    {
+      if (loops[child].empty())
+        continue;
+
+      const PolygonPt& pt = loops[child].front();
+      double best = std::numeric_limits<double>::max();
+      BOOST_FOREACH (size_t candidate, outer)
+      {
+        // Loops step out towards the boundary they were offset from: a hole loop to the hole loop
+        // it surrounds, any other loop to one that encloses it. The box is only a cheap pre-filter.
+        if (hole_side[candidate] != hole_side[child] || loops[candidate].empty())
+          continue;
+        if (hole_side[child])
+        {
+          const PolygonPt& candidate_pt = loops[candidate].front();
+          if (!boxes[child].contains(candidate_pt) || !inside(candidate_pt, loops[child]))
+            continue;
+        }
+        else if (!boxes[candidate].contains(pt) || !inside(pt, loops[candidate]))
+        {
+          continue;
+        }
+
+        double d2 = distance2(pt, loops[candidate]);
+        if (d2 < best)
+        {
+          best = d2;
+          parents[child] = static_cast<int>(candidate);
+        }
+      }
+    }
+  }
+  return parents;
+}
+
+std::vector<size_t> orderLoops(const std::vector<int>& parents, const std::vector<double>& offsets)
+{
+  DepthCompare compare = { &offsets };
+  std::priority_queue<size_t, std::vector<size_t>, DepthCompare> queue(compare);
+  for (size_t ii = 0; ii < parents.size(); ++ii)
+  {
+    queue.push(ii);
+  }
+
+  std::vector<bool> emitted(parents.size(), false);
+  std::vector<size_t> order;
+  order.reserve(parents.size());
+  while (!queue.empty())
+  {
+    size_t loop = queue.top();
+    queue.pop();
+    if (emitted[loop])
+      continue;
+
+    // Emit the deepest remaining loop and step out until reaching an emitted loop
+    for (int current = static_cast<int>(loop); current != -1 && !emitted[current];
+         current = parents[current])
+    {
+      emitted[current] = true;
+      order.push_back(static_cast<size_t>(current));
+    }
+  }
+  return order;
+}
+
+} /* namespace godel_polygon_offset */
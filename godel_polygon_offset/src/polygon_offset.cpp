@@ -31,36 +31,84 @@
 #include <boost/tuple/tuple.hpp>
 #include <boost/foreach.hpp>
 #include <boost/next_prior.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include <godel_process_path_generation/utils.h>
+#include "godel_polygon_offset/loop_ordering.h"
 #include "godel_polygon_offset/polygon_offset.h"
 
 using godel_process_path::PolygonBoundaryCollection;
 using godel_process_path::PolygonBoundary;
 using godel_process_path::PolygonPt;
-using godel_process_path::utils::exists;
-using godel_process_path::utils::getFirstChild;
-using godel_process_path::utils::moveItemFrom;
+// Input geometry is scaled to fit within this radius of the (unit) voronoi diagram circle
+const static double NORMALIZED_RADIUS = 0.9;
 
-typedef std::vector<ovd::MGVertex> MachiningLoopList;
+// Lower bound on face-grid bins; sqrt(n) is used for larger inputs
+const static int MIN_BINS = 10;
 
 namespace godel_polygon_offset
 {
 
-bool PolygonOffset::init(const PolygonBoundaryCollection& pbc, double _offset,
-                         double _initial_offset, double _discretization)
+bool PolygonOffset::setParameters(double _offset, double _initial_offset, double _discretization)
 {
   if (_offset <= 0. || _initial_offset <= 0. || _discretization <= 0)
   {
     ROS_ERROR("Cannot initialize PolygonOffset with negative offset parameters.");
     return false;
   }
-
-  // Reset PolygonOffset for new operations.
-  vd_.reset(new ovd::VoronoiDiagram(1, 100));
   offset_ = _offset;
   initial_offset_ = _initial_offset;
   discretization_ = _discretization;
-  ROS_INFO_COND(verbose_, "Creating voroni diagram from polygons");
+  return true;
+}
+
+bool PolygonOffset::init(const PolygonBoundaryCollection& pbc, double _offset,
+                         double _initial_offset, double _discretization)
+{
+  if (!setParameters(_offset, _initial_offset, _discretization))
+  {
+    return false;
+  }
+
+  // Normalize geometry into the unit circle: center on the bounding box, scale the farthest point
+  // to NORMALIZED_RADIUS.
+  size_t point_count(0);
+  double min_x(std::numeric_limits<double>::max()), max_x(-std::numeric_limits<double>::max());
+  double min_y(std::numeric_limits<double>::max()), max_y(-std::numeric_limits<double>::max());
+  BOOST_FOREACH (const PolygonBoundary& bnd, pbc)
+  {
+    BOOST_FOREACH (const PolygonPt& pt, bnd)
+    {
+      min_x = std::min(min_x, pt.x);
+      max_x = std::max(max_x, pt.x);
+      min_y = std::min(min_y, pt.y);
+      max_y = std::max(max_y, pt.y);
+      ++point_count;
+    }
+  }
+
+  center_ = PolygonPt((min_x + max_x) / 2., (min_y + max_y) / 2.);
+  double radius(0.);
+  BOOST_FOREACH (const PolygonBoundary& bnd, pbc)
+  {
+    BOOST_FOREACH (const PolygonPt& pt, bnd)
+    {
+      radius = std::max(radius, center_.dist(pt));
+    }
+  }
+  if (point_count == 0 || radius <= 0.)
+  {
+    ROS_ERROR("Cannot initialize PolygonOffset with empty or degenerate polygons.");
+    init_ok_ = false;
+    return false;
+  }
+  scale_ = NORMALIZED_RADIUS / radius;
+  int bins = std::max(MIN_BINS, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(point_count)))));
+
+  // Reset PolygonOffset for new operations.
+  vd_.reset(new ovd::VoronoiDiagram(1, bins));
+  ROS_INFO_COND(verbose_, "Creating voroni diagram from %li points (scale %f, %i bins)", point_count,
+                scale_, bins);
 
   // Add all points to vd.
   std::vector<std::vector<int> > pt_id_collection;
@@ -72,7 +120,8 @@ bool PolygonOffset::init(const PolygonBoundaryCollection& pbc, double _offset,
     for (PolygonBoundary::const_iterator pt = boundary->begin(), b_end = boundary->end();
          pt != b_end; ++pt)
     {
-      pt_id.push_back(vd_->insert_point_site(ovd::Point(pt->x, pt->y)));
+      pt_id.push_back(vd_->insert_point_site(
+          ovd::Point((pt->x - center_.x) * scale_, (pt->y - center_.y) * scale_)));
       ROS_INFO_COND(verbose_, "Added point %i at location %f, %f", pt_id.back(), pt->x, pt->y);
     }
     pt_id_collection.push_back(pt_id);
@@ -118,128 +167,164 @@ bool PolygonOffset::generateOrderedOffsets(PolygonBoundaryCollection& polygons,
     return false;
   }
 
-  ovd::HEGraph& g = vd_->get_graph_reference();
-  ovd::Offset offsetter(g);
-  ovd::OffsetSorter sorter(g);
-
   /* Perform offsets:
    * Start with initial_offset, and proceed with offset distance until no further offsets are
    * generated.
-   * Add each offset to sorter for subsequent sorting. */
-  double offset_distance(initial_offset_);
-  size_t loop_count(0);
-  while (true)
-  {
-    ROS_INFO_COND(verbose_, "Creating offset with distance %f", offset_distance);
-    ovd::OffsetLoops offset_list = offsetter.offset(offset_distance);
-    if (offset_list.size() == 0)
+   * Levels up to the estimated maximum inscribed distance are split across worker threads, each
+   * with its own offsetter on the shared (read-only) diagram. Results are merged in level order so
+   * the output does not depend on the number of threads. */
+  std::vector<double> distances;
+  double max_distance = maxInscribedDistance();
+  for (double offset_distance = initial_offset_; offset_distance <= max_distance;
+       offset_distance = initial_offset_ + offset_ * distances.size())
+  {
+    distances.push_back(offset_distance);
+  }
+
+  std::vector<PolygonBoundaryCollection> level_polygons(distances.size());
+  size_t thread_count = max_threads_ > 0 ? max_threads_ : boost::thread::hardware_concurrency();
+  thread_count = std::max<size_t>(1, std::min(thread_count, distances.size()));
+  ROS_INFO_COND(verbose_, "Offsetting %li levels up to %f (m) on %li threads", distances.size(),
+                max_distance, thread_count);
+  if (thread_count == 1)
+  {
+    offsetLevels(distances, 0, 1, level_polygons);
+  }
+  else
+  {
+    boost::thread_group workers;
+    for (size_t ii = 0; ii < thread_count; ++ii)
     {
-      break;
+      workers.create_thread(boost::bind(&PolygonOffset::offsetLevels, this, boost::cref(distances),
+                                        ii, thread_count, boost::ref(level_polygons)));
     }
-    loop_count += offset_list.size();
-    for (ovd::OffsetLoops::const_iterator loop = offset_list.begin(), loops_end = offset_list.end();
-         loop != loops_end; ++loop)
+    workers.join_all();
+  }
+
+  PolygonBoundaryCollection unordered_polygons;
+  std::vector<double> unordered_offsets;
+  bool exhausted(false);
+  for (size_t ii = 0; ii < distances.size() && !exhausted; ++ii)
+  {
+    exhausted = level_polygons[ii].empty();
+    BOOST_FOREACH (PolygonBoundary& polygon, level_polygons[ii])
+    {
+      unordered_polygons.push_back(PolygonBoundary());
+      unordered_polygons.back().swap(polygon);
+      unordered_offsets.push_back(distances[ii]);
+    }
+  }
+
+  // The estimate is taken at diagram vertices; continue serially in case it fell short.
+  if (!exhausted)
+  {
+    ovd::Offset offsetter(vd_->get_graph_reference());
+    for (double offset_distance = initial_offset_ + offset_ * distances.size();;
+         offset_distance += offset_)
     {
-      sorter.add_loop(*loop);
+      ROS_INFO_COND(verbose_, "Creating offset with distance %f", offset_distance);
+      ovd::OffsetLoops offset_list = offsetter.offset(offset_distance * scale_);
+      if (offset_list.size() == 0)
+      {
+        break;
+      }
+      for (ovd::OffsetLoops::const_iterator loop = offset_list.begin(), loops_end = offset_list.end();
+           loop != loops_end; ++loop)
+      {
+        unordered_polygons.push_back(loopToPolygon(*loop));
+        unordered_offsets.push_back(offset_distance);
+      }
     }
-    offset_distance += offset_;
   }
-  if (loop_count == 0)
+  if (unordered_polygons.empty())
   {
     ROS_WARN_STREAM("No offsets were generated: " << std::endl
                                                   << "Initial Offset: " << initial_offset_
                                                   << " (m)");
     return false;
   }
-  ROS_INFO_COND(verbose_, "Created %li offset loops", loop_count);
-
-  // Perform initial sort.
-  sorter.sort_loops();
-  const ovd::MachiningGraph& mg = sorter.getMachiningGraph();
+  ROS_INFO_COND(verbose_, "Created %li offset loops", unordered_polygons.size());
 
-  MachiningLoopList ordered_loops, unordered_loops; // For tracking order of loops for machining
+  /* Order loops for machining:
+   *  Take deepest remaining loop
+   *  Step out through each parent that has not been taken yet
+   *  Repeat (take deepest loop...)
+   */
+  std::vector<int> parents = buildLoopTree(unordered_polygons, unordered_offsets, offset_);
+  std::vector<size_t> order = orderLoops(parents, unordered_offsets);
 
-  // Populate unordered loops with all graph vertices
-  ovd::MGVertexItr loop, vertex_end;
-  for (boost::tie(loop, vertex_end) = boost::vertices(mg); loop != vertex_end; ++loop)
+  // Populate polygons and offsets
+  polygons.clear();
+  offsets.clear();
+  polygons.reserve(order.size());
+  offsets.reserve(order.size());
+  BOOST_FOREACH (size_t idx, order)
   {
-    unordered_loops.push_back(*loop);
+    ROS_INFO_COND(verbose_, "Moving loop at depth %f to ordered list.", unordered_offsets[idx]);
+    polygons.push_back(PolygonBoundary());
+    polygons.back().swap(unordered_polygons[idx]);
+    offsets.push_back(unordered_offsets[idx]);
   }
 
-  /* Sort unordered loops into ordered loops:
-   *  Move deepest loop in unordered to ordered
-   *  Move each parent from unordered to ordered until no more parents
-   *  Repeat (find deepest loop...)
-   */
-  while (unordered_loops.size() != 0)
+  return true;
+}
+
+double PolygonOffset::maxInscribedDistance() const
+{
+  // Clearance of a medial axis vertex is its distance to the nearest site
+  ovd::HEGraph& g = vd_->get_graph_reference();
+  double max_dist(0.);
+  BOOST_FOREACH (ovd::HEEdge e, g.edges())
   {
-    // Find deepest loop
-    double largest_offset(0);
-    ovd::MGVertex deepest_loop;
-    BOOST_FOREACH (ovd::MGVertex loop_descriptor, unordered_loops)
+    if (!g[e].valid)
     {
-      if (mg[loop_descriptor].offset_distance > largest_offset)
-      {
-        largest_offset = mg[loop_descriptor].offset_distance;
-        deepest_loop = loop_descriptor;
-      }
+      continue;
     }
-    ROS_INFO_COND(verbose_, "Moving loop at depth %f to ordered list.", largest_offset);
-    moveItemFrom(unordered_loops, ordered_loops, deepest_loop);
+    max_dist = std::max(max_dist, std::max(g[g.source(e)].dist(), g[g.target(e)].dist()));
+  }
+  // Nothing inside the input geometry can be farther from it than the normalized radius
+  return std::min(max_dist, NORMALIZED_RADIUS) / scale_;
+}
 
-    // Find child of deepest loop (TODO check for multiple children, should never happen!)
-    // Move child to ordered
-    ovd::MGVertex child;
-    while (getFirstChild(child, ordered_loops.back(), mg))
+void PolygonOffset::offsetLevels(const std::vector<double>& distances, size_t first, size_t stride,
+                                 std::vector<PolygonBoundaryCollection>& results) const
+{
+  ovd::Offset offsetter(vd_->get_graph_reference());
+  for (size_t ii = first; ii < distances.size(); ii += stride)
+  {
+    ovd::OffsetLoops offset_list = offsetter.offset(distances[ii] * scale_);
+    for (ovd::OffsetLoops::const_iterator loop = offset_list.begin(), loops_end = offset_list.end();
+         loop != loops_end; ++loop)
     {
-      if (exists(child, unordered_loops))
-      {
-        ROS_INFO_COND(verbose_, "Moving loop at depth %f to ordered list.",
-                      mg[child].offset_distance);
-        moveItemFrom(unordered_loops, ordered_loops, child);
-      }
-      else
-      {
-        break;
-      }
+      results[ii].push_back(loopToPolygon(*loop));
     }
   }
+}
 
-  // Convert ovg::OffsetLoops to polygons and discretize
-  // Populate polygons and offsets
-  polygons.clear();
-  offsets.clear();
-  BOOST_FOREACH (ovd::MGVertex loop_descriptor, ordered_loops)
+PolygonBoundary PolygonOffset::loopToPolygon(const ovd::OffsetLoop& loop) const
+{
+  PolygonBoundary polygon;
+  ovd::OffsetVertex prior_vtx = loop.vertices.front();
+  std::list<ovd::OffsetVertex>::const_iterator vtx = boost::next(loop.vertices.begin());
+  while (vtx != loop.vertices.end())
   {
-    PolygonBoundary polygon;
-    const ovd::OffsetLoop& loop = mg[loop_descriptor];
-    ovd::OffsetVertex prior_vtx = loop.vertices.front();
-    std::list<ovd::OffsetVertex>::const_iterator vtx = boost::next(loop.vertices.begin());
-    while (vtx != loop.vertices.end())
+    PolygonPt prior = toMetric(prior_vtx.p), current = toMetric(vtx->p);
+    std::vector<PolygonPt> pts;
+    if (vtx->r == -1)
     {
-      PolygonPt prior(prior_vtx.p.x, prior_vtx.p.y), current(vtx->p.x, vtx->p.y);
-      std::vector<PolygonPt> pts;
-      if (vtx->r == -1)
-      {
-        pts =
-            godel_process_path::utils::geometry::discretizeLinear(prior, current, discretization_);
-      }
-      else
-      {
-        PolygonPt arc_center(vtx->c.x, vtx->c.y);
-        pts = godel_process_path::utils::geometry::discretizeArc2D(prior, current, arc_center,
-                                                                   !vtx->cw, discretization_);
-      }
-      polygon.insert(polygon.end(), pts.begin(), pts.end());
-      pts.clear();
-      prior_vtx = *vtx;
-      ++vtx;
+      pts = godel_process_path::utils::geometry::discretizeLinear(prior, current, discretization_);
+    }
+    else
+    {
+      PolygonPt arc_center = toMetric(vtx->c);
+      pts = godel_process_path::utils::geometry::discretizeArc2D(prior, current, arc_center,
+                                                                 !vtx->cw, discretization_);
     }
-    polygons.push_back(polygon);
-    offsets.push_back(loop.offset_distance);
+    polygon.insert(polygon.end(), pts.begin(), pts.end());
+    prior_vtx = *vtx;
+    ++vtx;
   }
-
-  return true;
+  return polygon;
 }
 
 } /* namespace godel_polygon_offset */
@@ -26,8 +26,11 @@
  */
 
 #include <ros/ros.h>
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include "godel_polygon_offset/OffsetPolygon.h"
+#include "godel_polygon_offset/clipper_polygon_offset.h"
+#include "godel_polygon_offset/diagram_cache.h"
 #include "godel_polygon_offset/polygon_offset.h"
 #include "godel_process_path_generation/polygon_pts.hpp"
 #include "godel_process_path_generation/utils.h"
@@ -36,11 +39,28 @@ using godel_polygon_offset::OffsetPolygonRequest;
 using godel_polygon_offset::OffsetPolygonResponse;
 using namespace godel_process_path;
 
-bool offset_polygons_cb(OffsetPolygonRequest& req, OffsetPolygonResponse& res)
+const static int DEFAULT_DIAGRAM_CACHE_SIZE = 8;
+
+/* Engine and join type of requests that leave them empty */
+struct OffsetDefaults
+{
+  std::string engine;
+  std::string join_type;
+};
+
+static bool validEngine(const std::string& engine)
 {
-  godel_polygon_offset::PolygonOffset po;
-  po.verbose_ = true;
+  return engine == OffsetPolygonRequest::ENGINE_OPENVORONOI || engine == OffsetPolygonRequest::ENGINE_CLIPPER;
+}
 
+static bool validJoinType(const std::string& join_type)
+{
+  return join_type == OffsetPolygonRequest::JOIN_ROUND || join_type == OffsetPolygonRequest::JOIN_MITER;
+}
+
+bool offset_polygons_cb(OffsetPolygonRequest& req, OffsetPolygonResponse& res,
+                        godel_polygon_offset::DiagramCache& diagram_cache, const OffsetDefaults& defaults)
+{
   godel_process_path::PolygonBoundaryCollection pbc;
   utils::translations::geometryMsgsToGodel(pbc, req.polygons);
   ROS_INFO_STREAM("Received request with " << pbc.size() << " boundary polygons.");
@@ -49,16 +69,57 @@ bool offset_polygons_cb(OffsetPolygonRequest& req, OffsetPolygonResponse& res)
   {
     req.initial_offset = req.offset_distance; // Default initial offset if unspecified.
   }
-  if (!po.init(pbc, req.offset_distance, req.initial_offset, req.discretization))
+  if (req.engine.empty())
   {
-    ROS_ERROR("Could not initialize PolygonOffset.");
-    return false;
+    req.engine = defaults.engine;
+  }
+  if (req.join_type.empty())
+  {
+    req.join_type = defaults.join_type;
   }
-  if (!po.generateOrderedOffsets(pbc, res.offsets)) /* Generates polygons and offset list*/
+  if (!validEngine(req.engine) || !validJoinType(req.join_type))
   {
-    ROS_ERROR("Could not offset boundaries.");
+    ROS_ERROR_STREAM("Unknown offset engine '" << req.engine << "' or join type '" << req.join_type << "'");
     return false;
   }
+
+  if (req.engine == OffsetPolygonRequest::ENGINE_CLIPPER)
+  {
+    godel_polygon_offset::ClipperPolygonOffset po;
+    po.verbose_ = true;
+    po.setRoundJoins(req.join_type == OffsetPolygonRequest::JOIN_ROUND);
+    if (!po.init(pbc, req.offset_distance, req.initial_offset, req.discretization))
+    {
+      ROS_ERROR("Could not initialize ClipperPolygonOffset.");
+      return false;
+    }
+    if (!po.generateOrderedOffsets(pbc, res.offsets)) /* Generates polygons and offset list*/
+    {
+      ROS_ERROR("Could not offset boundaries.");
+      return false;
+    }
+  }
+  else
+  {
+    if (req.join_type != OffsetPolygonRequest::JOIN_ROUND)
+    {
+      ROS_WARN_STREAM("The " << req.engine << " engine only makes round joins; ignoring join type '"
+                             << req.join_type << "'");
+    }
+    godel_polygon_offset::DiagramCache::PolygonOffsetPtr po =
+        diagram_cache.get(pbc, req.offset_distance, req.initial_offset, req.discretization);
+    if (!po)
+    {
+      ROS_ERROR("Could not initialize PolygonOffset.");
+      return false;
+    }
+    po->verbose_ = true;
+    if (!po->generateOrderedOffsets(pbc, res.offsets)) /* Generates polygons and offset list*/
+    {
+      ROS_ERROR("Could not offset boundaries.");
+      return false;
+    }
+  }
   utils::translations::godelToGeometryMsgs(res.offset_polygons, pbc);
   ROS_INFO_STREAM("Returning " << pbc.size() << " offset polygons.");
   return true;
@@ -68,7 +129,25 @@ int main(int argc, char** argv)
 {
   ros::init(argc, argv, "polygon_offset_node");
   ros::NodeHandle nh;
-  ros::ServiceServer service = nh.advertiseService("offset_polygon", offset_polygons_cb);
+  ros::NodeHandle pnh("~");
+
+  int cache_size;
+  pnh.param("diagram_cache_size", cache_size, DEFAULT_DIAGRAM_CACHE_SIZE);
+  godel_polygon_offset::DiagramCache diagram_cache(static_cast<size_t>(std::max(0, cache_size)));
+
+  // Requests choose their engine and join type; these are used when they leave them empty
+  OffsetDefaults defaults;
+  pnh.param<std::string>("default_engine", defaults.engine, OffsetPolygonRequest::ENGINE_OPENVORONOI);
+  pnh.param<std::string>("default_join_type", defaults.join_type, OffsetPolygonRequest::JOIN_ROUND);
+  if (!validEngine(defaults.engine) || !validJoinType(defaults.join_type))
+  {
+    ROS_ERROR_STREAM("Unknown default offset engine '" << defaults.engine << "' or join type '"
+                                                        << defaults.join_type << "'");
+    return -1;
+  }
+
+  ros::ServiceServer service = nh.advertiseService<OffsetPolygonRequest, OffsetPolygonResponse>(
+      "offset_polygon", boost::bind(offset_polygons_cb, _1, _2, boost::ref(diagram_cache), defaults));
   ROS_INFO("%s ready to service requests.", service.getService().c_str());
   ros::spin();
   return 0;
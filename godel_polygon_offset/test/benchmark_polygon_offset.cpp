@@ -0,0 +1,101 @@
+/*
+ * Software License Agreement (GPLv3 License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * This file is part of godel. https://github.com/ros-industrial-consortium/godel
+ *
+ *  godel_polygon_offset is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  godel_polygon_offset is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with godel_polygon_offset.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * benchmark_polygon_offset.cpp
+ *
+ * Timings on large boundaries; built with the tests but not run with them:
+ *   rosrun godel_polygon_offset godel_polygon_offset-benchmark
+ */
+
+#include <gtest/gtest.h>
+#include <ros/time.h>
+#include <iostream>
+#include "godel_polygon_offset/clipper_polygon_offset.h"
+#include "godel_polygon_offset/polygon_offset.h"
+#include "polygon_test_utils.h"
+
+using godel_polygon_offset::ClipperPolygonOffset;
+using godel_polygon_offset::PolygonOffset;
+
+/* Times init and offset generation on a circular boundary with n vertices */
+static void scalingBenchmark(size_t n)
+{
+  PolygonBoundaryCollection pbc(1, circle(.5, .5, .5, n));
+
+  ros::WallTime start = ros::WallTime::now();
+  PolygonOffset po;
+  ASSERT_TRUE(po.init(pbc, .05, .025, .005));
+  ros::WallTime built = ros::WallTime::now();
+
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  ASSERT_TRUE(po.generateOrderedOffsets(loops, offsets));
+  ros::WallTime done = ros::WallTime::now();
+
+  EXPECT_EQ(10u, loops.size()); // 0.025 .. 0.475
+  std::cout << "[ BENCH    ] " << n << " vertices: init " << (built - start).toSec()
+            << " s, offsets " << (done - built).toSec() << " s" << std::endl;
+}
+
+TEST(PolygonOffsetScaling, vertices_1k) { scalingBenchmark(1000); }
+TEST(PolygonOffsetScaling, vertices_5k) { scalingBenchmark(5000); }
+TEST(PolygonOffsetScaling, vertices_10k) { scalingBenchmark(10000); }
+TEST(PolygonOffsetScaling, vertices_50k) { scalingBenchmark(50000); }
+
+/* Times both engines on a circular boundary with n vertices. The loops are only compared by
+ * depth; comparing their shapes (expectEquivalent) is quadratic in n, and is left to the unit tests
+ * on smaller boundaries. */
+static void engineBenchmark(size_t n)
+{
+  PolygonBoundaryCollection pbc(1, circle(.5, .5, .5, n));
+  PolygonBoundaryCollection ovd_loops, clipper_loops;
+  std::vector<double> ovd_offsets, clipper_offsets;
+
+  ros::WallTime start = ros::WallTime::now();
+  PolygonOffset ovd_po;
+  ASSERT_TRUE(ovd_po.init(pbc, .05, .025, .005));
+  ASSERT_TRUE(ovd_po.generateOrderedOffsets(ovd_loops, ovd_offsets));
+  ros::WallTime ovd_done = ros::WallTime::now();
+
+  ClipperPolygonOffset clipper_po;
+  ASSERT_TRUE(clipper_po.init(pbc, .05, .025, .005));
+  ASSERT_TRUE(clipper_po.generateOrderedOffsets(clipper_loops, clipper_offsets));
+  ros::WallTime clipper_done = ros::WallTime::now();
+
+  std::cout << "[ BENCH    ] " << n << " vertices: openvoronoi " << (ovd_done - start).toSec()
+            << " s, clipper " << (clipper_done - ovd_done).toSec() << " s" << std::endl;
+  ASSERT_EQ(ovd_offsets.size(), clipper_offsets.size());
+  for (size_t ii = 0; ii < ovd_offsets.size(); ++ii)
+  {
+    EXPECT_NEAR(ovd_offsets[ii], clipper_offsets[ii], 1e-9);
+  }
+}
+
+TEST(OffsetEngineBenchmark, vertices_1k) { engineBenchmark(1000); }
+TEST(OffsetEngineBenchmark, vertices_10k) { engineBenchmark(10000); }
+TEST(OffsetEngineBenchmark, vertices_100k) { engineBenchmark(100000); }
+
+int main(int argc, char** argv)
+{
+  ros::Time::init();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
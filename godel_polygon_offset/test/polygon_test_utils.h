@@ -0,0 +1,112 @@
+/*
+ * Software License Agreement (GPLv3 License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * This file is part of godel. https://github.com/ros-industrial-consortium/godel
+ *
+ *  godel_polygon_offset is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  godel_polygon_offset is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with godel_polygon_offset.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * polygon_test_utils.h
+ *
+ * Boundaries and comparisons shared by the unit tests and the benchmarks
+ */
+
+#ifndef GODEL_POLYGON_OFFSET_POLYGON_TEST_UTILS_H
+#define GODEL_POLYGON_OFFSET_POLYGON_TEST_UTILS_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <boost/foreach.hpp>
+#include <gtest/gtest.h>
+#include <godel_process_path_generation/polygon_pts.hpp>
+
+using godel_process_path::PolygonBoundary;
+using godel_process_path::PolygonBoundaryCollection;
+using godel_process_path::PolygonPt;
+
+/* Axis aligned CCW square centered at (cx, cy) */
+inline PolygonBoundary square(double cx, double cy, double side)
+{
+  PolygonBoundary bnd;
+  bnd.push_back(PolygonPt(cx - side / 2., cy - side / 2.));
+  bnd.push_back(PolygonPt(cx + side / 2., cy - side / 2.));
+  bnd.push_back(PolygonPt(cx + side / 2., cy + side / 2.));
+  bnd.push_back(PolygonPt(cx - side / 2., cy + side / 2.));
+  return bnd;
+}
+
+/* CCW regular polygon with n vertices */
+inline PolygonBoundary circle(double cx, double cy, double r, size_t n)
+{
+  PolygonBoundary bnd;
+  for (size_t ii = 0; ii < n; ++ii)
+  {
+    double a = 2. * M_PI * static_cast<double>(ii) / static_cast<double>(n);
+    bnd.push_back(PolygonPt(cx + r * std::cos(a), cy + r * std::sin(a)));
+  }
+  return bnd;
+}
+
+/* Largest distance from a point of a to the closed polyline b */
+inline double directedHausdorff(const PolygonBoundary& a, const PolygonBoundary& b)
+{
+  double worst(0.);
+  BOOST_FOREACH (const PolygonPt& pt, a)
+  {
+    double best = std::numeric_limits<double>::max();
+    for (size_t ii = 0; ii < b.size(); ++ii)
+    {
+      PolygonPt p0 = b[ii], d = b[(ii + 1) % b.size()] - p0;
+      double len2 = d.norm2();
+      double t = len2 > 0. ? std::max(0., std::min(1., (pt - p0).dot(d) / len2)) : 0.;
+      best = std::min(best, pt.dist(p0 + d * t));
+    }
+    worst = std::max(worst, best);
+  }
+  return worst;
+}
+
+/* Every loop of one engine has a loop of the other at the same depth within tol, and vice versa */
+inline void expectEquivalent(const PolygonBoundaryCollection& a, const std::vector<double>& a_offsets,
+                             const PolygonBoundaryCollection& b, const std::vector<double>& b_offsets,
+                             double tol)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    const PolygonBoundaryCollection& from = pass == 0 ? a : b;
+    const PolygonBoundaryCollection& to = pass == 0 ? b : a;
+    const std::vector<double>& from_offsets = pass == 0 ? a_offsets : b_offsets;
+    const std::vector<double>& to_offsets = pass == 0 ? b_offsets : a_offsets;
+    for (size_t ii = 0; ii < from.size(); ++ii)
+    {
+      double best = std::numeric_limits<double>::max();
+      for (size_t jj = 0; jj < to.size(); ++jj)
+      {
+        if (std::abs(from_offsets[ii] - to_offsets[jj]) < 1e-9)
+        {
+          best = std::min(best, std::max(directedHausdorff(from[ii], to[jj]),
+                                         directedHausdorff(to[jj], from[ii])));
+        }
+      }
+      EXPECT_LT(best, tol) << "Loop " << ii << " at depth " << from_offsets[ii];
+    }
+  }
+}
+
+#endif // GODEL_POLYGON_OFFSET_POLYGON_TEST_UTILS_H
@@ -0,0 +1,394 @@
+/*
+ * Software License Agreement (GPLv3 License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * This file is part of godel. https://github.com/ros-industrial-consortium/godel
+ *
+ *  godel_polygon_offset is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  godel_polygon_offset is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with godel_polygon_offset.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * test_polygon_offset.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <ros/time.h>
+#include <algorithm>
+#include <boost/foreach.hpp>
+#include "godel_polygon_offset/clipper_polygon_offset.h"
+#include "godel_polygon_offset/diagram_cache.h"
+#include "godel_polygon_offset/loop_ordering.h"
+#include "godel_polygon_offset/polygon_offset.h"
+#include "polygon_test_utils.h"
+
+using godel_polygon_offset::ClipperPolygonOffset;
+using godel_polygon_offset::PolygonOffset;
+using godel_process_path::PolygonBoundary;
+using godel_process_path::PolygonPt;
+
+/* Check that every loop point of a square lies exactly 'offset' inside the square or closer to
+ * its center */
+static void expectInsideSquare(const PolygonBoundary& loop, double cx, double cy, double side,
+                               double offset, double tol = 1e-6)
+{
+  BOOST_FOREACH (const PolygonPt& pt, loop)
+  {
+    EXPECT_LE(std::abs(pt.x - cx), side / 2. - offset + tol);
+    EXPECT_LE(std::abs(pt.y - cy), side / 2. - offset + tol);
+  }
+}
+
+TEST(PolygonOffsetTest, metricSquare)
+{
+  // A 4m square does not fit in the unit circle without normalization
+  const double cx = 10., cy = -3., side = 4.;
+  PolygonBoundaryCollection pbc(1, square(cx, cy, side));
+
+  PolygonOffset po;
+  ASSERT_TRUE(po.init(pbc, .5, .25, .05));
+
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  ASSERT_TRUE(po.generateOrderedOffsets(loops, offsets));
+  ASSERT_EQ(loops.size(), offsets.size());
+  ASSERT_EQ(4u, loops.size()); // 0.25, 0.75, 1.25, 1.75
+
+  for (size_t ii = 0; ii < loops.size(); ++ii)
+  {
+    EXPECT_NEAR(1.75 - .5 * ii, offsets[ii], 1e-6); // Innermost first, spiralling out
+    expectInsideSquare(loops[ii], cx, cy, side, offsets[ii]);
+  }
+}
+
+TEST(PolygonOffsetTest, smallSquare)
+{
+  const double side = .01;
+  PolygonBoundaryCollection pbc(1, square(.3, .2, side));
+
+  PolygonOffset po;
+  ASSERT_TRUE(po.init(pbc, .001, .001, .0005));
+
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  ASSERT_TRUE(po.generateOrderedOffsets(loops, offsets));
+  ASSERT_EQ(4u, loops.size()); // 1, 2, 3, 4 mm
+  for (size_t ii = 0; ii < loops.size(); ++ii)
+  {
+    expectInsideSquare(loops[ii], .3, .2, side, offsets[ii]);
+  }
+}
+
+TEST(PolygonOffsetTest, threadCountIndependent)
+{
+  // Square with a round hole: many levels, with loops around both boundaries
+  PolygonBoundaryCollection pbc;
+  pbc.push_back(square(0., 0., 2.));
+  PolygonBoundary hole = circle(.3, .2, .2, 64);
+  std::reverse(hole.begin(), hole.end());
+  pbc.push_back(hole);
+
+  PolygonBoundaryCollection serial_loops, parallel_loops;
+  std::vector<double> serial_offsets, parallel_offsets;
+
+  PolygonOffset serial;
+  serial.setMaxThreads(1);
+  ASSERT_TRUE(serial.init(pbc, .02, .01, .005));
+  ASSERT_TRUE(serial.generateOrderedOffsets(serial_loops, serial_offsets));
+
+  PolygonOffset parallel;
+  parallel.setMaxThreads(4);
+  ASSERT_TRUE(parallel.init(pbc, .02, .01, .005));
+  ASSERT_TRUE(parallel.generateOrderedOffsets(parallel_loops, parallel_offsets));
+
+  ASSERT_EQ(serial_loops.size(), parallel_loops.size());
+  EXPECT_GT(serial_loops.size(), 20u);
+  for (size_t ii = 0; ii < serial_loops.size(); ++ii)
+  {
+    EXPECT_EQ(serial_offsets[ii], parallel_offsets[ii]);
+    ASSERT_EQ(serial_loops[ii].size(), parallel_loops[ii].size());
+    for (size_t jj = 0; jj < serial_loops[ii].size(); ++jj)
+    {
+      EXPECT_EQ(serial_loops[ii][jj].x, parallel_loops[ii][jj].x);
+      EXPECT_EQ(serial_loops[ii][jj].y, parallel_loops[ii][jj].y);
+    }
+  }
+}
+
+TEST(PolygonOffsetTest, degenerate)
+{
+  PolygonOffset po;
+  EXPECT_FALSE(po.init(PolygonBoundaryCollection(), .01, .01, .01));
+  EXPECT_FALSE(po.init(PolygonBoundaryCollection(1, PolygonBoundary(3, PolygonPt(1., 1.))), .01,
+                       .01, .01));
+}
+
+TEST(LoopOrderingTest, twoPockets)
+{
+  // Offsets of a rectangle with a waist: one outer loop that splits into two pockets
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  loops.push_back(square(0., 0., 4.));  // 0
+  offsets.push_back(.5);
+  loops.push_back(square(-1., 0., 1.)); // 1: left pocket
+  offsets.push_back(1.);
+  loops.push_back(square(1., 0., 1.));  // 2: right pocket
+  offsets.push_back(1.);
+  loops.push_back(square(1., 0., .5)); // 3: inside right pocket
+  offsets.push_back(1.5);
+
+  std::vector<int> parents = godel_polygon_offset::buildLoopTree(loops, offsets, .5);
+  ASSERT_EQ(4u, parents.size());
+  EXPECT_EQ(-1, parents[0]);
+  EXPECT_EQ(0, parents[1]);
+  EXPECT_EQ(0, parents[2]);
+  EXPECT_EQ(2, parents[3]);
+
+  // Deepest first and out to the boundary, then the remaining pocket
+  std::vector<size_t> order = godel_polygon_offset::orderLoops(parents, offsets);
+  ASSERT_EQ(4u, order.size());
+  EXPECT_EQ(3u, order[0]);
+  EXPECT_EQ(2u, order[1]);
+  EXPECT_EQ(0u, order[2]);
+  EXPECT_EQ(1u, order[3]);
+}
+
+TEST(LoopOrderingTest, nearestParent)
+{
+  // Two separate islands; each inner loop must step out to its own island
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  loops.push_back(square(0., 0., 2.));
+  offsets.push_back(.1);
+  loops.push_back(square(5., 0., 2.));
+  offsets.push_back(.1);
+  loops.push_back(square(5., 0., 1.6));
+  offsets.push_back(.3);
+  loops.push_back(square(0., 0., 1.6));
+  offsets.push_back(.3);
+
+  std::vector<int> parents = godel_polygon_offset::buildLoopTree(loops, offsets, .2);
+  EXPECT_EQ(1, parents[2]);
+  EXPECT_EQ(0, parents[3]);
+
+  std::vector<size_t> order = godel_polygon_offset::orderLoops(parents, offsets);
+  ASSERT_EQ(4u, order.size());
+  EXPECT_EQ(2u, order[0]);
+  EXPECT_EQ(1u, order[1]);
+  EXPECT_EQ(3u, order[2]);
+  EXPECT_EQ(0u, order[3]);
+}
+
+TEST(LoopOrderingTest, sideBySideIslands)
+{
+  // Islands with overlapping bounding boxes; the inner loops start on the facing sides
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  loops.push_back(square(-1.05, 0., 2.)); // 0
+  offsets.push_back(.2);
+  loops.push_back(square(1.05, 0., 2.));  // 1
+  offsets.push_back(.2);
+  PolygonBoundary right_inner = square(1.05, 0., 1.6);
+  std::rotate(right_inner.begin(), right_inner.begin() + 3, right_inner.end());
+  loops.push_back(right_inner);           // 2: starts at (0.25, 0.8)
+  offsets.push_back(.4);
+  PolygonBoundary left_inner = square(-1.05, 0., 1.6);
+  std::rotate(left_inner.begin(), left_inner.begin() + 1, left_inner.end());
+  loops.push_back(left_inner);            // 3: starts at (-0.25, -0.8)
+  offsets.push_back(.4);
+
+  std::vector<int> parents = godel_polygon_offset::buildLoopTree(loops, offsets, .2);
+  ASSERT_EQ(4u, parents.size());
+  EXPECT_EQ(-1, parents[0]);
+  EXPECT_EQ(-1, parents[1]);
+  EXPECT_EQ(1, parents[2]);
+  EXPECT_EQ(0, parents[3]);
+}
+
+TEST(LoopOrderingTest, enclosingParent)
+{
+  // A loop that passes close to a hole steps out to the boundary around it, not to the hole
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  loops.push_back(square(0., 0., 4.));  // 0: outer boundary
+  offsets.push_back(.5);
+  loops.push_back(square(1., 0., .6));  // 1: around a hole
+  offsets.push_back(.5);
+  PolygonBoundary inner;
+  inner.push_back(PolygonPt(1.5, 0.));
+  inner.push_back(PolygonPt(1.5, 1.5));
+  inner.push_back(PolygonPt(-1.5, 1.5));
+  inner.push_back(PolygonPt(-1.5, -1.5));
+  inner.push_back(PolygonPt(1.5, -1.5));
+  loops.push_back(inner);               // 2: starts .2 from the hole loop
+  offsets.push_back(1.);
+
+  std::vector<int> parents = godel_polygon_offset::buildLoopTree(loops, offsets, .5);
+  ASSERT_EQ(3u, parents.size());
+  EXPECT_EQ(0, parents[2]);
+}
+
+TEST(LoopOrderingTest, holeParent)
+{
+  // Offsets of a square with a square hole: loops around the hole step out to the hole, even
+  // though they start inside the loops around the outer boundary
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  for (size_t level = 0; level < 3; ++level)
+  {
+    loops.push_back(square(0., 0., 10. - level)); // 0, 2, 4: outer boundary
+    offsets.push_back(.5 + .5 * level);
+    PolygonBoundary hole_loop = square(1., 0., 1. + level);
+    std::reverse(hole_loop.begin(), hole_loop.end());
+    loops.push_back(hole_loop);                    // 1, 3, 5: around the hole
+    offsets.push_back(.5 + .5 * level);
+  }
+
+  std::vector<int> parents = godel_polygon_offset::buildLoopTree(loops, offsets, .5);
+  ASSERT_EQ(6u, parents.size());
+  EXPECT_EQ(-1, parents[0]);
+  EXPECT_EQ(-1, parents[1]);
+  EXPECT_EQ(0, parents[2]);
+  EXPECT_EQ(1, parents[3]);
+  EXPECT_EQ(2, parents[4]);
+  EXPECT_EQ(3, parents[5]);
+
+  std::vector<size_t> order = godel_polygon_offset::orderLoops(parents, offsets);
+  const size_t expected[] = {4, 2, 0, 5, 3, 1};
+  EXPECT_EQ(std::vector<size_t>(expected, expected + 6), order);
+}
+
+TEST(DiagramCacheTest, reuseAndEvict)
+{
+  godel_polygon_offset::DiagramCache cache(2);
+  PolygonBoundaryCollection a(1, square(0., 0., 1.)), b(1, square(1., 0., 1.)),
+      c(1, square(2., 0., 1.));
+
+  godel_polygon_offset::DiagramCache::PolygonOffsetPtr first = cache.get(a, .1, .1, .01);
+  ASSERT_TRUE(first.get() != NULL);
+
+  // Same geometry with new parameters reuses the diagram
+  godel_polygon_offset::DiagramCache::PolygonOffsetPtr again = cache.get(a, .05, .05, .01);
+  EXPECT_EQ(first.get(), again.get());
+  EXPECT_EQ(1u, cache.hits());
+
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  ASSERT_TRUE(again->generateOrderedOffsets(loops, offsets));
+  EXPECT_EQ(10u, loops.size()); // 0.05 .. 0.45
+
+  // a is least recently used once b and c are added
+  cache.get(b, .1, .1, .01);
+  cache.get(c, .1, .1, .01);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_NE(first.get(), cache.get(a, .1, .1, .01).get());
+  EXPECT_EQ(4u, cache.misses());
+
+  // Invalid parameters are rejected without evicting
+  EXPECT_FALSE(cache.get(a, -1., .1, .01));
+  EXPECT_EQ(2u, cache.size());
+}
+
+TEST(PolygonOffsetTest, manyVertices)
+{
+  // Larger boundaries are timed by the benchmark target (benchmark_polygon_offset.cpp)
+  PolygonBoundaryCollection pbc(1, circle(.5, .5, .5, 1000));
+  PolygonOffset po;
+  ASSERT_TRUE(po.init(pbc, .05, .025, .005));
+
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  ASSERT_TRUE(po.generateOrderedOffsets(loops, offsets));
+  EXPECT_EQ(10u, loops.size()); // 0.025 .. 0.475
+}
+
+TEST(ClipperPolygonOffsetTest, metricSquare)
+{
+  const double cx = 10., cy = -3., side = 4.;
+  PolygonBoundaryCollection pbc(1, square(cx, cy, side));
+
+  ClipperPolygonOffset po;
+  ASSERT_TRUE(po.init(pbc, .5, .25, .05));
+
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  ASSERT_TRUE(po.generateOrderedOffsets(loops, offsets));
+  ASSERT_EQ(4u, loops.size());
+  for (size_t ii = 0; ii < loops.size(); ++ii)
+  {
+    EXPECT_NEAR(1.75 - .5 * ii, offsets[ii], 1e-6);
+    expectInsideSquare(loops[ii], cx, cy, side, offsets[ii], 2e-6); // 1 um integer grid
+  }
+}
+
+TEST(ClipperPolygonOffsetTest, degenerate)
+{
+  ClipperPolygonOffset po;
+  EXPECT_FALSE(po.init(PolygonBoundaryCollection(), .01, .01, .01));
+  EXPECT_FALSE(po.init(PolygonBoundaryCollection(1, PolygonBoundary(3, PolygonPt(1., 1.))), .01,
+                       .01, .01));
+  PolygonBoundaryCollection loops;
+  std::vector<double> offsets;
+  EXPECT_FALSE(po.generateOrderedOffsets(loops, offsets));
+}
+
+TEST(ClipperPolygonOffsetTest, matchesVoronoi)
+{
+  PolygonBoundaryCollection pbc;
+  pbc.push_back(square(0., 0., 2.));
+  PolygonBoundary hole = circle(.3, .2, .2, 64);
+  std::reverse(hole.begin(), hole.end());
+  pbc.push_back(hole);
+
+  PolygonBoundaryCollection ovd_loops, clipper_loops;
+  std::vector<double> ovd_offsets, clipper_offsets;
+
+  PolygonOffset ovd_po;
+  ASSERT_TRUE(ovd_po.init(pbc, .05, .025, .005));
+  ASSERT_TRUE(ovd_po.generateOrderedOffsets(ovd_loops, ovd_offsets));
+
+  ClipperPolygonOffset clipper_po;
+  ASSERT_TRUE(clipper_po.init(pbc, .05, .025, .005));
+  ASSERT_TRUE(clipper_po.generateOrderedOffsets(clipper_loops, clipper_offsets));
+
+  expectEquivalent(ovd_loops, ovd_offsets, clipper_loops, clipper_offsets, 1e-3);
+}
+
+/* Checks that both engines agree on a circular boundary with n vertices */
+static void expectEnginesAgree(size_t n)
+{
+  PolygonBoundaryCollection pbc(1, circle(.5, .5, .5, n));
+  PolygonBoundaryCollection ovd_loops, clipper_loops;
+  std::vector<double> ovd_offsets, clipper_offsets;
+
+  PolygonOffset ovd_po;
+  ASSERT_TRUE(ovd_po.init(pbc, .05, .025, .005));
+  ASSERT_TRUE(ovd_po.generateOrderedOffsets(ovd_loops, ovd_offsets));
+
+  ClipperPolygonOffset clipper_po;
+  ASSERT_TRUE(clipper_po.init(pbc, .05, .025, .005));
+  ASSERT_TRUE(clipper_po.generateOrderedOffsets(clipper_loops, clipper_offsets));
+
+  expectEquivalent(ovd_loops, ovd_offsets, clipper_loops, clipper_offsets, 1e-3);
+}
+
+// Larger boundaries are timed by the benchmark target (benchmark_polygon_offset.cpp)
+TEST(ClipperPolygonOffsetTest, matchesVoronoi_100) { expectEnginesAgree(100); }
+TEST(ClipperPolygonOffsetTest, matchesVoronoi_1k) { expectEnginesAgree(1000); }
+
+int main(int argc, char** argv)
+{
+  ros::Time::init();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -4,6 +4,7 @@
 #include <ros/ros.h>
 #include <godel_msgs/ProcessExecutionAction.h>
 #include <actionlib/server/simple_action_server.h>
+#include <godel_utils/joint_state_cache.h>
 
 namespace godel_process_execution
 {
@@ -24,6 +25,7 @@ public:
 
 private:
   ros::NodeHandle nh_;
+  godel_utils::JointStateCache joint_states_;
   ros::ServiceClient real_client_;
   ros::ServiceClient sim_client_;
   actionlib::SimpleActionServer<godel_msgs::ProcessExecutionAction> process_exe_action_server_;
@@ -10,10 +10,6 @@
 #include "abb_file_suite/ExecuteProgram.h"
 #include <godel_utils/ensenso_guard.h>
 
-// hack
-#include "sensor_msgs/JointState.h"
-#include "ros/topic.h"
-
 const static double DEFAULT_JOINT_TOPIC_WAIT_TIME = 5.0; // seconds
 const static double DEFAULT_TRAJECTORY_BUFFER_TIME = 5.0; // seconds
 const static std::string JOINT_TOPIC_NAME = "/joint_states";
@@ -42,7 +38,8 @@ static inline bool compare(const std::vector<double>& a, const std::vector<doubl
   return diff < eps;
 }
 
-static bool waitForExecution(const std::vector<double>& end_goal, const ros::Duration& wait_for,
+static bool waitForExecution(const godel_utils::JointStateCache& joint_states,
+                             const std::vector<double>& end_goal, const ros::Duration& wait_for,
                              const ros::Duration& time_out)
 {
   ensenso::EnsensoGuard guard;
@@ -54,8 +51,7 @@ static bool waitForExecution(const std::vector<double>& end_goal, const ros::Dur
 
   while (ros::Time::now() < end_time)
   {
-    state = ros::topic::waitForMessage<sensor_msgs::JointState>(
-        JOINT_TOPIC_NAME, ros::Duration(DEFAULT_JOINT_TOPIC_WAIT_TIME));
+    state = joint_states.next(ros::Duration(DEFAULT_JOINT_TOPIC_WAIT_TIME));
     if (!state)
     {
       ROS_WARN("Could not get a joint_state in time");
@@ -140,6 +136,7 @@ static bool writeRapidFile(const std::string& path,
 }
 
 godel_process_execution::AbbBlendProcessService::AbbBlendProcessService(ros::NodeHandle& nh) : nh_(nh),
+  joint_states_(nh_, JOINT_TOPIC_NAME),
   process_exe_action_server_(nh_,
                            PROCESS_EXE_ACTION_SERVER_NAME,
                            boost::bind(&godel_process_execution::AbbBlendProcessService::executionCallback, this, _1),
@@ -212,7 +209,7 @@ bool godel_process_execution::AbbBlendProcessService::executeProcess(
   if (goal->wait_for_execution)
   {
     // If we must wait for execution, then block and listen until robot returns to initial point or times out
-    return waitForExecution(goal->trajectory_approach.points.front().positions,
+    return waitForExecution(joint_states_, goal->trajectory_approach.points.front().positions,
                             aggregate_traj.points.back().time_from_start, // wait for
                             aggregate_traj.points.back().time_from_start +
                                 ros::Duration(DEFAULT_TRAJECTORY_BUFFER_TIME)); // timeout
@@ -67,6 +67,8 @@ public:
    */
   geometry_msgs::PoseArray asPoseArray() const;
 
+  size_t size() const { return pts_.size(); }
+
   void clear()
   {
     pts_.clear();
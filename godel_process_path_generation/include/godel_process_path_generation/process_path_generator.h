@@ -28,6 +28,7 @@
 #include "godel_process_path_generation/polygon_pts.hpp"
 #include "godel_process_path_generation/process_path.h"
 #include "godel_process_path_generation/polygon_utils.h"
+#include "godel_process_path_generation/sequence_optimizer.h"
 
 using descartes::ProcessPt;
 using descartes::ProcessPath;
@@ -47,14 +48,21 @@ class ProcessPathGenerator
 {
 public:
   ProcessPathGenerator()
-      : tool_radius_(0.), margin_(0.), overlap_(0.), safe_traverse_height_(-1.), verbose_(false){};
+      : tool_radius_(0.), margin_(0.), overlap_(0.), safe_traverse_height_(-1.), verbose_(false),
+        optimize_sequence_(false), adaptive_discretization_(false), max_chord_error_(0.),
+        max_adaptive_spacing_(0.){};
   virtual ~ProcessPathGenerator(){};
 
   bool createProcessPath();
   const descartes::ProcessPath& getProcessPath() const { return process_path_; }
 
+  /**@brief Index ranges [first, second) of the process path points of each chain of loops, in path
+   * order. The traverses between chains, the initial approach and the final retract are left out. */
+  const std::vector<std::pair<size_t, size_t> >& getChainRanges() const { return chain_ranges_; }
+
   /**@brief Set data used by path generator.
-   * Note: Polygons data may become rotated during processing, but order will remain consistent.
+   * Note: Polygons data may become rotated during processing. Their order is kept; sequence
+   * optimization reorders a copy, so that polygons and offsets stay in step.
    * @param polygons Pointer to collection of polygons that will be joined into ProcessPath
    * @param offset_depths Offset distance of each polygon
    */
@@ -78,6 +86,27 @@ public:
   void setTraverseHeight(double height) { safe_traverse_height_ = height; }
   void setVelocity(const ProcessVelocity& vel) { velocity_ = vel; }
 
+  /**@brief Reorder chains of loops (and choose where each chain starts) to minimize traverse time.
+   * A chain is a run of polygons joined on the surface by stepping out to the next loop. */
+  void setOptimizeSequence(bool optimize) { optimize_sequence_ = optimize; }
+
+  /**@brief Motion between chains assumed when sequencing. Independent of the traverse height and
+   * velocities of the generated path, which may leave the traverses to a later planning stage. */
+  void setTravelCost(const sequencing::TravelCostParameters& cost) { travel_cost_ = cost; }
+
+  /**@brief Resample loops adaptively instead of keeping every input point.
+   * Straight runs are reduced to points at most max_spacing apart; curves and corners keep enough
+   * points that the path deviates from the input loops by no more than max_chord_error. Straight
+   * connecting moves are also interpolated at max_spacing. Both bounds must be positive when
+   * enabled; variables_ok() fails otherwise.
+   */
+  void setAdaptiveDiscretization(bool enable, double max_chord_error, double max_spacing)
+  {
+    adaptive_discretization_ = enable;
+    max_chord_error_ = max_chord_error;
+    max_adaptive_spacing_ = max_spacing;
+  }
+
   /**@brief Check if values of offset variables are acceptable */
   bool variables_ok() const
   {
@@ -85,7 +114,9 @@ public:
            margin_ >= 0. &&                          /*negative margin is dangerous*/
            overlap_ < 2. * tool_radius_ &&           /*offset must increment inward*/
            (tool_radius_ != 0. || overlap_ != 0.) && /*offset must be positive*/
-           safe_traverse_height_ >= 0.; /*negative traverse height may be inside part!*/
+           safe_traverse_height_ >= 0. && /*negative traverse height may be inside part!*/
+           (!adaptive_discretization_ ||
+            (max_chord_error_ > 0. && max_adaptive_spacing_ > 0.)); /*adaptive bounds must be positive*/
   }
 
   bool verbose_;
@@ -100,6 +131,13 @@ private:
   // TODO comment
   void addTraverseToProcessPath(const PolygonPt& from, const PolygonPt& to);
 
+  /**@brief Reorders polygons by chain using the sequence optimizer
+   * @param polygons Copy of the path polygons; reordered, and the first loop of each chain rotated
+   * to its entry vertex
+   * @param chain_starts True for each polygon that begins a chain; reordered along with the polygons
+   */
+  void sequenceChains(PolygonBoundaryCollection& polygons, std::vector<bool>& chain_starts);
+
   /**@brief Create a ProcessTransition with linear velocity
    * ProcessTransition will be populated with linear velocity [0, vel, double::max()]
    * @param vel Desired path velocity
@@ -116,6 +154,11 @@ private:
   double margin_;      /**<Margin (m) around boundary to leave untouched (first pass only) */
   double overlap_;     /**<Amount of overlap(m) between adjacent passes. */
   double safe_traverse_height_; /**<Height to move to when traversing to new loops */
+  bool optimize_sequence_;      /**<Reorder chains of loops before creating the path */
+  sequencing::TravelCostParameters travel_cost_; /**<Motion between chains assumed when sequencing */
+  bool adaptive_discretization_; /**<Resample loops by chordal error instead of keeping all points */
+  double max_chord_error_;       /**<(m) Max deviation of adaptive chords from the input loops */
+  double max_adaptive_spacing_;  /**<(m) Max distance between points when adaptive */
 
   double
       max_discretization_distance_; /**<(m) When discretizing segments, use this or less distance
@@ -125,6 +168,7 @@ private:
   const std::vector<double>* path_offsets_;
 
   descartes::ProcessPath process_path_;
+  std::vector<std::pair<size_t, size_t> > chain_ranges_; /**<Process path points of each chain */
   ProcessVelocity velocity_; /**<Velocities for different types of path movements */
 };
 
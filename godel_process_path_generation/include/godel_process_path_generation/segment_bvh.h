@@ -0,0 +1,159 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * segment_bvh.h
+ *
+ * Bounding volume hierarchy over polygon segments. Replaces all-pairs segment comparisons in
+ * boundary validation and closest point searches with tree queries that only test segments whose
+ * bounding boxes overlap (or are near enough to improve the best result so far).
+ */
+
+#ifndef SEGMENT_BVH_H_
+#define SEGMENT_BVH_H_
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "godel_process_path_generation/polygon_utils.h"
+
+namespace godel_process_path
+{
+namespace polygon_utils
+{
+
+/**@brief Axis aligned bounding box on the plane */
+struct BoundingBox2D
+{
+  BoundingBox2D()
+      : min_x(std::numeric_limits<double>::max()), min_y(std::numeric_limits<double>::max()),
+        max_x(-std::numeric_limits<double>::max()), max_y(-std::numeric_limits<double>::max()){};
+  double min_x, min_y, max_x, max_y;
+
+  inline void extend(const PolygonPt& pt)
+  {
+    min_x = std::min(min_x, pt.x);
+    min_y = std::min(min_y, pt.y);
+    max_x = std::max(max_x, pt.x);
+    max_y = std::max(max_y, pt.y);
+  }
+  inline void extend(const BoundingBox2D& other)
+  {
+    min_x = std::min(min_x, other.min_x);
+    min_y = std::min(min_y, other.min_y);
+    max_x = std::max(max_x, other.max_x);
+    max_y = std::max(max_y, other.max_y);
+  }
+  inline bool overlaps(const BoundingBox2D& other) const
+  {
+    return min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y &&
+           other.min_y <= max_y;
+  }
+  /**@brief Squared distance from pt to the box (0 inside) */
+  inline double dist2(const PolygonPt& pt) const
+  {
+    double dx = std::max(0., std::max(min_x - pt.x, pt.x - max_x));
+    double dy = std::max(0., std::max(min_y - pt.y, pt.y - max_y));
+    return dx * dx + dy * dy;
+  }
+};
+
+/**@brief Identifies a segment by its boundary and its index within that boundary.
+ * Segment i of a boundary runs from vertex i to vertex i + 1 (the last one closes the loop). */
+struct SegmentRef
+{
+  SegmentRef() : boundary(0), index(0){};
+  SegmentRef(size_t b, size_t i) : boundary(b), index(i){};
+  size_t boundary;
+  size_t index;
+};
+
+class SegmentBVH
+{
+public:
+  /**@param tol Endpoint tolerance of intersection tests, as in PolygonSegment::intersects */
+  SegmentBVH(double tol = 1e-5) : tol_(tol){};
+
+  /**@brief Build from the closed boundaries of a collection */
+  void build(const PolygonBoundaryCollection& pbc);
+  /**@brief Build from a single closed boundary */
+  void build(const PolygonBoundary& bnd);
+  /**@brief Build from segments forming one closed chain (see boundaryToSegments) */
+  void build(const std::vector<PolygonSegment>& segments);
+
+  size_t size() const { return segments_.size(); }
+  const PolygonSegment& segment(size_t seg) const { return segments_[seg]; }
+  const SegmentRef& ref(size_t seg) const { return refs_[seg]; }
+
+  /**@brief Find two intersecting segments that are not adjacent on the same boundary.
+   * @param a, b Indices of the intersecting segments (a < b) if found.
+   * @return True if an intersection was found.
+   */
+  bool findSelfIntersection(size_t& a, size_t& b) const;
+
+  /**@brief Find a segment of this tree that intersects a segment of other.
+   * @param a Index into this tree, b index into other, if found.
+   */
+  bool findIntersection(const SegmentBVH& other, size_t& a, size_t& b) const;
+
+  /**@brief Find the vertex closest to pt. Vertices are segment start points.
+   * @param include_last Set false to ignore the last vertex of each boundary (as closestPoint does)
+   * @param seg Segment starting at the closest vertex.
+   * @return Distance to the closest vertex, infinity if the tree is empty.
+   */
+  double closestVertex(const PolygonPt& pt, size_t& seg, bool include_last = true) const;
+
+  /**@brief Find the point on any segment closest to pt.
+   * @param seg Segment containing the closest point.
+   * @param closest Closest point.
+   * @return Distance to the closest point, infinity if the tree is empty.
+   */
+  double closestSegment(const PolygonPt& pt, size_t& seg, PolygonPt& closest) const;
+
+private:
+  struct Node
+  {
+    BoundingBox2D box;
+    size_t first, count; /**<Range of order_ covered by a leaf (count == 0 for inner nodes) */
+    size_t left, right;  /**<Children of inner nodes */
+  };
+
+  void buildTree();
+  size_t buildNode(size_t first, size_t count);
+  bool adjacent(size_t a, size_t b) const;
+
+  double tol_;
+  std::vector<PolygonSegment> segments_;
+  std::vector<SegmentRef> refs_;
+  std::vector<BoundingBox2D> boxes_;   /**<Segment boxes grown by the intersection tolerance */
+  std::vector<size_t> boundary_sizes_; /**<Segments per boundary */
+  std::vector<size_t> order_;          /**<Segment indices, grouped by leaf */
+  std::vector<Node> nodes_;            /**<nodes_[0] is the root */
+};
+
+/**@brief Check if any boundary of a intersects any boundary of b */
+bool intersects(const PolygonBoundaryCollection& a, const PolygonBoundaryCollection& b);
+
+/**@brief closestPoint for many points against the same boundary
+ * @return pair(index into PolygonBoundary, distance) for each of pts
+ */
+std::vector<std::pair<size_t, float> > closestPoints(const std::vector<PolygonPt>& pts,
+                                                     const PolygonBoundary& bnd);
+
+} /* namespace polygon_utils */
+} /* namespace godel_process_path */
+#endif /* SEGMENT_BVH_H_ */
@@ -0,0 +1,144 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * sequence_optimizer.h
+ *
+ * Orders a set of independent process items (surfaces, path segments, offset loop chains) so as to
+ * minimize the time spent travelling between them. Each item may be executed in one of several
+ * ways (e.g. forward/reversed, or starting from different vertices), each with its own entry and
+ * exit point, which makes the problem an asymmetric TSP with a choice of option per city.
+ *
+ * Solution: nearest-neighbour construction, then Or-opt relocation and segment reversal local
+ * search. After every improvement the options are re-chosen by dynamic programming.
+ */
+
+#ifndef SEQUENCE_OPTIMIZER_H_
+#define SEQUENCE_OPTIMIZER_H_
+
+#include <vector>
+#include <cstddef>
+#include <Eigen/Core>
+
+namespace godel_process_path
+{
+namespace sequencing
+{
+
+/**@brief One way of executing an item: the point where the tool arrives and the point it leaves */
+struct EntryOption
+{
+  EntryOption() : entry(Eigen::Vector3d::Zero()), exit(Eigen::Vector3d::Zero()){};
+  EntryOption(const Eigen::Vector3d& entry, const Eigen::Vector3d& exit) : entry(entry), exit(exit){};
+  Eigen::Vector3d entry;
+  Eigen::Vector3d exit;
+};
+
+struct SequenceItem
+{
+  std::vector<EntryOption> options; /**<Must contain at least one option */
+};
+
+/**@brief Motion used between items: retract to traverse height, traverse, approach the next item.
+ * Non-positive speeds are treated as 1 m/s so that costs degrade to distances. */
+struct TravelCostParameters
+{
+  TravelCostParameters()
+      : traverse_height(0.), traverse_speed(1.), approach_speed(1.), retract_speed(1.){};
+  double traverse_height; /**<(m) */
+  double traverse_speed;  /**<(m/s) */
+  double approach_speed;  /**<(m/s) */
+  double retract_speed;   /**<(m/s) */
+};
+
+struct SequenceStep
+{
+  SequenceStep() : item(0), option(0){};
+  SequenceStep(std::size_t item, std::size_t option) : item(item), option(option){};
+  std::size_t item;   /**<Index into the input items */
+  std::size_t option; /**<Index into the item's options */
+};
+
+struct SequenceResult
+{
+  SequenceResult() : initial_cost(0.), cost(0.){};
+  std::vector<SequenceStep> steps; /**<Execution order */
+  double initial_cost;             /**<(s) Travel time of the input order, using the first option of each item */
+  double cost;                     /**<(s) Travel time of the optimized order */
+};
+
+class SequenceOptimizer
+{
+public:
+  SequenceOptimizer(const TravelCostParameters& params = TravelCostParameters());
+
+  /**@brief Sets the tool position before the first item. Without a start point the first item
+   * is free and reaching it costs nothing. */
+  void setStart(const Eigen::Vector3d& start)
+  {
+    start_ = start;
+    has_start_ = true;
+  }
+  void clearStart() { has_start_ = false; }
+
+  /**@brief Maximum number of improving local search moves applied by solve() */
+  void setMaxIterations(std::size_t n) { max_iterations_ = n; }
+
+  /**@brief Computes an execution order for items
+   * @param items Items to order; every item must have at least one option
+   * @return Order and option of every item. Cost is never worse than initial_cost. If any item has
+   * no options the items are rejected and the result has no steps.
+   */
+  SequenceResult solve(const std::vector<SequenceItem>& items) const;
+
+  /**@brief Total travel time (s) needed to execute steps in order */
+  double cost(const std::vector<SequenceItem>& items, const std::vector<SequenceStep>& steps) const;
+
+  /**@brief Travel time (s) between the exit of one item and the entry of the next */
+  double travelTime(const Eigen::Vector3d& from, const Eigen::Vector3d& to) const;
+
+private:
+  /**@brief Cost of reaching position i from position i - 1 (or from the start point) */
+  double arrivalCost(const std::vector<SequenceItem>& items, const std::vector<SequenceStep>& steps,
+                     std::size_t i) const;
+
+  /**@brief Re-chooses the options of positions [lo, hi] given their fixed neighbours
+   * @return Cost of all arrivals at positions lo through hi + 1 (if it exists)
+   */
+  double assignOptions(const std::vector<SequenceItem>& items, std::vector<SequenceStep>& steps,
+                       std::size_t lo, std::size_t hi) const;
+
+  std::vector<SequenceStep> nearestNeighbour(const std::vector<SequenceItem>& items) const;
+
+  /**@brief Applies the first improving relocation of a block of up to 3 items */
+  bool improveByRelocation(const std::vector<SequenceItem>& items,
+                           std::vector<SequenceStep>& steps) const;
+
+  /**@brief Applies the first improving reversal of a run of items */
+  bool improveByReversal(const std::vector<SequenceItem>& items,
+                         std::vector<SequenceStep>& steps) const;
+
+  TravelCostParameters params_;
+  Eigen::Vector3d start_;
+  bool has_start_;
+  std::size_t max_iterations_;
+};
+
+} /* namespace sequencing */
+} /* namespace godel_process_path */
+
+#endif /* SEQUENCE_OPTIMIZER_H_ */
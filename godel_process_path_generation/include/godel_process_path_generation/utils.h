@@ -107,6 +107,73 @@ inline std::vector<Pt> discretizeLinear(const Pt& p1, const Pt& p2, double max_s
   return vec;
 }
 
+/**@brief Distance from pt to the segment [a, b] */
+template <class Pt>
+inline double distToSegment(const Pt& pt, const Pt& a, const Pt& b)
+{
+  Pt ab = b - a;
+  double len2 = ab.norm2();
+  double t = len2 > 0. ? std::max(0., std::min(1., (pt - a).dot(ab) / len2)) : 0.;
+  return pt.dist(a + ab * t);
+}
+
+/**@brief Resample a densely discretized polyline so that straight runs are sparse and arcs and
+ * direction changes stay dense.
+ * Points are dropped while every dropped point lies within max_error of the chord replacing it and
+ * the chord is no longer than max_sep. Chords longer than max_sep in the input are subdivided.
+ * @param pts Input polyline
+ * @param closed Treat the last point as joined to the first (as in PolygonBoundary)
+ * @return Resampled polyline starting at pts.front(). Open polylines end at pts.back(); closed
+ * ones do not repeat the first point. The input unchanged if max_error or max_sep is not positive.
+ */
+template <class Pt>
+inline std::vector<Pt> discretizeAdaptive(const std::vector<Pt>& pts, bool closed, double max_error,
+                                          double max_sep)
+{
+  if (pts.size() < 2 || !(max_error > 0.) || !(max_sep > 0.))
+  {
+    return pts;
+  }
+
+  std::vector<Pt> vec;
+  const size_t n = pts.size();
+  const size_t last = closed ? n : n - 1; // Index of the final point; n wraps to pts.front()
+  size_t anchor = 0;
+  while (anchor < last)
+  {
+    // Extend the chord from anchor as far as the error and spacing bounds allow
+    size_t end = anchor + 1;
+    for (size_t cand = anchor + 2; cand <= last; ++cand)
+    {
+      const Pt& a = pts[anchor];
+      const Pt& b = pts[cand % n];
+      if (a.dist(b) > max_sep)
+      {
+        break;
+      }
+      bool within_error = true;
+      for (size_t kk = anchor + 1; kk < cand && within_error; ++kk)
+      {
+        within_error = distToSegment(pts[kk], a, b) <= max_error;
+      }
+      if (!within_error)
+      {
+        break;
+      }
+      end = cand;
+    }
+
+    std::vector<Pt> chord = discretizeLinear(pts[anchor], pts[end % n], max_sep);
+    vec.insert(vec.end(), chord.begin(), chord.end());
+    anchor = end;
+  }
+  if (!closed)
+  {
+    vec.push_back(pts.back());
+  }
+  return vec;
+}
+
 } /* namespace geometry */
 
 namespace translations
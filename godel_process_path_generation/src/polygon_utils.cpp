@@ -23,10 +23,14 @@
  */
 
 #include "godel_process_path_generation/polygon_utils.h"
+#include "godel_process_path_generation/segment_bvh.h"
 #include <boost/next_prior.hpp>
 #include <boost/foreach.hpp>
 #include <Eigen/Geometry>
 
+// Above this many segment pairs, intersection checks go through a SegmentBVH
+const static size_t BRUTE_FORCE_PAIRS = 1024;
+
 namespace godel_process_path
 {
 namespace polygon_utils
@@ -138,6 +142,15 @@ bool intersects(const PolygonBoundary& a, const PolygonBoundary& b)
 
 bool intersects(const std::vector<PolygonSegment>& a, const std::vector<PolygonSegment>& b)
 {
+  if (a.size() * b.size() > BRUTE_FORCE_PAIRS)
+  {
+    SegmentBVH tree_a, tree_b;
+    tree_a.build(a);
+    tree_b.build(b);
+    size_t seg_a, seg_b;
+    return tree_a.findIntersection(tree_b, seg_a, seg_b);
+  }
+
   BOOST_FOREACH (const PolygonSegment& seg_a, a)
   {
     BOOST_FOREACH (const PolygonSegment& seg_b, b)
@@ -151,15 +164,14 @@ bool intersects(const std::vector<PolygonSegment>& a, const std::vector<PolygonS
   return false;
 }
 
-bool checkBoundary(const PolygonBoundary& bnd)
+/**@brief Checks that a boundary has at least 3 points and no 0-length segments */
+static bool checkSegmentLengths(const PolygonBoundary& bnd)
 {
-  const size_t N = bnd.size();
-  if (N < 3)
+  if (bnd.size() < 3)
   {
     return false;
   }
 
-  // Check for 0-length segments
   const double LENGTH_TOL = 100. * std::numeric_limits<double>::epsilon();
   PolygonBoundary::const_iterator pt, last_pt;
   int pt_counter = 0;
@@ -181,6 +193,16 @@ bool checkBoundary(const PolygonBoundary& bnd)
     }
     pt_counter++;
   }
+  return true;
+}
+
+bool checkBoundary(const PolygonBoundary& bnd)
+{
+  const size_t N = bnd.size();
+  if (!checkSegmentLengths(bnd))
+  {
+    return false;
+  }
 
   // Subsequent checks for intersection are pointless on a triangle
   if (N == 3)
@@ -188,28 +210,15 @@ bool checkBoundary(const PolygonBoundary& bnd)
     return true;
   }
 
-  // Represent entire boundary as segments, and check for self-intersection
-  std::vector<PolygonSegment> segments;
-  boundaryToSegments(segments, bnd);
-
-  for (std::vector<PolygonSegment>::const_iterator seg = segments.begin();
-       seg != (segments.end() - 2); ++seg)
+  // Check for self-intersection between non-adjacent segments
+  SegmentBVH tree;
+  tree.build(bnd);
+  size_t seg, other_seg;
+  if (tree.findSelfIntersection(seg, other_seg))
   {
-    for (std::vector<PolygonSegment>::const_iterator other_seg = boost::next(seg, 2);
-         other_seg != segments.end(); ++other_seg)
-    {
-      if (seg == segments.begin() && other_seg == boost::prior(segments.end()))
-      {
-        continue;
-      }
-      if (seg->intersects(*other_seg))
-      {
-        ROS_WARN_STREAM("Self-intersecting polygon at segments "
-                        << seg - segments.begin() << " - " << other_seg - segments.begin() << " / "
-                        << segments.size());
-        return false;
-      }
-    }
+    ROS_WARN_STREAM("Self-intersecting polygon at segments " << seg << " - " << other_seg << " / "
+                                                             << tree.size());
+    return false;
   }
 
   return true;
@@ -220,44 +229,26 @@ bool checkBoundaryCollection(const PolygonBoundaryCollection& pbc)
   // Check each boundary individually
   BOOST_FOREACH (const PolygonBoundary& bnd, pbc)
   {
-    if (!checkBoundary(bnd)) /*call check boundary without intersection checks*/
+    if (!checkSegmentLengths(bnd))
     {
       return false;
     }
   }
 
-  // Precompute vectors of segments for polygonboundaries
-  typedef std::vector<std::vector<PolygonSegment> > SegmentsList;
-  SegmentsList segments_list;
-  BOOST_FOREACH (const PolygonBoundary& bnd, pbc)
-  {
-    std::vector<PolygonSegment> segments;
-    boundaryToSegments(segments, bnd);
-    segments_list.push_back(segments);
-  }
-
-  //  // Check global intersections between boundaries
-  //  BOOST_FOREACH(const PolygonBoundary &a, pbc)
-  //  {
-  //    BOOST_FOREACH(const PolygonBoundary &b, pbc)
-  //    {
-  //      if ((&a != &b) && intersects(a,b) )
-  //      {
-  //        return false;
-  //      }
-  //    }
-  //  }
-
-  // Check global intersections between boundaries
-  for (SegmentsList::const_iterator a = segments_list.begin(); a != segments_list.end(); ++a)
+  // Self-intersections and intersections between boundaries are found in one pass over all segments
+  SegmentBVH tree;
+  tree.build(pbc);
+  size_t seg, other_seg;
+  if (tree.findSelfIntersection(seg, other_seg))
   {
-    for (SegmentsList::const_iterator b = boost::next(a); b != segments_list.end(); ++b)
+    const SegmentRef& a = tree.ref(seg);
+    const SegmentRef& b = tree.ref(other_seg);
+    if (a.boundary == b.boundary)
     {
-      if (intersects(*a, *b))
-      {
-        return false;
-      }
+      ROS_WARN_STREAM("Self-intersecting polygon " << a.boundary << " at segments " << a.index
+                                                   << " - " << b.index);
     }
+    return false;
   }
 
   return true;
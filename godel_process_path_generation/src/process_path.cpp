@@ -59,6 +59,7 @@ visualization_msgs::Marker ProcessPath::asMarker() const
 geometry_msgs::PoseArray ProcessPath::asPoseArray() const
 {
   geometry_msgs::PoseArray poses;
+  poses.poses.reserve(pts_.size());
   for (const auto& pt : pts_)
   {
     geometry_msgs::Pose pose;
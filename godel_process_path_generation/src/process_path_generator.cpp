@@ -27,10 +27,13 @@
 #include "godel_process_path_generation/process_path_generator.h"
 #include "godel_process_path_generation/polygon_pts.hpp"
 #include "godel_process_path_generation/polygon_utils.h"
+#include "godel_process_path_generation/sequence_optimizer.h"
 #include "godel_process_path_generation/utils.h"
 
 using descartes::ProcessPt;
 
+const static size_t MAX_CHAIN_ENTRY_OPTIONS = 8; /**<Candidate start vertices per chain */
+
 namespace godel_process_path
 {
 
@@ -44,9 +47,10 @@ void ProcessPathGenerator::addInterpolatedProcessPts(const ProcessPt& start, con
   const Eigen::Affine3d& p1 = start.pose();
   const Eigen::Affine3d& p2 = end.pose();
   double sep = (p2.translation() - p1.translation()).norm();
-  if (sep > max_discretization_distance_)
+  double max_sep = adaptive_discretization_ ? max_adaptive_spacing_ : max_discretization_distance_;
+  if (sep > max_sep)
   {
-    size_t new_ptcnt = static_cast<size_t>(std::ceil(sep / max_discretization_distance_) - 1.);
+    size_t new_ptcnt = static_cast<size_t>(std::ceil(sep / max_sep) - 1.);
     for (size_t ii = 1; ii <= new_ptcnt; ++ii)
     {
       double t = static_cast<double>(ii) / static_cast<double>(new_ptcnt + 1.);
@@ -63,7 +67,10 @@ void ProcessPathGenerator::addInterpolatedProcessPts(const ProcessPt& start, con
 
 void ProcessPathGenerator::addPolygonToProcessPath(const PolygonBoundary& bnd_ref)
 {
-  PolygonBoundary bnd = bnd_ref;
+  PolygonBoundary bnd =
+      adaptive_discretization_
+          ? utils::geometry::discretizeAdaptive(bnd_ref, true, max_chord_error_, max_adaptive_spacing_)
+          : bnd_ref;
   bnd.push_back(bnd.front());
   ProcessPt process_pt;
   BOOST_FOREACH (const PolygonPt& pg_pt, bnd)
@@ -94,6 +101,73 @@ void ProcessPathGenerator::addTraverseToProcessPath(const PolygonPt& from, const
                                                                 // of vel.approach
 }
 
+void ProcessPathGenerator::sequenceChains(PolygonBoundaryCollection& polygons, std::vector<bool>& chain_starts)
+{
+  using namespace sequencing;
+
+  // [begin, end) of each chain
+  std::vector<std::pair<size_t, size_t> > chains;
+  for (size_t ii = 0; ii < polygons.size(); ++ii)
+  {
+    if (chain_starts[ii])
+    {
+      chains.push_back(std::make_pair(ii, ii));
+    }
+    chains.back().second = ii + 1;
+  }
+  if (chains.size() < 2)
+  {
+    return;
+  }
+
+  // Each option starts the chain at a different vertex of its first loop; the exit follows the
+  // same closest point step-outs createProcessPath makes.
+  std::vector<SequenceItem> items(chains.size());
+  std::vector<std::vector<size_t> > entry_indices(chains.size());
+  for (size_t cc = 0; cc < chains.size(); ++cc)
+  {
+    const PolygonBoundary& first = polygons[chains[cc].first];
+    size_t count = std::min(MAX_CHAIN_ENTRY_OPTIONS, first.size());
+    for (size_t kk = 0; kk < count; ++kk)
+    {
+      size_t idx = kk * first.size() / count;
+      PolygonPt exit = first[idx];
+      for (size_t pp = chains[cc].first + 1; pp < chains[cc].second; ++pp)
+      {
+        exit = polygons[pp][polygon_utils::closestPoint(exit, polygons[pp]).first];
+      }
+      items[cc].options.push_back(EntryOption(Eigen::Vector3d(first[idx].x, first[idx].y, 0.),
+                                              Eigen::Vector3d(exit.x, exit.y, 0.)));
+      entry_indices[cc].push_back(idx);
+    }
+  }
+
+  SequenceResult result = SequenceOptimizer(travel_cost_).solve(items);
+  if (result.steps.size() != chains.size())
+  {
+    ROS_WARN("Could not sequence loop chains, keeping them in offset order");
+    return;
+  }
+
+  PolygonBoundaryCollection ordered;
+  std::vector<bool> ordered_starts;
+  BOOST_FOREACH (const SequenceStep& step, result.steps)
+  {
+    for (size_t pp = chains[step.item].first; pp < chains[step.item].second; ++pp)
+    {
+      ordered.push_back(polygons[pp]);
+      ordered_starts.push_back(pp == chains[step.item].first);
+    }
+    PolygonBoundary& first = ordered[ordered.size() - (chains[step.item].second - chains[step.item].first)];
+    std::rotate(first.begin(), first.begin() + entry_indices[step.item][step.option], first.end());
+  }
+  polygons.swap(ordered);
+  chain_starts.swap(ordered_starts);
+
+  ROS_INFO_COND(verbose_, "Sequenced %li loop chains: estimated traverse time %.2f s -> %.2f s",
+                chains.size(), result.initial_cost, result.cost);
+}
+
 bool ProcessPathGenerator::createProcessPath()
 {
   if (!variables_ok())
@@ -121,14 +195,38 @@ bool ProcessPathGenerator::createProcessPath()
     return false;
   }
 
+  /* A chain begins wherever the offset does not decrease, i.e. where the next loop is not one
+   * step out from the previous */
+  std::vector<bool> chain_starts(path_polygons_->size(), true);
+  for (size_t ii = 1; ii < path_offsets_->size(); ++ii)
+  {
+    chain_starts[ii] = !(path_offsets_->at(ii) < path_offsets_->at(ii - 1));
+  }
+
+  // Sequencing reorders a copy: the caller's polygons stay in step with their offsets
+  PolygonBoundaryCollection polygons_copy;
+  if (optimize_sequence_)
+  {
+    polygons_copy = *path_polygons_;
+    sequenceChains(polygons_copy, chain_starts);
+  }
+  PolygonBoundaryCollection& polygons = optimize_sequence_ ? polygons_copy : *path_polygons_;
+
   /* Strategy: Create initial approach
-   * Do loops until offset increases; addTraverseToProcessPath
+   * Do loops until a new chain starts; addTraverseToProcessPath
    * Create retract */
 
+  size_t polygon_pt_count(0);
+  BOOST_FOREACH (const PolygonBoundary& polygon, polygons)
+  {
+    polygon_pt_count += polygon.size();
+  }
+
   // Add approach vector
   process_path_.clear();
+  chain_ranges_.clear();
   ProcessPt approach, start;
-  const PolygonPt& first = *(path_polygons_->begin()->begin());
+  const PolygonPt& first = *(polygons.begin()->begin());
 
   approach.setPosePosition(first.x, first.y, safe_traverse_height_);
   start << first;
@@ -137,13 +235,16 @@ bool ProcessPathGenerator::createProcessPath()
   ROS_INFO_COND(verbose_, "Created approach path.");
 
   // Do all loops until last
-  double current_offset = std::numeric_limits<double>::max();
   size_t pgIdx(0);
-  while (pgIdx < path_polygons_->size() - 1)
+  while (pgIdx < polygons.size() - 1)
   {
-    current_offset = path_offsets_->at(pgIdx);
-    const PolygonBoundary& polygon = path_polygons_->at(pgIdx);
+    const PolygonBoundary& polygon = polygons.at(pgIdx);
+    if (chain_starts[pgIdx])
+    {
+      chain_ranges_.push_back(std::make_pair(process_path_.size(), process_path_.size()));
+    }
     addPolygonToProcessPath(polygon);
+    chain_ranges_.back().second = process_path_.size();
     ROS_INFO_COND(verbose_, "Added polygon %li to process path.", pgIdx);
 
     const PolygonPt last_pgpt = polygon.front(); // Each polygon ends where it starts
@@ -151,9 +252,9 @@ bool ProcessPathGenerator::createProcessPath()
     last_pt << last_pgpt;
 
     ++pgIdx;
-    PolygonBoundary& next_polygon = path_polygons_->at(pgIdx);
+    PolygonBoundary& next_polygon = polygons.at(pgIdx);
 
-    if (path_offsets_->at(pgIdx) < current_offset)
+    if (!chain_starts[pgIdx])
     { /*Take one step out*/
       size_t rotate_index = polygon_utils::closestPoint(last_pgpt, next_polygon).first;
       std::rotate(next_polygon.begin(), next_polygon.begin() + rotate_index, next_polygon.end());
@@ -170,8 +271,13 @@ bool ProcessPathGenerator::createProcessPath()
   }
 
   // Add last loop and retract
-  const PolygonBoundary& polygon = path_polygons_->at(pgIdx);
+  const PolygonBoundary& polygon = polygons.at(pgIdx);
+  if (chain_starts[pgIdx])
+  {
+    chain_ranges_.push_back(std::make_pair(process_path_.size(), process_path_.size()));
+  }
   addPolygonToProcessPath(polygon);
+  chain_ranges_.back().second = process_path_.size();
   ROS_INFO_COND(verbose_, "Added polygon %li to process path.", pgIdx);
   const PolygonPt last_pgpt = polygon.front();
   ProcessPt last, retract;
@@ -182,6 +288,8 @@ bool ProcessPathGenerator::createProcessPath()
   ROS_INFO_COND(verbose_, "Added retract path.");
 
   ROS_INFO_COND(verbose_, "Successfully converted Polygons to ProcessPath.");
+  ROS_INFO_COND(adaptive_discretization_, "Adaptive discretization: %li polygon points, %li process "
+                                          "points", polygon_pt_count, process_path_.size());
   return true;
 }
 
@@ -38,6 +38,18 @@ const std::string OFFSET_POLYGON_SERVICE = "offset_polygon";
 
 const static double DISCRETIZATION_DISTANCE = 0.01; // m
 const static double TRAVERSE_HEIGHT = 0.075;        // m
+const static double DEFAULT_MAX_CHORD_ERROR = 0.0005; // m
+const static double DEFAULT_MAX_SPACING = 0.05;       // m
+
+// Blend speeds used by process planning; the sequencing cost of traverses between loop chains
+const static std::string BLEND_PARAM_PREFIX = "/process_planning_params/blend_params/";
+
+struct AdaptiveDiscretization
+{
+  bool enable;
+  double max_chord_error;
+  double max_spacing;
+};
 
 double dist(const Eigen::Affine3d& from, const Eigen::Affine3d& to)
 {
@@ -71,9 +83,21 @@ bool pathDataToDurations(std::vector<ros::Duration>& times,
 
 
 bool generateProcessPlan(descartes::ProcessPath& process_path,
+                         std::vector<std::pair<size_t, size_t> >& chain_ranges,
                          const godel_msgs::PathPlanningRequest& req,
-                         ros::ServiceClientPtr offset_service_client)
+                         ros::ServiceClientPtr offset_service_client,
+                         bool optimize_sequence,
+                         const std::string& offset_engine,
+                         const AdaptiveDiscretization& adaptive)
 {
+  // The path itself stays on the surface, but chains are sequenced for the traverse moves that
+  // process planning will add between them
+  godel_process_path::sequencing::TravelCostParameters travel_cost;
+  travel_cost.traverse_height = req.params.traverse_height;
+  ros::param::param(BLEND_PARAM_PREFIX + "traverse_speed", travel_cost.traverse_speed, 0.05);
+  ros::param::param(BLEND_PARAM_PREFIX + "approach_speed", travel_cost.approach_speed, 0.005);
+  ros::param::param(BLEND_PARAM_PREFIX + "retract_speed", travel_cost.retract_speed, 0.02);
+
   // Create ProcessPathGenerator and initialize.
   godel_process_path::ProcessPathGenerator ppg;
   ppg.verbose_ = true;
@@ -84,6 +108,9 @@ bool generateProcessPlan(descartes::ProcessPath& process_path,
   ppg.setTraverseHeight(0.0); // Note: We added traverse height to the newer
                               // 'process_planning' component of our system
                               // so I set the param to zero here.
+  ppg.setOptimizeSequence(optimize_sequence);
+  ppg.setTravelCost(travel_cost);
+  ppg.setAdaptiveDiscretization(adaptive.enable, adaptive.max_chord_error, adaptive.max_spacing);
   if (!ppg.variables_ok())
   {
     ROS_ERROR("Cannot continue path generation with current variables.");
@@ -98,6 +125,8 @@ bool generateProcessPlan(descartes::ProcessPath& process_path,
   ob_req.initial_offset = req.params.tool_radius + req.params.margin;
   ob_req.offset_distance = req.params.tool_radius - req.params.overlap;
   ob_req.polygons = req.surface.boundaries;
+  ob_req.engine = req.params.offset_engine.empty() ? offset_engine : req.params.offset_engine;
+  ob_req.join_type = req.params.offset_join_type;
 
   if (!offset_service_client->call(ob_req, ob_res))
   {
@@ -119,6 +148,7 @@ bool generateProcessPlan(descartes::ProcessPath& process_path,
     return false;
   }
   process_path = ppg.getProcessPath();
+  chain_ranges = ppg.getChainRanges();
 
   return true;
 }
@@ -126,14 +156,22 @@ bool generateProcessPlan(descartes::ProcessPath& process_path,
 
 bool pathGen(godel_msgs::PathPlanningRequest& req,
              godel_msgs::PathPlanningResponse& res,
-             ros::ServiceClientPtr offset_service_client)
+             ros::ServiceClientPtr offset_service_client,
+             bool optimize_sequence,
+             const std::string& offset_engine,
+             const AdaptiveDiscretization& adaptive)
 {
   // Call function to generate process path.
   godel_msgs::PathPlanningRequest path_planninging_request;
   path_planninging_request.params = req.params;
   path_planninging_request.surface = req.surface;
   descartes::ProcessPath process_path;
-  generateProcessPlan(process_path, path_planninging_request, offset_service_client);
+  std::vector<std::pair<size_t, size_t> > chain_ranges;
+  ros::WallTime start = ros::WallTime::now();
+  generateProcessPlan(process_path, chain_ranges, path_planninging_request, offset_service_client, optimize_sequence,
+                      offset_engine, adaptive);
+  ROS_INFO_STREAM("Generated process path with " << process_path.size() << " points in "
+                  << (ros::WallTime::now() - start).toSec() << " s");
 
   // Populate service response
   std::vector<descartes::ProcessPt> pts;
@@ -141,6 +179,11 @@ bool pathGen(godel_msgs::PathPlanningRequest& req,
   boost::tie(pts, transitions) = process_path.data();
 
   res.poses = process_path.asPoseArray();
+  for (size_t ii = 0; ii < chain_ranges.size(); ++ii)
+  {
+    res.segment_starts.push_back(chain_ranges[ii].first);
+    res.segment_ends.push_back(chain_ranges[ii].second);
+  }
 
   return true;
 }
@@ -152,6 +195,27 @@ int main(int argc, char** argv)
 
   ros::init(argc, argv, "process_path_generator");
   ros::NodeHandle nh;
+  ros::NodeHandle pnh("~");
+
+  // Reorder chains of offset loops to reduce traverse time between them
+  bool optimize_sequence;
+  pnh.param("optimize_sequence", optimize_sequence, true);
+
+  // Offset engine of requests that do not choose one (empty for the polygon offset service's default)
+  std::string offset_engine;
+  pnh.param<std::string>("offset_engine", offset_engine, "");
+
+  // Sample straight runs sparsely, bounded by chordal error and spacing
+  AdaptiveDiscretization adaptive;
+  pnh.param("adaptive_discretization", adaptive.enable, false);
+  pnh.param("max_chord_error", adaptive.max_chord_error, DEFAULT_MAX_CHORD_ERROR);
+  pnh.param("max_spacing", adaptive.max_spacing, DEFAULT_MAX_SPACING);
+  if (adaptive.enable && !(adaptive.max_chord_error > 0. && adaptive.max_spacing > 0.))
+  {
+    ROS_WARN("Adaptive discretization needs a positive max_chord_error and max_spacing, it is "
+             "disabled");
+    adaptive.enable = false;
+  }
 
   // waiting for service
   while (!ros::service::waitForService(OFFSET_POLYGON_SERVICE, ros::Duration(10.0f)))
@@ -164,7 +228,8 @@ int main(int argc, char** argv)
 
   ros::ServiceServer path_generator =
       nh.advertiseService<godel_msgs::PathPlanningRequest, godel_msgs::PathPlanningResponse>(
-          "process_path_generator", boost::bind(pathGen, _1, _2, boundary_offset_client));
+          "process_path_generator", boost::bind(pathGen, _1, _2, boundary_offset_client, optimize_sequence,
+                                                  offset_engine, adaptive));
   ROS_INFO("%s ready to service requests.", path_generator.getService().c_str());
   ros::spin();
 
@@ -0,0 +1,397 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * segment_bvh.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <boost/foreach.hpp>
+#include "godel_process_path_generation/segment_bvh.h"
+
+namespace
+{
+const size_t LEAF_SIZE = 4; /**<Max segments per leaf */
+
+struct CenterLess
+{
+  CenterLess(const std::vector<godel_process_path::polygon_utils::BoundingBox2D>& boxes, bool x_axis)
+      : boxes(boxes), x_axis(x_axis){};
+  const std::vector<godel_process_path::polygon_utils::BoundingBox2D>& boxes;
+  bool x_axis;
+  bool operator()(size_t a, size_t b) const
+  {
+    return x_axis ? boxes[a].min_x + boxes[a].max_x < boxes[b].min_x + boxes[b].max_x
+                  : boxes[a].min_y + boxes[a].max_y < boxes[b].min_y + boxes[b].max_y;
+  }
+};
+}
+
+namespace godel_process_path
+{
+namespace polygon_utils
+{
+
+void SegmentBVH::build(const PolygonBoundaryCollection& pbc)
+{
+  segments_.clear();
+  refs_.clear();
+  boundary_sizes_.clear();
+  std::vector<PolygonSegment> segments;
+  for (size_t bb = 0; bb < pbc.size(); ++bb)
+  {
+    if (pbc[bb].empty())
+    {
+      boundary_sizes_.push_back(0);
+      continue;
+    }
+    boundaryToSegments(segments, pbc[bb]);
+    for (size_t ii = 0; ii < segments.size(); ++ii)
+    {
+      segments_.push_back(segments[ii]);
+      refs_.push_back(SegmentRef(bb, ii));
+    }
+    boundary_sizes_.push_back(segments.size());
+  }
+  buildTree();
+}
+
+void SegmentBVH::build(const PolygonBoundary& bnd)
+{
+  build(PolygonBoundaryCollection(1, bnd));
+}
+
+void SegmentBVH::build(const std::vector<PolygonSegment>& segments)
+{
+  segments_ = segments;
+  refs_.clear();
+  for (size_t ii = 0; ii < segments.size(); ++ii)
+  {
+    refs_.push_back(SegmentRef(0, ii));
+  }
+  boundary_sizes_.assign(1, segments.size());
+  buildTree();
+}
+
+void SegmentBVH::buildTree()
+{
+  // An intersection may lie up to tol_ (relative to segment length) beyond either endpoint
+  boxes_.resize(segments_.size());
+  for (size_t ii = 0; ii < segments_.size(); ++ii)
+  {
+    BoundingBox2D& box = boxes_[ii];
+    box = BoundingBox2D();
+    box.extend(segments_[ii].start);
+    box.extend(segments_[ii].end);
+    double grow = std::abs(tol_) * segments_[ii].length();
+    box.min_x -= grow;
+    box.min_y -= grow;
+    box.max_x += grow;
+    box.max_y += grow;
+  }
+
+  order_.resize(segments_.size());
+  for (size_t ii = 0; ii < order_.size(); ++ii)
+  {
+    order_[ii] = ii;
+  }
+  nodes_.clear();
+  if (!segments_.empty())
+  {
+    nodes_.reserve(2 * segments_.size() / LEAF_SIZE + 1);
+    buildNode(0, segments_.size());
+  }
+}
+
+size_t SegmentBVH::buildNode(size_t first, size_t count)
+{
+  size_t idx = nodes_.size();
+  nodes_.push_back(Node());
+  BoundingBox2D box;
+  for (size_t ii = first; ii < first + count; ++ii)
+  {
+    box.extend(boxes_[order_[ii]]);
+  }
+  nodes_[idx].box = box;
+
+  if (count <= LEAF_SIZE)
+  {
+    nodes_[idx].first = first;
+    nodes_[idx].count = count;
+    return idx;
+  }
+
+  // Median split along the longer side
+  size_t half = count / 2;
+  std::nth_element(order_.begin() + first, order_.begin() + first + half,
+                   order_.begin() + first + count,
+                   CenterLess(boxes_, box.max_x - box.min_x >= box.max_y - box.min_y));
+  size_t left = buildNode(first, half);
+  size_t right = buildNode(first + half, count - half);
+  nodes_[idx].first = first;
+  nodes_[idx].count = 0;
+  nodes_[idx].left = left;
+  nodes_[idx].right = right;
+  return idx;
+}
+
+bool SegmentBVH::adjacent(size_t a, size_t b) const
+{
+  if (refs_[a].boundary != refs_[b].boundary)
+  {
+    return false;
+  }
+  size_t lo = std::min(refs_[a].index, refs_[b].index), hi = std::max(refs_[a].index, refs_[b].index);
+  return hi - lo == 1 || (lo == 0 && hi + 1 == boundary_sizes_[refs_[a].boundary]);
+}
+
+bool SegmentBVH::findSelfIntersection(size_t& a, size_t& b) const
+{
+  if (nodes_.empty())
+  {
+    return false;
+  }
+
+  std::vector<std::pair<size_t, size_t> > stack(1, std::make_pair(0, 0));
+  while (!stack.empty())
+  {
+    std::pair<size_t, size_t> pair = stack.back();
+    stack.pop_back();
+    const Node& na = nodes_[pair.first];
+    const Node& nb = nodes_[pair.second];
+    if (!na.box.overlaps(nb.box))
+    {
+      continue;
+    }
+
+    if (na.count > 0 && nb.count > 0)
+    {
+      for (size_t ii = na.first; ii < na.first + na.count; ++ii)
+      {
+        // Within one leaf, test each pair once
+        size_t jj_begin = pair.first == pair.second ? ii + 1 : nb.first;
+        for (size_t jj = jj_begin; jj < nb.first + nb.count; ++jj)
+        {
+          size_t sa = order_[ii], sb = order_[jj];
+          if (adjacent(sa, sb) || !boxes_[sa].overlaps(boxes_[sb]))
+          {
+            continue;
+          }
+          if (segments_[sa].intersects(segments_[sb], tol_))
+          {
+            a = std::min(sa, sb);
+            b = std::max(sa, sb);
+            return true;
+          }
+        }
+      }
+    }
+    else if (pair.first == pair.second)
+    {
+      stack.push_back(std::make_pair(na.left, na.left));
+      stack.push_back(std::make_pair(na.left, na.right));
+      stack.push_back(std::make_pair(na.right, na.right));
+    }
+    else if (nb.count > 0 || (na.count == 0 && pair.first < pair.second))
+    {
+      // Descend the inner node; nodes closer to the root have lower indices
+      stack.push_back(std::make_pair(na.left, pair.second));
+      stack.push_back(std::make_pair(na.right, pair.second));
+    }
+    else
+    {
+      stack.push_back(std::make_pair(pair.first, nb.left));
+      stack.push_back(std::make_pair(pair.first, nb.right));
+    }
+  }
+  return false;
+}
+
+bool SegmentBVH::findIntersection(const SegmentBVH& other, size_t& a, size_t& b) const
+{
+  if (nodes_.empty() || other.nodes_.empty())
+  {
+    return false;
+  }
+
+  std::vector<std::pair<size_t, size_t> > stack(1, std::make_pair(0, 0));
+  while (!stack.empty())
+  {
+    std::pair<size_t, size_t> pair = stack.back();
+    stack.pop_back();
+    const Node& na = nodes_[pair.first];
+    const Node& nb = other.nodes_[pair.second];
+    if (!na.box.overlaps(nb.box))
+    {
+      continue;
+    }
+
+    if (na.count > 0 && nb.count > 0)
+    {
+      for (size_t ii = na.first; ii < na.first + na.count; ++ii)
+      {
+        for (size_t jj = nb.first; jj < nb.first + nb.count; ++jj)
+        {
+          size_t sa = order_[ii], sb = other.order_[jj];
+          if (boxes_[sa].overlaps(other.boxes_[sb]) &&
+              segments_[sa].intersects(other.segments_[sb], tol_))
+          {
+            a = sa;
+            b = sb;
+            return true;
+          }
+        }
+      }
+    }
+    else if (nb.count > 0 || na.count == 0)
+    {
+      stack.push_back(std::make_pair(na.left, pair.second));
+      stack.push_back(std::make_pair(na.right, pair.second));
+    }
+    else
+    {
+      stack.push_back(std::make_pair(pair.first, nb.left));
+      stack.push_back(std::make_pair(pair.first, nb.right));
+    }
+  }
+  return false;
+}
+
+double SegmentBVH::closestVertex(const PolygonPt& pt, size_t& seg, bool include_last) const
+{
+  double best2 = std::numeric_limits<double>::max();
+  if (nodes_.empty())
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  std::vector<size_t> stack(1, 0);
+  while (!stack.empty())
+  {
+    const Node& node = nodes_[stack.back()];
+    stack.pop_back();
+    // Ties go to the lowest segment index, so equidistant nodes are still visited
+    if (node.box.dist2(pt) > best2)
+    {
+      continue;
+    }
+
+    if (node.count > 0)
+    {
+      for (size_t ii = node.first; ii < node.first + node.count; ++ii)
+      {
+        size_t s = order_[ii];
+        if (!include_last && refs_[s].index + 1 == boundary_sizes_[refs_[s].boundary])
+        {
+          continue;
+        }
+        double d2 = pt.dist2(segments_[s].start);
+        if (d2 < best2 || (d2 == best2 && s < seg))
+        {
+          best2 = d2;
+          seg = s;
+        }
+      }
+    }
+    else
+    {
+      // Visit the nearer child first
+      bool left_first = nodes_[node.left].box.dist2(pt) <= nodes_[node.right].box.dist2(pt);
+      stack.push_back(left_first ? node.right : node.left);
+      stack.push_back(left_first ? node.left : node.right);
+    }
+  }
+  return best2 == std::numeric_limits<double>::max() ? std::numeric_limits<double>::infinity()
+                                                     : std::sqrt(best2);
+}
+
+double SegmentBVH::closestSegment(const PolygonPt& pt, size_t& seg, PolygonPt& closest) const
+{
+  double best2 = std::numeric_limits<double>::max();
+  if (nodes_.empty())
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  std::vector<size_t> stack(1, 0);
+  while (!stack.empty())
+  {
+    const Node& node = nodes_[stack.back()];
+    stack.pop_back();
+    if (node.box.dist2(pt) >= best2)
+    {
+      continue;
+    }
+
+    if (node.count > 0)
+    {
+      for (size_t ii = node.first; ii < node.first + node.count; ++ii)
+      {
+        size_t s = order_[ii];
+        const PolygonSegment& segment = segments_[s];
+        PolygonPt v = segment.vector();
+        double len2 = v.norm2();
+        double t = len2 > 0. ? std::max(0., std::min(1., (pt - segment.start).dot(v) / len2)) : 0.;
+        PolygonPt candidate = segment.start + v * t;
+        double d2 = pt.dist2(candidate);
+        if (d2 < best2)
+        {
+          best2 = d2;
+          seg = s;
+          closest = candidate;
+        }
+      }
+    }
+    else
+    {
+      bool left_first = nodes_[node.left].box.dist2(pt) <= nodes_[node.right].box.dist2(pt);
+      stack.push_back(left_first ? node.right : node.left);
+      stack.push_back(left_first ? node.left : node.right);
+    }
+  }
+  return std::sqrt(best2);
+}
+
+bool intersects(const PolygonBoundaryCollection& a, const PolygonBoundaryCollection& b)
+{
+  SegmentBVH tree_a, tree_b;
+  tree_a.build(a);
+  tree_b.build(b);
+  size_t seg_a, seg_b;
+  return tree_a.findIntersection(tree_b, seg_a, seg_b);
+}
+
+std::vector<std::pair<size_t, float> > closestPoints(const std::vector<PolygonPt>& pts,
+                                                     const PolygonBoundary& bnd)
+{
+  std::vector<std::pair<size_t, float> > result;
+  result.reserve(pts.size());
+  SegmentBVH tree;
+  tree.build(bnd);
+  BOOST_FOREACH (const PolygonPt& pt, pts)
+  {
+    size_t seg(0);
+    double dist = tree.closestVertex(pt, seg, false);
+    result.push_back(std::make_pair(tree.ref(seg).index, static_cast<float>(dist)));
+  }
+  return result;
+}
+
+} /* namespace polygon_utils */
+} /* namespace godel_process_path */
@@ -0,0 +1,321 @@
+/*
+ * Software License Agreement (Apache License)
+ *
+ * Copyright (c) 2014, Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*
+ * sequence_optimizer.cpp
+ */
+
+#include <algorithm>
+#include <limits>
+#include "godel_process_path_generation/sequence_optimizer.h"
+
+namespace
+{
+const double IMPROVEMENT_EPS = 1e-9;      /**<(s) Moves must improve by more than this */
+const std::size_t MAX_RELOCATED_BLOCK = 3; /**<Or-opt block lengths 1..3 */
+const std::size_t MAX_REVERSAL_LENGTH = 50; /**<Bounds the cost of a reversal pass on long sequences */
+const std::size_t DEFAULT_MAX_ITERATIONS = 1000;
+
+inline double positiveOrOne(double v) { return v > 0. ? v : 1.; }
+}
+
+namespace godel_process_path
+{
+namespace sequencing
+{
+
+SequenceOptimizer::SequenceOptimizer(const TravelCostParameters& params)
+    : params_(params), start_(Eigen::Vector3d::Zero()), has_start_(false),
+      max_iterations_(DEFAULT_MAX_ITERATIONS)
+{
+  params_.traverse_speed = positiveOrOne(params_.traverse_speed);
+  params_.approach_speed = positiveOrOne(params_.approach_speed);
+  params_.retract_speed = positiveOrOne(params_.retract_speed);
+  params_.traverse_height = std::max(0., params_.traverse_height);
+}
+
+double SequenceOptimizer::travelTime(const Eigen::Vector3d& from, const Eigen::Vector3d& to) const
+{
+  // Both ends are lifted by the same height, so the traverse covers the straight-line distance
+  return params_.traverse_height / params_.retract_speed + (to - from).norm() / params_.traverse_speed +
+         params_.traverse_height / params_.approach_speed;
+}
+
+double SequenceOptimizer::arrivalCost(const std::vector<SequenceItem>& items,
+                                      const std::vector<SequenceStep>& steps, std::size_t i) const
+{
+  const Eigen::Vector3d& entry = items[steps[i].item].options[steps[i].option].entry;
+  if (i > 0)
+  {
+    return travelTime(items[steps[i - 1].item].options[steps[i - 1].option].exit, entry);
+  }
+  return has_start_ ? travelTime(start_, entry) : 0.;
+}
+
+double SequenceOptimizer::cost(const std::vector<SequenceItem>& items,
+                               const std::vector<SequenceStep>& steps) const
+{
+  double total = 0.;
+  for (std::size_t i = 0; i < steps.size(); ++i)
+  {
+    total += arrivalCost(items, steps, i);
+  }
+  return total;
+}
+
+double SequenceOptimizer::assignOptions(const std::vector<SequenceItem>& items,
+                                        std::vector<SequenceStep>& steps, std::size_t lo,
+                                        std::size_t hi) const
+{
+  // Viterbi over the options of positions lo..hi
+  std::vector<std::vector<std::size_t> > back(hi - lo + 1);
+  const std::vector<EntryOption>& first = items[steps[lo].item].options;
+  std::vector<double> acc(first.size(), 0.);
+  for (std::size_t o = 0; o < first.size(); ++o)
+  {
+    if (lo > 0)
+      acc[o] = travelTime(items[steps[lo - 1].item].options[steps[lo - 1].option].exit, first[o].entry);
+    else if (has_start_)
+      acc[o] = travelTime(start_, first[o].entry);
+  }
+
+  for (std::size_t p = lo + 1; p <= hi; ++p)
+  {
+    const std::vector<EntryOption>& prev = items[steps[p - 1].item].options;
+    const std::vector<EntryOption>& cur = items[steps[p].item].options;
+    std::vector<double> next(cur.size(), std::numeric_limits<double>::max());
+    back[p - lo].resize(cur.size(), 0);
+    for (std::size_t o = 0; o < cur.size(); ++o)
+    {
+      for (std::size_t q = 0; q < prev.size(); ++q)
+      {
+        double c = acc[q] + travelTime(prev[q].exit, cur[o].entry);
+        if (c < next[o])
+        {
+          next[o] = c;
+          back[p - lo][o] = q;
+        }
+      }
+    }
+    acc.swap(next);
+  }
+
+  const std::vector<EntryOption>& last = items[steps[hi].item].options;
+  double best = std::numeric_limits<double>::max();
+  std::size_t best_option = 0;
+  for (std::size_t o = 0; o < last.size(); ++o)
+  {
+    double c = acc[o];
+    if (hi + 1 < steps.size())
+      c += travelTime(last[o].exit, items[steps[hi + 1].item].options[steps[hi + 1].option].entry);
+    if (c < best)
+    {
+      best = c;
+      best_option = o;
+    }
+  }
+
+  for (std::size_t p = hi;; --p)
+  {
+    steps[p].option = best_option;
+    if (p == lo)
+      break;
+    best_option = back[p - lo][best_option];
+  }
+  return best;
+}
+
+std::vector<SequenceStep>
+SequenceOptimizer::nearestNeighbour(const std::vector<SequenceItem>& items) const
+{
+  std::vector<SequenceStep> steps;
+  std::vector<bool> used(items.size(), false);
+
+  bool have_position = has_start_;
+  Eigen::Vector3d position = start_;
+  if (!have_position)
+  {
+    // Without a start point, begin with the first item as given
+    steps.push_back(SequenceStep(0, 0));
+    used[0] = true;
+    position = items[0].options[0].exit;
+  }
+
+  while (steps.size() < items.size())
+  {
+    double best = std::numeric_limits<double>::max();
+    SequenceStep best_step;
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+      if (used[i])
+        continue;
+      for (std::size_t o = 0; o < items[i].options.size(); ++o)
+      {
+        double c = travelTime(position, items[i].options[o].entry);
+        if (c < best)
+        {
+          best = c;
+          best_step = SequenceStep(i, o);
+        }
+      }
+    }
+    used[best_step.item] = true;
+    steps.push_back(best_step);
+    position = items[best_step.item].options[best_step.option].exit;
+  }
+  return steps;
+}
+
+bool SequenceOptimizer::improveByRelocation(const std::vector<SequenceItem>& items,
+                                            std::vector<SequenceStep>& steps) const
+{
+  const std::size_t n = steps.size();
+
+  // Arrival cost at 'to' from 'from', where from == n denotes the start point
+  auto link = [&](std::size_t from, std::size_t to) -> double
+  {
+    const Eigen::Vector3d& entry = items[steps[to].item].options[steps[to].option].entry;
+    if (from == n)
+      return has_start_ ? travelTime(start_, entry) : 0.;
+    return travelTime(items[steps[from].item].options[steps[from].option].exit, entry);
+  };
+
+  for (std::size_t len = 1; len <= MAX_RELOCATED_BLOCK && len < n; ++len)
+  {
+    for (std::size_t i = 0; i + len <= n; ++i)
+    {
+      const std::size_t j = i + len - 1; // last position of the block
+      const std::size_t before = i > 0 ? i - 1 : n;
+      const bool has_after = j + 1 < n;
+
+      double removed = link(before, i) + (has_after ? link(j, j + 1) : 0.);
+      double bridged = has_after ? link(before, j + 1) : 0.;
+
+      // Insert the block after position p (p == n inserts it at the front)
+      for (std::size_t p = 0; p <= n; ++p)
+      {
+        if (p == before || (p >= i && p <= j))
+          continue;
+
+        // Element that follows p once the block is removed
+        const std::size_t succ = p == n ? 0 : p + 1;
+        const bool has_succ = succ < n;
+
+        double opened = has_succ ? link(p, succ) : 0.;
+        double inserted = link(p, i) + (has_succ ? link(j, succ) : 0.);
+
+        double delta = (bridged - removed) + (inserted - opened);
+        if (delta < -IMPROVEMENT_EPS)
+        {
+          std::vector<SequenceStep> block(steps.begin() + i, steps.begin() + j + 1);
+          std::vector<SequenceStep> rest;
+          rest.reserve(n);
+          for (std::size_t k = 0; k < n; ++k)
+          {
+            if (k >= i && k <= j)
+              continue;
+            if (p == n && rest.empty())
+              rest.insert(rest.end(), block.begin(), block.end());
+            rest.push_back(steps[k]);
+            if (k == p)
+              rest.insert(rest.end(), block.begin(), block.end());
+          }
+          steps.swap(rest);
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool SequenceOptimizer::improveByReversal(const std::vector<SequenceItem>& items,
+                                          std::vector<SequenceStep>& steps) const
+{
+  const std::size_t n = steps.size();
+  for (std::size_t i = 0; i + 1 < n; ++i)
+  {
+    for (std::size_t j = i + 1; j < n && j - i < MAX_REVERSAL_LENGTH; ++j)
+    {
+      double current = 0.;
+      for (std::size_t k = i; k <= std::min(j + 1, n - 1); ++k)
+      {
+        current += arrivalCost(items, steps, k);
+      }
+
+      std::vector<SequenceStep> candidate(steps);
+      std::reverse(candidate.begin() + i, candidate.begin() + j + 1);
+      double reversed = assignOptions(items, candidate, i, j);
+      if (reversed < current - IMPROVEMENT_EPS)
+      {
+        steps.swap(candidate);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+SequenceResult SequenceOptimizer::solve(const std::vector<SequenceItem>& items) const
+{
+  SequenceResult result;
+  for (std::size_t i = 0; i < items.size(); ++i)
+  {
+    if (items[i].options.empty())
+    {
+      // There is no way to execute this item, so no order can be given for the set
+      return result;
+    }
+  }
+  if (items.empty())
+  {
+    return result;
+  }
+
+  std::vector<SequenceStep> identity(items.size());
+  for (std::size_t i = 0; i < items.size(); ++i)
+  {
+    identity[i] = SequenceStep(i, 0);
+  }
+  result.initial_cost = cost(items, identity);
+
+  std::vector<SequenceStep> steps = nearestNeighbour(items);
+  assignOptions(items, steps, 0, steps.size() - 1);
+
+  for (std::size_t iter = 0; iter < max_iterations_; ++iter)
+  {
+    if (!improveByRelocation(items, steps) && !improveByReversal(items, steps))
+    {
+      break;
+    }
+    assignOptions(items, steps, 0, steps.size() - 1);
+  }
+
+  result.cost = cost(items, steps);
+  if (result.cost > result.initial_cost)
+  {
+    // Construction heuristics are not guaranteed to beat the input order; never return worse
+    assignOptions(items, identity, 0, identity.size() - 1);
+    steps = identity;
+    result.cost = cost(items, steps);
+  }
+  result.steps = steps;
+  return result;
+}
+
+} /* namespace sequencing */
+} /* namespace godel_process_path */
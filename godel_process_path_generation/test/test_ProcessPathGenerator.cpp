@@ -7,6 +7,7 @@
 
 #include <gtest/gtest.h>
 #include "godel_process_path_generation/process_path_generator.h"
+#include "godel_process_path_generation/utils.h"
 
 using godel_process_path::ProcessPathGenerator;
 using godel_process_path::PolygonPt;
@@ -72,6 +73,126 @@ TEST(ProcessPathGeneratorTest, complete)
   EXPECT_TRUE(ppg.createProcessPath());
 }
 
+/* Square with rounded corners, discretized at a fixed 1 cm as the offset service does */
+static godel_process_path::PolygonBoundary roundedSquare(double side, double radius)
+{
+  using godel_process_path::utils::geometry::discretizeArc2D;
+  using godel_process_path::utils::geometry::discretizeLinear;
+  const double h = side / 2. - radius;
+  const PolygonPt centers[] = { PolygonPt(h, -h), PolygonPt(h, h), PolygonPt(-h, h),
+                                PolygonPt(-h, -h) };
+  godel_process_path::PolygonBoundary bnd;
+  for (size_t ii = 0; ii < 4; ++ii)
+  {
+    double a0 = M_PI_2 * (static_cast<double>(ii) - 1.);
+    const PolygonPt& c = centers[ii];
+    PolygonPt arc_start = c + PolygonPt(std::cos(a0), std::sin(a0)) * radius;
+    PolygonPt arc_end = c + PolygonPt(std::cos(a0 + M_PI_2), std::sin(a0 + M_PI_2)) * radius;
+    const PolygonPt& next_c = centers[(ii + 1) % 4];
+    PolygonPt line_end = next_c + PolygonPt(std::cos(a0 + M_PI_2), std::sin(a0 + M_PI_2)) * radius;
+
+    std::vector<PolygonPt> pts = discretizeArc2D(arc_start, arc_end, c, true, .01);
+    bnd.insert(bnd.end(), pts.begin(), pts.end());
+    pts = discretizeLinear(arc_end, line_end, .01);
+    bnd.insert(bnd.end(), pts.begin(), pts.end());
+  }
+  return bnd;
+}
+
+TEST(ProcessPathGeneratorTest, discretizeAdaptive)
+{
+  using godel_process_path::utils::geometry::discretizeAdaptive;
+  using godel_process_path::utils::geometry::distToSegment;
+  const double max_error = .0005, max_sep = .05;
+
+  godel_process_path::PolygonBoundary dense = roundedSquare(1., .05);
+  godel_process_path::PolygonBoundary sparse = discretizeAdaptive(dense, true, max_error, max_sep);
+  ASSERT_GT(sparse.size(), 4u);
+  EXPECT_LT(sparse.size() * 3, dense.size());
+  EXPECT_EQ(dense.front(), sparse.front());
+
+  for (size_t ii = 0; ii < sparse.size(); ++ii)
+  {
+    EXPECT_LE(sparse[ii].dist(sparse[(ii + 1) % sparse.size()]), max_sep + 1e-12);
+  }
+
+  // Every input point lies within max_error of the resampled loop
+  for (size_t ii = 0; ii < dense.size(); ++ii)
+  {
+    double best = std::numeric_limits<double>::max();
+    for (size_t jj = 0; jj < sparse.size(); ++jj)
+    {
+      best = std::min(best, distToSegment(dense[ii], sparse[jj], sparse[(jj + 1) % sparse.size()]));
+    }
+    EXPECT_LE(best, max_error + 1e-12);
+  }
+
+  // Open polylines keep both ends
+  godel_process_path::PolygonBoundary line;
+  for (size_t ii = 0; ii <= 100; ++ii)
+  {
+    line.push_back(PolygonPt(.01 * ii, 0.));
+  }
+  godel_process_path::PolygonBoundary line_sparse =
+      discretizeAdaptive(line, false, max_error, .055);
+  ASSERT_EQ(21u, line_sparse.size()); // Every 5th point
+  EXPECT_EQ(line.back(), line_sparse.back());
+
+  // Non-positive bounds leave the input as it is
+  EXPECT_EQ(line, discretizeAdaptive(line, false, max_error, 0.));
+  EXPECT_EQ(line, discretizeAdaptive(line, false, 0., max_sep));
+  EXPECT_EQ(dense, discretizeAdaptive(dense, true, max_error, -max_sep));
+}
+
+TEST(ProcessPathGeneratorTest, adaptiveRejectsNonPositiveBounds)
+{
+  ProcessPathGenerator ppg;
+  ppg.setTraverseHeight(.05);
+  ppg.setToolRadius(.025);
+  ppg.setAdaptiveDiscretization(true, .0005, .05);
+  EXPECT_TRUE(ppg.variables_ok());
+
+  ppg.setAdaptiveDiscretization(true, .0005, 0.);
+  EXPECT_FALSE(ppg.variables_ok());
+  ppg.setAdaptiveDiscretization(true, 0., .05);
+  EXPECT_FALSE(ppg.variables_ok());
+  ppg.setAdaptiveDiscretization(true, -.0005, -.05);
+  EXPECT_FALSE(ppg.variables_ok());
+
+  // The bounds are unused when adaptive discretization is off
+  ppg.setAdaptiveDiscretization(false, 0., 0.);
+  EXPECT_TRUE(ppg.variables_ok());
+}
+
+TEST(ProcessPathGeneratorTest, adaptivePointCount)
+{
+  size_t counts[2];
+  for (int adaptive = 0; adaptive < 2; ++adaptive)
+  {
+    ProcessPathGenerator ppg;
+    ppg.setTraverseHeight(.05);
+    ppg.setMargin(.005);
+    ppg.setOverlap(.01);
+    ppg.setToolRadius(.025);
+    ppg.setDiscretizationDistance(.01);
+    ppg.setVelocity(godel_process_path::ProcessVelocity());
+    ppg.setAdaptiveDiscretization(adaptive == 1, .0005, .05);
+
+    godel_process_path::PolygonBoundaryCollection boundaries;
+    boundaries.push_back(roundedSquare(1., .05));
+    boundaries.push_back(roundedSquare(.9, .05));
+    std::vector<double> offsets;
+    offsets.push_back(.08);
+    offsets.push_back(.03);
+    ASSERT_TRUE(ppg.setPathPolygons(&boundaries, &offsets));
+    ASSERT_TRUE(ppg.createProcessPath());
+    counts[adaptive] = ppg.getProcessPath().size();
+  }
+  std::cout << "[ COUNT    ] fixed " << counts[0] << " points, adaptive " << counts[1] << " points"
+            << std::endl;
+  EXPECT_LT(counts[1] * 3, counts[0]);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
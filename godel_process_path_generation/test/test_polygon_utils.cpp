@@ -23,7 +23,28 @@
  */
 
 #include <gtest/gtest.h>
+#include <cstdlib>
 #include "godel_process_path_generation/polygon_utils.h"
+#include "godel_process_path_generation/segment_bvh.h"
+
+using godel_process_path::PolygonBoundary;
+using godel_process_path::PolygonBoundaryCollection;
+using godel_process_path::PolygonPt;
+using godel_process_path::polygon_utils::PolygonSegment;
+using godel_process_path::polygon_utils::SegmentBVH;
+
+/* CCW polygon with n vertices and radius jitter; self-intersects only if jitter is large */
+static PolygonBoundary wavyCircle(double cx, double cy, double r, size_t n, double jitter)
+{
+  PolygonBoundary bnd;
+  for (size_t ii = 0; ii < n; ++ii)
+  {
+    double a = 2. * M_PI * static_cast<double>(ii) / static_cast<double>(n);
+    double rr = r + jitter * (static_cast<double>(std::rand()) / RAND_MAX - .5);
+    bnd.push_back(PolygonPt(cx + rr * std::cos(a), cy + rr * std::sin(a)));
+  }
+  return bnd;
+}
 
 TEST(PolygonSegment, simple)
 {
@@ -64,6 +85,101 @@ TEST(PolygonSegment, complex)
   EXPECT_TRUE(s41.intersects(s23));
 }
 
+TEST(SegmentBVH, matchesBruteForce)
+{
+  std::srand(1);
+  for (int trial = 0; trial < 50; ++trial)
+  {
+    // Random segments in the unit square
+    std::vector<PolygonSegment> a, b;
+    for (size_t ii = 0; ii < 40; ++ii)
+    {
+      PolygonPt p(1. * std::rand() / RAND_MAX, 1. * std::rand() / RAND_MAX);
+      PolygonPt q(1. * std::rand() / RAND_MAX, 1. * std::rand() / RAND_MAX);
+      (ii % 2 ? a : b).push_back(PolygonSegment(p, p + (q - p) * .1));
+    }
+
+    bool brute = false;
+    for (size_t ii = 0; ii < a.size(); ++ii)
+      for (size_t jj = 0; jj < b.size(); ++jj)
+        brute = brute || a[ii].intersects(b[jj]);
+
+    SegmentBVH tree_a, tree_b;
+    tree_a.build(a);
+    tree_b.build(b);
+    size_t seg_a, seg_b;
+    bool found = tree_a.findIntersection(tree_b, seg_a, seg_b);
+    EXPECT_EQ(brute, found);
+    if (found)
+    {
+      EXPECT_TRUE(a[seg_a].intersects(b[seg_b]));
+    }
+  }
+}
+
+TEST(SegmentBVH, checkBoundary)
+{
+  std::srand(2);
+  PolygonBoundary bnd = wavyCircle(0., 0., 1., 5000, 1e-4);
+  EXPECT_TRUE(godel_process_path::polygon_utils::checkBoundary(bnd));
+
+  // Swapping two distant vertices creates a self-intersection
+  std::swap(bnd[100], bnd[2600]);
+  EXPECT_FALSE(godel_process_path::polygon_utils::checkBoundary(bnd));
+}
+
+TEST(SegmentBVH, checkBoundaryCollection)
+{
+  std::srand(3);
+  PolygonBoundaryCollection pbc;
+  pbc.push_back(wavyCircle(0., 0., 1., 2000, 1e-4));
+  PolygonBoundary hole = wavyCircle(.2, 0., .5, 1000, 1e-4);
+  std::reverse(hole.begin(), hole.end());
+  pbc.push_back(hole);
+  EXPECT_TRUE(godel_process_path::polygon_utils::checkBoundaryCollection(pbc));
+
+  // Move the hole so that it crosses the outer boundary
+  for (size_t ii = 0; ii < pbc[1].size(); ++ii)
+  {
+    pbc[1][ii].x += .4;
+  }
+  EXPECT_FALSE(godel_process_path::polygon_utils::checkBoundaryCollection(pbc));
+
+  PolygonBoundaryCollection other(1, wavyCircle(3., 0., .5, 100, 0.));
+  EXPECT_FALSE(godel_process_path::polygon_utils::intersects(pbc, other));
+  other[0].push_back(PolygonPt(0., 0.)); // Spike into the first boundary
+  EXPECT_TRUE(godel_process_path::polygon_utils::intersects(pbc, other));
+}
+
+TEST(SegmentBVH, closestPoint)
+{
+  std::srand(4);
+  PolygonBoundary bnd = wavyCircle(0., 0., 1., 3000, .05);
+  std::vector<PolygonPt> pts;
+  for (size_t ii = 0; ii < 200; ++ii)
+  {
+    pts.push_back(PolygonPt(4. * std::rand() / RAND_MAX - 2., 4. * std::rand() / RAND_MAX - 2.));
+  }
+  pts.push_back(bnd.back()); // The last vertex is never reported
+
+  std::vector<std::pair<size_t, float> > batch =
+      godel_process_path::polygon_utils::closestPoints(pts, bnd);
+  ASSERT_EQ(pts.size(), batch.size());
+  for (size_t ii = 0; ii < pts.size(); ++ii)
+  {
+    std::pair<size_t, float> linear = godel_process_path::polygon_utils::closestPoint(pts[ii], bnd);
+    EXPECT_EQ(linear.first, batch[ii].first);
+    EXPECT_FLOAT_EQ(linear.second, batch[ii].second);
+  }
+
+  SegmentBVH tree;
+  tree.build(bnd);
+  size_t seg;
+  PolygonPt closest;
+  EXPECT_NEAR(0., tree.closestSegment((bnd[10] + bnd[11]) * .5, seg, closest), 1e-12);
+  EXPECT_EQ(10u, seg);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
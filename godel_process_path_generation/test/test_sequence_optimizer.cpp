@@ -0,0 +1,141 @@
+/*
+ * test_sequence_optimizer.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "godel_process_path_generation/sequence_optimizer.h"
+
+using namespace godel_process_path::sequencing;
+
+static SequenceItem pointItem(double x, double y)
+{
+  SequenceItem item;
+  item.options.push_back(EntryOption(Eigen::Vector3d(x, y, 0.), Eigen::Vector3d(x, y, 0.)));
+  return item;
+}
+
+/* Exactly one step per item */
+static bool isPermutation(const std::vector<SequenceStep>& steps, std::size_t n)
+{
+  std::vector<bool> seen(n, false);
+  for (std::size_t i = 0; i < steps.size(); ++i)
+  {
+    if (steps[i].item >= n || seen[steps[i].item])
+      return false;
+    seen[steps[i].item] = true;
+  }
+  return steps.size() == n;
+}
+
+TEST(SequenceOptimizerTest, empty)
+{
+  SequenceOptimizer opt;
+  SequenceResult result = opt.solve(std::vector<SequenceItem>());
+  EXPECT_TRUE(result.steps.empty());
+  EXPECT_EQ(0., result.cost);
+}
+
+TEST(SequenceOptimizerTest, rejectItemWithoutOptions)
+{
+  std::vector<SequenceItem> items;
+  items.push_back(pointItem(0., 0.));
+  items.push_back(SequenceItem());
+  items.push_back(pointItem(1., 0.));
+
+  SequenceOptimizer opt;
+  opt.setStart(Eigen::Vector3d(2., 0., 0.));
+  SequenceResult result = opt.solve(items);
+  EXPECT_TRUE(result.steps.empty());
+  EXPECT_EQ(0., result.cost);
+  EXPECT_EQ(0., result.initial_cost);
+}
+
+TEST(SequenceOptimizerTest, shuffledLine)
+{
+  // Points on a line in scrambled order; the optimal open path visits them left to right
+  const double xs[] = { 0., 5., 2., 8., 1., 6., 3., 9., 4., 7. };
+  std::vector<SequenceItem> items;
+  for (std::size_t i = 0; i < 10; ++i)
+  {
+    items.push_back(pointItem(xs[i], 0.));
+  }
+
+  SequenceOptimizer opt;
+  opt.setStart(Eigen::Vector3d(-1., 0., 0.));
+  SequenceResult result = opt.solve(items);
+
+  ASSERT_TRUE(isPermutation(result.steps, items.size()));
+  EXPECT_NEAR(10., result.cost, 1e-9);
+  EXPECT_LT(result.cost, result.initial_cost);
+  for (std::size_t i = 0; i < result.steps.size(); ++i)
+  {
+    EXPECT_EQ(static_cast<double>(i), xs[result.steps[i].item]);
+  }
+}
+
+TEST(SequenceOptimizerTest, chooseReversedOption)
+{
+  // The second segment is given pointing back towards the first; executing it reversed avoids
+  // travelling across it
+  std::vector<SequenceItem> items(2);
+  items[0].options.push_back(EntryOption(Eigen::Vector3d(0., 0., 0.), Eigen::Vector3d(1., 0., 0.)));
+  items[1].options.push_back(EntryOption(Eigen::Vector3d(3., 1., 0.), Eigen::Vector3d(1., 1., 0.)));
+  items[1].options.push_back(EntryOption(Eigen::Vector3d(1., 1., 0.), Eigen::Vector3d(3., 1., 0.)));
+
+  SequenceOptimizer opt;
+  opt.setStart(Eigen::Vector3d(0., 0., 0.));
+  SequenceResult result = opt.solve(items);
+
+  ASSERT_EQ(2u, result.steps.size());
+  EXPECT_EQ(0u, result.steps[0].item);
+  EXPECT_EQ(1u, result.steps[1].option);
+  EXPECT_NEAR(1., result.cost, 1e-9);
+}
+
+TEST(SequenceOptimizerTest, travelCost)
+{
+  TravelCostParameters params;
+  params.traverse_height = 0.1;
+  params.retract_speed = 0.1;
+  params.approach_speed = 0.05;
+  params.traverse_speed = 0.5;
+  SequenceOptimizer opt(params);
+
+  // 1 s up, 2 s across, 2 s down
+  EXPECT_NEAR(5., opt.travelTime(Eigen::Vector3d(0., 0., 0.), Eigen::Vector3d(1., 0., 0.)), 1e-9);
+}
+
+TEST(SequenceOptimizerTest, neverWorseThanInput)
+{
+  std::srand(42);
+  TravelCostParameters params;
+  params.traverse_height = 0.05;
+  params.traverse_speed = 0.05;
+  params.approach_speed = 0.005;
+  params.retract_speed = 0.02;
+  SequenceOptimizer opt(params);
+
+  for (int trial = 0; trial < 10; ++trial)
+  {
+    std::vector<SequenceItem> items(40);
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+      Eigen::Vector3d a = Eigen::Vector3d::Random();
+      Eigen::Vector3d b = a + 0.1 * Eigen::Vector3d::Random();
+      items[i].options.push_back(EntryOption(a, b));
+      items[i].options.push_back(EntryOption(b, a));
+    }
+
+    SequenceResult result = opt.solve(items);
+    ASSERT_TRUE(isPermutation(result.steps, items.size()));
+    EXPECT_LE(result.cost, result.initial_cost);
+    EXPECT_NEAR(result.cost, opt.cost(items, result.steps), 1e-9);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
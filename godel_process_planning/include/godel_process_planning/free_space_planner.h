@@ -0,0 +1,165 @@
+#ifndef GODEL_PROCESS_PLANNING_FREE_SPACE_PLANNER_H
+#define GODEL_PROCESS_PLANNING_FREE_SPACE_PLANNER_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <moveit/robot_model/robot_model.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+/*
+ * Collision free joint space motions between two configurations, planned by MoveIt.
+ *
+ * Approach and depart moves that cannot be joint interpolated used to cost one MoveIt planning
+ * call each, over a service connection opened for that call, with one planner and a budget of
+ * many seconds. FreeSpacePlanner keeps its service connections open, tries a list of planner
+ * configurations in turn, each with a short budget, and takes the first valid answer, and
+ * remembers the motions it planned: the next plan from the same home position to the same
+ * approach point (or back) reuses them.
+ *
+ * The planner configurations are not raced against each other. move_group serves the planning
+ * service from a single thread, so concurrent requests would only queue behind each other, and a
+ * request it has started cannot be cancelled once another planner has answered. Each
+ * configuration instead makes several attempts within MoveIt, which picks the shortest of them.
+ */
+namespace godel_process_planning
+{
+
+struct FreeSpacePlannerConfig
+{
+  FreeSpacePlannerConfig(const std::string& planner_id, double planning_time, int planning_attempts)
+      : planner_id(planner_id), planning_time(planning_time), planning_attempts(planning_attempts){};
+  std::string planner_id; /**<A planner configuration of the MoveIt planning pipeline */
+  double planning_time;   /**<(s) Allowed planning time */
+  int planning_attempts;  /**<Attempts MoveIt makes (in parallel) and picks the shortest of */
+};
+
+struct FreeSpacePlannerParameters
+{
+  FreeSpacePlannerParameters()
+      : planners{FreeSpacePlannerConfig("RRTConnectkConfigDefault", 1.0, 4),
+                 FreeSpacePlannerConfig("LBKPIECEkConfigDefault", 1.0, 4),
+                 FreeSpacePlannerConfig("RRTkConfigDefault", 1.0, 4)},
+        velocity_scaling(0.1), cache_capacity(32), cache_tolerance(1e-3){};
+  std::vector<FreeSpacePlannerConfig> planners; /**<Tried in order until one finds a motion */
+  double velocity_scaling; /**<Scales the velocity limits MoveIt times the motion with */
+  std::size_t cache_capacity; /**<Maximum number of remembered motions; 0 disables the cache */
+  double cache_tolerance;  /**<(rad) Configurations closer than this in every joint are the same */
+};
+
+struct FreeSpacePlannerStats
+{
+  FreeSpacePlannerStats() : cache_hits(0), cache_misses(0), planned(0), failed(0){};
+  std::size_t cache_hits;
+  std::size_t cache_misses;
+  std::size_t planned; /**<Motions planned by one of the planners */
+  std::size_t failed;  /**<Motions no planner found in time */
+};
+
+std::ostream& operator<<(std::ostream& os, const FreeSpacePlannerStats& stats);
+
+/**@brief Counts accumulated between two snapshots */
+FreeSpacePlannerStats operator-(const FreeSpacePlannerStats& after, const FreeSpacePlannerStats& before);
+
+/**
+ * @brief Remembers joint trajectories by their start and goal configuration. A trajectory also
+ * answers for the reverse motion, reversed, so the depart move back home can reuse the approach.
+ * Least recently used entries are evicted first. Not synchronized.
+ */
+class FreeMoveCache
+{
+public:
+  FreeMoveCache(std::size_t capacity, double tolerance);
+
+  /**
+   * @brief Looks up a motion from 'start' to 'goal', or from 'goal' to 'start'
+   * @param traj Output; the stored trajectory, reversed if needed, with its first and last
+   *        positions set to exactly 'start' and 'goal'
+   */
+  bool find(const std::vector<double>& start, const std::vector<double>& goal,
+            trajectory_msgs::JointTrajectory& traj);
+
+  /**@brief Stores 'traj' for the motion from its first to its last point */
+  void insert(const trajectory_msgs::JointTrajectory& traj);
+
+  /**@brief Drops the motion between 'start' and 'goal' (in either direction), e.g. once it is in collision */
+  void erase(const std::vector<double>& start, const std::vector<double>& goal);
+
+  std::size_t size() const { return entries_.size(); }
+
+private:
+  struct Entry
+  {
+    std::vector<double> start;
+    std::vector<double> goal;
+    trajectory_msgs::JointTrajectory traj;
+  };
+
+  bool near(const std::vector<double>& a, const std::vector<double>& b) const;
+
+  // Most recently used first
+  std::list<Entry>::iterator findEntry(const std::vector<double>& start, const std::vector<double>& goal,
+                                       bool& reversed);
+
+  std::size_t capacity_;
+  double tolerance_;
+  std::list<Entry> entries_;
+};
+
+/**@brief 'traj' played backwards: points in reverse order, timed from its end, velocities negated */
+trajectory_msgs::JointTrajectory reverseTrajectory(const trajectory_msgs::JointTrajectory& traj);
+
+/**@brief (rad) The length of 'traj' in joint space */
+double jointPathLength(const trajectory_msgs::JointTrajectory& traj);
+
+/**
+ * @brief Plans motions of one planning group through MoveIt's motion planning service. Safe to
+ * call from several threads at once; concurrent calls use separate service connections.
+ */
+class FreeSpacePlanner
+{
+public:
+  FreeSpacePlanner(moveit::core::RobotModelConstPtr model, const std::string& group_name,
+                   const FreeSpacePlannerParameters& params = FreeSpacePlannerParameters());
+
+  /**
+   * @brief A motion from 'start' to 'goal' that was planned before, in either direction. Whether
+   * it is still collision free in the current scene is up to the caller to check.
+   */
+  bool findCached(const std::vector<double>& start, const std::vector<double>& goal,
+                  trajectory_msgs::JointTrajectory& traj);
+
+  /**@brief Forgets the cached motion between 'start' and 'goal', e.g. because it is now in collision */
+  void forgetCached(const std::vector<double>& start, const std::vector<double>& goal);
+
+  /**
+   * @brief Plans from 'start' to 'goal' with each planner in turn and returns the first valid plan.
+   * Nothing keeps planning once this returns. Successful plans are cached.
+   * @return The joint trajectory; or std::runtime_error if no planner succeeded in time
+   */
+  trajectory_msgs::JointTrajectory plan(const std::vector<double>& start, const std::vector<double>& goal);
+
+  FreeSpacePlannerStats stats() const;
+
+private:
+  struct Connections; // Idle persistent service connections
+
+  moveit::core::RobotModelConstPtr model_;
+  std::string group_name_;
+  FreeSpacePlannerParameters params_;
+  std::shared_ptr<Connections> connections_;
+
+  mutable std::mutex mutex_;
+  FreeMoveCache cache_;
+  FreeSpacePlannerStats stats_;
+};
+
+typedef std::shared_ptr<FreeSpacePlanner> FreeSpacePlannerPtr;
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_FREE_SPACE_PLANNER_H
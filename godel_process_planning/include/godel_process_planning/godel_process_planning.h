@@ -5,6 +5,11 @@
 #include "godel_msgs/KeyenceProcessPlanning.h"
 
 #include <descartes_core/robot_model.h>
+#include <godel_utils/joint_state_cache.h>
+#include <godel_process_planning/free_space_planner.h>
+#include <godel_process_planning/ik_cache.h>
+#include <godel_process_planning/time_parameterization.h>
+#include <godel_process_planning/validity_checker.h>
 #include <pluginlib/class_loader.h>
 
 /*
@@ -24,27 +29,88 @@
 namespace godel_process_planning
 {
 
+class PlannerPool;
+
 class ProcessPlanningManager
 {
 public:
   ProcessPlanningManager(const std::string& world_frame, const std::string& blend_group,
                          const std::string& blend_tcp, const std::string& keyence_group,
-                         const std::string& keyence_tcp, const std::string& robot_model_plugin);
+                         const std::string& keyence_tcp, const std::string& robot_model_plugin,
+                         std::size_t planning_threads = 0, std::size_t concurrent_requests = 1,
+                         const IkCacheParameters& ik_cache_params = IkCacheParameters(),
+                         const ValidityCheckerParameters& validity_params = ValidityCheckerParameters(),
+                         const FreeSpacePlannerParameters& free_space_params = FreeSpacePlannerParameters());
 
+  // The handlers may be called concurrently, up to 'concurrent_requests' of each kind at once;
+  // further requests wait for a planning instance to become free. 'planning_threads' (0 for one
+  // per hardware thread) is split evenly between all of these requests. How much a motion library
+  // gains from concurrent requests has not been measured; their free space moves still go through
+  // move_group one at a time.
   bool handleBlendPlanning(godel_msgs::BlendProcessPlanning::Request& req,
                            godel_msgs::BlendProcessPlanning::Response& res);
 
   bool handleKeyencePlanning(godel_msgs::KeyenceProcessPlanning::Request& req,
                              godel_msgs::KeyenceProcessPlanning::Response& res);
 
+  /**
+   * @brief Plans a blend or scan process path starting and ending at 'current_joints'. These are
+   * what the service handlers do after capturing the robot's current state; batch planning calls
+   * them directly so that every path starts from the same state.
+   * @param seed_plan A previous plan of this path to warm start from; ignored if empty or of the
+   *        other process type
+   * @return True if a valid plan was generated (or there was nothing to plan); false otherwise
+   */
+  bool planBlendPath(const godel_msgs::ProcessPath& path, const godel_msgs::BlendingPlanParameters& params,
+                     const std::vector<double>& current_joints, const godel_msgs::ProcessPlan& seed_plan,
+                     godel_msgs::ProcessPlan& plan);
+
+  bool planKeyencePath(const godel_msgs::ProcessPath& path, const godel_msgs::ScanPlanParameters& params,
+                       const std::vector<double>& current_joints, const godel_msgs::ProcessPlan& seed_plan,
+                       godel_msgs::ProcessPlan& plan);
+
+  /**
+   * @brief The robot's joint positions, from a joint state received at most a moment ago
+   * @throws std::runtime_error if no joint state arrives in time
+   */
+  std::vector<double> currentJointState() const;
+
+  /**@brief The number of blend plus scan paths that can be planned at once */
+  std::size_t concurrency() const;
+
+  /**@brief If set, paths planned other than densely (sparse, coarse to fine, or warm started) are
+   * also planned densely, and the planning times and path costs of both are logged */
+  void setComparePlanningModes(bool compare) { compare_planning_modes_ = compare; }
+
+  /**@brief How the joint trajectories of new plans are timed (see timeParameterize) */
+  void setTimeParameterization(const TimeParameterizationParameters& params) { timing_params_ = params; }
+
 private:
-  descartes_core::RobotModelPtr blend_model_;
-  descartes_core::RobotModelPtr keyence_model_;
+  descartes_core::RobotModelPtr loadModel(const std::string& robot_model_plugin, const std::string& group,
+                                          const std::string& world_frame, const std::string& tcp);
+
   moveit::core::RobotModelConstPtr moveit_model_;
+  // Latest state of the robot, shared by all requests
+  godel_utils::JointStateCachePtr joint_states_;
+  // One planning instance per concurrent request, each with one robot model per thread of its share
+  // of the planning threads
+  std::shared_ptr<PlannerPool> blend_pool_;
+  std::shared_ptr<PlannerPool> keyence_pool_;
+  // Shared by all models of a group; null when IK caching is disabled
+  IkCachePtr blend_ik_cache_;
+  IkCachePtr keyence_ik_cache_;
+  // Shared by all models of a group
+  ValidityCheckerPtr blend_validity_checker_;
+  ValidityCheckerPtr keyence_validity_checker_;
+  // Shared by all requests of a group, as are the motions they cache
+  FreeSpacePlannerPtr blend_free_space_planner_;
+  FreeSpacePlannerPtr keyence_free_space_planner_;
   pluginlib::ClassLoader<descartes_core::RobotModel>
       plugin_loader_; // kept around so code doesn't get unloaded
   std::string blend_group_name_;
   std::string keyence_group_name_;
+  bool compare_planning_modes_;
+  TimeParameterizationParameters timing_params_;
 };
 }
 
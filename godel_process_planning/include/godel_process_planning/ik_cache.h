@@ -0,0 +1,137 @@
+#ifndef GODEL_PROCESS_PLANNING_IK_CACHE_H
+#define GODEL_PROCESS_PLANNING_IK_CACHE_H
+
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+#include <godel_process_planning/robot_model_decorator.h>
+#include <godel_utils/batch_ik_solver.h>
+
+/*
+ * IK solution cache for Descartes robot models.
+ *
+ * Re-planning a surface (or planning a path that overlaps a previous one) asks for the IK of the
+ * same tool poses again and again. IkCache stores getAllIK results keyed by the pose quantized to a
+ * configurable resolution, and CachedRobotModel is a RobotModel decorator that consults it. One
+ * cache can be shared by all the models of a planning group (e.g. the per-thread models of the
+ * graph builder); it is internally synchronized.
+ */
+namespace godel_process_planning
+{
+
+enum class IkCacheMode
+{
+  EXACT,       // A hit returns the stored solutions of the quantized pose as they are
+  NEAREST_SEED // A hit seeds getIK() for the actual pose with each stored solution
+};
+
+struct IkCacheParameters
+{
+  IkCacheParameters()
+      : capacity(100000), position_resolution(1e-5), orientation_resolution(1e-4),
+        mode(IkCacheMode::EXACT){};
+  std::size_t capacity;          /**<Maximum number of cached poses; 0 disables caching */
+  double position_resolution;    /**<(m) Poses closer than this may share an entry */
+  double orientation_resolution; /**<(rad) Poses rotated less than this may share an entry */
+  IkCacheMode mode;
+};
+
+struct IkCacheStats
+{
+  IkCacheStats() : hits(0), misses(0), evictions(0), size(0){};
+  std::size_t hits;
+  std::size_t misses;
+  std::size_t evictions;
+  std::size_t size;
+};
+
+std::ostream& operator<<(std::ostream& os, const IkCacheStats& stats);
+
+/**@brief Counts accumulated between two snapshots; size is that of the later one */
+IkCacheStats operator-(const IkCacheStats& after, const IkCacheStats& before);
+
+class IkCache
+{
+public:
+  typedef std::array<long long, 8> Key; // quantized x y z, quaternion x y z w, collision flag
+
+  explicit IkCache(const IkCacheParameters& params = IkCacheParameters());
+
+  const IkCacheParameters& parameters() const { return params_; }
+
+  Key makeKey(const Eigen::Affine3d& pose, bool check_collisions) const;
+
+  /**@brief Copies the solutions stored for key into 'solutions' and marks the entry recently used
+   * @return False on a miss */
+  bool lookup(const Key& key, std::vector<std::vector<double> >& solutions);
+
+  /**@brief Stores solutions for key, evicting the least recently used entry when full */
+  void insert(const Key& key, const std::vector<std::vector<double> >& solutions);
+
+  void clear();
+  IkCacheStats stats() const;
+
+private:
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+  struct Entry
+  {
+    Key key;
+    std::vector<std::vector<double> > solutions;
+  };
+  typedef std::list<Entry> EntryList; // Most recently used first
+
+  IkCacheParameters params_;
+  mutable std::mutex mutex_;
+  EntryList entries_;
+  std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+  IkCacheStats stats_;
+};
+
+typedef std::shared_ptr<IkCache> IkCachePtr;
+
+/**
+ * @brief Robot model decorator answering getAllIK from an IkCache; every other call is forwarded
+ * to the wrapped model. Solutions depend on collision checking, so it is part of the key. Clear
+ * the cache when the collision environment changes.
+ *
+ * Batched requests look up every pose and pass the misses on in one batch when the wrapped model
+ * is a godel_utils::BatchIkSolver.
+ */
+class CachedRobotModel : public RobotModelDecorator, public godel_utils::BatchIkSolver
+{
+public:
+  CachedRobotModel(descartes_core::RobotModelPtr model, IkCachePtr cache);
+
+  virtual bool getAllIK(const Eigen::Affine3d& pose, std::vector<std::vector<double> >& joint_poses) const;
+
+  virtual bool getAllIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses, std::vector<double>& joints,
+                             std::vector<std::size_t>& offsets) const;
+
+  virtual bool initialize(const std::string& robot_description, const std::string& group_name,
+                          const std::string& world_frame, const std::string& tcp_frame)
+  {
+    cache_->clear();
+    return RobotModelDecorator::initialize(robot_description, group_name, world_frame, tcp_frame);
+  }
+
+  const IkCachePtr& cache() const { return cache_; }
+
+private:
+  /**@brief Answers pose from the cache
+   * @return False on a miss, or if a nearest-seed refinement lost a solution branch */
+  bool lookupSolutions(const Eigen::Affine3d& pose, const IkCache::Key& key,
+                       std::vector<std::vector<double> >& joint_poses) const;
+
+  IkCachePtr cache_;
+};
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_IK_CACHE_H
@@ -0,0 +1,78 @@
+#ifndef GODEL_PROCESS_PLANNING_ROBOT_MODEL_DECORATOR_H
+#define GODEL_PROCESS_PLANNING_ROBOT_MODEL_DECORATOR_H
+
+#include <stdexcept>
+#include <descartes_core/robot_model.h>
+
+namespace godel_process_planning
+{
+
+/**
+ * @brief Base for robot models that wrap another one: every call is forwarded to the wrapped
+ * model. Derived classes override the calls they want to intercept.
+ */
+class RobotModelDecorator : public descartes_core::RobotModel
+{
+public:
+  explicit RobotModelDecorator(descartes_core::RobotModelPtr model) : model_(model)
+  {
+    if (!model_)
+    {
+      throw std::invalid_argument("RobotModelDecorator requires a robot model");
+    }
+    check_collisions_ = model_->getCheckCollisions();
+  }
+
+  virtual bool getAllIK(const Eigen::Affine3d& pose, std::vector<std::vector<double> >& joint_poses) const
+  {
+    return model_->getAllIK(pose, joint_poses);
+  }
+
+  virtual bool getIK(const Eigen::Affine3d& pose, const std::vector<double>& seed_state,
+                     std::vector<double>& joint_pose) const
+  {
+    return model_->getIK(pose, seed_state, joint_pose);
+  }
+
+  virtual bool getFK(const std::vector<double>& joint_pose, Eigen::Affine3d& pose) const
+  {
+    return model_->getFK(joint_pose, pose);
+  }
+
+  virtual int getDOF() const { return model_->getDOF(); }
+
+  virtual bool isValid(const std::vector<double>& joint_pose) const { return model_->isValid(joint_pose); }
+
+  virtual bool isValid(const Eigen::Affine3d& pose) const { return model_->isValid(pose); }
+
+  virtual bool initialize(const std::string& robot_description, const std::string& group_name,
+                          const std::string& world_frame, const std::string& tcp_frame)
+  {
+    return model_->initialize(robot_description, group_name, world_frame, tcp_frame);
+  }
+
+  using descartes_core::RobotModel::isValidMove;
+  virtual bool isValidMove(const double* s, const double* f, double dt) const
+  {
+    return model_->isValidMove(s, f, dt);
+  }
+
+  virtual std::vector<double> getJointVelocityLimits() const { return model_->getJointVelocityLimits(); }
+
+  virtual void setCheckCollisions(bool check_collisions)
+  {
+    check_collisions_ = check_collisions;
+    model_->setCheckCollisions(check_collisions);
+  }
+
+  virtual bool getCheckCollisions() { return model_->getCheckCollisions(); }
+
+  const descartes_core::RobotModelPtr& model() const { return model_; }
+
+protected:
+  descartes_core::RobotModelPtr model_;
+};
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_ROBOT_MODEL_DECORATOR_H
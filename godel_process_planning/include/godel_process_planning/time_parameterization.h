@@ -0,0 +1,66 @@
+#ifndef GODEL_PROCESS_PLANNING_TIME_PARAMETERIZATION_H
+#define GODEL_PROCESS_PLANNING_TIME_PARAMETERIZATION_H
+
+#include <string>
+#include <vector>
+
+#include <moveit/robot_model/robot_model.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+/*
+ * Timing of joint trajectories under joint velocity and acceleration limits.
+ *
+ * A trajectory is taken as straight joint space segments between its points, traversed at a speed
+ * along the path that the joint limits allow: each segment is no faster than its fastest moving
+ * joint's velocity limit (or slower, if the caller asks for it, e.g. to move the tool at a commanded
+ * Cartesian speed), the speed at each point is limited by how sharply the path turns there, and a
+ * forward pass then a backward pass limit speeding up and slowing down to the acceleration limits.
+ * Each segment takes the shortest time between the speeds at its ends. The trajectory starts and
+ * ends at rest, and stops where the path turns back on itself; for densely sampled paths the result
+ * is close to time optimal.
+ */
+namespace godel_process_planning
+{
+
+struct TimeParameterizationParameters
+{
+  TimeParameterizationParameters()
+      : velocity_scaling(0.5), acceleration_scaling(0.5), default_velocity(1.0), default_acceleration(2.0),
+        start_time(0.1){};
+  double velocity_scaling;     /**<Fraction of each joint's velocity limit to plan with */
+  double acceleration_scaling; /**<Fraction of each joint's acceleration limit to plan with */
+  double default_velocity;     /**<(rad/s) Limit of joints without a velocity limit in the robot model */
+  double default_acceleration; /**<(rad/s^2) Limit of joints without an acceleration limit in the robot model */
+  double start_time; /**<(s) Time of the first point, so that appended trajectories keep increasing times */
+};
+
+struct JointLimits
+{
+  std::vector<double> velocity;     /**<(rad/s) One per joint, already scaled */
+  std::vector<double> acceleration; /**<(rad/s^2) One per joint, already scaled */
+};
+
+/**
+ * @brief The velocity and acceleration limits of the active joints of 'group_name', in the order
+ * of its active joint names, scaled as 'params' say
+ */
+JointLimits getJointLimits(const moveit::core::RobotModel& model, const std::string& group_name,
+                           const TimeParameterizationParameters& params = TimeParameterizationParameters());
+
+/**
+ * @brief Sets the time, velocities and accelerations of every point of 'traj' (see above); the
+ * positions are unchanged
+ * @param min_durations If not empty, one per point: the least time (s) from the previous point to
+ *        this one, e.g. to keep the tool at a commanded Cartesian speed. The first entry is unused.
+ * @param start_time (s) Time of the first point
+ * @return False, leaving 'traj' unchanged, if the points, limits and durations do not match in size
+ */
+bool timeParameterize(trajectory_msgs::JointTrajectory& traj, const JointLimits& limits,
+                      const std::vector<double>& min_durations = std::vector<double>(), double start_time = 0.0);
+
+/**@brief (s) Time from the first point of 'traj' to its last */
+double trajectoryDuration(const trajectory_msgs::JointTrajectory& traj);
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_TIME_PARAMETERIZATION_H
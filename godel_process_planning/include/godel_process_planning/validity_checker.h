@@ -0,0 +1,144 @@
+#ifndef GODEL_PROCESS_PLANNING_VALIDITY_CHECKER_H
+#define GODEL_PROCESS_PLANNING_VALIDITY_CHECKER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+#include <godel_process_planning/robot_model_decorator.h>
+#include <godel_utils/batch_ik_solver.h>
+#include <moveit/planning_scene/planning_scene.h>
+
+/*
+ * Staged joint state validity checking for Descartes robot models.
+ *
+ * A full MoveIt collision check of every IK solution dominates graph construction on cluttered
+ * cells, and most candidates fail for cheap reasons. ValidityChecker runs the checks from cheapest
+ * to most expensive and stops at the first failure:
+ *
+ *  1. Joint limits of the planning group
+ *  2. Collisions between the links of the planning group only
+ *  3. Collisions of the planning group with the rest of the robot (the cell) and the world
+ *
+ * Collision results are memoized by joint configuration quantized to a configurable resolution.
+ * ValidityCheckedRobotModel is a RobotModel decorator that routes getAllIK/getIK/isValid through a
+ * checker; the wrapped model only checks joint limits.
+ */
+namespace godel_process_planning
+{
+
+struct ValidityCheckerParameters
+{
+  ValidityCheckerParameters() : cache_capacity(100000), joint_resolution(1e-4){};
+  std::size_t cache_capacity; /**<Maximum number of memoized collision results; 0 disables memoizing */
+  double joint_resolution;    /**<(rad) Configurations closer than this in every joint share a result */
+};
+
+struct ValidityStats
+{
+  ValidityStats()
+      : checks(0), cache_hits(0), limit_rejections(0), group_collision_rejections(0),
+        environment_collision_rejections(0){};
+  std::size_t checks;
+  std::size_t cache_hits;
+  std::size_t limit_rejections;
+  std::size_t group_collision_rejections;
+  std::size_t environment_collision_rejections;
+};
+
+std::ostream& operator<<(std::ostream& os, const ValidityStats& stats);
+
+/**@brief Counts accumulated between two snapshots */
+ValidityStats operator-(const ValidityStats& after, const ValidityStats& before);
+
+/**
+ * @brief Checks joint states of one planning group against a planning scene. Safe to share
+ * between threads as long as every thread passes its own RobotState scratch.
+ */
+class ValidityChecker
+{
+public:
+  ValidityChecker(const moveit::core::RobotModelConstPtr& model, const std::string& group_name,
+                  const ValidityCheckerParameters& params = ValidityCheckerParameters());
+
+  /**
+   * @brief Runs the staged checks on 'joints'
+   * @param state Scratch state owned by the calling thread; see makeState()
+   * @param check_collisions If false, only the joint limits are checked
+   */
+  bool isValid(moveit::core::RobotState& state, const std::vector<double>& joints, bool check_collisions);
+
+  /**@brief A scratch state for isValid() with all joints outside the group at their defaults */
+  moveit::core::RobotState makeState() const;
+
+  /**@brief Drops memoized collision results; call when the collision environment changes */
+  void clearCache();
+
+  ValidityStats stats() const;
+  void resetStats();
+
+private:
+  typedef std::vector<long long> Key;
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  bool isCollisionFree(moveit::core::RobotState& state, const std::vector<double>& joints);
+
+  ValidityCheckerParameters params_;
+  planning_scene::PlanningScenePtr scene_;
+  const moveit::core::JointModelGroup* group_;
+  collision_detection::AllowedCollisionMatrix group_acm_;       // Only pairs of group links
+  collision_detection::AllowedCollisionMatrix environment_acm_; // Everything but pairs of group links
+
+  std::mutex cache_mutex_;
+  std::unordered_map<Key, bool, KeyHash> cache_;
+
+  std::atomic<std::size_t> checks_;
+  std::atomic<std::size_t> cache_hits_;
+  std::atomic<std::size_t> limit_rejections_;
+  std::atomic<std::size_t> group_collision_rejections_;
+  std::atomic<std::size_t> environment_collision_rejections_;
+};
+
+typedef std::shared_ptr<ValidityChecker> ValidityCheckerPtr;
+
+/**
+ * @brief Robot model decorator whose validity checks go through a ValidityChecker. Collision
+ * checking is switched off on the wrapped model, so its own IK only filters by joint limits, and
+ * the solutions are then filtered here.
+ */
+class ValidityCheckedRobotModel : public RobotModelDecorator, public godel_utils::BatchIkSolver
+{
+public:
+  ValidityCheckedRobotModel(descartes_core::RobotModelPtr model, ValidityCheckerPtr checker);
+
+  virtual bool getAllIK(const Eigen::Affine3d& pose, std::vector<std::vector<double> >& joint_poses) const;
+
+  virtual bool getAllIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses, std::vector<double>& joints,
+                             std::vector<std::size_t>& offsets) const;
+
+  virtual bool getIK(const Eigen::Affine3d& pose, const std::vector<double>& seed_state,
+                     std::vector<double>& joint_pose) const;
+
+  virtual bool isValid(const std::vector<double>& joint_pose) const;
+
+  virtual bool isValid(const Eigen::Affine3d& pose) const;
+
+  virtual void setCheckCollisions(bool check_collisions) { check_collisions_ = check_collisions; }
+
+  virtual bool getCheckCollisions() { return check_collisions_; }
+
+  const ValidityCheckerPtr& checker() const { return checker_; }
+
+private:
+  ValidityCheckerPtr checker_;
+  mutable moveit::core::RobotState state_; // Scratch for the checker; one model per thread
+};
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_VALIDITY_CHECKER_H
@@ -0,0 +1,89 @@
+#include "batch_planning_server.h"
+#include "parallel_for.h"
+
+#include <boost/bind.hpp>
+
+godel_process_planning::BatchPlanningServer::BatchPlanningServer(ros::NodeHandle& nh, const std::string& name,
+                                                                 ProcessPlanningManager& manager)
+    : manager_(manager), server_(nh, name, boost::bind(&BatchPlanningServer::execute, this, _1), false)
+{
+  server_.start();
+}
+
+void godel_process_planning::BatchPlanningServer::execute(const godel_msgs::BatchProcessPlanningGoalConstPtr& goal)
+{
+  const std::size_t n_paths = goal->paths.size();
+  godel_msgs::BatchProcessPlanningResult result;
+  result.succeeded.assign(n_paths, false);
+  result.plans.resize(n_paths);
+
+  // All paths start from (and return to) the same state
+  std::vector<double> current_joints;
+  try
+  {
+    current_joints = manager_.currentJointState();
+  }
+  catch (const std::runtime_error& e)
+  {
+    ROS_ERROR("%s: Could not get the current robot state: %s", __FUNCTION__, e.what());
+    server_.setAborted(result, e.what());
+    return;
+  }
+
+  std::size_t completed = 0;
+  const ros::WallTime start = ros::WallTime::now();
+  parallelFor(manager_.concurrency(), n_paths, [&](std::size_t, std::size_t i)
+  {
+    if (server_.isPreemptRequested() || !ros::ok())
+    {
+      return false;
+    }
+
+    const godel_msgs::NamedProcessPath& path = goal->paths[i];
+    godel_msgs::ProcessPlan plan;
+    bool planned = false;
+    if (path.type == godel_msgs::NamedProcessPath::BLEND_TYPE)
+    {
+      planned = manager_.planBlendPath(path.path, goal->blend_params, current_joints, path.seed_plan, plan);
+    }
+    else if (path.type == godel_msgs::NamedProcessPath::SCAN_TYPE)
+    {
+      planned = manager_.planKeyencePath(path.path, goal->scan_params, current_joints, path.seed_plan, plan);
+    }
+    else
+    {
+      ROS_ERROR("%s: Unknown process type %d for path '%s'", __FUNCTION__, path.type, path.name.c_str());
+    }
+
+    if (!planned)
+    {
+      ROS_ERROR("%s: Failed to plan for: %s", __FUNCTION__, path.name.c_str());
+    }
+
+    godel_msgs::BatchProcessPlanningFeedback feedback;
+    feedback.index = i;
+    feedback.name = path.name;
+    feedback.succeeded = planned;
+    feedback.plan = plan;
+    feedback.total = n_paths;
+
+    std::lock_guard<std::mutex> lock(feedback_mutex_);
+    result.succeeded[i] = planned;
+    result.plans[i] = std::move(plan);
+    feedback.completed = ++completed;
+    server_.publishFeedback(feedback);
+    return true;
+  }, 1);
+
+  ROS_INFO("%s: Planned %lu of %lu paths in %.3f s", __FUNCTION__, completed, n_paths,
+           (ros::WallTime::now() - start).toSec());
+
+  if (completed < n_paths)
+  {
+    server_.setPreempted(result);
+  }
+  else
+  {
+    server_.setSucceeded(result);
+  }
+}
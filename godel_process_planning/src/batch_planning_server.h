@@ -0,0 +1,33 @@
+#ifndef GODEL_PROCESS_PLANNING_BATCH_PLANNING_SERVER_H
+#define GODEL_PROCESS_PLANNING_BATCH_PLANNING_SERVER_H
+
+#include <mutex>
+
+#include <actionlib/server/simple_action_server.h>
+#include <godel_msgs/BatchProcessPlanningAction.h>
+#include <godel_process_planning/godel_process_planning.h>
+
+namespace godel_process_planning
+{
+
+/**
+ * @brief Serves the batch process planning action on top of a ProcessPlanningManager. The robot
+ * state is captured once per goal and every path is planned from it, as many at once as the
+ * manager has planning instances for. Each finished path is sent back as feedback.
+ */
+class BatchPlanningServer
+{
+public:
+  BatchPlanningServer(ros::NodeHandle& nh, const std::string& name, ProcessPlanningManager& manager);
+
+private:
+  void execute(const godel_msgs::BatchProcessPlanningGoalConstPtr& goal);
+
+  ProcessPlanningManager& manager_;
+  actionlib::SimpleActionServer<godel_msgs::BatchProcessPlanningAction> server_;
+  std::mutex feedback_mutex_;
+};
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_BATCH_PLANNING_SERVER_H
@@ -10,6 +10,8 @@
 #include "common_utils.h"
 #include "path_transitions.h"
 #include "generate_motion_plan.h"
+#include "planner_pool.h"
+#include "tool_axis_pt.h"
 #include "boost/make_shared.hpp"
 
 namespace godel_process_planning
@@ -19,9 +21,6 @@ namespace godel_process_planning
 const double BLENDING_ANGLE_DISCRETIZATION =
     M_PI / 12.0; // The discretization of the tool's pose about
                  // the z axis
-const static std::string JOINT_TOPIC_NAME =
-    "joint_states"; // ROS topic to subscribe to for current robot
-                    // state info
 /**
  * @brief Translated an Eigen pose to a Descartes trajectory point appropriate for the BLEND
  * process!
@@ -40,6 +39,16 @@ descartes_core::TrajectoryPtPtr toDescartesBlendPt(const Eigen::Affine3d& pose,
                                               AxialSymmetricPt::Z_AXIS, tm);
 }
 
+/**
+ * @brief Like toDescartesBlendPt, but the tool rotations sampled can be changed by the planner
+ * (see coarseToFineSolve)
+ */
+descartes_core::TrajectoryPtPtr toToolAxisBlendPt(const Eigen::Affine3d& pose, double dt)
+{
+  const descartes_core::TimingConstraint tm(dt);
+  return descartes_core::TrajectoryPtPtr(new ToolAxisPt(pose, BLENDING_ANGLE_DISCRETIZATION, tm));
+}
+
 /**
  * @brief Computes a joint motion plan based on input points and the blending process; this includes
  *        motion from current position to process path and back to the starting position.
@@ -50,18 +59,25 @@ descartes_core::TrajectoryPtPtr toDescartesBlendPt(const Eigen::Affine3d& pose,
 bool ProcessPlanningManager::handleBlendPlanning(godel_msgs::BlendProcessPlanning::Request& req,
                                                  godel_msgs::BlendProcessPlanning::Response& res)
 {
-  // Enable Collision Checks
-  blend_model_->setCheckCollisions(true);
+  // Capture the current state of the robot
+  std::vector<double> current_joints = currentJointState();
+  return planBlendPath(req.path, req.params, current_joints, req.seed_plan, res.plan);
+}
 
+bool ProcessPlanningManager::planBlendPath(const godel_msgs::ProcessPath& path,
+                                           const godel_msgs::BlendingPlanParameters& params,
+                                           const std::vector<double>& current_joints,
+                                           const godel_msgs::ProcessPlan& seed_plan, godel_msgs::ProcessPlan& plan)
+{
   // Precondition: There must be at least one input segments
-  if (req.path.segments.empty())
+  if (path.segments.empty())
   {
     ROS_WARN("Planning request contained no trajectory segments. Nothing to be done.");
     return true;
   }
 
   // Precondition: All input segments must have at least one pose associated with them
-  for (const auto& segment : req.path.segments)
+  for (const auto& segment : path.segments)
   {
     if (segment.poses.empty())
     {
@@ -70,8 +86,11 @@ bool ProcessPlanningManager::handleBlendPlanning(godel_msgs::BlendProcessPlannin
     }
   }
 
-  // Transform process path from geometry msgs to descartes points
-  std::vector<double> current_joints = getCurrentJointState(JOINT_TOPIC_NAME);
+  // Plan on an instance of our own; it returns to the pool when this request is done
+  const PlanningInstancePtr planner = blend_pool_->acquire();
+
+  // Enable Collision Checks
+  planner->model->setCheckCollisions(true);
 
   const static double LINEAR_DISCRETIZATION = 0.01; // meters
   const static double ANGULAR_DISCRETIZATION = 0.1; // radians
@@ -81,16 +100,58 @@ bool ProcessPlanningManager::handleBlendPlanning(godel_msgs::BlendProcessPlannin
   transition_params.linear_disc = LINEAR_DISCRETIZATION;
   transition_params.angular_disc = ANGULAR_DISCRETIZATION;
   transition_params.retract_dist = RETRACT_DISTANCE;
-  transition_params.traverse_height = req.params.safe_traverse_height;
-  transition_params.z_adjust = req.params.z_adjust;
+  transition_params.traverse_height = params.safe_traverse_height;
+  transition_params.z_adjust = params.z_adjust;
+
+  MotionPlanOptions options;
+  options.compare_dense = compare_planning_modes_;
+  boost::function<descartes_core::TrajectoryPtPtr(const Eigen::Affine3d&, const double)> point_fn = toDescartesBlendPt;
+  if (params.planning_mode == godel_msgs::BlendingPlanParameters::PLANNING_SPARSE)
+  {
+    options.mode = MotionPlanOptions::SPARSE;
+  }
+  else if (params.planning_mode == godel_msgs::BlendingPlanParameters::PLANNING_COARSE_TO_FINE)
+  {
+    options.mode = MotionPlanOptions::COARSE_TO_FINE;
+    options.coarse_to_fine_params.fine_step = BLENDING_ANGLE_DISCRETIZATION;
+    point_fn = toToolAxisBlendPt;
+  }
+  if (seed_plan.type == godel_msgs::ProcessPlan::BLEND_TYPE)
+  {
+    options.seed = toJointPath(seed_plan.trajectory_process);
+  }
 
-  DescartesTraj process_points = toDescartesTraj(req.path.segments, req.params.traverse_spd, transition_params,
-                                                 toDescartesBlendPt);
+  // Speeds that are not set fall back to the traverse speed
+  ProcessSpeeds speeds(params.traverse_spd);
+  if (params.approach_spd > 0.0)
+    speeds.approach = params.approach_spd;
+  if (params.blending_spd > 0.0)
+    speeds.process = params.blending_spd;
+  if (params.retract_spd > 0.0)
+    speeds.retract = params.retract_spd;
+  options.timing_params = timing_params_;
+
+  DescartesTraj process_points = toDescartesTraj(path.segments, speeds, transition_params, point_fn);
+
+  // The planners are shared between requests: log what this one adds to their counts. Requests
+  // planned concurrently (e.g. a batch) add to the same counts.
+  const IkCacheStats ik_stats = blend_ik_cache_ ? blend_ik_cache_->stats() : IkCacheStats();
+  const ValidityStats validity_stats = blend_validity_checker_->stats();
+  const FreeSpacePlannerStats free_space_stats = blend_free_space_planner_->stats();
+
+  const bool planned = generateMotionPlan(planner->model, planner->graph_builder, planner->segment_validator,
+                                          *blend_free_space_planner_, process_points, moveit_model_,
+                                          blend_group_name_, current_joints, options, plan);
+  if (blend_ik_cache_)
+  {
+    ROS_INFO_STREAM("Blend IK cache: " << (blend_ik_cache_->stats() - ik_stats));
+  }
+  ROS_INFO_STREAM("Blend validity checks: " << (blend_validity_checker_->stats() - validity_stats));
+  ROS_INFO_STREAM("Blend free space planning: " << (blend_free_space_planner_->stats() - free_space_stats));
 
-  if (generateMotionPlan(blend_model_, process_points, moveit_model_, blend_group_name_,
-                         current_joints, res.plan))
+  if (planned)
   {
-    res.plan.type = res.plan.BLEND_TYPE;
+    plan.type = plan.BLEND_TYPE;
     return true;
   }
   else
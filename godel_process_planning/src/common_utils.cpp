@@ -4,16 +4,9 @@
 #include <descartes_planner/sparse_planner.h>
 #include <descartes_trajectory/axial_symmetric_pt.h>
 
-#include <moveit/kinematic_constraints/utils.h>
-#include <moveit_msgs/GetMotionPlan.h>
-
-#include <ros/topic.h>
 #include "trajectory_utils.h"
 
 // Constants
-const static double DEFAULT_TIME_UNDEFINED_VELOCITY =
-    1.0; // When a Descartes trajectory point has no timing info associated
-         // with it, this value (in seconds) is used instead
 const static std::string DEFAULT_FRAME_ID =
     "world_frame"; // The default frame_id used for trajectories generated
                    // by these helper functions
@@ -22,15 +15,8 @@ const static double DEFAULT_ANGLE_DISCRETIZATION =
                  // in these helper functions
 const static double DEFAULT_JOINT_WAIT_TIME = 5.0; // Maximum time allowed to capture a new joint
                                                    // state message
-const static double DEFAULT_JOINT_VELOCITY = 0.3; // rad/s
-
-// MoveIt Configuration Constants
-const static int DEFAULT_MOVEIT_NUM_PLANNING_ATTEMPTS = 20;
-const static double DEFAULT_MOVEIT_PLANNING_TIME = 20.0;   // seconds
-const static double DEFAULT_MOVEIT_VELOCITY_SCALING = 0.1; // Slow down the robot
-const static std::string DEFAULT_MOVEIT_PLANNER_ID = "RRTConnectkConfigDefault";
-const static std::string DEFAULT_MOVEIT_FRAME_ID = "world_frame";
-const static std::string DEFAULT_MOVEIT_PLANNING_SERVICE_NAME = "plan_kinematic_path";
+const static double MAX_JOINT_STATE_AGE = 0.5; // A cached joint state older than this (seconds) is not
+                                               // taken as the current state
 
 Eigen::Affine3d godel_process_planning::createNominalTransform(const geometry_msgs::Pose& ref_pose,
                                                                const geometry_msgs::Point& pt)
@@ -100,27 +86,14 @@ bool godel_process_planning::descartesSolve(const godel_process_planning::Descar
 }
 
 
-static double calcDefaultTime(const std::vector<double>& a, const std::vector<double>& b,
-                              double max_joint_vel)
-{
-  ROS_ASSERT(a.size() == b.size());
-  ROS_ASSERT(a.size() > 0);
-  std::vector<double> result (a.size());
-  std::transform(a.begin(), a.end(), b.begin(), result.begin(), [] (double a, double b)
-  {
-    return std::abs(a - b);
-  });
-
-  return *std::max_element(result.begin(), result.end()) / max_joint_vel;
-}
-
 trajectory_msgs::JointTrajectory
 godel_process_planning::toROSTrajectory(const godel_process_planning::DescartesTraj& solution,
-                                        const descartes_core::RobotModel& model)
+                                        const descartes_core::RobotModel& model, const JointLimits& limits,
+                                        double start_time)
 {
-  ros::Duration from_start(0.0);
   std::vector<double> joint_point;
   std::vector<double> dummy;
+  std::vector<double> min_durations;
   trajectory_msgs::JointTrajectory ros_trajectory; // result
 
   for (std::size_t i = 0; i < solution.size(); ++i)
@@ -129,34 +102,16 @@ godel_process_planning::toROSTrajectory(const godel_process_planning::DescartesT
 
     trajectory_msgs::JointTrajectoryPoint pt;
     pt.positions = joint_point;
-    pt.velocities.resize(joint_point.size(), 0.0);
-    pt.accelerations.resize(joint_point.size(), 0.0);
     pt.effort.resize(joint_point.size(), 0.0);
-
-    double time_step = solution[i]->getTiming().upper; // request descartes timing
-    if (time_step == 0.0)
-    {
-      if (i == 0)
-        from_start += ros::Duration(DEFAULT_TIME_UNDEFINED_VELOCITY); // default time
-      else
-      {
-        // If we have a previous point then it makes more sense to set the time of the
-        // motion based on the largest joint motion required between two points and a
-        // default velocity.
-        const auto& prev = ros_trajectory.points.back().positions;
-        const auto& next = pt.positions;
-        const auto td = calcDefaultTime(prev, next, DEFAULT_JOINT_VELOCITY);
-        from_start += ros::Duration(td);
-      }
-    }
-    else
-      from_start += ros::Duration(time_step);
-
-    pt.time_from_start = from_start;
-
     ros_trajectory.points.push_back(pt);
+
+    min_durations.push_back(solution[i]->getTiming().lower); // 0 if free to go as fast as the joints allow
   }
 
+  if (!timeParameterize(ros_trajectory, limits, min_durations, start_time))
+  {
+    throw std::runtime_error("Could not time the joint trajectory");
+  }
   return ros_trajectory;
 }
 
@@ -168,10 +123,11 @@ void godel_process_planning::fillTrajectoryHeaders(const std::vector<std::string
   traj.header.stamp = ros::Time::now();
 }
 
-std::vector<double> godel_process_planning::getCurrentJointState(const std::string& topic)
+std::vector<double>
+godel_process_planning::getCurrentJointState(const godel_utils::JointStateCache& joint_states)
 {
-  sensor_msgs::JointStateConstPtr state = ros::topic::waitForMessage<sensor_msgs::JointState>(
-      topic, ros::Duration(DEFAULT_JOINT_WAIT_TIME));
+  sensor_msgs::JointStateConstPtr state =
+      joint_states.latest(ros::Duration(MAX_JOINT_STATE_AGE), ros::Duration(DEFAULT_JOINT_WAIT_TIME));
   if (!state)
     throw std::runtime_error("Joint state message capture failed");
   return state->position;
@@ -208,87 +164,59 @@ godel_process_planning::createJointPath(const std::vector<double>& start,
   return result;
 }
 
-trajectory_msgs::JointTrajectory godel_process_planning::getMoveitPlan(
-    const std::string& group_name, const std::vector<double>& joints_start,
-    const std::vector<double>& joints_stop, moveit::core::RobotModelConstPtr model)
+// True if the joint interpolated motion from 'start' to 'stop' is collision free
+static bool isJointMotionValid(const descartes_core::RobotModel& model, const std::vector<double>& start,
+                               const std::vector<double>& stop)
 {
-  const moveit::core::JointModelGroup* group = model->getJointModelGroup(group_name);
-  robot_state::RobotState goal_state(model);
-  goal_state.setJointGroupPositions(group, joints_stop);
-
-  moveit_msgs::GetMotionPlan::Request req;
-  req.motion_plan_request.group_name = group_name;
-  req.motion_plan_request.num_planning_attempts = DEFAULT_MOVEIT_NUM_PLANNING_ATTEMPTS;
-  req.motion_plan_request.max_velocity_scaling_factor = DEFAULT_MOVEIT_VELOCITY_SCALING;
-  req.motion_plan_request.allowed_planning_time = DEFAULT_MOVEIT_PLANNING_TIME;
-  req.motion_plan_request.planner_id = DEFAULT_MOVEIT_PLANNER_ID;
-
-  req.motion_plan_request.workspace_parameters.header.frame_id = model->getRootLinkName();
-  req.motion_plan_request.workspace_parameters.header.stamp = ros::Time::now();
-
-  // Set the start state
-  // Will want to add options here to start from a state that's not the start state
-  moveit_msgs::RobotState start_state;
-  start_state.is_diff = false;
-  sensor_msgs::JointState joint_state;
-  joint_state.name = group->getActiveJointModelNames();
-  joint_state.position = joints_start;
-  start_state.joint_state = joint_state;
-  req.motion_plan_request.start_state = start_state;
-
-  // Set the goal state
-  moveit_msgs::Constraints c = kinematic_constraints::constructGoalConstraints(goal_state, group);
-  req.motion_plan_request.goal_constraints.push_back(c);
-
-  // Make connection the planning-service offered by the MoveIt MoveGroup node
-  ros::NodeHandle nh;
-  ros::ServiceClient client =
-      nh.serviceClient<moveit_msgs::GetMotionPlan>(DEFAULT_MOVEIT_PLANNING_SERVICE_NAME);
-
-  trajectory_msgs::JointTrajectory jt;
-  moveit_msgs::GetMotionPlan::Response res;
-  if (client.call(req, res))
-  {
-    jt = res.motion_plan_response.trajectory.joint_trajectory;
-  }
-  else
+  godel_process_planning::DescartesTraj path = godel_process_planning::createJointPath(start, stop);
+  for (std::size_t i = 0; i < path.size(); ++i)
   {
-    ROS_ERROR("%s: Unable to call MoveIt path planning service: '%s' or planning failed",
-              __FUNCTION__, DEFAULT_MOVEIT_PLANNING_SERVICE_NAME.c_str());
-    throw std::runtime_error("Unable to generate MoveIt path plan");
+    if (!path[i]->isValid(model))
+    {
+      return false;
+    }
   }
-  return jt;
+  return true;
 }
 
-trajectory_msgs::JointTrajectory godel_process_planning::planFreeMove(
-    descartes_core::RobotModel& model, const std::string& group_name,
-    moveit::core::RobotModelConstPtr moveit_model, const std::vector<double>& start,
-    const std::vector<double>& stop)
+trajectory_msgs::JointTrajectory godel_process_planning::planFreeMove(descartes_core::RobotModel& model,
+                                                                      FreeSpacePlanner& planner,
+                                                                      const std::vector<double>& start,
+                                                                      const std::vector<double>& stop,
+                                                                      const JointLimits& limits,
+                                                                      double start_time)
 {
   // Attempt joint interpolated motion
-  DescartesTraj joint_approach = createJointPath(start, stop);
+  if (isJointMotionValid(model, start, stop))
+  {
+    return toROSTrajectory(createJointPath(start, stop), model, limits, start_time);
+  }
 
-  // Check approach for collisions
-  bool collision_free = true;
-  for (std::size_t i = 0; i < joint_approach.size(); ++i)
+  // A motion planned for an earlier path between the same configurations, if the scene has not
+  // changed in its way since
+  trajectory_msgs::JointTrajectory cached;
+  if (planner.findCached(start, stop, cached))
   {
-    if (!joint_approach[i]->isValid(model))
+    bool collision_free = true;
+    for (std::size_t i = 1; i < cached.points.size() && collision_free; ++i)
     {
-      collision_free = false;
-      break;
+      collision_free = isJointMotionValid(model, cached.points[i - 1].positions, cached.points[i].positions);
     }
+    if (collision_free && timeParameterize(cached, limits, std::vector<double>(), start_time))
+    {
+      ROS_INFO("%s: Reusing a previously planned free space motion", __FUNCTION__);
+      return cached;
+    }
+    planner.forgetCached(start, stop);
   }
 
-  // If the method is collision free, then we use the interpolation
-  // otherwise let moveit try
-  if (collision_free)
-  {
-    return toROSTrajectory(joint_approach, model);
-  }
-  else
+  // Otherwise let moveit try; its waypoints are retimed like every other motion's
+  trajectory_msgs::JointTrajectory planned = planner.plan(start, stop);
+  if (!timeParameterize(planned, limits, std::vector<double>(), start_time))
   {
-    return godel_process_planning::getMoveitPlan(group_name, start, stop, moveit_model);
+    throw std::runtime_error("Could not time the planned free space motion");
   }
+  return planned;
 }
 
 std::vector<std::vector<double>>
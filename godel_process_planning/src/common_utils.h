@@ -8,6 +8,9 @@
 #include <descartes_core/robot_model.h>
 
 #include <sensor_msgs/JointState.h>
+#include <godel_utils/joint_state_cache.h>
+#include <godel_process_planning/free_space_planner.h>
+#include <godel_process_planning/time_parameterization.h>
 
 #include <Eigen/Geometry>
 
@@ -46,14 +49,19 @@ Eigen::Affine3d createNominalTransform(const Eigen::Affine3d& ref_pose, const do
 bool descartesSolve(const DescartesTraj& in_path, descartes_core::RobotModelConstPtr robot_model,
                     DescartesTraj& out_path);
 /**
- * @brief Extracts joint position values from Descartes trajectory and packs them into a ROS message
+ * @brief Extracts joint position values from Descartes trajectory and packs them into a ROS message,
+ * timed within 'limits' (see timeParameterize)
  * @param solution The Descartes trajectory used to generate nominal joint trajectory
  * @param model The robot model used in generating the above trajectory
+ * @param limits Joint limits of the group of 'model'
+ * @param start_time (s) Time of the first point
  * @return A ROS joint trajectory with only the 'points' field filled in; you must add header/joint
- * name info
+ * name info. A point takes at least the lower bound of its Descartes timing to reach from the one
+ * before it. Throws std::runtime_error if the points do not match the limits.
  */
 trajectory_msgs::JointTrajectory toROSTrajectory(const DescartesTraj& solution,
-                                                 const descartes_core::RobotModel& model);
+                                                 const descartes_core::RobotModel& model,
+                                                 const JointLimits& limits, double start_time);
 /**
  * @brief Updates the joint names, frame id, and time stamp of the given trajectory
  * @param joints Joint names; listed in same order as the values they correspond to
@@ -63,11 +71,12 @@ void fillTrajectoryHeaders(const std::vector<std::string>& joints,
                            trajectory_msgs::JointTrajectory& traj);
 
 /**
- * @brief Attempts to capture the most recent JointState from the given topic
- * @param topic The joint topic name on which to listen for the robot state
- * @return The joint positions captured from the topic or a std::runtime_error
+ * @brief Gets the current robot state from the cache of its joint state topic
+ * @param joint_states Cache of the joint state topic; a state it holds is used if recent enough,
+ *        otherwise this waits for the next one
+ * @return The joint positions of the robot or a std::runtime_error
  */
-std::vector<double> getCurrentJointState(const std::string& topic);
+std::vector<double> getCurrentJointState(const godel_utils::JointStateCache& joint_states);
 
 /**
  * @brief Creates descartes trajectory consisting of cartesian positions in a linear path between
@@ -88,20 +97,6 @@ DescartesTraj createLinearPath(const Eigen::Affine3d& start, const Eigen::Affine
  */
 DescartesTraj createJointPath(const std::vector<double>& start, const std::vector<double>& stop,
                               double dtheta = M_PI / 180.0);
-/**
- * @brief Invokes MoveGroup's 'plan_kinematic_path' service to create a collision free path between
- * joints_start and joints_stop
- * @brief group_name The name of the MoveIt move-group associated with this plan
- * @param joints_start The initial robot configuration
- * @param joints_stop The target robot configuration
- * @param model The MoveIt model containing the move-group 'group_name'
- * @return Joint Trajectory represeting motion from joints_start to joints_stop; or
- * std::runtime_error
- */
-trajectory_msgs::JointTrajectory getMoveitPlan(const std::string& group_name,
-                                               const std::vector<double>& joints_start,
-                                               const std::vector<double>& joints_stop,
-                                               moveit::core::RobotModelConstPtr model);
 /**
  * @brief A helper function to make getting the nominal joint value out of a Descartes point more
  * concise
@@ -120,19 +115,20 @@ static inline std::vector<double> extractJoints(const descartes_core::RobotModel
 /**
  * @brief A planning helper function for getting a valid path between start and stop; first attempts
  * a joint interpolated motion
- *        to see if its collision free. If not, it invokes MoveIt as a backup.
+ *        to see if its collision free. If not, it reuses a motion the planner cached between the
+ *        same configurations if that is still collision free, and otherwise plans with MoveIt.
  * @param model Associated descartes robot model
- * @param group_name Name of moveit move-group associated with the moveit model
- * @param moveit_model the moveit robot description associated with this item
+ * @param planner Free space planner of the move-group associated with 'model'
  * @param start Initial robot configuration
  * @param stop Final robot configuration
- * @return A collision-free path from start to stop
+ * @param limits Joint limits of the group of 'model', to time the path as fast as they allow
+ * @param start_time (s) Time of the first point
+ * @return A collision-free path from start to stop; or std::runtime_error
  */
-trajectory_msgs::JointTrajectory planFreeMove(descartes_core::RobotModel& model,
-                                              const std::string& group_name,
-                                              moveit::core::RobotModelConstPtr moveit_model,
+trajectory_msgs::JointTrajectory planFreeMove(descartes_core::RobotModel& model, FreeSpacePlanner& planner,
                                               const std::vector<double>& start,
-                                              const std::vector<double>& stop);
+                                              const std::vector<double>& stop, const JointLimits& limits,
+                                              double start_time);
 
 /**
  * @brief Given a list of possible joint solutions, remove those that end in collision. Checking via 'model'.
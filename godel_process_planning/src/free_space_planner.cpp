@@ -0,0 +1,314 @@
+#include <godel_process_planning/free_space_planner.h>
+
+#include <cmath>
+
+#include <moveit/kinematic_constraints/utils.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit_msgs/GetMotionPlan.h>
+#include <ros/ros.h>
+
+const static std::string MOVEIT_PLANNING_SERVICE_NAME = "plan_kinematic_path";
+
+struct godel_process_planning::FreeSpacePlanner::Connections
+{
+  // A persistent client is used by one plan() call at a time, as roscpp does not multiplex calls
+  // on one connection; concurrent calls open further connections rather than wait for it
+  ros::ServiceClient acquire()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      while (!idle.empty())
+      {
+        ros::ServiceClient client = idle.back();
+        idle.pop_back();
+        if (client.isValid())
+        {
+          return client;
+        }
+      }
+    }
+    ros::NodeHandle nh;
+    return nh.serviceClient<moveit_msgs::GetMotionPlan>(MOVEIT_PLANNING_SERVICE_NAME, true);
+  }
+
+  // Broken connections (e.g. the service restarted) are dropped and reopened by a later acquire()
+  void release(const ros::ServiceClient& client)
+  {
+    if (client.isValid())
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      idle.push_back(client);
+    }
+  }
+
+  std::mutex mutex;
+  std::vector<ros::ServiceClient> idle;
+};
+
+namespace
+{
+
+bool sameConfiguration(const std::vector<double>& a, const std::vector<double>& b, double tolerance)
+{
+  if (a.size() != b.size())
+  {
+    return false;
+  }
+  for (std::size_t i = 0; i < a.size(); ++i)
+  {
+    if (std::abs(a[i] - b[i]) > tolerance)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+std::ostream& godel_process_planning::operator<<(std::ostream& os, const FreeSpacePlannerStats& stats)
+{
+  os << "cache hits: " << stats.cache_hits << ", cache misses: " << stats.cache_misses
+     << ", planned: " << stats.planned << ", failed: " << stats.failed;
+  return os;
+}
+
+godel_process_planning::FreeSpacePlannerStats
+godel_process_planning::operator-(const FreeSpacePlannerStats& after, const FreeSpacePlannerStats& before)
+{
+  FreeSpacePlannerStats diff;
+  diff.cache_hits = after.cache_hits - before.cache_hits;
+  diff.cache_misses = after.cache_misses - before.cache_misses;
+  diff.planned = after.planned - before.planned;
+  diff.failed = after.failed - before.failed;
+  return diff;
+}
+
+godel_process_planning::FreeMoveCache::FreeMoveCache(std::size_t capacity, double tolerance)
+    : capacity_(capacity), tolerance_(tolerance)
+{
+}
+
+bool godel_process_planning::FreeMoveCache::near(const std::vector<double>& a, const std::vector<double>& b) const
+{
+  return sameConfiguration(a, b, tolerance_);
+}
+
+std::list<godel_process_planning::FreeMoveCache::Entry>::iterator
+godel_process_planning::FreeMoveCache::findEntry(const std::vector<double>& start, const std::vector<double>& goal,
+                                                 bool& reversed)
+{
+  for (auto it = entries_.begin(); it != entries_.end(); ++it)
+  {
+    if (near(it->start, start) && near(it->goal, goal))
+    {
+      reversed = false;
+      return it;
+    }
+    if (near(it->start, goal) && near(it->goal, start))
+    {
+      reversed = true;
+      return it;
+    }
+  }
+  return entries_.end();
+}
+
+bool godel_process_planning::FreeMoveCache::find(const std::vector<double>& start, const std::vector<double>& goal,
+                                                 trajectory_msgs::JointTrajectory& traj)
+{
+  bool reversed;
+  auto it = findEntry(start, goal, reversed);
+  if (it == entries_.end())
+  {
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it);
+
+  traj = reversed ? reverseTrajectory(it->traj) : it->traj;
+  traj.points.front().positions = start;
+  traj.points.back().positions = goal;
+  return true;
+}
+
+void godel_process_planning::FreeMoveCache::insert(const trajectory_msgs::JointTrajectory& traj)
+{
+  if (capacity_ == 0 || traj.points.empty())
+  {
+    return;
+  }
+
+  Entry entry;
+  entry.start = traj.points.front().positions;
+  entry.goal = traj.points.back().positions;
+  entry.traj = traj;
+
+  bool reversed;
+  auto it = findEntry(entry.start, entry.goal, reversed);
+  if (it != entries_.end())
+  {
+    entries_.erase(it);
+  }
+  entries_.push_front(entry);
+  if (entries_.size() > capacity_)
+  {
+    entries_.pop_back();
+  }
+}
+
+void godel_process_planning::FreeMoveCache::erase(const std::vector<double>& start, const std::vector<double>& goal)
+{
+  bool reversed;
+  auto it = findEntry(start, goal, reversed);
+  if (it != entries_.end())
+  {
+    entries_.erase(it);
+  }
+}
+
+trajectory_msgs::JointTrajectory
+godel_process_planning::reverseTrajectory(const trajectory_msgs::JointTrajectory& traj)
+{
+  trajectory_msgs::JointTrajectory reversed;
+  reversed.header = traj.header;
+  reversed.joint_names = traj.joint_names;
+  if (traj.points.empty())
+  {
+    return reversed;
+  }
+
+  const ros::Duration end = traj.points.back().time_from_start;
+  for (auto it = traj.points.rbegin(); it != traj.points.rend(); ++it)
+  {
+    trajectory_msgs::JointTrajectoryPoint pt = *it;
+    pt.time_from_start = end - it->time_from_start;
+    for (double& v : pt.velocities)
+    {
+      v = -v;
+    }
+    reversed.points.push_back(pt);
+  }
+  return reversed;
+}
+
+double godel_process_planning::jointPathLength(const trajectory_msgs::JointTrajectory& traj)
+{
+  double length = 0.0;
+  for (std::size_t i = 1; i < traj.points.size(); ++i)
+  {
+    const std::vector<double>& a = traj.points[i - 1].positions;
+    const std::vector<double>& b = traj.points[i].positions;
+    double d = 0.0;
+    for (std::size_t j = 0; j < a.size() && j < b.size(); ++j)
+    {
+      d += (a[j] - b[j]) * (a[j] - b[j]);
+    }
+    length += std::sqrt(d);
+  }
+  return length;
+}
+
+godel_process_planning::FreeSpacePlanner::FreeSpacePlanner(moveit::core::RobotModelConstPtr model,
+                                                           const std::string& group_name,
+                                                           const FreeSpacePlannerParameters& params)
+    : model_(model), group_name_(group_name), params_(params), connections_(std::make_shared<Connections>()),
+      cache_(params.cache_capacity, params.cache_tolerance)
+{
+  if (params_.planners.empty())
+  {
+    throw std::runtime_error("Free space planning needs at least one planner configuration");
+  }
+}
+
+bool godel_process_planning::FreeSpacePlanner::findCached(const std::vector<double>& start,
+                                                          const std::vector<double>& goal,
+                                                          trajectory_msgs::JointTrajectory& traj)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cache_.find(start, goal, traj))
+  {
+    ++stats_.cache_hits;
+    return true;
+  }
+  ++stats_.cache_misses;
+  return false;
+}
+
+void godel_process_planning::FreeSpacePlanner::forgetCached(const std::vector<double>& start,
+                                                            const std::vector<double>& goal)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_.erase(start, goal);
+}
+
+trajectory_msgs::JointTrajectory
+godel_process_planning::FreeSpacePlanner::plan(const std::vector<double>& start, const std::vector<double>& goal)
+{
+  const moveit::core::JointModelGroup* group = model_->getJointModelGroup(group_name_);
+  robot_state::RobotState goal_state(model_);
+  goal_state.setJointGroupPositions(group, goal);
+
+  moveit_msgs::GetMotionPlan::Request req;
+  req.motion_plan_request.group_name = group_name_;
+  req.motion_plan_request.max_velocity_scaling_factor = params_.velocity_scaling;
+  req.motion_plan_request.workspace_parameters.header.frame_id = model_->getRootLinkName();
+  req.motion_plan_request.workspace_parameters.header.stamp = ros::Time::now();
+
+  moveit_msgs::RobotState start_state;
+  start_state.is_diff = false;
+  start_state.joint_state.name = group->getActiveJointModelNames();
+  start_state.joint_state.position = start;
+  req.motion_plan_request.start_state = start_state;
+  req.motion_plan_request.goal_constraints.push_back(
+      kinematic_constraints::constructGoalConstraints(goal_state, group));
+
+  // The planners are tried one after the other, on this thread. MoveIt's planning service handles
+  // one request at a time, so calling the planners at once would only queue them, and a request
+  // it is working on cannot be cancelled.
+  const ros::WallTime start_time = ros::WallTime::now();
+  ros::ServiceClient client = connections_->acquire();
+  for (const FreeSpacePlannerConfig& config : params_.planners)
+  {
+    moveit_msgs::GetMotionPlan::Request planner_req = req;
+    planner_req.motion_plan_request.planner_id = config.planner_id;
+    planner_req.motion_plan_request.allowed_planning_time = config.planning_time;
+    planner_req.motion_plan_request.num_planning_attempts = config.planning_attempts;
+
+    moveit_msgs::GetMotionPlan::Response res;
+    if (!client.call(planner_req, res))
+    {
+      ROS_WARN("%s: Could not call the '%s' service", __FUNCTION__, MOVEIT_PLANNING_SERVICE_NAME.c_str());
+      connections_->release(client);
+      client = connections_->acquire();
+      continue;
+    }
+    if (res.motion_plan_response.error_code.val != moveit_msgs::MoveItErrorCodes::SUCCESS ||
+        res.motion_plan_response.trajectory.joint_trajectory.points.empty())
+    {
+      ROS_DEBUG("%s: %s found no path", __FUNCTION__, config.planner_id.c_str());
+      continue;
+    }
+
+    connections_->release(client);
+    const trajectory_msgs::JointTrajectory& traj = res.motion_plan_response.trajectory.joint_trajectory;
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.planned;
+    ROS_INFO("%s: Planned a free space motion of length %f in %f s with %s", __FUNCTION__, jointPathLength(traj),
+             (ros::WallTime::now() - start_time).toSec(), config.planner_id.c_str());
+    cache_.insert(traj);
+    return traj;
+  }
+  connections_->release(client);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.failed;
+  ROS_ERROR("%s: No planner found a path for group '%s' within %f s", __FUNCTION__, group_name_.c_str(),
+            (ros::WallTime::now() - start_time).toSec());
+  throw std::runtime_error("Unable to generate MoveIt path plan");
+}
+
+godel_process_planning::FreeSpacePlannerStats godel_process_planning::FreeSpacePlanner::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
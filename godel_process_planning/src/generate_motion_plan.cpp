@@ -1,125 +1,160 @@
 #include "generate_motion_plan.h"
 #include "trajectory_utils.h"
 #include "common_utils.h"
+#include "graph_solvers.h"
 #include <descartes_trajectory/axial_symmetric_pt.h>
 #include <descartes_trajectory/joint_trajectory_pt.h>
 
-#include <descartes_planner/ladder_graph_dag_search.h>
 #include <descartes_planner/dense_planner.h>
-
-const static bool validateTrajectory(const trajectory_msgs::JointTrajectory& pts,
-                                     const descartes_core::RobotModel& model,
-                                     const double min_segment_size)
-{
-  for (std::size_t i = 1; i < pts.points.size(); ++i)
-  {
-    const auto& pt_a = pts.points[i - 1].positions;
-    const auto& pt_b = pts.points[i].positions;
-
-    auto interpolate = godel_process_planning::interpolateJoint(pt_a, pt_b, min_segment_size);
-
-    // The thought here is that the graph building process already checks the waypoints in the
-    // trajectory for collisions. What we want to do is check between these waypoints when they
-    // move a lot. 'interpolateJoint()' returns a list of positions where the maximum joint motion
-    // between them is no more 'than min_segment_size' and its inclusive. So if there are only two
-    // solutions, then we just have the start & end which are already checked.
-    if (interpolate.size() > 2)
-    {
-      for (std::size_t j = 1; j < interpolate.size() - 1; ++j)
-      {
-        if (!model.isValid(interpolate[j]))
-        {
-          return false;
-        }
-      }
-    }
-  }
-  return true;
-}
+#include <ros/time.h>
 
 bool godel_process_planning::generateMotionPlan(const descartes_core::RobotModelPtr model,
+                                                const ParallelGraphBuilder& graph_builder,
+                                                const SegmentValidator& segment_validator,
+                                                FreeSpacePlanner& free_space_planner,
                                                 const std::vector<descartes_core::TrajectoryPtPtr> &traj,
                                                 moveit::core::RobotModelConstPtr moveit_model,
                                                 const std::string &move_group_name,
                                                 const std::vector<double> &start_state,
+                                                const MotionPlanOptions& options,
                                                 godel_msgs::ProcessPlan &plan)
 {
 
-  // Generate a graph of the process path joint solutions
-  descartes_planner::PlanningGraph planning_graph (model);
-  if (!planning_graph.insertGraph(traj)) // builds the graph out
+  JointPath joint_path;
+  bool solved = false;
+  bool warm_started = false;
+  if (!options.seed.empty())
   {
-    ROS_ERROR("%s: Failed to build graph. One or more points may have no valid IK solutions", __FUNCTION__);
-    return false;
+    ros::WallTime start = ros::WallTime::now();
+    WarmStartStats stats;
+    solved = warmStartSolve(graph_builder, *model, traj, start_state, options.seed, options.warm_start_params,
+                            joint_path, stats);
+    const double warm_start_time = (ros::WallTime::now() - start).toSec();
+    warm_started = solved;
+    if (solved)
+    {
+      ROS_INFO("%s: Warm start solved %lu points in %f s: %lu reused from the previous plan, %lu replanned; "
+               "path cost %f", __FUNCTION__, traj.size(), warm_start_time, stats.reused_points,
+               stats.replanned_points, jointPathCost(joint_path));
+    }
+    else
+    {
+      ROS_INFO("%s: Could not warm start from the previous plan (%f s); planning from scratch", __FUNCTION__,
+               warm_start_time);
+    }
   }
 
-  // Using the valid starting configurations, let's compute an estimate
-  // of the cost to move to these configurations from our starting pose
-  const auto& graph = planning_graph.graph();
-  const auto dof = graph.dof();
-
-  std::vector<std::vector<double>> process_start_poses;
-  const auto& joint_data = graph.getRung(0).data; // This is a flat vector of doubles w/ all the solutions
-  const auto n_start_poses = joint_data.size() / dof;
-
-  for (std::size_t i = 0; i < n_start_poses; ++i) // This builds a list of starting poses
+  if (!solved && options.mode == MotionPlanOptions::SPARSE)
+  {
+    ros::WallTime start = ros::WallTime::now();
+    SparsePlanningStats stats;
+    solved = sparseSolve(graph_builder, *model, traj, start_state, options.sparse_params, joint_path, stats);
+    const double sparse_time = (ros::WallTime::now() - start).toSec();
+    if (solved)
+    {
+      ROS_INFO("%s: Sparse planning solved %lu points in %f s: %lu in the sparse graph, %lu interpolated, "
+               "%lu intervals planned densely; path cost %f", __FUNCTION__, traj.size(), sparse_time,
+               stats.sparse_points, stats.interpolated_points, stats.densified_intervals, jointPathCost(joint_path));
+    }
+    else
+    {
+      ROS_WARN("%s: Sparse planning failed after %f s; planning densely", __FUNCTION__, sparse_time);
+    }
+  }
+  else if (!solved && options.mode == MotionPlanOptions::COARSE_TO_FINE)
   {
-    std::vector<double> sol (&joint_data[i * dof], &joint_data[i*dof + dof]);
-    process_start_poses.push_back(sol);
+    ros::WallTime start = ros::WallTime::now();
+    CoarseToFinePlanningStats stats;
+    solved = coarseToFineSolve(graph_builder, *model, traj, start_state, options.coarse_to_fine_params, joint_path,
+                               stats);
+    const double coarse_to_fine_time = (ros::WallTime::now() - start).toSec();
+    if (solved)
+    {
+      ROS_INFO("%s: Coarse to fine planning solved %lu points in %f s: %lu coarse and %lu fine tool rotations, "
+               "%lu points widened; path cost %f", __FUNCTION__, traj.size(), coarse_to_fine_time,
+               stats.coarse_samples, stats.fine_samples, stats.widened_points, jointPathCost(joint_path));
+    }
+    else
+    {
+      ROS_WARN("%s: Coarse to fine planning failed after %f s; planning densely", __FUNCTION__, coarse_to_fine_time);
+    }
   }
 
-  std::vector<double> process_start_costs (process_start_poses.size());
-  for (std::size_t i = 0; i < process_start_costs.size(); ++i) // This computes the list of configurations
+  if (solved && options.compare_dense)
   {
-    process_start_costs[i] = freeSpaceCostFunction(start_state, process_start_poses[i]);
+    ros::WallTime start = ros::WallTime::now();
+    JointPath dense_path;
+    double dense_cost;
+    if (denseSolve(graph_builder, traj, start_state, dense_path, dense_cost))
+    {
+      ROS_INFO("%s: Dense planning for comparison took %f s; path cost %f", __FUNCTION__,
+               (ros::WallTime::now() - start).toSec(), jointPathCost(dense_path));
+    }
   }
 
-  // Now we perform the search using the starting costs from our estimation above
-  descartes_planner::DAGSearch search (graph);
-  double cost = search.run(process_start_costs);
-  if (cost == std::numeric_limits<double>::max())
+  if (!solved)
   {
-    ROS_ERROR("%s: Failed to search graph. All points have IK, but process constraints (e.g velocity) "
-              "prevent a solution", __FUNCTION__);
-    return false;
+    double cost;
+    if (!denseSolve(graph_builder, traj, start_state, joint_path, cost))
+    {
+      return false;
+    }
+    ROS_INFO("%s: Descartes computed path with cost %lf", __FUNCTION__, cost);
   }
 
-  // Here we search the graph for the shortest path and build a descartes trajectory of it!
-  auto path_idxs = search.shortestPath();
-  ROS_INFO("%s: Descartes computed path with cost %lf", __FUNCTION__, cost);
+  // Build a descartes trajectory of the solution
   DescartesTraj solution;
-  for (size_t i = 0; i < path_idxs.size(); ++i)
+  for (std::size_t i = 0; i < joint_path.size(); ++i)
   {
-    const auto idx = path_idxs[i];
-    const auto* data = graph.vertex(i, idx);
-    const auto& tm = graph.getRung(i).timing;
-    auto pt = descartes_core::TrajectoryPtPtr(new descartes_trajectory::JointTrajectoryPt(std::vector<double>(data, data + dof), tm));
-    solution.push_back(pt);
+    solution.push_back(descartes_core::TrajectoryPtPtr(
+        new descartes_trajectory::JointTrajectoryPt(joint_path[i], traj[i]->getTiming())));
   }
 
   // Now we plan our approach and depart to/from the path. We try to joint interpolate, and then we run from there
   try
   {
+    const JointLimits limits = getJointLimits(*moveit_model, move_group_name, options.timing_params);
+    const double start_time = options.timing_params.start_time;
+
     trajectory_msgs::JointTrajectory approach =
-        planFreeMove(*model, move_group_name, moveit_model,
+        planFreeMove(*model, free_space_planner,
                      start_state,
-                     extractJoints(*model, *solution.front()));
+                     extractJoints(*model, *solution.front()), limits, start_time);
 
     trajectory_msgs::JointTrajectory depart = planFreeMove(
-        *model, move_group_name, moveit_model,
+        *model, free_space_planner,
         extractJoints(*model, *solution.back()),
-        start_state);
+        start_state, limits, start_time);
 
     // Break out the process path from the seed path and convert to ROS messages
-    trajectory_msgs::JointTrajectory process = toROSTrajectory(solution, *model);
+    trajectory_msgs::JointTrajectory process = toROSTrajectory(solution, *model, limits, start_time);
 
+    // The graph building process already checks the waypoints of the trajectory; what is left is
+    // to check between them where they move a lot
     const static double SMALLEST_VALID_SEGMENT = 0.05;
-    if (!validateTrajectory(process, *model, SMALLEST_VALID_SEGMENT))
+    std::size_t invalid_segment;
+    if (!segment_validator.validate(process, SMALLEST_VALID_SEGMENT, invalid_segment))
     {
-      ROS_ERROR_STREAM("%s: Computed path contains joint configuration changes that would result in a collision.");
+      if (warm_started)
+      {
+        // The pinned points were checked, but not the motion between them in the current scene
+        ROS_WARN("%s: Warm started path is invalid between points %lu and %lu; planning from scratch",
+                 __FUNCTION__, invalid_segment, invalid_segment + 1);
+        MotionPlanOptions from_scratch = options;
+        from_scratch.seed.clear();
+        return generateMotionPlan(model, graph_builder, segment_validator, free_space_planner, traj, moveit_model,
+                                  move_group_name, start_state, from_scratch, plan);
+      }
+
+      ROS_ERROR("%s: Computed path contains joint configuration changes that would result in a collision "
+                "(first between points %lu and %lu of %lu)", __FUNCTION__, invalid_segment, invalid_segment + 1,
+                process.points.size());
       return false;
     }
 
+    ROS_INFO("%s: Approach takes %f s, process %f s, depart %f s", __FUNCTION__, trajectoryDuration(approach),
+             trajectoryDuration(process), trajectoryDuration(depart));
+
     // Fill in result trajectories
     plan.trajectory_process = process;
     plan.trajectory_approach = approach;
@@ -140,3 +175,15 @@ bool godel_process_planning::generateMotionPlan(const descartes_core::RobotModel
     return false;
   }
 }
+
+godel_process_planning::JointPath
+godel_process_planning::toJointPath(const trajectory_msgs::JointTrajectory& traj)
+{
+  JointPath path;
+  path.reserve(traj.points.size());
+  for (const auto& pt : traj.points)
+  {
+    path.push_back(pt.positions);
+  }
+  return path;
+}
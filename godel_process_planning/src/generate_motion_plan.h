@@ -4,28 +4,65 @@
 #include <descartes_core/robot_model.h>
 #include <descartes_core/trajectory_pt.h>
 #include <godel_msgs/ProcessPlan.h>
+#include <godel_process_planning/free_space_planner.h>
+#include <godel_process_planning/time_parameterization.h>
+#include "graph_solvers.h"
+#include "parallel_graph_builder.h"
+#include "segment_validator.h"
 
 namespace godel_process_planning
 {
 
+struct MotionPlanOptions
+{
+  enum SolveMode
+  {
+    DENSE,         /**<One graph over every point (see denseSolve) */
+    SPARSE,        /**<Sparse first, then fill in (see sparseSolve) */
+    COARSE_TO_FINE /**<Coarse tool rotations first, then fine ones (see coarseToFineSolve) */
+  };
+
+  MotionPlanOptions() : mode(DENSE), compare_dense(false){};
+  SolveMode mode;
+  SparsePlanningParameters sparse_params;
+  CoarseToFinePlanningParameters coarse_to_fine_params;
+  JointPath seed; /**<If not empty, the process joint path of a previous plan to warm start from (see warmStartSolve) */
+  WarmStartParameters warm_start_params;
+  bool compare_dense; /**<After a sparse, coarse to fine or warm started solve, also solve densely and log how the
+                         two compare */
+  TimeParameterizationParameters timing_params; /**<How the approach, process and depart trajectories are timed */
+};
+
+/**@brief The joint positions of the points of 'traj', e.g. a previous plan's process path */
+JointPath toJointPath(const trajectory_msgs::JointTrajectory& traj);
+
 /**
  * @brief This is a helper function for doing the joint level trajectory planning for a
  * a robot from a given \e start_state to and through the process path defined by \e
  * traj.
  * @param model A descartes robot model for this process/tool
+ * @param graph_builder Builds the planning graph; its models must be instances of 'model'
+ * @param segment_validator Checks the motion between the planned process waypoints; its models
+ * must be instances of 'model'
+ * @param free_space_planner Plans the approach and depart motions that cannot be joint interpolated
  * @param traj A sequence of descartes points encapsulating the path tolerances
  * @param moveit_model A moveit robot model corresponding to the robot used
  * @param move_group_name The name of the move group being manipulated
  * @param start_state The initial position of the robot
+ * @param options How to solve the process path
  * @param plan Output parameter - the approach, process, and departure joint paths.
  * NOTE THAT ProcessPlan::type is NOT set.
  * @return True on planning success, false otherwise
  */
 bool generateMotionPlan(const descartes_core::RobotModelPtr model,
+                        const ParallelGraphBuilder& graph_builder,
+                        const SegmentValidator& segment_validator,
+                        FreeSpacePlanner& free_space_planner,
                         const std::vector<descartes_core::TrajectoryPtPtr>& traj,
                         moveit::core::RobotModelConstPtr moveit_model,
                         const std::string& move_group_name,
                         const std::vector<double>& start_state,
+                        const MotionPlanOptions& options,
                         godel_msgs::ProcessPlan& plan);
 
 
@@ -1,43 +1,141 @@
 #include "godel_process_planning/godel_process_planning.h"
 #include <moveit/robot_model_loader/robot_model_loader.h>
+#include <thread>
+#include <boost/make_shared.hpp>
+#include "planner_pool.h"
+#include "common_utils.h"
+
+const static std::string JOINT_TOPIC_NAME = "joint_states"; // ROS topic to subscribe to for robot state
 
 godel_process_planning::ProcessPlanningManager::ProcessPlanningManager(
     const std::string& world_frame, const std::string& blend_group, const std::string& blend_tcp,
     const std::string& keyence_group, const std::string& keyence_tcp,
-    const std::string& robot_model_plugin)
+    const std::string& robot_model_plugin, std::size_t planning_threads, std::size_t concurrent_requests,
+    const IkCacheParameters& ik_cache_params, const ValidityCheckerParameters& validity_params,
+    const FreeSpacePlannerParameters& free_space_params)
     : plugin_loader_("descartes_core", "descartes_core::RobotModel"),
-      blend_group_name_(blend_group), keyence_group_name_(keyence_group)
+      blend_group_name_(blend_group), keyence_group_name_(keyence_group), compare_planning_modes_(false)
 {
-  // Attempt to load and initialize the blending robot model
-  blend_model_ = plugin_loader_.createInstance(robot_model_plugin);
-  if (!blend_model_)
+  // Load the moveit model
+  robot_model_loader::RobotModelLoader robot_model_loader("robot_description");
+  moveit_model_ = robot_model_loader.getModel();
+
+  if (moveit_model_.get() == NULL)
   {
-    throw std::runtime_error(std::string("Could not load: ") + robot_model_plugin);
+    throw std::runtime_error("Could not load moveit robot model");
   }
 
-  if (!blend_model_->initialize("robot_description", blend_group, world_frame, blend_tcp))
+  ros::NodeHandle nh;
+  joint_states_ = std::make_shared<godel_utils::JointStateCache>(nh, JOINT_TOPIC_NAME);
+
+  if (planning_threads == 0)
   {
-    throw std::runtime_error("Unable to initialize blending robot model");
+    planning_threads = std::max(1u, std::thread::hardware_concurrency());
   }
+  concurrent_requests = std::max<std::size_t>(1, concurrent_requests);
 
-  // Attempt to load and initialize the scanning/keyence robot model
-  keyence_model_ = plugin_loader_.createInstance(robot_model_plugin);
-  if (!keyence_model_)
+  // 'planning_threads' bounds the threads of all requests in flight, up to 'concurrent_requests'
+  // of each kind, so that concurrent requests share the cores instead of oversubscribing them
+  const std::size_t max_concurrent_requests = std::max<std::size_t>(1, planning_threads / 2);
+  if (concurrent_requests > max_concurrent_requests)
   {
-    throw std::runtime_error(std::string("Could not load: ") + robot_model_plugin);
+    ROS_WARN("%lu planning threads cannot serve %lu concurrent requests of each kind; serving %lu", planning_threads,
+             concurrent_requests, max_concurrent_requests);
+    concurrent_requests = max_concurrent_requests;
   }
+  const std::size_t request_threads = std::max<std::size_t>(1, planning_threads / (2 * concurrent_requests));
 
-  if (!keyence_model_->initialize("robot_description", keyence_group, world_frame, keyence_tcp))
+  // Checkers and caches are shared by every model of a group, across requests
+  blend_validity_checker_ = std::make_shared<ValidityChecker>(moveit_model_, blend_group, validity_params);
+  keyence_validity_checker_ = std::make_shared<ValidityChecker>(moveit_model_, keyence_group, validity_params);
+  blend_free_space_planner_ = std::make_shared<FreeSpacePlanner>(moveit_model_, blend_group, free_space_params);
+  keyence_free_space_planner_ = std::make_shared<FreeSpacePlanner>(moveit_model_, keyence_group, free_space_params);
+  if (ik_cache_params.capacity > 0)
   {
-    throw std::runtime_error("Unable to initialize scanning robot model");
+    blend_ik_cache_ = std::make_shared<IkCache>(ik_cache_params);
+    keyence_ik_cache_ = std::make_shared<IkCache>(ik_cache_params);
   }
 
-  // Load the moveit model
-  robot_model_loader::RobotModelLoader robot_model_loader("robot_description");
-  moveit_model_ = robot_model_loader.getModel();
+  // The IK solvers and collision environments of the robot models are not thread safe, so every
+  // planning thread of every concurrent request gets its own model
+  blend_pool_ = std::make_shared<PlannerPool>();
+  keyence_pool_ = std::make_shared<PlannerPool>();
+  for (std::size_t r = 0; r < concurrent_requests; ++r)
+  {
+    std::vector<descartes_core::RobotModelPtr> blend_models;
+    std::vector<descartes_core::RobotModelPtr> keyence_models;
+    for (std::size_t i = 0; i < request_threads; ++i)
+    {
+      descartes_core::RobotModelPtr blend = loadModel(robot_model_plugin, blend_group, world_frame, blend_tcp);
+      descartes_core::RobotModelPtr keyence = loadModel(robot_model_plugin, keyence_group, world_frame, keyence_tcp);
+      if (!blend || !keyence)
+      {
+        break;
+      }
 
-  if (moveit_model_.get() == NULL)
+      // Validity checking is wrapped below the IK cache so that cached solutions are already
+      // collision checked
+      blend = boost::make_shared<ValidityCheckedRobotModel>(blend, blend_validity_checker_);
+      keyence = boost::make_shared<ValidityCheckedRobotModel>(keyence, keyence_validity_checker_);
+      if (blend_ik_cache_)
+      {
+        blend = boost::make_shared<CachedRobotModel>(blend, blend_ik_cache_);
+        keyence = boost::make_shared<CachedRobotModel>(keyence, keyence_ik_cache_);
+      }
+      blend_models.push_back(blend);
+      keyence_models.push_back(keyence);
+    }
+
+    if (blend_models.empty())
+    {
+      if (r == 0)
+      {
+        throw std::runtime_error(std::string("Unable to load and initialize robot models from: ") +
+                                 robot_model_plugin);
+      }
+      ROS_WARN("Could not create robot models for concurrent request %lu; serving %lu requests at once", r, r);
+      break;
+    }
+    if (blend_models.size() < request_threads)
+    {
+      ROS_WARN("Could not create all robot models for concurrent request %lu; planning it with %lu threads", r,
+               blend_models.size());
+    }
+
+    blend_pool_->add(std::unique_ptr<PlanningInstance>(new PlanningInstance(blend_models)));
+    keyence_pool_->add(std::unique_ptr<PlanningInstance>(new PlanningInstance(keyence_models)));
+  }
+}
+
+descartes_core::RobotModelPtr godel_process_planning::ProcessPlanningManager::loadModel(
+    const std::string& robot_model_plugin, const std::string& group, const std::string& world_frame,
+    const std::string& tcp)
+{
+  descartes_core::RobotModelPtr model;
+  try
   {
-    throw std::runtime_error("Could not load moveit robot model");
+    model = plugin_loader_.createInstance(robot_model_plugin);
   }
+  catch (const pluginlib::PluginlibException& ex)
+  {
+    ROS_ERROR("Could not load %s: %s", robot_model_plugin.c_str(), ex.what());
+    return descartes_core::RobotModelPtr();
+  }
+
+  if (!model || !model->initialize("robot_description", group, world_frame, tcp))
+  {
+    ROS_ERROR("Unable to initialize robot model for group %s", group.c_str());
+    return descartes_core::RobotModelPtr();
+  }
+  return model;
+}
+
+std::size_t godel_process_planning::ProcessPlanningManager::concurrency() const
+{
+  return blend_pool_->size() + keyence_pool_->size();
+}
+
+std::vector<double> godel_process_planning::ProcessPlanningManager::currentJointState() const
+{
+  return getCurrentJointState(*joint_states_);
 }
@@ -1,10 +1,12 @@
 #include <ros/ros.h>
 // Process Services
 #include <godel_process_planning/godel_process_planning.h>
+#include "batch_planning_server.h"
 
 // Globals
 const static std::string DEFAULT_BLEND_PLANNING_SERVICE = "blend_process_planning";
 const static std::string DEFAULT_KEYENCE_PLANNING_SERVICE = "keyence_process_planning";
+const static std::string DEFAULT_BATCH_PLANNING_ACTION = "batch_process_planning";
 
 int main(int argc, char** argv)
 {
@@ -19,6 +21,88 @@ int main(int argc, char** argv)
   pnh.param<std::string>("blend_tcp", blend_tcp, "tcp_frame");
   pnh.param<std::string>("keyence_tcp", keyence_tcp, "keyence_tcp_frame");
   pnh.param<std::string>("robot_model_plugin", robot_model_plugin, "");
+  int planning_threads;
+  pnh.param<int>("planning_threads", planning_threads, 0); // All requests; 0 = one per hardware thread
+  int concurrent_requests;
+  pnh.param<int>("concurrent_requests", concurrent_requests, 2); // of each kind, blend and keyence
+  bool compare_planning_modes; // Time sparse or coarse to fine blend planning against dense planning
+  pnh.param<bool>("compare_planning_modes", compare_planning_modes, false);
+
+  // IK cache; a size of 0 disables it
+  godel_process_planning::IkCacheParameters ik_cache_params;
+  int ik_cache_size;
+  std::string ik_cache_mode;
+  pnh.param<int>("ik_cache_size", ik_cache_size, static_cast<int>(ik_cache_params.capacity));
+  pnh.param<double>("ik_cache_position_resolution", ik_cache_params.position_resolution,
+                    ik_cache_params.position_resolution);
+  pnh.param<double>("ik_cache_orientation_resolution", ik_cache_params.orientation_resolution,
+                    ik_cache_params.orientation_resolution);
+  pnh.param<std::string>("ik_cache_mode", ik_cache_mode, "exact");
+  ik_cache_params.capacity = static_cast<std::size_t>(std::max(0, ik_cache_size));
+  if (ik_cache_mode == "nearest_seed")
+  {
+    ik_cache_params.mode = godel_process_planning::IkCacheMode::NEAREST_SEED;
+  }
+  else if (ik_cache_mode != "exact")
+  {
+    ROS_ERROR_STREAM("Unknown ik_cache_mode '" << ik_cache_mode << "'; expected 'exact' or 'nearest_seed'");
+    return -1;
+  }
+
+  // Memoized collision results; a size of 0 disables memoizing
+  godel_process_planning::ValidityCheckerParameters validity_params;
+  int collision_cache_size;
+  pnh.param<int>("collision_cache_size", collision_cache_size, static_cast<int>(validity_params.cache_capacity));
+  pnh.param<double>("collision_cache_resolution", validity_params.joint_resolution,
+                    validity_params.joint_resolution);
+  validity_params.cache_capacity = static_cast<std::size_t>(std::max(0, collision_cache_size));
+
+  // Free space planners, tried in turn for each approach/depart motion MoveIt must plan, each with
+  // the same short budget; a cache size of 0 disables reusing motions
+  godel_process_planning::FreeSpacePlannerParameters free_space_params;
+  std::vector<std::string> free_space_planners;
+  double free_space_planning_time;
+  int free_space_planning_attempts, free_space_cache_size;
+  pnh.param<double>("free_space_planning_time", free_space_planning_time,
+                    free_space_params.planners.front().planning_time);
+  pnh.param<int>("free_space_planning_attempts", free_space_planning_attempts,
+                 free_space_params.planners.front().planning_attempts);
+  pnh.param<int>("free_space_cache_size", free_space_cache_size, static_cast<int>(free_space_params.cache_capacity));
+  free_space_params.cache_capacity = static_cast<std::size_t>(std::max(0, free_space_cache_size));
+  if (!pnh.getParam("free_space_planners", free_space_planners))
+  {
+    for (const auto& config : free_space_params.planners)
+    {
+      free_space_planners.push_back(config.planner_id);
+    }
+  }
+  free_space_params.planners.clear();
+  for (const auto& planner_id : free_space_planners)
+  {
+    free_space_params.planners.emplace_back(planner_id, free_space_planning_time,
+                                            std::max(1, free_space_planning_attempts));
+  }
+  if (free_space_params.planners.empty())
+  {
+    ROS_ERROR_STREAM("Parameter 'free_space_planners' must list at least one planner configuration");
+    return -1;
+  }
+
+  // Joint trajectory timing; fractions of the joint limits in the robot model, with defaults for
+  // joints it does not limit (acceleration limits are often left out of the MoveIt configuration)
+  godel_process_planning::TimeParameterizationParameters timing_params;
+  pnh.param<double>("joint_velocity_scaling", timing_params.velocity_scaling, timing_params.velocity_scaling);
+  pnh.param<double>("joint_acceleration_scaling", timing_params.acceleration_scaling,
+                    timing_params.acceleration_scaling);
+  pnh.param<double>("default_joint_velocity", timing_params.default_velocity, timing_params.default_velocity);
+  pnh.param<double>("default_joint_acceleration", timing_params.default_acceleration,
+                    timing_params.default_acceleration);
+  if (timing_params.velocity_scaling <= 0.0 || timing_params.acceleration_scaling <= 0.0 ||
+      timing_params.default_velocity <= 0.0 || timing_params.default_acceleration <= 0.0)
+  {
+    ROS_ERROR_STREAM("Joint velocity and acceleration scalings and defaults must be positive");
+    return -1;
+  }
 
   // IK Plugin parameter must be specified
   if (robot_model_plugin.empty())
@@ -33,16 +117,23 @@ int main(int argc, char** argv)
   // all required initialization. It exposes member functions to handle each kind of processing
   // event.
   ProcessPlanningManager manager(world_frame, blend_group, blend_tcp, keyence_group, keyence_tcp,
-                                 robot_model_plugin);
+                                 robot_model_plugin, static_cast<std::size_t>(std::max(0, planning_threads)),
+                                 static_cast<std::size_t>(std::max(1, concurrent_requests)), ik_cache_params,
+                                 validity_params, free_space_params);
+  manager.setComparePlanningModes(compare_planning_modes);
+  manager.setTimeParameterization(timing_params);
   // Plumb in the appropriate ros services
   ros::ServiceServer blend_server = nh.advertiseService(
       DEFAULT_BLEND_PLANNING_SERVICE, &ProcessPlanningManager::handleBlendPlanning, &manager);
   ros::ServiceServer keyence_server = nh.advertiseService(
       DEFAULT_KEYENCE_PLANNING_SERVICE, &ProcessPlanningManager::handleKeyencePlanning, &manager);
+  godel_process_planning::BatchPlanningServer batch_server(nh, DEFAULT_BATCH_PLANNING_ACTION, manager);
 
-  // Serve and wait for shutdown
+  // Serve and wait for shutdown; one callback thread per request that can be planned at once
+  ros::AsyncSpinner spinner(2 * std::max(1, concurrent_requests));
+  spinner.start();
   ROS_INFO_STREAM("Godel Process Planning Server Online");
-  ros::spin();
+  ros::waitForShutdown();
 
   return 0;
 }
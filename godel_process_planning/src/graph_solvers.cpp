@@ -0,0 +1,406 @@
+#include "graph_solvers.h"
+#include "common_utils.h"
+#include "tool_axis_pt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <boost/make_shared.hpp>
+#include <descartes_planner/ladder_graph_dag_search.h>
+#include <descartes_trajectory/joint_trajectory_pt.h>
+#include <ros/console.h>
+
+namespace
+{
+
+typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > PoseVector;
+
+// Time allowed from point 'first - 1' to point 'last': the sum of the points' own limits, or
+// unspecified if any of them is
+descartes_core::TimingConstraint spanTiming(const godel_process_planning::DescartesTraj& traj, std::size_t first,
+                                            std::size_t last)
+{
+  double upper = 0.0;
+  for (std::size_t k = first; k <= last; ++k)
+  {
+    const descartes_core::TimingConstraint& timing = traj[k]->getTiming();
+    if (!timing.isSpecified())
+    {
+      return descartes_core::TimingConstraint();
+    }
+    upper += timing.upper;
+  }
+  return descartes_core::TimingConstraint(upper);
+}
+
+bool withinVelocityLimits(const std::vector<double>& from, const std::vector<double>& to,
+                          const descartes_core::TimingConstraint& timing, const std::vector<double>& velocity_limits)
+{
+  if (!timing.isSpecified())
+  {
+    return true;
+  }
+  for (std::size_t j = 0; j < from.size() && j < velocity_limits.size(); ++j)
+  {
+    if (std::abs(to[j] - from[j]) > velocity_limits[j] * timing.upper)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Fills in the points strictly between 'a' and 'b' by interpolating the joints of path[a]
+ * and path[b], parameterized by the distance travelled along the nominal tool positions
+ * @return False (leaving 'path' partially written) if any interpolated state is too far from its
+ *         point, invalid, or too fast
+ */
+bool interpolateInterval(const descartes_core::RobotModel& model, const godel_process_planning::DescartesTraj& traj,
+                         std::size_t a, std::size_t b, const std::vector<double>& velocity_limits,
+                         const godel_process_planning::SparsePlanningParameters& params,
+                         godel_process_planning::JointPath& path)
+{
+  const std::vector<double>& start = path[a];
+  const std::vector<double>& stop = path[b];
+
+  PoseVector nominal(b - a + 1);
+  std::vector<double> distance(b - a + 1, 0.0);
+  for (std::size_t k = a; k <= b; ++k)
+  {
+    if (!traj[k]->getNominalCartPose(start, model, nominal[k - a]))
+    {
+      return false;
+    }
+    if (k > a)
+    {
+      distance[k - a] =
+          distance[k - a - 1] + (nominal[k - a].translation() - nominal[k - a - 1].translation()).norm();
+    }
+  }
+  const double total = distance.back();
+
+  const double cos_max_axis = std::cos(params.max_axis_deviation);
+  std::vector<double> joints(start.size());
+  Eigen::Affine3d actual;
+  for (std::size_t k = a + 1; k < b; ++k)
+  {
+    const double s = total > 0.0 ? distance[k - a] / total : static_cast<double>(k - a) / (b - a);
+    for (std::size_t j = 0; j < joints.size(); ++j)
+    {
+      joints[j] = start[j] + s * (stop[j] - start[j]);
+    }
+
+    if (!withinVelocityLimits(path[k - 1], joints, traj[k]->getTiming(), velocity_limits) ||
+        !model.getFK(joints, actual))
+    {
+      return false;
+    }
+
+    const Eigen::Affine3d& target = nominal[k - a];
+    if ((actual.translation() - target.translation()).norm() > params.max_position_deviation ||
+        actual.linear().col(2).dot(target.linear().col(2)) < cos_max_axis)
+    {
+      return false;
+    }
+
+    if (!model.isValid(joints))
+    {
+      return false;
+    }
+    path[k] = joints;
+  }
+
+  return withinVelocityLimits(path[b - 1], stop, traj[b]->getTiming(), velocity_limits);
+}
+
+} // namespace
+
+bool godel_process_planning::denseSolve(const ParallelGraphBuilder& graph_builder, const DescartesTraj& traj,
+                                        const std::vector<double>& start_state, JointPath& path, double& cost,
+                                        std::vector<std::size_t>* failed_points)
+{
+  // Generate a graph of the process path joint solutions
+  descartes_planner::LadderGraph graph(graph_builder.dof());
+  if (!graph_builder.build(traj, graph, failed_points))
+  {
+    if (!failed_points || failed_points->empty())
+    {
+      ROS_ERROR("%s: Failed to build graph. One or more points may have no valid IK solutions", __FUNCTION__);
+    }
+    return false;
+  }
+
+  // Using the valid starting configurations, estimate the cost to move to each of them from the
+  // starting pose
+  const auto dof = graph.dof();
+  const auto& joint_data = graph.getRung(0).data; // This is a flat vector of doubles w/ all the solutions
+  std::vector<double> start_costs(joint_data.size() / dof, 0.0);
+  if (!start_state.empty())
+  {
+    for (std::size_t i = 0; i < start_costs.size(); ++i)
+    {
+      std::vector<double> sol(&joint_data[i * dof], &joint_data[i * dof + dof]);
+      start_costs[i] = freeSpaceCostFunction(start_state, sol);
+    }
+  }
+
+  descartes_planner::DAGSearch search(graph);
+  cost = search.run(start_costs);
+  if (cost == std::numeric_limits<double>::max())
+  {
+    ROS_ERROR("%s: Failed to search graph. All points have IK, but process constraints (e.g velocity) "
+              "prevent a solution", __FUNCTION__);
+    return false;
+  }
+
+  const auto path_idxs = search.shortestPath();
+  path.resize(path_idxs.size());
+  for (std::size_t i = 0; i < path_idxs.size(); ++i)
+  {
+    const auto* data = graph.vertex(i, path_idxs[i]);
+    path[i].assign(data, data + dof);
+  }
+  return true;
+}
+
+bool godel_process_planning::sparseSolve(const ParallelGraphBuilder& graph_builder,
+                                         const descartes_core::RobotModel& model, const DescartesTraj& traj,
+                                         const std::vector<double>& start_state,
+                                         const SparsePlanningParameters& params, JointPath& path,
+                                         SparsePlanningStats& stats)
+{
+  stats = SparsePlanningStats();
+  const std::size_t n = traj.size();
+  const std::size_t stride = std::max<std::size_t>(1, params.stride);
+  double cost;
+  if (n < 3 || stride == 1)
+  {
+    stats.sparse_points = n;
+    return denseSolve(graph_builder, traj, start_state, path, cost);
+  }
+
+  // 1 - The sparse graph: every stride'th point, allowed the time of the points it skips
+  std::vector<std::size_t> keys;
+  for (std::size_t i = 0; i < n; i += stride)
+  {
+    keys.push_back(i);
+  }
+  if (keys.back() != n - 1)
+  {
+    keys.push_back(n - 1);
+  }
+
+  DescartesTraj sparse;
+  for (std::size_t j = 0; j < keys.size(); ++j)
+  {
+    descartes_core::TrajectoryPtPtr pt = traj[keys[j]]->copy();
+    if (j > 0)
+    {
+      pt->setTiming(spanTiming(traj, keys[j - 1] + 1, keys[j]));
+    }
+    sparse.push_back(pt);
+  }
+
+  JointPath sparse_path;
+  if (!denseSolve(graph_builder, sparse, start_state, sparse_path, cost))
+  {
+    return false;
+  }
+  stats.sparse_points = keys.size();
+
+  path.assign(n, std::vector<double>());
+  for (std::size_t j = 0; j < keys.size(); ++j)
+  {
+    path[keys[j]] = sparse_path[j];
+  }
+
+  // 2 - Fill in between the sparse solutions, densely where interpolating strays from the path
+  const std::vector<double> velocity_limits = model.getJointVelocityLimits();
+  for (std::size_t j = 1; j < keys.size(); ++j)
+  {
+    const std::size_t a = keys[j - 1];
+    const std::size_t b = keys[j];
+    if (b - a < 2)
+    {
+      continue;
+    }
+
+    if (interpolateInterval(model, traj, a, b, velocity_limits, params, path))
+    {
+      stats.interpolated_points += b - a - 1;
+      continue;
+    }
+
+    DescartesTraj interval;
+    interval.push_back(boost::make_shared<descartes_trajectory::JointTrajectoryPt>(path[a], traj[a]->getTiming()));
+    interval.insert(interval.end(), traj.begin() + a + 1, traj.begin() + b);
+    interval.push_back(boost::make_shared<descartes_trajectory::JointTrajectoryPt>(path[b], traj[b]->getTiming()));
+
+    JointPath interval_path;
+    if (!denseSolve(graph_builder, interval, std::vector<double>(), interval_path, cost))
+    {
+      ROS_WARN("%s: Could not connect the sparse solutions of points %lu and %lu", __FUNCTION__, a, b);
+      return false;
+    }
+    std::copy(interval_path.begin() + 1, interval_path.end() - 1, path.begin() + a + 1);
+    ++stats.densified_intervals;
+  }
+  return true;
+}
+
+bool godel_process_planning::coarseToFineSolve(const ParallelGraphBuilder& graph_builder,
+                                               const descartes_core::RobotModel& model, const DescartesTraj& traj,
+                                               const std::vector<double>& start_state,
+                                               const CoarseToFinePlanningParameters& params, JointPath& path,
+                                               CoarseToFinePlanningStats& stats)
+{
+  stats = CoarseToFinePlanningStats();
+
+  // Work on copies; the rotations sampled are changed below
+  DescartesTraj sampled(traj.size());
+  std::vector<ToolAxisPt*> axial(traj.size(), NULL);
+  for (std::size_t i = 0; i < traj.size(); ++i)
+  {
+    sampled[i] = traj[i]->copy();
+    axial[i] = dynamic_cast<ToolAxisPt*>(sampled[i].get());
+    if (axial[i])
+    {
+      axial[i]->sampleCircle(params.coarse_step);
+    }
+  }
+
+  // 1 - The coarse graph. Points that have no IK at any coarse rotation are sampled finely all the
+  // way round instead, and the graph is built again; a fine sampling only helps with reach, so
+  // once no point is left to widen a failure is final.
+  double cost;
+  JointPath coarse_path;
+  std::vector<std::size_t> failed;
+  std::vector<bool> is_wide(traj.size(), false);
+  while (!denseSolve(graph_builder, sampled, start_state, coarse_path, cost, &failed))
+  {
+    std::size_t widened = 0;
+    for (std::size_t i : failed)
+    {
+      if (axial[i] && !is_wide[i])
+      {
+        axial[i]->sampleCircle(params.fine_step);
+        is_wide[i] = true;
+        ++widened;
+      }
+    }
+    if (widened == 0)
+    {
+      return false;
+    }
+    ROS_DEBUG("%s: Sampling %lu points with no coarse IK at fine rotations", __FUNCTION__, widened);
+    stats.widened_points += widened;
+  }
+
+  for (const ToolAxisPt* pt : axial)
+  {
+    stats.coarse_samples += pt ? pt->angles().size() : 0;
+  }
+
+  // 2 - The fine graph: near the rotation the coarse solution uses. By default the window is half a
+  // coarse step either side, the rotations closer to it than to its coarse neighbours.
+  Eigen::Affine3d pose;
+  for (std::size_t i = 0; i < sampled.size(); ++i)
+  {
+    if (!axial[i])
+    {
+      continue;
+    }
+    if (!model.getFK(coarse_path[i], pose))
+    {
+      return false;
+    }
+    axial[i]->sampleWindow(axial[i]->angleOf(pose), params.window, params.fine_step);
+    stats.fine_samples += axial[i]->angles().size();
+  }
+
+  return denseSolve(graph_builder, sampled, start_state, path, cost);
+}
+
+bool godel_process_planning::warmStartSolve(const ParallelGraphBuilder& graph_builder,
+                                            const descartes_core::RobotModel& model, const DescartesTraj& traj,
+                                            const std::vector<double>& start_state, const JointPath& seed,
+                                            const WarmStartParameters& params, JointPath& path, WarmStartStats& stats)
+{
+  stats = WarmStartStats();
+  const std::size_t n = traj.size();
+  if (seed.size() != n)
+  {
+    ROS_DEBUG("%s: Previous solution has %lu points, the path %lu; nothing to reuse", __FUNCTION__, seed.size(), n);
+    return false;
+  }
+
+  // 1 - Which points the previous solution still solves: the same tool position and axis, and valid
+  // in the current scene. This is one FK and one validity check per point, no IK.
+  const double cos_max_axis = std::cos(params.max_axis_deviation);
+  const std::size_t dof = graph_builder.dof();
+  std::vector<bool> changed(n, true);
+  Eigen::Affine3d nominal, actual;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (seed[i].size() != dof || !traj[i]->getNominalCartPose(seed[i], model, nominal) ||
+        !model.getFK(seed[i], actual))
+    {
+      continue;
+    }
+    changed[i] = (actual.translation() - nominal.translation()).norm() > params.max_position_deviation ||
+                 actual.linear().col(2).dot(nominal.linear().col(2)) < cos_max_axis || !model.isValid(seed[i]);
+  }
+
+  // 2 - Points within 'margin' of a changed point keep all their solutions, so that the path can
+  // switch configuration there; the rest are pinned to their previous solution
+  std::vector<bool> replan(n, false);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (changed[i])
+    {
+      const std::size_t first = i > params.margin ? i - params.margin : 0;
+      const std::size_t last = std::min(n - 1, i + params.margin);
+      std::fill(replan.begin() + first, replan.begin() + last + 1, true);
+    }
+  }
+
+  DescartesTraj seeded(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (replan[i])
+    {
+      seeded[i] = traj[i];
+      ++stats.replanned_points;
+    }
+    else
+    {
+      seeded[i] = boost::make_shared<descartes_trajectory::JointTrajectoryPt>(seed[i], traj[i]->getTiming());
+      ++stats.reused_points;
+    }
+  }
+
+  if (stats.reused_points == 0)
+  {
+    ROS_DEBUG("%s: None of the previous solution can be reused", __FUNCTION__);
+    return false;
+  }
+
+  // 3 - The pinned points still have their edges checked against the (possibly new) timing
+  double cost;
+  return denseSolve(graph_builder, seeded, start_state, path, cost);
+}
+
+double godel_process_planning::jointPathCost(const JointPath& path)
+{
+  double cost = 0.0;
+  for (std::size_t i = 1; i < path.size(); ++i)
+  {
+    for (std::size_t j = 0; j < path[i].size(); ++j)
+    {
+      cost += std::abs(path[i][j] - path[i - 1][j]);
+    }
+  }
+  return cost;
+}
@@ -0,0 +1,136 @@
+#ifndef GODEL_PROCESS_PLANNING_GRAPH_SOLVERS_H
+#define GODEL_PROCESS_PLANNING_GRAPH_SOLVERS_H
+
+#include <descartes_core/robot_model.h>
+#include <descartes_core/trajectory_pt.h>
+#include <cmath>
+#include "parallel_graph_builder.h"
+
+/*
+ * Strategies for finding joint solutions of a process path with the Descartes ladder graph.
+ *
+ * Dense: one graph over every Cartesian point of the path, searched for the cheapest path. This is
+ * what the planner has always done; it is exact but builds IK and edges for every point.
+ *
+ * Sparse: a graph over every n'th point only. Between the chosen sparse solutions the joints are
+ * interpolated linearly, and each interpolated state is kept only if its tool pose stays within a
+ * tolerance of the point it stands in for (and it is valid, and within the joint velocity limits).
+ * Intervals where that fails are planned densely, pinned to the sparse solutions at both ends.
+ *
+ * Coarse to fine: for points that are free to rotate about the tool axis (ToolAxisPt), a graph
+ * over few rotations per point first, then a graph over finely spaced rotations near the ones the
+ * coarse solution picked. Points with no IK at any coarse rotation are sampled finely around the
+ * whole circle from the start.
+ *
+ * Warm start: reuses the solution of a previous plan of the same path. Points whose tool pose the
+ * previous joint state still reaches (and where it is still valid) are pinned to it; only the
+ * points that changed, and a few either side of them, get their full IK.
+ */
+namespace godel_process_planning
+{
+
+/**@brief One joint solution per trajectory point */
+typedef std::vector<std::vector<double> > JointPath;
+
+struct SparsePlanningParameters
+{
+  SparsePlanningParameters() : stride(10), max_position_deviation(0.001), max_axis_deviation(0.02){};
+  std::size_t stride;            /**<Every stride'th point (and the last) is planned in the sparse graph */
+  double max_position_deviation; /**<(m) Largest distance of an interpolated tool position from its point */
+  double max_axis_deviation;     /**<(rad) Largest angle of an interpolated tool z axis from its point's */
+};
+
+struct SparsePlanningStats
+{
+  SparsePlanningStats() : sparse_points(0), interpolated_points(0), densified_intervals(0){};
+  std::size_t sparse_points;       /**<Points in the sparse graph */
+  std::size_t interpolated_points; /**<Points solved by joint interpolation */
+  std::size_t densified_intervals; /**<Intervals that had to be planned densely */
+};
+
+struct CoarseToFinePlanningParameters
+{
+  CoarseToFinePlanningParameters() : coarse_step(M_PI / 4.0), fine_step(M_PI / 12.0), window(M_PI / 8.0){};
+  double coarse_step; /**<(rad) Rotation about the tool axis between samples of the coarse graph */
+  double fine_step;   /**<(rad) Rotation between samples of the fine graph, and of widened points */
+  double window;      /**<(rad) The fine graph samples this far either side of the coarse solution */
+};
+
+struct CoarseToFinePlanningStats
+{
+  CoarseToFinePlanningStats() : coarse_samples(0), fine_samples(0), widened_points(0){};
+  std::size_t coarse_samples; /**<Tool rotations sampled over all points of the coarse graph */
+  std::size_t fine_samples;   /**<Tool rotations sampled over all points of the fine graph */
+  std::size_t widened_points; /**<Points without IK at the coarse rotations, sampled finely */
+};
+
+struct WarmStartParameters
+{
+  WarmStartParameters() : max_position_deviation(1e-4), max_axis_deviation(1e-3), margin(5){};
+  double max_position_deviation; /**<(m) Largest distance of a previous tool position from its point */
+  double max_axis_deviation;     /**<(rad) Largest angle of a previous tool z axis from its point's */
+  std::size_t margin; /**<Points either side of a changed point that are planned from scratch too */
+};
+
+struct WarmStartStats
+{
+  WarmStartStats() : reused_points(0), replanned_points(0){};
+  std::size_t reused_points;    /**<Points pinned to the previous solution */
+  std::size_t replanned_points; /**<Points solved with their full IK */
+};
+
+/**
+ * @brief Solves 'traj' with a single graph over all of its points
+ * @param start_state Joint state the robot moves to the path from, used to rank the path's
+ *        starting configurations; if empty, all starting configurations cost the same
+ * @param path Output; a joint solution per point of 'traj'
+ * @param cost Output; the graph cost of the solution (summed joint motion)
+ * @param failed_points If given, lists the points without IK solutions when the graph can't be
+ *        built (see ParallelGraphBuilder::build)
+ */
+bool denseSolve(const ParallelGraphBuilder& graph_builder, const std::vector<descartes_core::TrajectoryPtPtr>& traj,
+                const std::vector<double>& start_state, JointPath& path, double& cost,
+                std::vector<std::size_t>* failed_points = NULL);
+
+/**
+ * @brief Solves 'traj' sparse first, then fills in the points between the sparse solutions
+ * @param model Reference model of 'graph_builder'; used for FK and validity checks of the
+ *        interpolated states
+ * @return False if the sparse graph or a dense interval cannot be solved; callers should then
+ *         plan densely
+ */
+bool sparseSolve(const ParallelGraphBuilder& graph_builder, const descartes_core::RobotModel& model,
+                 const std::vector<descartes_core::TrajectoryPtPtr>& traj, const std::vector<double>& start_state,
+                 const SparsePlanningParameters& params, JointPath& path, SparsePlanningStats& stats);
+
+/**
+ * @brief Solves 'traj' at coarse tool rotations first, then at fine rotations near the coarse
+ * solution. Points other than ToolAxisPt are planned as they are. 'traj' is not modified.
+ * @param model Reference model of 'graph_builder'; used for FK of the coarse solution
+ * @return False if either graph cannot be solved; callers should then plan densely
+ */
+bool coarseToFineSolve(const ParallelGraphBuilder& graph_builder, const descartes_core::RobotModel& model,
+                       const std::vector<descartes_core::TrajectoryPtPtr>& traj,
+                       const std::vector<double>& start_state, const CoarseToFinePlanningParameters& params,
+                       JointPath& path, CoarseToFinePlanningStats& stats);
+
+/**
+ * @brief Solves 'traj' starting from 'seed', the joint solution of a previous plan of it
+ * @param model Reference model of 'graph_builder'; used to check the previous solution against
+ *        the points and the current planning scene
+ * @param seed One joint state per point of 'traj'; if the path's point count has changed, there is
+ *        nothing to reuse
+ * @return False if no point can be reused or the graph cannot be solved; callers should then plan
+ *         from scratch
+ */
+bool warmStartSolve(const ParallelGraphBuilder& graph_builder, const descartes_core::RobotModel& model,
+                    const std::vector<descartes_core::TrajectoryPtPtr>& traj, const std::vector<double>& start_state,
+                    const JointPath& seed, const WarmStartParameters& params, JointPath& path,
+                    WarmStartStats& stats);
+
+/**@brief Summed absolute joint motion along 'path'; the cost the graph search minimizes */
+double jointPathCost(const JointPath& path);
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_GRAPH_SOLVERS_H
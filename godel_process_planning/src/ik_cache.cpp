@@ -0,0 +1,238 @@
+#include <godel_process_planning/ik_cache.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <boost/functional/hash.hpp>
+
+std::ostream& godel_process_planning::operator<<(std::ostream& os, const IkCacheStats& stats)
+{
+  return os << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions << " evictions, "
+            << stats.size << " entries";
+}
+
+godel_process_planning::IkCacheStats godel_process_planning::operator-(const IkCacheStats& after,
+                                                                       const IkCacheStats& before)
+{
+  IkCacheStats diff;
+  diff.hits = after.hits - before.hits;
+  diff.misses = after.misses - before.misses;
+  diff.evictions = after.evictions - before.evictions;
+  diff.size = after.size;
+  return diff;
+}
+
+godel_process_planning::IkCache::IkCache(const IkCacheParameters& params) : params_(params)
+{
+  if (!(params_.position_resolution > 0.0) || !(params_.orientation_resolution > 0.0))
+  {
+    throw std::invalid_argument("IK cache resolutions must be positive");
+  }
+}
+
+godel_process_planning::IkCache::Key
+godel_process_planning::IkCache::makeKey(const Eigen::Affine3d& pose, bool check_collisions) const
+{
+  // q and -q are the same rotation; pick the one with w >= 0. A rotation by a small angle a moves
+  // the quaternion components by about a / 2, hence the halved resolution.
+  Eigen::Quaterniond q(pose.rotation());
+  if (q.w() < 0.0)
+  {
+    q.coeffs() *= -1.0;
+  }
+  const double q_res = 0.5 * params_.orientation_resolution;
+
+  Key key;
+  for (int i = 0; i < 3; ++i)
+  {
+    key[i] = std::llround(pose.translation()(i) / params_.position_resolution);
+  }
+  for (int i = 0; i < 4; ++i)
+  {
+    key[3 + i] = std::llround(q.coeffs()(i) / q_res);
+  }
+  key[7] = check_collisions ? 1 : 0;
+  return key;
+}
+
+std::size_t godel_process_planning::IkCache::KeyHash::operator()(const Key& key) const
+{
+  return boost::hash_range(key.begin(), key.end());
+}
+
+bool godel_process_planning::IkCache::lookup(const Key& key, std::vector<std::vector<double> >& solutions)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end())
+  {
+    ++stats_.misses;
+    return false;
+  }
+
+  entries_.splice(entries_.begin(), entries_, it->second);
+  solutions = it->second->solutions;
+  ++stats_.hits;
+  return true;
+}
+
+void godel_process_planning::IkCache::insert(const Key& key, const std::vector<std::vector<double> >& solutions)
+{
+  if (params_.capacity == 0)
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end())
+  {
+    // Another thread solved the same pose first
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  Entry entry;
+  entry.key = key;
+  entry.solutions = solutions;
+  entries_.push_front(std::move(entry));
+  index_[key] = entries_.begin();
+
+  while (entries_.size() > params_.capacity)
+  {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+    ++stats_.evictions;
+  }
+}
+
+void godel_process_planning::IkCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+}
+
+godel_process_planning::IkCacheStats godel_process_planning::IkCache::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  IkCacheStats result = stats_;
+  result.size = entries_.size();
+  return result;
+}
+
+godel_process_planning::CachedRobotModel::CachedRobotModel(descartes_core::RobotModelPtr model,
+                                                           IkCachePtr cache)
+    : RobotModelDecorator(model), cache_(cache)
+{
+  if (!cache_)
+  {
+    throw std::invalid_argument("CachedRobotModel requires a cache");
+  }
+}
+
+bool godel_process_planning::CachedRobotModel::lookupSolutions(const Eigen::Affine3d& pose,
+                                                               const IkCache::Key& key,
+                                                               std::vector<std::vector<double> >& joint_poses) const
+{
+  std::vector<std::vector<double> > cached;
+  if (!cache_->lookup(key, cached))
+  {
+    return false;
+  }
+
+  if (cache_->parameters().mode == IkCacheMode::EXACT)
+  {
+    joint_poses = std::move(cached);
+    return true;
+  }
+
+  // Refine the stored solutions onto the actual pose; each converges to the same branch
+  joint_poses.clear();
+  std::vector<double> solution;
+  for (const auto& seed : cached)
+  {
+    if (model_->getIK(pose, seed, solution))
+    {
+      joint_poses.push_back(solution);
+    }
+  }
+  // If some branch was lost (e.g. at a joint limit) the caller falls back to a full solve
+  return joint_poses.size() == cached.size();
+}
+
+bool godel_process_planning::CachedRobotModel::getAllIK(const Eigen::Affine3d& pose,
+                                                        std::vector<std::vector<double> >& joint_poses) const
+{
+  const IkCache::Key key = cache_->makeKey(pose, check_collisions_);
+  if (lookupSolutions(pose, key, joint_poses))
+  {
+    return !joint_poses.empty();
+  }
+
+  const bool found = model_->getAllIK(pose, joint_poses);
+  cache_->insert(key, joint_poses);
+  return found;
+}
+
+bool godel_process_planning::CachedRobotModel::getAllIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses,
+                                                             std::vector<double>& joints,
+                                                             std::vector<std::size_t>& offsets) const
+{
+  const std::size_t dof = static_cast<std::size_t>(getDOF());
+  std::vector<IkCache::Key> keys(n_poses);
+  std::vector<std::vector<std::vector<double> > > solutions(n_poses);
+  std::vector<std::size_t> misses;
+  std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > miss_poses;
+
+  for (std::size_t i = 0; i < n_poses; ++i)
+  {
+    keys[i] = cache_->makeKey(poses[i], check_collisions_);
+    if (!lookupSolutions(poses[i], keys[i], solutions[i]))
+    {
+      misses.push_back(i);
+      miss_poses.push_back(poses[i]);
+    }
+  }
+
+  // Solve the misses, in one batch if the wrapped model supports it
+  const godel_utils::BatchIkSolver* batch = dynamic_cast<const godel_utils::BatchIkSolver*>(model_.get());
+  if (batch && !misses.empty())
+  {
+    batch->getAllIKBatch(miss_poses.data(), miss_poses.size(), joints, offsets);
+    for (std::size_t k = 0; k < misses.size(); ++k)
+    {
+      std::vector<std::vector<double> >& sols = solutions[misses[k]];
+      sols.clear();
+      for (std::size_t s = offsets[k]; s < offsets[k + 1]; ++s)
+      {
+        sols.push_back(std::vector<double>(joints.begin() + s * dof, joints.begin() + (s + 1) * dof));
+      }
+    }
+  }
+  else
+  {
+    for (std::size_t k = 0; k < misses.size(); ++k)
+    {
+      model_->getAllIK(miss_poses[k], solutions[misses[k]]);
+    }
+  }
+  for (std::size_t k = 0; k < misses.size(); ++k)
+  {
+    cache_->insert(keys[misses[k]], solutions[misses[k]]);
+  }
+
+  // Flatten
+  bool all_solved = true;
+  joints.clear();
+  offsets.assign(1, 0);
+  for (std::size_t i = 0; i < n_poses; ++i)
+  {
+    for (const auto& sol : solutions[i])
+    {
+      joints.insert(joints.end(), sol.begin(), sol.end());
+    }
+    offsets.push_back(joints.size() / dof);
+    all_solved &= !solutions[i].empty();
+  }
+  return all_solved;
+}
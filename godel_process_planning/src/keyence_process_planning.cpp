@@ -9,12 +9,11 @@
 #include "path_transitions.h"
 #include "common_utils.h"
 #include "generate_motion_plan.h"
+#include "planner_pool.h"
 
 namespace godel_process_planning
 {
 
-const static std::string JOINT_TOPIC_NAME =
-    "joint_states"; // ROS topic to subscribe to for robot state
 /**
  * @brief Translated an Eigen pose to a Descartes trajectory point appropriate for the scan process!
  *        Mirros the function in blend_process_planning.cpp document.
@@ -54,20 +53,32 @@ descartes_core::TrajectoryPtPtr toDescartesScanPt(const Eigen::Affine3d& pose, d
 bool ProcessPlanningManager::handleKeyencePlanning(godel_msgs::KeyenceProcessPlanning::Request& req,
                                                    godel_msgs::KeyenceProcessPlanning::Response& res)
 {
-  keyence_model_->setCheckCollisions(true);
+  // Capture the current state of the robot
+  std::vector<double> current_joints = currentJointState();
+  return planKeyencePath(req.path, req.params, current_joints, req.seed_plan, res.plan);
+}
+
+bool ProcessPlanningManager::planKeyencePath(const godel_msgs::ProcessPath& path,
+                                             const godel_msgs::ScanPlanParameters& params,
+                                             const std::vector<double>& current_joints,
+                                             const godel_msgs::ProcessPlan& seed_plan, godel_msgs::ProcessPlan& plan)
+{
   // Precondition: Input trajectory must be non-zero
-  if (req.path.segments.empty())
+  if (path.segments.empty())
   {
     ROS_WARN("%s: Cannot create scan process plan for empty trajectory", __FUNCTION__);
     return true;
   }
 
-  if (req.path.segments.size() > 1)
+  if (path.segments.size() > 1)
   {
     ROS_WARN("%s: Currently we do not support scan paths w/ more than 1 segment."
              " Planning only for the first.", __FUNCTION__);
   }
 
+  const PlanningInstancePtr planner = keyence_pool_->acquire();
+  planner->model->setCheckCollisions(true);
+
   // Transform process path from geometry msgs to descartes points
   const static double LINEAR_DISCRETIZATION = 0.01; // meters
   const static double ANGULAR_DISCRETIZATION = 0.1; // radians
@@ -77,18 +88,38 @@ bool ProcessPlanningManager::handleKeyencePlanning(godel_msgs::KeyenceProcessPla
   transition_params.linear_disc = LINEAR_DISCRETIZATION;
   transition_params.angular_disc = ANGULAR_DISCRETIZATION;
   transition_params.retract_dist = RETRACT_DISTANCE;
-  transition_params.traverse_height = req.params.approach_distance;
-  transition_params.z_adjust = req.params.z_adjust;
+  transition_params.traverse_height = params.approach_distance;
+  transition_params.z_adjust = params.z_adjust;
 
-  DescartesTraj process_points = toDescartesTraj(req.path.segments, req.params.traverse_spd, transition_params,
-                                                 toDescartesScanPt);
-  // Capture the current state of the robot
-  std::vector<double> current_joints = getCurrentJointState(JOINT_TOPIC_NAME);
+  DescartesTraj process_points = toDescartesTraj(path.segments, ProcessSpeeds(params.traverse_spd),
+                                                 transition_params, toDescartesScanPt);
+
+  MotionPlanOptions options;
+  options.timing_params = timing_params_;
+  if (seed_plan.type == godel_msgs::ProcessPlan::SCAN_TYPE)
+  {
+    options.seed = toJointPath(seed_plan.trajectory_process);
+  }
+
+  // The planners are shared between requests: log what this one adds to their counts. Requests
+  // planned concurrently (e.g. a batch) add to the same counts.
+  const IkCacheStats ik_stats = keyence_ik_cache_ ? keyence_ik_cache_->stats() : IkCacheStats();
+  const ValidityStats validity_stats = keyence_validity_checker_->stats();
+  const FreeSpacePlannerStats free_space_stats = keyence_free_space_planner_->stats();
+
+  const bool planned = generateMotionPlan(planner->model, planner->graph_builder, planner->segment_validator,
+                                          *keyence_free_space_planner_, process_points, moveit_model_,
+                                          keyence_group_name_, current_joints, options, plan);
+  if (keyence_ik_cache_)
+  {
+    ROS_INFO_STREAM("Keyence IK cache: " << (keyence_ik_cache_->stats() - ik_stats));
+  }
+  ROS_INFO_STREAM("Keyence validity checks: " << (keyence_validity_checker_->stats() - validity_stats));
+  ROS_INFO_STREAM("Keyence free space planning: " << (keyence_free_space_planner_->stats() - free_space_stats));
 
-  if (generateMotionPlan(keyence_model_, process_points, moveit_model_, keyence_group_name_,
-                         current_joints, res.plan))
+  if (planned)
   {
-    res.plan.type = res.plan.SCAN_TYPE;
+    plan.type = plan.SCAN_TYPE;
     return true;
   }
   else
@@ -0,0 +1,63 @@
+#ifndef GODEL_PROCESS_PLANNING_PARALLEL_FOR_H
+#define GODEL_PROCESS_PLANNING_PARALLEL_FOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace godel_process_planning
+{
+
+/**
+ * @brief Runs 'work(thread_index, item)' for every item in [0, n_items) on 'n_threads' threads.
+ * Items are handed out in increasing chunks of 'chunk_size' from a shared counter so that uneven
+ * cost balances out, and the counter stays out of the inner loop. Once 'work' returns false no
+ * further chunks are handed out; chunks already handed out are finished, so every item before the
+ * first failing one has been processed.
+ * @return False if any call to 'work' returned false
+ */
+template <typename WorkFn>
+bool parallelFor(std::size_t n_threads, std::size_t n_items, WorkFn work, std::size_t chunk_size = 8)
+{
+  std::atomic<std::size_t> next(0);
+  std::atomic<bool> ok(true);
+
+  auto worker = [&](std::size_t thread_index)
+  {
+    while (ok)
+    {
+      const std::size_t first = next.fetch_add(chunk_size);
+      if (first >= n_items)
+      {
+        return;
+      }
+      const std::size_t last = std::min(first + chunk_size, n_items);
+      for (std::size_t i = first; i < last; ++i)
+      {
+        if (!work(thread_index, i))
+        {
+          ok = false;
+          return;
+        }
+      }
+    }
+  };
+
+  n_threads = std::max<std::size_t>(1, std::min(n_threads, (n_items + chunk_size - 1) / chunk_size));
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < n_threads; ++t)
+  {
+    threads.emplace_back(worker, t);
+  }
+  worker(0);
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  return ok;
+}
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_PARALLEL_FOR_H
@@ -0,0 +1,187 @@
+#include "parallel_graph_builder.h"
+#include "parallel_for.h"
+#include "tool_axis_pt.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#include <ros/console.h>
+#include <ros/time.h>
+
+#include <godel_utils/batch_ik_solver.h>
+
+godel_process_planning::ParallelGraphBuilder::ParallelGraphBuilder(
+    const std::vector<descartes_core::RobotModelPtr>& models)
+    : models_(models)
+{
+  if (models_.empty() || !models_.front())
+  {
+    throw std::invalid_argument("ParallelGraphBuilder requires at least one robot model");
+  }
+  velocity_limits_ = models_.front()->getJointVelocityLimits();
+}
+
+bool godel_process_planning::ParallelGraphBuilder::build(const std::vector<descartes_core::TrajectoryPtPtr>& traj,
+                                                         descartes_planner::LadderGraph& graph,
+                                                         std::vector<std::size_t>* failed_points) const
+{
+  if (failed_points)
+  {
+    failed_points->clear();
+  }
+
+  if (traj.size() < 2)
+  {
+    ROS_ERROR("%s: Input trajectory must contain at least two points", __FUNCTION__);
+    return false;
+  }
+
+  for (std::size_t i = 0; i < traj.size(); ++i)
+  {
+    if (!traj[i])
+    {
+      ROS_ERROR("%s: Input trajectory contains null point at index %lu", __FUNCTION__, i);
+      return false;
+    }
+  }
+
+  // Clones are created with collision checking in their default state
+  for (std::size_t t = 1; t < models_.size(); ++t)
+  {
+    models_[t]->setCheckCollisions(models_.front()->getCheckCollisions());
+  }
+
+  const std::size_t dof = models_.front()->getDOF();
+  graph.clear();
+  graph.allocate(traj.size());
+
+  // Models that solve IK in batches get all of a ToolAxisPt's orientation samples in one call, and
+  // write their solutions straight into the rung's flat buffer. Only ToolAxisPt is batched: its
+  // joint poses are by definition the IK solutions of all of its Cartesian poses. Other point types
+  // may sample, filter or seed their IK differently, so they are asked for their joint poses.
+  std::vector<const godel_utils::BatchIkSolver*> batch_solvers(models_.size());
+  typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > PoseVector;
+  std::vector<PoseVector> poses(models_.size());
+  std::vector<std::vector<std::size_t> > offsets(models_.size());
+  for (std::size_t t = 0; t < models_.size(); ++t)
+  {
+    batch_solvers[t] = dynamic_cast<const godel_utils::BatchIkSolver*>(models_[t].get());
+  }
+
+  // 1 - Rungs. Every rung is written by exactly one thread, and the rungs were allocated above.
+  ros::WallTime start = ros::WallTime::now();
+  std::atomic<std::size_t> failed_index(std::numeric_limits<std::size_t>::max());
+  std::mutex failed_mutex;
+  bool ik_ok = parallelFor(models_.size(), traj.size(), [&](std::size_t thread_index, std::size_t i)
+  {
+    std::vector<std::vector<double> > solutions;
+    const ToolAxisPt* tool_axis_pt = dynamic_cast<const ToolAxisPt*>(traj[i].get());
+    if (!batch_solvers[thread_index] || !tool_axis_pt)
+    {
+      traj[i]->getJointPoses(*models_[thread_index], solutions);
+      graph.assignRung(i, traj[i]->getID(), traj[i]->getTiming(), solutions);
+    }
+    else
+    {
+      graph.assignRung(i, traj[i]->getID(), traj[i]->getTiming(), solutions);
+      PoseVector& point_poses = poses[thread_index];
+      tool_axis_pt->getCartesianPoses(*models_[thread_index], point_poses);
+      if (!point_poses.empty())
+      {
+        batch_solvers[thread_index]->getAllIKBatch(point_poses.data(), point_poses.size(),
+                                                   graph.getRung(i).data, offsets[thread_index]);
+      }
+    }
+
+    if (graph.getRung(i).data.empty())
+    {
+      if (failed_points)
+      {
+        std::lock_guard<std::mutex> lock(failed_mutex);
+        failed_points->push_back(i);
+        return true;
+      }
+      failed_index = i;
+      return false;
+    }
+    return true;
+  });
+
+  if (failed_points && !failed_points->empty())
+  {
+    // The caller asked for the list to deal with it; not necessarily an error
+    std::sort(failed_points->begin(), failed_points->end());
+    ROS_DEBUG("%s: IK failed for %lu input trajectory points, the first %lu", __FUNCTION__, failed_points->size(),
+              failed_points->front());
+    return false;
+  }
+  if (!ik_ok)
+  {
+    ROS_ERROR("%s: IK failed for input trajectory point %lu", __FUNCTION__, failed_index.load());
+    return false;
+  }
+  ros::WallTime rungs_done = ros::WallTime::now();
+
+  // 2 - Edges between rung i and i + 1, stored on rung i. Rung data is only read from here on.
+  parallelFor(models_.size(), traj.size() - 1, [&](std::size_t, std::size_t i)
+  {
+    graph.assignEdges(i, computeEdges(graph.getRung(i), graph.getRung(i + 1), dof));
+    return true;
+  });
+
+  ROS_INFO("%s: Built graph of %lu rungs (%lu vertices) on %lu threads: IK %f s, edges %f s", __FUNCTION__,
+           graph.size(), graph.numVertices(), models_.size(), (rungs_done - start).toSec(),
+           (ros::WallTime::now() - rungs_done).toSec());
+  return true;
+}
+
+std::vector<descartes_planner::LadderGraph::EdgeList>
+godel_process_planning::ParallelGraphBuilder::computeEdges(const descartes_planner::Rung& from,
+                                                           const descartes_planner::Rung& to,
+                                                           std::size_t dof) const
+{
+  const std::size_t n_from = from.data.size() / dof;
+  const std::size_t n_to = to.data.size() / dof;
+  const bool timed = to.timing.isSpecified();
+
+  std::vector<double> max_step(dof, std::numeric_limits<double>::max());
+  if (timed)
+  {
+    for (std::size_t j = 0; j < dof && j < velocity_limits_.size(); ++j)
+    {
+      max_step[j] = velocity_limits_[j] * to.timing.upper;
+    }
+  }
+
+  std::vector<descartes_planner::LadderGraph::EdgeList> edges(n_from);
+  for (std::size_t a = 0; a < n_from; ++a)
+  {
+    const double* start = &from.data[a * dof];
+    for (std::size_t b = 0; b < n_to; ++b)
+    {
+      const double* stop = &to.data[b * dof];
+      double cost = 0.0;
+      bool valid = true;
+      for (std::size_t j = 0; j < dof; ++j)
+      {
+        const double step = std::abs(stop[j] - start[j]);
+        if (step > max_step[j])
+        {
+          valid = false;
+          break;
+        }
+        cost += step;
+      }
+
+      if (valid)
+      {
+        edges[a].push_back({cost, static_cast<unsigned>(b)});
+      }
+    }
+  }
+  return edges;
+}
@@ -0,0 +1,62 @@
+#ifndef GODEL_PROCESS_PLANNING_PARALLEL_GRAPH_BUILDER_H
+#define GODEL_PROCESS_PLANNING_PARALLEL_GRAPH_BUILDER_H
+
+#include <descartes_core/robot_model.h>
+#include <descartes_core/trajectory_pt.h>
+#include <descartes_planner/ladder_graph.h>
+
+namespace godel_process_planning
+{
+
+/**
+ * @brief Builds the Descartes ladder graph for a trajectory on several threads. This replaces
+ * descartes_planner::PlanningGraph::insertGraph, which solves the IK of every point and then
+ * evaluates every edge serially.
+ *
+ * Each thread owns a robot model: the IK solvers and collision environments of the models are not
+ * safe to share. Rungs (IK solutions per point) are populated first, then the edges between each
+ * pair of adjacent rungs. The resulting graph can be handed straight to descartes_planner::DAGSearch.
+ */
+class ParallelGraphBuilder
+{
+public:
+  /**
+   * @brief Constructs a builder for 'models.size()' threads
+   * @param models One robot model per thread; all must be initialized identically. The first is
+   *        the reference model whose collision checking setting is mirrored on the others.
+   */
+  explicit ParallelGraphBuilder(const std::vector<descartes_core::RobotModelPtr>& models);
+
+  /**
+   * @brief Populates 'graph' with the joint solutions of every point in 'traj' and the edges
+   * between consecutive points
+   * @param traj The trajectory; must contain at least two points
+   * @param graph Output graph, cleared first; must have been created with the models' DOF
+   * @param failed_points If given, a point without IK solutions does not stop the build: the
+   *        indices of all such points are listed here, in increasing order
+   * @return False if 'traj' is invalid or any point has no IK solution
+   */
+  bool build(const std::vector<descartes_core::TrajectoryPtPtr>& traj, descartes_planner::LadderGraph& graph,
+             std::vector<std::size_t>* failed_points = NULL) const;
+
+  std::size_t threads() const { return models_.size(); }
+
+  std::size_t dof() const { return static_cast<std::size_t>(models_.front()->getDOF()); }
+
+private:
+  /**
+   * @brief Computes the edges from every solution of 'from' to every solution of 'to'. Mirrors the
+   * Descartes default: cost is the summed joint displacement, and when 'to' carries timing, edges
+   * that exceed a joint velocity limit are dropped.
+   */
+  std::vector<descartes_planner::LadderGraph::EdgeList> computeEdges(const descartes_planner::Rung& from,
+                                                                     const descartes_planner::Rung& to,
+                                                                     std::size_t dof) const;
+
+  std::vector<descartes_core::RobotModelPtr> models_;
+  std::vector<double> velocity_limits_;
+};
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_PARALLEL_GRAPH_BUILDER_H
@@ -38,45 +38,8 @@ static Eigen::Affine3d closestRotationalPose(const Eigen::Affine3d& start, const
   }
 }
 
-static EigenSTL::vector_Affine3d interpolateCartesian(const Eigen::Affine3d& start, const Eigen::Affine3d& stop,
-                                                      const double ds, const double dt)
-{
-  // Required position change
-  Eigen::Vector3d delta_translation = (stop.translation() - start.translation());
-  Eigen::Vector3d start_pos = start.translation();
-  Eigen::Affine3d stop_prime = start.inverse()*stop; //This the stop pose represented in the start pose coordinate system
-  Eigen::AngleAxisd delta_rotation(stop_prime.rotation());
-
-  // Calculate number of steps
-  unsigned steps_translation = static_cast<unsigned>(delta_translation.norm() / ds) + 1;
-  unsigned steps_rotation = static_cast<unsigned>(delta_rotation.angle() / dt) + 1;
-  unsigned steps = std::max(steps_translation, steps_rotation);
-
-  // Step size
-  Eigen::Vector3d step = delta_translation / steps;
-
-  // Orientation interpolation
-  Eigen::Quaterniond start_q (start.rotation());
-  Eigen::Quaterniond stop_q (stop.rotation());
-  double slerp_ratio = 1.0 / steps;
-
-  std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > result;
-  Eigen::Vector3d trans;
-  Eigen::Quaterniond q;
-  Eigen::Affine3d pose;
-  result.reserve(steps+1);
-  for (unsigned i = 0; i <= steps; ++i)
-  {
-    trans = start_pos + step * i;
-    q = start_q.slerp(slerp_ratio * i, stop_q);
-    pose = (Eigen::Translation3d(trans) * q);
-    result.push_back(pose);
-  }
-  return result;
-}
-
-static EigenSTL::vector_Affine3d retractPath(const Eigen::Affine3d& start, double retract_dist, double traverse_height,
-                                             const double linear_disc, const double angular_disc)
+static godel_utils::PathBuffer retractPath(const Eigen::Affine3d& start, double retract_dist, double traverse_height,
+                                         const double linear_disc, const double angular_disc, int tag)
 {
 
   Eigen::Affine3d a = start * Eigen::Translation3d(0, 0, retract_dist);
@@ -88,12 +51,12 @@ static EigenSTL::vector_Affine3d retractPath(const Eigen::Affine3d& start, doubl
   Eigen::Affine3d b = a;
   b.translation().z() = traverse_height;
 
-  auto segment_a = interpolateCartesian(start, a, linear_disc, angular_disc);
-  auto segment_b = interpolateCartesian(a, b, linear_disc, angular_disc);
-
-  EigenSTL::vector_Affine3d result;
-  result.insert(result.end(), segment_a.begin(), segment_a.end());
-  result.insert(result.end(), segment_b.begin() + 1, segment_b.end());
+  godel_utils::PathBuffer result;
+  result.appendInterpolated(start, a, linear_disc, angular_disc, tag);
+  result.pop_back(); // 'a' starts the second leg
+  const std::size_t a_index = result.size();
+  result.appendInterpolated(a, b, linear_disc, angular_disc, godel_process_planning::TRAVERSE_TAG);
+  result.tag(a_index) = tag; // ... and ends the first
 
   return result;
 }
@@ -123,10 +86,10 @@ godel_process_planning::generateTransitions(const std::vector<geometry_msgs::Pos
 
     // Now we want to generate our intermediate waypoints
     auto approach = retractPath(e_start, params.retract_dist,traverse_height, params.linear_disc,
-                                params.angular_disc);
+                                params.angular_disc, APPROACH_TAG);
     auto depart = retractPath(e_end, params.retract_dist, traverse_height, params.linear_disc,
-                              params.angular_disc);
-    std::reverse(approach.begin(), approach.end()); // we flip the 'to' path to keep the time ordering of the path
+                              params.angular_disc, RETRACT_TAG);
+    approach.reverse(); // we flip the 'to' path to keep the time ordering of the path
 
     ConnectingPath c;
     c.depart = std::move(depart);
@@ -141,62 +104,64 @@ using DescartesConversionFunc =
 
 godel_process_planning::DescartesTraj
 godel_process_planning::toDescartesTraj(const std::vector<geometry_msgs::PoseArray> &segments,
-                                        const double process_speed, const TransitionParameters& transition_params,
+                                        const ProcessSpeeds& speeds, const TransitionParameters& transition_params,
                                         DescartesConversionFunc conversion_fn)
 {
   auto transitions = generateTransitions(segments, transition_params);
 
-  DescartesTraj traj;
-  Eigen::Affine3d last_pose = createNominalTransform(segments.front().poses.front());
-
-  // Convert pose arrays to Eigen types
-  auto eigen_segments = toEigenArrays(segments);
-
-  // Inline function for adding a sequence of motions
-  auto add_segment = [&traj, &last_pose, process_speed, conversion_fn, transition_params]
-                     (const EigenSTL::vector_Affine3d& poses, bool free_last)
-  {
-    // Create Descartes trajectory for the segment path
-    for (std::size_t j = 0; j < poses.size(); ++j)
-    {
-      Eigen::Affine3d this_pose = createNominalTransform(poses[j], transition_params.z_adjust);
-      // O(1) jerky - may need to revisit this time parameterization later. This at least allows
-      // Descartes to perform some optimizations in its graph serach.
-      double dt = (this_pose.translation() - last_pose.translation()).norm() / process_speed;
-
-      if (dt < 1e-4)
-      {
-        continue;
-      }
-
-      if (j == poses.size() - 1 && free_last)
-      {
-        dt = 0.0;
-      }
-      traj.push_back( conversion_fn(this_pose, dt) );
-      last_pose = this_pose;
-    }
-  };
-
+  // Assemble the whole motion in world frame, then flip every pose into a tool pose in one pass
+  godel_utils::PathBuffer path;
   for (std::size_t i = 0; i < segments.size(); ++i)
   {
-    add_segment(transitions[i].approach, false);
-
-    add_segment(eigen_segments[i], false);
-
-    add_segment(transitions[i].depart, false);
+    path.append(transitions[i].approach);
+    path.fromPoseArray(segments[i], PROCESS_TAG);
+    path.append(transitions[i].depart);
 
     if (i != segments.size() - 1)
     {
       // To keep the robot at a safe height while we have no model of the parts we're working on, this code enforces a
       // linear travel between poses. The call to closestRotationalPose allows the linear interpolation to happen to the
       // pose that is 180 degrees off (about Z) from the nominal one. The discretization in Descartes takes care of the rest.
-      auto connection = interpolateCartesian(transitions[i].depart.back(),
-                                             closestRotationalPose(transitions[i].depart.back(), transitions[i+1].approach.front()),
-                                             transition_params.linear_disc, transition_params.angular_disc);
-      add_segment(connection, false);
+      const Eigen::Affine3d depart_end = transitions[i].depart.back();
+      path.appendInterpolated(depart_end, closestRotationalPose(depart_end, transitions[i+1].approach.front()),
+                              transition_params.linear_disc, transition_params.angular_disc, TRAVERSE_TAG);
     }
   } // end segments
+  path.transformLocal(createNominalTransform(Eigen::Affine3d::Identity(), transition_params.z_adjust));
+
+  DescartesTraj traj;
+  traj.reserve(path.size());
+  Eigen::Affine3d last_pose = createNominalTransform(segments.front().poses.front());
+
+  // Create Descartes trajectory for the path
+  for (std::size_t j = 0; j < path.size(); ++j)
+  {
+    Eigen::Affine3d this_pose = path.pose(j);
+    // Nominal time at the speed of this kind of motion; it lets Descartes perform some optimizations
+    // in its graph search, and times the final trajectory (see toROSTrajectory)
+    const int tag = path.tag(j);
+    double speed = speeds.process;
+    if (tag == APPROACH_TAG)
+      speed = speeds.approach;
+    else if (tag == RETRACT_TAG)
+      speed = speeds.retract;
+    else if (tag == TRAVERSE_TAG)
+      speed = speeds.traverse;
+    double dt = (this_pose.translation() - last_pose.translation()).norm() / speed;
+
+    if (dt < 1e-4)
+    {
+      continue;
+    }
+
+    descartes_core::TrajectoryPtPtr pt = conversion_fn(this_pose, dt);
+    if (tag != TRAVERSE_TAG)
+    {
+      pt->setTiming(descartes_core::TimingConstraint(dt, dt));
+    }
+    traj.push_back(pt);
+    last_pose = this_pose;
+  }
 
   return traj;
 }
@@ -4,6 +4,7 @@
 #include "common_utils.h"
 #include <godel_msgs/BlendingPlanParameters.h>
 #include "eigen_conversions/eigen_msg.h"
+#include <godel_utils/path_buffer.h>
 
 
 namespace godel_process_planning
@@ -11,8 +12,8 @@ namespace godel_process_planning
 
 struct ConnectingPath
 {
-  EigenSTL::vector_Affine3d depart;
-  EigenSTL::vector_Affine3d approach;
+  godel_utils::PathBuffer depart;
+  godel_utils::PathBuffer approach;
 };
 
 struct TransitionParameters
@@ -24,6 +25,30 @@ struct TransitionParameters
   double z_adjust;
 };
 
+/**@brief Tags of the poses toDescartesTraj assembles (see godel_utils::PathBuffer) */
+enum PathTag
+{
+  PROCESS_TAG = 0,
+  APPROACH_TAG,
+  RETRACT_TAG,
+  TRAVERSE_TAG
+};
+
+/**
+ * Tool speeds (m/s) along each kind of motion. Approach and retract are the legs between the
+ * surface and the retract distance; the rise to the traverse height is part of the traverse.
+ * Approach, process and retract motions are timed to keep their speed; traverses only use theirs
+ * to space the planning graph, and are then timed as fast as the joint limits allow.
+ */
+struct ProcessSpeeds
+{
+  explicit ProcessSpeeds(double speed) : approach(speed), process(speed), retract(speed), traverse(speed){};
+  double approach;
+  double process;
+  double retract;
+  double traverse;
+};
+
 std::vector<ConnectingPath> generateTransitions(const std::vector<geometry_msgs::PoseArray>& segments,
                                                 const TransitionParameters& params);
 
@@ -34,7 +59,9 @@ std::vector<ConnectingPath> generateTransitions(const std::vector<geometry_msgs:
  * @param segments Sequence of poses (relative to the world space of blending robot model)
  * @param traverse_height The height in meters from the surface of the part to move to before
  *        moving to the next segment start
- * @param process_speed The point to point difference in speed
+ * @param speeds Tool speeds of the approach, process, retract and traverse motions; each point is
+ *        timed by the speed of the motion it ends. Points of all but traverses get that time as
+ *        their least duration (TimingConstraint::lower).
  * @param linear_discretization The distance (meters) between points in the connecting paths
  * @param conversion_fn A function that creates a Descartes process point of whatever type your
  *        process (e.g. blending or scanning) requires
@@ -42,7 +69,7 @@ std::vector<ConnectingPath> generateTransitions(const std::vector<geometry_msgs:
  */
 godel_process_planning::DescartesTraj
 toDescartesTraj(const std::vector<geometry_msgs::PoseArray>& segments,
-                const double process_speed, const TransitionParameters& transition_params,
+                const ProcessSpeeds& speeds, const TransitionParameters& transition_params,
                 boost::function<descartes_core::TrajectoryPtPtr(const Eigen::Affine3d&, const double)> conversion_fn);
 
 
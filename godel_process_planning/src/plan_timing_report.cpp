@@ -0,0 +1,162 @@
+/*
+ * Retimes the process plans recorded in a trajectory library bag (see
+ * godel_surface_detection::TrajectoryLibrary) the way the planner now times new plans, and reports
+ * how much shorter each plan and the whole cycle would be.
+ *
+ * Approach and depart motions are retimed as fast as the joint limits allow. The process motion
+ * keeps at least its recorded time between points, as that is what its commanded speed gave; only
+ * its speed ups and slow downs are retimed.
+ *
+ * Usage: rosrun godel_process_planning plan_timing_report <bag file>
+ * (with the robot_description of the recorded robot loaded)
+ */
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <godel_msgs/ProcessPlan.h>
+#include <godel_process_planning/time_parameterization.h>
+
+using godel_process_planning::JointLimits;
+using godel_process_planning::trajectoryDuration;
+
+// Durations between the points of 'traj'; the first entry is unused
+static std::vector<double> pointDurations(const trajectory_msgs::JointTrajectory& traj)
+{
+  std::vector<double> durations(traj.points.size(), 0.0);
+  for (std::size_t i = 1; i < traj.points.size(); ++i)
+  {
+    durations[i] = (traj.points[i].time_from_start - traj.points[i - 1].time_from_start).toSec();
+  }
+  return durations;
+}
+
+static double planDuration(const godel_msgs::ProcessPlan& plan)
+{
+  return trajectoryDuration(plan.trajectory_approach) + trajectoryDuration(plan.trajectory_process) +
+         trajectoryDuration(plan.trajectory_depart);
+}
+
+// Retimes 'plan' in place; false if its joints do not match 'joint_names'
+static bool retime(godel_msgs::ProcessPlan& plan, const std::vector<std::string>& joint_names,
+                   const JointLimits& limits, double start_time)
+{
+  for (const trajectory_msgs::JointTrajectory* traj :
+       {&plan.trajectory_approach, &plan.trajectory_process, &plan.trajectory_depart})
+  {
+    if (!traj->points.empty() && traj->joint_names != joint_names)
+    {
+      return false;
+    }
+  }
+
+  const std::vector<double> process_durations = pointDurations(plan.trajectory_process);
+  return godel_process_planning::timeParameterize(plan.trajectory_approach, limits, std::vector<double>(),
+                                                  start_time) &&
+         godel_process_planning::timeParameterize(plan.trajectory_process, limits, process_durations,
+                                                  start_time) &&
+         godel_process_planning::timeParameterize(plan.trajectory_depart, limits, std::vector<double>(),
+                                                  start_time);
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "plan_timing_report");
+  if (argc < 2)
+  {
+    ROS_ERROR("Usage: %s <trajectory library bag>", argv[0]);
+    return -1;
+  }
+
+  // Same groups and timing parameters as the process planning node
+  ros::NodeHandle pnh("~");
+  std::string blend_group, keyence_group;
+  pnh.param<std::string>("blend_group", blend_group, "manipulator_tcp");
+  pnh.param<std::string>("keyence_group", keyence_group, "manipulator_keyence");
+  godel_process_planning::TimeParameterizationParameters timing_params;
+  pnh.param<double>("joint_velocity_scaling", timing_params.velocity_scaling, timing_params.velocity_scaling);
+  pnh.param<double>("joint_acceleration_scaling", timing_params.acceleration_scaling,
+                    timing_params.acceleration_scaling);
+  pnh.param<double>("default_joint_velocity", timing_params.default_velocity, timing_params.default_velocity);
+  pnh.param<double>("default_joint_acceleration", timing_params.default_acceleration,
+                    timing_params.default_acceleration);
+
+  robot_model_loader::RobotModelLoader robot_model_loader("robot_description");
+  moveit::core::RobotModelConstPtr model = robot_model_loader.getModel();
+  if (!model)
+  {
+    ROS_ERROR("Could not load the robot model");
+    return -1;
+  }
+
+  JointLimits blend_limits, keyence_limits;
+  std::vector<std::string> blend_joints, keyence_joints;
+  try
+  {
+    blend_limits = godel_process_planning::getJointLimits(*model, blend_group, timing_params);
+    keyence_limits = godel_process_planning::getJointLimits(*model, keyence_group, timing_params);
+    blend_joints = model->getJointModelGroup(blend_group)->getActiveJointModelNames();
+    keyence_joints = model->getJointModelGroup(keyence_group)->getActiveJointModelNames();
+  }
+  catch (const std::runtime_error& e)
+  {
+    ROS_ERROR_STREAM(e.what());
+    return -1;
+  }
+
+  rosbag::Bag bag;
+  try
+  {
+    bag.open(argv[1], rosbag::bagmode::Read);
+  }
+  catch (const rosbag::BagException& e)
+  {
+    ROS_ERROR_STREAM("Could not open '" << argv[1] << "': " << e.what());
+    return -1;
+  }
+
+  double total_before = 0.0;
+  double total_after = 0.0;
+  std::size_t skipped = 0;
+  rosbag::View view(bag);
+  for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+  {
+    godel_msgs::ProcessPlanPtr plan = it->instantiate<godel_msgs::ProcessPlan>();
+    if (!plan)
+    {
+      ROS_WARN_STREAM("Skipping '" << it->getTopic() << "': not a process plan");
+      ++skipped;
+      continue;
+    }
+
+    const bool is_blend = plan->type == godel_msgs::ProcessPlan::BLEND_TYPE;
+    const double before = planDuration(*plan);
+    if (!retime(*plan, is_blend ? blend_joints : keyence_joints, is_blend ? blend_limits : keyence_limits,
+                timing_params.start_time))
+    {
+      ROS_WARN_STREAM("Skipping '" << it->getTopic() << "': its joints do not match the "
+                                   << (is_blend ? blend_group : keyence_group) << " group");
+      ++skipped;
+      continue;
+    }
+    const double after = planDuration(*plan);
+
+    ROS_INFO("%s (%s): %.2f s -> %.2f s (approach %.2f s, process %.2f s, depart %.2f s)",
+             it->getTopic().c_str(), is_blend ? "blend" : "scan", before, after,
+             trajectoryDuration(plan->trajectory_approach), trajectoryDuration(plan->trajectory_process),
+             trajectoryDuration(plan->trajectory_depart));
+    total_before += before;
+    total_after += after;
+  }
+
+  if (total_before > 0.0)
+  {
+    ROS_INFO("Cycle time: %.2f s -> %.2f s, %.2f s (%.1f%%) shorter; %lu plans skipped", total_before,
+             total_after, total_before - total_after, 100.0 * (total_before - total_after) / total_before, skipped);
+  }
+  else
+  {
+    ROS_INFO("No plans to report on; %lu skipped", skipped);
+  }
+  return 0;
+}
@@ -0,0 +1,31 @@
+#include "planner_pool.h"
+
+godel_process_planning::PlanningInstance::PlanningInstance(const std::vector<descartes_core::RobotModelPtr>& models)
+    : model(models.front()), graph_builder(models), segment_validator(models)
+{
+}
+
+void godel_process_planning::PlannerPool::add(std::unique_ptr<PlanningInstance> instance)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_.push_back(instance.get());
+  instances_.push_back(std::move(instance));
+}
+
+godel_process_planning::PlanningInstancePtr godel_process_planning::PlannerPool::acquire()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  returned_.wait(lock, [this] { return !free_.empty(); });
+  PlanningInstance* instance = free_.back();
+  free_.pop_back();
+  return PlanningInstancePtr(instance, [this](PlanningInstance* p) { release(p); });
+}
+
+void godel_process_planning::PlannerPool::release(PlanningInstance* instance)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(instance);
+  }
+  returned_.notify_one();
+}
@@ -0,0 +1,65 @@
+#ifndef GODEL_PROCESS_PLANNING_PLANNER_POOL_H
+#define GODEL_PROCESS_PLANNING_PLANNER_POOL_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <descartes_core/robot_model.h>
+#include "parallel_graph_builder.h"
+#include "segment_validator.h"
+
+namespace godel_process_planning
+{
+
+/**
+ * @brief Everything one planning request mutates: a reference robot model (whose collision
+ * checking the handlers toggle) and the graph builder and segment validator over the per-thread
+ * models it belongs to.
+ */
+struct PlanningInstance
+{
+  /**
+   * @param models One robot model per planning thread, initialized identically; the first is the
+   *        reference model
+   */
+  explicit PlanningInstance(const std::vector<descartes_core::RobotModelPtr>& models);
+
+  descartes_core::RobotModelPtr model;
+  ParallelGraphBuilder graph_builder;
+  SegmentValidator segment_validator;
+};
+
+typedef std::shared_ptr<PlanningInstance> PlanningInstancePtr;
+
+/**
+ * @brief A fixed set of planning instances for one planning group, handed out to one request at a
+ * time. Requests beyond the pool size wait for an instance to be returned.
+ */
+class PlannerPool
+{
+public:
+  /**@brief Adds an instance; not safe to call while instances are handed out */
+  void add(std::unique_ptr<PlanningInstance> instance);
+
+  /**
+   * @brief Blocks until an instance is free and hands it out. The instance returns to the pool
+   * when the last copy of the returned pointer is destroyed; the pool must outlive it.
+   */
+  PlanningInstancePtr acquire();
+
+  std::size_t size() const { return instances_.size(); }
+
+private:
+  void release(PlanningInstance* instance);
+
+  std::vector<std::unique_ptr<PlanningInstance> > instances_;
+  std::vector<PlanningInstance*> free_;
+  std::mutex mutex_;
+  std::condition_variable returned_;
+};
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_PLANNER_POOL_H
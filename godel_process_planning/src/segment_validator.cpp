@@ -0,0 +1,103 @@
+#include "segment_validator.h"
+#include "parallel_for.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+godel_process_planning::SegmentValidator::SegmentValidator(const std::vector<descartes_core::RobotModelPtr>& models)
+    : models_(models)
+{
+  if (models_.empty() || !models_.front())
+  {
+    throw std::invalid_argument("SegmentValidator requires at least one robot model");
+  }
+}
+
+bool godel_process_planning::SegmentValidator::validate(const trajectory_msgs::JointTrajectory& traj,
+                                                        double max_step, std::size_t& first_invalid) const
+{
+  if (traj.points.size() < 2)
+  {
+    return true;
+  }
+
+  for (std::size_t t = 1; t < models_.size(); ++t)
+  {
+    models_[t]->setCheckCollisions(models_.front()->getCheckCollisions());
+  }
+
+  const std::size_t no_failure = std::numeric_limits<std::size_t>::max();
+  std::atomic<std::size_t> failure(no_failure);
+  std::vector<std::vector<double> > samples(models_.size());
+
+  parallelFor(models_.size(), traj.points.size() - 1, [&](std::size_t thread_index, std::size_t i)
+  {
+    if (validateSegment(*models_[thread_index], traj.points[i].positions, traj.points[i + 1].positions, max_step,
+                        i, failure, samples[thread_index]))
+    {
+      return true;
+    }
+
+    // Keep the lowest failing index; another thread may have found a later one first
+    std::size_t current = failure.load();
+    while (i < current && !failure.compare_exchange_weak(current, i))
+    {
+    }
+    return false;
+  });
+
+  if (failure == no_failure)
+  {
+    return true;
+  }
+  first_invalid = failure;
+  return false;
+}
+
+bool godel_process_planning::SegmentValidator::validateSegment(const descartes_core::RobotModel& model,
+                                                               const std::vector<double>& start,
+                                                               const std::vector<double>& stop, double max_step,
+                                                               std::size_t index,
+                                                               const std::atomic<std::size_t>& first_invalid,
+                                                               std::vector<double>& sample) const
+{
+  // Same sampling as interpolateJoint(): 'steps' equal steps, no joint moving more than max_step
+  unsigned steps = 0;
+  for (std::size_t j = 0; j < start.size(); ++j)
+  {
+    steps = std::max(steps, static_cast<unsigned>(std::ceil(std::abs(stop[j] - start[j]) / max_step)));
+  }
+
+  // Sample k is visited at the level of its lowest set bit: the midpoint first, then the quarter
+  // points, and so on down to every sample
+  unsigned stride = 1;
+  while (stride < steps)
+  {
+    stride *= 2;
+  }
+
+  sample.resize(start.size());
+  for (; stride >= 1; stride /= 2)
+  {
+    for (unsigned k = stride; k < steps; k += 2 * stride)
+    {
+      if (first_invalid < index)
+      {
+        return true; // An earlier segment already failed
+      }
+
+      const double s = static_cast<double>(k) / steps;
+      for (std::size_t j = 0; j < start.size(); ++j)
+      {
+        sample[j] = start[j] + s * (stop[j] - start[j]);
+      }
+      if (!model.isValid(sample))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,57 @@
+#ifndef GODEL_PROCESS_PLANNING_SEGMENT_VALIDATOR_H
+#define GODEL_PROCESS_PLANNING_SEGMENT_VALIDATOR_H
+
+#include <atomic>
+#include <descartes_core/robot_model.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+namespace godel_process_planning
+{
+
+/**
+ * @brief Checks the motion between consecutive waypoints of a joint trajectory. The waypoints
+ * themselves are assumed valid (the planning graph only contains valid states); the segments
+ * between them are sampled so that no joint moves more than a given step between samples.
+ *
+ * Samples are visited coarse to fine (midpoint first, then quarter points, ...) so a collision
+ * anywhere in a segment is found after few checks, and segments are checked on several threads,
+ * one robot model per thread. Checking stops at the first invalid segment; segments after it are
+ * abandoned.
+ */
+class SegmentValidator
+{
+public:
+  /**
+   * @param models One robot model per thread; all must be initialized identically. The first is
+   *        the reference model whose collision checking setting is mirrored on the others.
+   */
+  explicit SegmentValidator(const std::vector<descartes_core::RobotModelPtr>& models);
+
+  /**
+   * @brief Checks every segment of 'traj'
+   * @param max_step (rad) Largest joint motion between checked samples
+   * @param first_invalid Output; if validation fails, the index i of the first invalid segment
+   *        (from point i to point i + 1). Callers can repair the trajectory around it.
+   * @return True if all segments are valid
+   */
+  bool validate(const trajectory_msgs::JointTrajectory& traj, double max_step, std::size_t& first_invalid) const;
+
+  std::size_t threads() const { return models_.size(); }
+
+private:
+  /**
+   * @brief Checks the interior samples of segment 'index', from 'start' to 'stop', coarse to fine.
+   * Gives up (returning true) once a segment before 'index' is known to be invalid.
+   * @param sample Scratch buffer
+   * @return False if any sample is invalid
+   */
+  bool validateSegment(const descartes_core::RobotModel& model, const std::vector<double>& start,
+                       const std::vector<double>& stop, double max_step, std::size_t index,
+                       const std::atomic<std::size_t>& first_invalid, std::vector<double>& sample) const;
+
+  std::vector<descartes_core::RobotModelPtr> models_;
+};
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_SEGMENT_VALIDATOR_H
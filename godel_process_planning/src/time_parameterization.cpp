@@ -0,0 +1,257 @@
+#include <godel_process_planning/time_parameterization.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <ros/console.h>
+
+namespace
+{
+
+const double MIN_SEGMENT_TIME = 1e-3; // (s) Duration of segments that do not move
+
+// The speed along the path (rad/s, joint space norm) each segment allows: the velocity limit of its
+// fastest moving joint, and its requested duration
+double segmentSpeedLimit(const std::vector<double>& direction, const std::vector<double>& limits, double length,
+                         double min_duration)
+{
+  double speed = std::numeric_limits<double>::max();
+  for (std::size_t j = 0; j < direction.size(); ++j)
+  {
+    if (direction[j] != 0.0)
+    {
+      speed = std::min(speed, limits[j] / std::abs(direction[j]));
+    }
+  }
+  if (min_duration > 0.0 && length > 0.0)
+  {
+    speed = std::min(speed, length / min_duration);
+  }
+  return speed;
+}
+
+// Shortest time to cover 'length' starting at speed 'v0' and ending at 'v1', at most 'v_max' in
+// between, speeding up and slowing down at 'a'
+double segmentTime(double length, double v0, double v1, double v_max, double a)
+{
+  const double peak = std::sqrt((2.0 * a * length + v0 * v0 + v1 * v1) / 2.0);
+  if (peak <= v_max)
+  {
+    return (2.0 * peak - v0 - v1) / a;
+  }
+  const double ramps = (2.0 * v_max * v_max - v0 * v0 - v1 * v1) / (2.0 * a);
+  return (2.0 * v_max - v0 - v1) / a + (length - ramps) / v_max;
+}
+
+} // namespace
+
+godel_process_planning::JointLimits
+godel_process_planning::getJointLimits(const moveit::core::RobotModel& model, const std::string& group_name,
+                                       const TimeParameterizationParameters& params)
+{
+  const moveit::core::JointModelGroup* group = model.getJointModelGroup(group_name);
+  if (!group)
+  {
+    throw std::runtime_error("No planning group named '" + group_name + "' to get the joint limits of");
+  }
+
+  JointLimits limits;
+  for (const moveit::core::JointModel* joint : group->getActiveJointModels())
+  {
+    const moveit::core::VariableBounds& bounds = joint->getVariableBounds().front();
+
+    double velocity = params.default_velocity;
+    if (bounds.velocity_bounded_)
+    {
+      velocity = std::min(std::abs(bounds.min_velocity_), std::abs(bounds.max_velocity_));
+    }
+    double acceleration = params.default_acceleration;
+    if (bounds.acceleration_bounded_)
+    {
+      acceleration = std::min(std::abs(bounds.min_acceleration_), std::abs(bounds.max_acceleration_));
+    }
+
+    if (velocity <= 0.0 || acceleration <= 0.0)
+    {
+      ROS_WARN("Joint '%s' has a zero velocity or acceleration limit; using the defaults (%f rad/s, %f rad/s^2)",
+               joint->getName().c_str(), params.default_velocity, params.default_acceleration);
+      velocity = params.default_velocity;
+      acceleration = params.default_acceleration;
+    }
+    limits.velocity.push_back(velocity * params.velocity_scaling);
+    limits.acceleration.push_back(acceleration * params.acceleration_scaling);
+  }
+  return limits;
+}
+
+bool godel_process_planning::timeParameterize(trajectory_msgs::JointTrajectory& traj, const JointLimits& limits,
+                                              const std::vector<double>& min_durations, double start_time)
+{
+  const std::size_t n = traj.points.size();
+  const std::size_t dof = limits.velocity.size();
+  if (limits.acceleration.size() != dof || (!min_durations.empty() && min_durations.size() != n))
+  {
+    ROS_ERROR("%s: %lu velocity limits, %lu acceleration limits and %lu durations for %lu points", __FUNCTION__,
+              dof, limits.acceleration.size(), min_durations.size(), n);
+    return false;
+  }
+  for (std::size_t j = 0; j < dof; ++j)
+  {
+    if (limits.velocity[j] <= 0.0 || limits.acceleration[j] <= 0.0)
+    {
+      ROS_ERROR("%s: The limits of joint %lu are not positive", __FUNCTION__, j);
+      return false;
+    }
+  }
+  for (const auto& pt : traj.points)
+  {
+    if (pt.positions.size() != dof)
+    {
+      ROS_ERROR("%s: A point has %lu joint positions, but there are limits for %lu joints", __FUNCTION__,
+                pt.positions.size(), dof);
+      return false;
+    }
+  }
+
+  if (n == 0)
+  {
+    return true;
+  }
+
+  // Length and direction (unit vector in joint space) of each segment; entry k is the segment from
+  // point k - 1 to point k. A segment that does not move keeps the direction of the one before it.
+  std::vector<double> length(n, 0.0);
+  std::vector<std::vector<double> > direction(n, std::vector<double>(dof, 0.0));
+  for (std::size_t k = 1; k < n; ++k)
+  {
+    double squared = 0.0;
+    for (std::size_t j = 0; j < dof; ++j)
+    {
+      const double delta = traj.points[k].positions[j] - traj.points[k - 1].positions[j];
+      direction[k][j] = delta;
+      squared += delta * delta;
+    }
+    length[k] = std::sqrt(squared);
+    if (length[k] > 0.0)
+    {
+      for (double& d : direction[k])
+      {
+        d /= length[k];
+      }
+    }
+    else
+    {
+      direction[k] = direction[k - 1];
+    }
+  }
+  // Segments that do not move before the first one that does take its direction
+  std::size_t first_moving = 1;
+  while (first_moving < n && length[first_moving] == 0.0)
+  {
+    ++first_moving;
+  }
+  for (std::size_t k = 1; k < first_moving && first_moving < n; ++k)
+  {
+    direction[k] = direction[first_moving];
+  }
+
+  // Top speed along each segment, and the acceleration along it that keeps every joint in limits
+  std::vector<double> top_speed(n, 0.0);
+  std::vector<double> path_acceleration(n, 0.0);
+  for (std::size_t k = 1; k < n; ++k)
+  {
+    top_speed[k] = segmentSpeedLimit(direction[k], limits.velocity, length[k],
+                                     min_durations.empty() ? 0.0 : min_durations[k]);
+    path_acceleration[k] = segmentSpeedLimit(direction[k], limits.acceleration, 0.0, 0.0);
+  }
+
+  // Speed at each point: at rest at the ends and where the path turns back on itself; in between, no
+  // faster than either segment allows, nor than turning the corner to the next segment's direction
+  // within the acceleration limits
+  std::vector<double> speed(n, 0.0);
+  for (std::size_t k = 1; k + 1 < n; ++k)
+  {
+    double cosine = 0.0;
+    for (std::size_t j = 0; j < dof; ++j)
+    {
+      cosine += direction[k][j] * direction[k + 1][j];
+    }
+    if (cosine <= 0.0)
+    {
+      continue;
+    }
+
+    speed[k] = std::min(top_speed[k], top_speed[k + 1]);
+    const double turn_length = 0.5 * (length[k] + length[k + 1]);
+    for (std::size_t j = 0; j < dof; ++j)
+    {
+      const double turn = std::abs(direction[k + 1][j] - direction[k][j]);
+      if (turn > 0.0)
+      {
+        speed[k] = std::min(speed[k], std::sqrt(limits.acceleration[j] * turn_length / turn));
+      }
+    }
+  }
+
+  // Speeding up is limited going forward, slowing down going backward
+  for (std::size_t k = 1; k < n; ++k)
+  {
+    speed[k] = std::min(speed[k], std::sqrt(speed[k - 1] * speed[k - 1] + 2.0 * path_acceleration[k] * length[k]));
+  }
+  for (std::size_t k = n - 1; k > 0; --k)
+  {
+    speed[k - 1] =
+        std::min(speed[k - 1], std::sqrt(speed[k] * speed[k] + 2.0 * path_acceleration[k] * length[k]));
+  }
+
+  // Times, then the joint velocities at the points along the average of the adjacent segments'
+  // directions, and accelerations from the change in velocity around each point
+  std::vector<double> time(n, start_time);
+  for (std::size_t k = 1; k < n; ++k)
+  {
+    double duration = min_durations.empty() ? 0.0 : min_durations[k];
+    if (length[k] > 0.0)
+    {
+      duration = std::max(duration, segmentTime(length[k], speed[k - 1], speed[k], top_speed[k],
+                                                path_acceleration[k]));
+    }
+    time[k] = time[k - 1] + std::max(duration, MIN_SEGMENT_TIME);
+  }
+
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    trajectory_msgs::JointTrajectoryPoint& pt = traj.points[k];
+    pt.time_from_start = ros::Duration(time[k]);
+    pt.velocities.assign(dof, 0.0);
+    if (k > 0 && k + 1 < n)
+    {
+      for (std::size_t j = 0; j < dof; ++j)
+      {
+        pt.velocities[j] = speed[k] * 0.5 * (direction[k][j] + direction[k + 1][j]);
+      }
+    }
+  }
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    const std::size_t before = k > 0 ? k - 1 : k;
+    const std::size_t after = k + 1 < n ? k + 1 : k;
+    const double dt = time[after] - time[before];
+    std::vector<double>& acceleration = traj.points[k].accelerations;
+    acceleration.assign(dof, 0.0);
+    for (std::size_t j = 0; j < dof && dt > 0.0; ++j)
+    {
+      acceleration[j] = (traj.points[after].velocities[j] - traj.points[before].velocities[j]) / dt;
+    }
+  }
+  return true;
+}
+
+double godel_process_planning::trajectoryDuration(const trajectory_msgs::JointTrajectory& traj)
+{
+  if (traj.points.empty())
+  {
+    return 0.0;
+  }
+  return (traj.points.back().time_from_start - traj.points.front().time_from_start).toSec();
+}
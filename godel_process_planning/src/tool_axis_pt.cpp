@@ -0,0 +1,166 @@
+#include "tool_axis_pt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+double squaredDistance(const std::vector<double>& a, const std::vector<double>& b)
+{
+  double d = 0.0;
+  for (std::size_t i = 0; i < a.size() && i < b.size(); ++i)
+  {
+    d += (a[i] - b[i]) * (a[i] - b[i]);
+  }
+  return d;
+}
+
+} // namespace
+
+godel_process_planning::ToolAxisPt::ToolAxisPt(const Eigen::Affine3d& nominal, double step,
+                                               const descartes_core::TimingConstraint& timing)
+    : descartes_core::TrajectoryPt(timing), nominal_(nominal)
+{
+  sampleCircle(step);
+}
+
+void godel_process_planning::ToolAxisPt::sampleCircle(double step)
+{
+  angles_.clear();
+  const int n = std::max(1, static_cast<int>(std::round(2.0 * M_PI / step)));
+  for (int i = 0; i < n; ++i)
+  {
+    angles_.push_back(2.0 * M_PI * i / n);
+  }
+}
+
+void godel_process_planning::ToolAxisPt::sampleWindow(double center, double half_width, double step)
+{
+  if (2.0 * half_width + step >= 2.0 * M_PI)
+  {
+    sampleCircle(step);
+    return;
+  }
+
+  angles_.clear();
+  const int n = static_cast<int>(std::floor(half_width / step + 1e-9));
+  for (int i = -n; i <= n; ++i)
+  {
+    angles_.push_back(center + i * step);
+  }
+}
+
+double godel_process_planning::ToolAxisPt::angleOf(const Eigen::Affine3d& pose) const
+{
+  const Eigen::Matrix3d relative = nominal_.linear().transpose() * pose.linear();
+  return std::atan2(relative(1, 0), relative(0, 0));
+}
+
+Eigen::Affine3d godel_process_planning::ToolAxisPt::sample(double angle) const
+{
+  return nominal_ * Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ());
+}
+
+bool godel_process_planning::ToolAxisPt::getClosestCartPose(const std::vector<double>& seed_state,
+                                                            const descartes_core::RobotModel& model,
+                                                            Eigen::Affine3d& pose) const
+{
+  Eigen::Affine3d seed_pose;
+  if (!model.getFK(seed_state, seed_pose))
+  {
+    return false;
+  }
+  pose = sample(angleOf(seed_pose));
+  return true;
+}
+
+bool godel_process_planning::ToolAxisPt::getNominalCartPose(const std::vector<double>&,
+                                                            const descartes_core::RobotModel&,
+                                                            Eigen::Affine3d& pose) const
+{
+  pose = nominal_;
+  return true;
+}
+
+void godel_process_planning::ToolAxisPt::getCartesianPoses(
+    const descartes_core::RobotModel&,
+    std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> >& poses) const
+{
+  poses.clear();
+  for (double angle : angles_)
+  {
+    poses.push_back(sample(angle));
+  }
+}
+
+bool godel_process_planning::ToolAxisPt::getClosestJointPose(const std::vector<double>& seed_state,
+                                                             const descartes_core::RobotModel& model,
+                                                             std::vector<double>& joint_pose) const
+{
+  std::vector<std::vector<double> > solutions;
+  getJointPoses(model, solutions);
+
+  double best = std::numeric_limits<double>::max();
+  for (const auto& solution : solutions)
+  {
+    const double d = squaredDistance(seed_state, solution);
+    if (d < best)
+    {
+      best = d;
+      joint_pose = solution;
+    }
+  }
+  return !solutions.empty();
+}
+
+bool godel_process_planning::ToolAxisPt::getNominalJointPose(const std::vector<double>& seed_state,
+                                                             const descartes_core::RobotModel& model,
+                                                             std::vector<double>& joint_pose) const
+{
+  return model.getIK(nominal_, seed_state, joint_pose);
+}
+
+void godel_process_planning::ToolAxisPt::getJointPoses(const descartes_core::RobotModel& model,
+                                                       std::vector<std::vector<double> >& joint_poses) const
+{
+  joint_poses.clear();
+  std::vector<std::vector<double> > solutions;
+  for (double angle : angles_)
+  {
+    if (model.getAllIK(sample(angle), solutions))
+    {
+      joint_poses.insert(joint_poses.end(), solutions.begin(), solutions.end());
+    }
+  }
+}
+
+bool godel_process_planning::ToolAxisPt::isValid(const descartes_core::RobotModel& model) const
+{
+  std::vector<std::vector<double> > solutions;
+  for (double angle : angles_)
+  {
+    if (model.getAllIK(sample(angle), solutions))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool godel_process_planning::ToolAxisPt::setDiscretization(const std::vector<double>& discretization)
+{
+  if (discretization.size() != 1 || discretization[0] <= 0.0)
+  {
+    return false;
+  }
+  sampleCircle(discretization[0]);
+  return true;
+}
+
+descartes_core::TrajectoryPtPtr godel_process_planning::ToolAxisPt::copy() const
+{
+  // Not make_shared: the pose member needs the class's aligned operator new
+  return descartes_core::TrajectoryPtPtr(new ToolAxisPt(*this));
+}
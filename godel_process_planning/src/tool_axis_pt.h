@@ -0,0 +1,76 @@
+#ifndef GODEL_PROCESS_PLANNING_TOOL_AXIS_PT_H
+#define GODEL_PROCESS_PLANNING_TOOL_AXIS_PT_H
+
+#include <descartes_core/trajectory_pt.h>
+#include <Eigen/Geometry>
+
+namespace godel_process_planning
+{
+
+/**
+ * @brief A Cartesian process point whose tool z axis is fixed and whose rotation about that axis
+ * is free. Like descartes_trajectory::AxialSymmetricPt, except that the rotations sampled are an
+ * explicit list of angles (relative to the nominal pose) that can be changed after construction,
+ * e.g. to search coarsely first and then only near the rotation a coarse solution picked.
+ */
+class ToolAxisPt : public descartes_core::TrajectoryPt
+{
+public:
+  /**
+   * @brief Samples the full circle about the tool z axis
+   * @param nominal Nominal tool pose
+   * @param step (rad) Angle between samples
+   */
+  ToolAxisPt(const Eigen::Affine3d& nominal, double step,
+             const descartes_core::TimingConstraint& timing = descartes_core::TimingConstraint());
+
+  /**@brief Samples the full circle about the tool z axis every 'step' radians */
+  void sampleCircle(double step);
+
+  /**@brief Samples [center - half_width, center + half_width] every 'step' radians */
+  void sampleWindow(double center, double half_width, double step);
+
+  const std::vector<double>& angles() const { return angles_; }
+
+  /**@brief The rotation about the tool z axis of 'pose' relative to the nominal pose, in (-pi, pi] */
+  double angleOf(const Eigen::Affine3d& pose) const;
+
+  const Eigen::Affine3d& nominal() const { return nominal_; }
+
+  virtual bool getClosestCartPose(const std::vector<double>& seed_state, const descartes_core::RobotModel& model,
+                                  Eigen::Affine3d& pose) const;
+
+  virtual bool getNominalCartPose(const std::vector<double>& seed_state, const descartes_core::RobotModel& model,
+                                  Eigen::Affine3d& pose) const;
+
+  virtual void getCartesianPoses(const descartes_core::RobotModel& model,
+                                 std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> >& poses) const;
+
+  virtual bool getClosestJointPose(const std::vector<double>& seed_state, const descartes_core::RobotModel& model,
+                                   std::vector<double>& joint_pose) const;
+
+  virtual bool getNominalJointPose(const std::vector<double>& seed_state, const descartes_core::RobotModel& model,
+                                   std::vector<double>& joint_pose) const;
+
+  virtual void getJointPoses(const descartes_core::RobotModel& model,
+                             std::vector<std::vector<double> >& joint_poses) const;
+
+  virtual bool isValid(const descartes_core::RobotModel& model) const;
+
+  /**@brief Takes a single value: the angle between samples of the full circle */
+  virtual bool setDiscretization(const std::vector<double>& discretization);
+
+  virtual descartes_core::TrajectoryPtPtr copy() const;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  Eigen::Affine3d sample(double angle) const;
+
+  Eigen::Affine3d nominal_;
+  std::vector<double> angles_;
+};
+
+} // namespace godel_process_planning
+
+#endif // GODEL_PROCESS_PLANNING_TOOL_AXIS_PT_H
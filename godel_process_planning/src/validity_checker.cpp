@@ -0,0 +1,286 @@
+#include <godel_process_planning/validity_checker.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <boost/functional/hash.hpp>
+
+// Joint states exactly at a limit are valid
+const static double JOINT_LIMIT_MARGIN = 1e-7;
+
+static const godel_process_planning::ValidityCheckerPtr&
+requireChecker(const godel_process_planning::ValidityCheckerPtr& checker)
+{
+  if (!checker)
+  {
+    throw std::invalid_argument("ValidityCheckedRobotModel requires a checker");
+  }
+  return checker;
+}
+
+std::ostream& godel_process_planning::operator<<(std::ostream& os, const ValidityStats& stats)
+{
+  return os << stats.checks << " checks (" << stats.cache_hits << " memoized), rejected " << stats.limit_rejections
+            << " by joint limits, " << stats.group_collision_rejections << " by group collisions, "
+            << stats.environment_collision_rejections << " by environment collisions";
+}
+
+godel_process_planning::ValidityStats godel_process_planning::operator-(const ValidityStats& after,
+                                                                        const ValidityStats& before)
+{
+  ValidityStats diff;
+  diff.checks = after.checks - before.checks;
+  diff.cache_hits = after.cache_hits - before.cache_hits;
+  diff.limit_rejections = after.limit_rejections - before.limit_rejections;
+  diff.group_collision_rejections = after.group_collision_rejections - before.group_collision_rejections;
+  diff.environment_collision_rejections =
+      after.environment_collision_rejections - before.environment_collision_rejections;
+  return diff;
+}
+
+godel_process_planning::ValidityChecker::ValidityChecker(const moveit::core::RobotModelConstPtr& model,
+                                                         const std::string& group_name,
+                                                         const ValidityCheckerParameters& params)
+    : params_(params), checks_(0), cache_hits_(0), limit_rejections_(0), group_collision_rejections_(0),
+      environment_collision_rejections_(0)
+{
+  if (!model)
+  {
+    throw std::invalid_argument("ValidityChecker requires a robot model");
+  }
+  if (!(params_.joint_resolution > 0.0))
+  {
+    throw std::invalid_argument("Validity cache joint resolution must be positive");
+  }
+
+  group_ = model->getJointModelGroup(group_name);
+  if (!group_)
+  {
+    throw std::invalid_argument("Unknown planning group: " + group_name);
+  }
+
+  scene_.reset(new planning_scene::PlanningScene(model));
+
+  // Split the scene's allowed collision matrix in two: the first stage only looks at pairs of
+  // group links, the second at everything else
+  const std::vector<std::string>& group_links = group_->getLinkModelNamesWithCollisionGeometry();
+  const std::vector<std::string>& all_links = model->getLinkModelNamesWithCollisionGeometry();
+  std::vector<std::string> other_links;
+  for (const auto& link : all_links)
+  {
+    if (std::find(group_links.begin(), group_links.end(), link) == group_links.end())
+    {
+      other_links.push_back(link);
+    }
+  }
+
+  group_acm_ = scene_->getAllowedCollisionMatrix();
+  for (const auto& link : other_links)
+  {
+    group_acm_.setEntry(link, all_links, true);
+  }
+
+  environment_acm_ = scene_->getAllowedCollisionMatrix();
+  for (const auto& link : group_links)
+  {
+    environment_acm_.setEntry(link, group_links, true);
+  }
+}
+
+moveit::core::RobotState godel_process_planning::ValidityChecker::makeState() const
+{
+  moveit::core::RobotState state(scene_->getRobotModel());
+  state.setToDefaultValues();
+  return state;
+}
+
+bool godel_process_planning::ValidityChecker::isValid(moveit::core::RobotState& state,
+                                                      const std::vector<double>& joints, bool check_collisions)
+{
+  ++checks_;
+  if (joints.size() != group_->getVariableCount() ||
+      !group_->satisfiesPositionBounds(joints.data(), JOINT_LIMIT_MARGIN))
+  {
+    ++limit_rejections_;
+    return false;
+  }
+
+  return !check_collisions || isCollisionFree(state, joints);
+}
+
+bool godel_process_planning::ValidityChecker::isCollisionFree(moveit::core::RobotState& state,
+                                                              const std::vector<double>& joints)
+{
+  Key key(joints.size());
+  for (std::size_t i = 0; i < joints.size(); ++i)
+  {
+    key[i] = std::llround(joints[i] / params_.joint_resolution);
+  }
+
+  if (params_.cache_capacity > 0)
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end())
+    {
+      ++cache_hits_;
+      return it->second;
+    }
+  }
+
+  state.setJointGroupPositions(group_, joints);
+  state.update();
+
+  collision_detection::CollisionRequest request;
+  collision_detection::CollisionResult result;
+  scene_->checkSelfCollision(request, result, state, group_acm_);
+  bool collision_free = !result.collision;
+  if (!collision_free)
+  {
+    ++group_collision_rejections_;
+  }
+  else
+  {
+    result.clear();
+    scene_->checkCollision(request, result, state, environment_acm_);
+    collision_free = !result.collision;
+    if (!collision_free)
+    {
+      ++environment_collision_rejections_;
+    }
+  }
+
+  if (params_.cache_capacity > 0)
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    // Results are cheap to recompute; start over rather than track recency
+    if (cache_.size() >= params_.cache_capacity)
+    {
+      cache_.clear();
+    }
+    cache_[key] = collision_free;
+  }
+  return collision_free;
+}
+
+std::size_t godel_process_planning::ValidityChecker::KeyHash::operator()(const Key& key) const
+{
+  return boost::hash_range(key.begin(), key.end());
+}
+
+void godel_process_planning::ValidityChecker::clearCache()
+{
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  cache_.clear();
+}
+
+godel_process_planning::ValidityStats godel_process_planning::ValidityChecker::stats() const
+{
+  ValidityStats stats;
+  stats.checks = checks_;
+  stats.cache_hits = cache_hits_;
+  stats.limit_rejections = limit_rejections_;
+  stats.group_collision_rejections = group_collision_rejections_;
+  stats.environment_collision_rejections = environment_collision_rejections_;
+  return stats;
+}
+
+void godel_process_planning::ValidityChecker::resetStats()
+{
+  checks_ = 0;
+  cache_hits_ = 0;
+  limit_rejections_ = 0;
+  group_collision_rejections_ = 0;
+  environment_collision_rejections_ = 0;
+}
+
+godel_process_planning::ValidityCheckedRobotModel::ValidityCheckedRobotModel(descartes_core::RobotModelPtr model,
+                                                                             ValidityCheckerPtr checker)
+    : RobotModelDecorator(model), checker_(requireChecker(checker)), state_(checker_->makeState())
+{
+  // The wrapped model keeps checking joint limits in its IK; collisions are checked here
+  model_->setCheckCollisions(false);
+}
+
+bool godel_process_planning::ValidityCheckedRobotModel::getAllIK(
+    const Eigen::Affine3d& pose, std::vector<std::vector<double> >& joint_poses) const
+{
+  model_->getAllIK(pose, joint_poses);
+
+  auto last = std::remove_if(joint_poses.begin(), joint_poses.end(), [this](const std::vector<double>& joints)
+                             {
+                               return !checker_->isValid(state_, joints, check_collisions_);
+                             });
+  joint_poses.erase(last, joint_poses.end());
+  return !joint_poses.empty();
+}
+
+bool godel_process_planning::ValidityCheckedRobotModel::getAllIKBatch(const Eigen::Affine3d* poses,
+                                                                      std::size_t n_poses,
+                                                                      std::vector<double>& joints,
+                                                                      std::vector<std::size_t>& offsets) const
+{
+  const godel_utils::BatchIkSolver* batch = dynamic_cast<const godel_utils::BatchIkSolver*>(model_.get());
+  if (!batch)
+  {
+    // Assemble the flat buffers from per-pose solves
+    joints.clear();
+    offsets.assign(1, 0);
+    bool all_solved = true;
+    std::vector<std::vector<double> > solutions;
+    for (std::size_t i = 0; i < n_poses; ++i)
+    {
+      all_solved &= getAllIK(poses[i], solutions);
+      for (const auto& sol : solutions)
+      {
+        joints.insert(joints.end(), sol.begin(), sol.end());
+      }
+      offsets.push_back(joints.size() / getDOF());
+    }
+    return all_solved;
+  }
+
+  batch->getAllIKBatch(poses, n_poses, joints, offsets);
+
+  // Compact the surviving solutions in place
+  const std::size_t dof = static_cast<std::size_t>(getDOF());
+  std::vector<double> sol(dof);
+  std::size_t kept = 0;
+  bool all_solved = true;
+  for (std::size_t i = 0; i < n_poses; ++i)
+  {
+    const std::size_t pose_first = kept;
+    for (std::size_t s = offsets[i]; s < offsets[i + 1]; ++s)
+    {
+      sol.assign(joints.begin() + s * dof, joints.begin() + (s + 1) * dof);
+      if (checker_->isValid(state_, sol, check_collisions_))
+      {
+        std::copy(sol.begin(), sol.end(), joints.begin() + kept * dof);
+        ++kept;
+      }
+    }
+    offsets[i] = pose_first;
+    all_solved &= kept > pose_first;
+  }
+  offsets[n_poses] = kept;
+  joints.resize(kept * dof);
+  return all_solved;
+}
+
+bool godel_process_planning::ValidityCheckedRobotModel::getIK(const Eigen::Affine3d& pose,
+                                                              const std::vector<double>& seed_state,
+                                                              std::vector<double>& joint_pose) const
+{
+  return model_->getIK(pose, seed_state, joint_pose) && checker_->isValid(state_, joint_pose, check_collisions_);
+}
+
+bool godel_process_planning::ValidityCheckedRobotModel::isValid(const std::vector<double>& joint_pose) const
+{
+  return checker_->isValid(state_, joint_pose, check_collisions_);
+}
+
+bool godel_process_planning::ValidityCheckedRobotModel::isValid(const Eigen::Affine3d& pose) const
+{
+  std::vector<std::vector<double> > joint_poses;
+  return getAllIK(pose, joint_poses);
+}
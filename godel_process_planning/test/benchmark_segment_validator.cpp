@@ -0,0 +1,52 @@
+/*
+ * benchmark_segment_validator.cpp
+ *
+ * Timings against the discrete sampling it replaced; built with the tests but not run with them:
+ *   rosrun godel_process_planning godel_process_planning-segment-validator-benchmark
+ */
+
+#include <gtest/gtest.h>
+#include <iostream>
+#include "segment_validator_test_utils.h"
+
+using godel_process_planning::SegmentValidator;
+
+static double seconds(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(SegmentValidatorBenchmark, againstDiscreteSampling)
+{
+  // 400 segments of 0.5 rad sampled every 0.01 rad; a small obstacle in the middle of segment 300
+  const auto traj = makeDiagonal(401, 0.5);
+  const double lower = 150.24, upper = 150.26;
+  const int check_cost_us = 20;
+
+  auto reference_models = makeModels(1, lower, upper, check_cost_us);
+  std::size_t reference_index = 0;
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  EXPECT_FALSE(validateReference(traj, *reference_models.front(), 0.01, reference_index));
+  const double reference_time = seconds(t0);
+  EXPECT_EQ(300u, reference_index);
+  std::cout << "Discrete sampling: " << reference_time << " s, " << totalChecks(reference_models) << " checks\n";
+
+  for (std::size_t threads : {1, 4})
+  {
+    auto models = makeModels(threads, lower, upper, check_cost_us);
+    SegmentValidator validator(models);
+    std::size_t index = 0;
+    t0 = std::chrono::steady_clock::now();
+    EXPECT_FALSE(validator.validate(traj, 0.01, index));
+    const double time = seconds(t0);
+    EXPECT_EQ(300u, index);
+    std::cout << "SegmentValidator, " << threads << " threads: " << time << " s, " << totalChecks(models)
+              << " checks\n";
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,113 @@
+/*
+ * segment_validator_test_utils.h
+ *
+ * Robot model and trajectories shared by the segment validator tests and benchmark
+ */
+
+#ifndef GODEL_PROCESS_PLANNING_SEGMENT_VALIDATOR_TEST_UTILS_H
+#define GODEL_PROCESS_PLANNING_SEGMENT_VALIDATOR_TEST_UTILS_H
+
+#include <atomic>
+#include <chrono>
+#include "segment_validator.h"
+#include "trajectory_utils.h"
+
+/* Two joint model whose only invalid states form a box in joint space. Every check burns a few
+ * microseconds to stand in for a collision check. */
+class BoxObstacleModel : public descartes_core::RobotModel
+{
+public:
+  BoxObstacleModel(double lower, double upper, int check_cost_us = 0)
+      : lower_(lower), upper_(upper), check_cost_us_(check_cost_us), checks(0)
+  {
+  }
+
+  virtual bool isValid(const std::vector<double>& joint_pose) const
+  {
+    ++checks;
+    if (check_cost_us_ > 0)
+    {
+      const auto stop = std::chrono::steady_clock::now() + std::chrono::microseconds(check_cost_us_);
+      while (std::chrono::steady_clock::now() < stop)
+      {
+      }
+    }
+    return !(joint_pose[0] > lower_ && joint_pose[0] < upper_ && joint_pose[1] > lower_ && joint_pose[1] < upper_);
+  }
+
+  virtual bool getIK(const Eigen::Affine3d&, const std::vector<double>&, std::vector<double>&) const { return false; }
+  virtual bool getAllIK(const Eigen::Affine3d&, std::vector<std::vector<double> >&) const { return false; }
+  virtual bool getFK(const std::vector<double>&, Eigen::Affine3d&) const { return false; }
+  virtual int getDOF() const { return 2; }
+  virtual bool isValid(const Eigen::Affine3d&) const { return false; }
+  virtual bool initialize(const std::string&, const std::string&, const std::string&, const std::string&)
+  {
+    return true;
+  }
+  virtual bool isValidMove(const double*, const double*, double) const { return true; }
+  virtual std::vector<double> getJointVelocityLimits() const { return std::vector<double>(2, 1.0); }
+
+private:
+  double lower_;
+  double upper_;
+  int check_cost_us_;
+
+public:
+  mutable std::atomic<std::size_t> checks;
+};
+
+inline std::vector<descartes_core::RobotModelPtr> makeModels(std::size_t n, double lower, double upper,
+                                                             int check_cost_us = 0)
+{
+  std::vector<descartes_core::RobotModelPtr> models;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    models.push_back(descartes_core::RobotModelPtr(new BoxObstacleModel(lower, upper, check_cost_us)));
+  }
+  return models;
+}
+
+inline std::size_t totalChecks(const std::vector<descartes_core::RobotModelPtr>& models)
+{
+  std::size_t checks = 0;
+  for (const auto& model : models)
+  {
+    checks += static_cast<const BoxObstacleModel&>(*model).checks;
+  }
+  return checks;
+}
+
+/* Trajectory along the diagonal: point i is at (i, i) * spacing */
+inline trajectory_msgs::JointTrajectory makeDiagonal(std::size_t n_points, double spacing)
+{
+  trajectory_msgs::JointTrajectory traj;
+  for (std::size_t i = 0; i < n_points; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint pt;
+    pt.positions.assign(2, spacing * i);
+    traj.points.push_back(pt);
+  }
+  return traj;
+}
+
+/* Reference implementation: the discrete sampling generateMotionPlan used before SegmentValidator */
+inline bool validateReference(const trajectory_msgs::JointTrajectory& pts, const descartes_core::RobotModel& model,
+                              double min_segment_size, std::size_t& first_invalid)
+{
+  for (std::size_t i = 1; i < pts.points.size(); ++i)
+  {
+    auto interpolate =
+        godel_process_planning::interpolateJoint(pts.points[i - 1].positions, pts.points[i].positions, min_segment_size);
+    for (std::size_t j = 1; j + 1 < interpolate.size(); ++j)
+    {
+      if (!model.isValid(interpolate[j]))
+      {
+        first_invalid = i - 1;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * test_free_space_planner.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <godel_process_planning/free_space_planner.h>
+
+using godel_process_planning::FreeMoveCache;
+
+// A two joint motion from (start, 0) to (goal, 0) through (mid, 1), one second per segment
+static trajectory_msgs::JointTrajectory makeMotion(double start, double mid, double goal)
+{
+  trajectory_msgs::JointTrajectory traj;
+  const double positions[] = {start, mid, goal};
+  const double offsets[] = {0.0, 1.0, 0.0};
+  for (int i = 0; i < 3; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint pt;
+    pt.positions = {positions[i], offsets[i]};
+    pt.velocities = {0.0, i == 1 ? 0.5 : 0.0};
+    pt.time_from_start = ros::Duration(static_cast<double>(i));
+    traj.points.push_back(pt);
+  }
+  return traj;
+}
+
+TEST(FreeSpacePlanner, reverseTrajectory)
+{
+  trajectory_msgs::JointTrajectory traj = makeMotion(0.0, 1.0, 3.0);
+  traj.points[2].time_from_start = ros::Duration(3.0);
+
+  trajectory_msgs::JointTrajectory reversed = godel_process_planning::reverseTrajectory(traj);
+  ASSERT_EQ(3u, reversed.points.size());
+  EXPECT_EQ(3.0, reversed.points[0].positions[0]);
+  EXPECT_EQ(0.0, reversed.points[2].positions[0]);
+  EXPECT_DOUBLE_EQ(0.0, reversed.points[0].time_from_start.toSec());
+  EXPECT_DOUBLE_EQ(2.0, reversed.points[1].time_from_start.toSec());
+  EXPECT_DOUBLE_EQ(3.0, reversed.points[2].time_from_start.toSec());
+  EXPECT_EQ(-0.5, reversed.points[1].velocities[1]);
+}
+
+TEST(FreeSpacePlanner, jointPathLength)
+{
+  // (0,0) -> (0,1) -> (0,0)
+  EXPECT_DOUBLE_EQ(2.0, godel_process_planning::jointPathLength(makeMotion(0.0, 0.0, 0.0)));
+  EXPECT_DOUBLE_EQ(0.0, godel_process_planning::jointPathLength(trajectory_msgs::JointTrajectory()));
+}
+
+TEST(FreeSpacePlanner, defaultPlannersHaveShortBudgets)
+{
+  // Planners are tried one after another, so together they bound how long a motion can stall planning
+  godel_process_planning::FreeSpacePlannerParameters params;
+  ASSERT_FALSE(params.planners.empty());
+  double total = 0.0;
+  for (const auto& config : params.planners)
+  {
+    EXPECT_GT(config.planning_time, 0.0);
+    total += config.planning_time;
+  }
+  EXPECT_LE(total, 5.0);
+}
+
+TEST(FreeSpacePlanner, requiresAPlanner)
+{
+  godel_process_planning::FreeSpacePlannerParameters params;
+  params.planners.clear();
+  EXPECT_THROW(godel_process_planning::FreeSpacePlanner(moveit::core::RobotModelConstPtr(), "manipulator", params),
+               std::runtime_error);
+}
+
+TEST(FreeMoveCache, findsBothDirections)
+{
+  FreeMoveCache cache(4, 1e-3);
+  cache.insert(makeMotion(0.0, 1.0, 2.0));
+
+  const std::vector<double> home = {0.0, 0.0};
+  const std::vector<double> approach = {2.0, 0.0};
+  trajectory_msgs::JointTrajectory traj;
+  ASSERT_TRUE(cache.find(home, approach, traj));
+  EXPECT_EQ(1.0, traj.points[1].positions[0]);
+  EXPECT_EQ(approach, traj.points.back().positions);
+
+  ASSERT_TRUE(cache.find(approach, home, traj));
+  EXPECT_EQ(approach, traj.points.front().positions);
+  EXPECT_EQ(home, traj.points.back().positions);
+  EXPECT_DOUBLE_EQ(2.0, traj.points.back().time_from_start.toSec());
+}
+
+TEST(FreeMoveCache, matchesWithinTolerance)
+{
+  FreeMoveCache cache(4, 1e-3);
+  cache.insert(makeMotion(0.0, 1.0, 2.0));
+
+  // Snapped to the requested configurations
+  const std::vector<double> home = {0.0005, -0.0005};
+  trajectory_msgs::JointTrajectory traj;
+  ASSERT_TRUE(cache.find(home, {2.0, 0.0}, traj));
+  EXPECT_EQ(home, traj.points.front().positions);
+
+  EXPECT_FALSE(cache.find({0.002, 0.0}, {2.0, 0.0}, traj));
+  EXPECT_FALSE(cache.find({0.0, 0.0}, {2.0, 0.0, 0.0}, traj));
+}
+
+TEST(FreeMoveCache, evictsLeastRecentlyUsed)
+{
+  FreeMoveCache cache(2, 1e-3);
+  cache.insert(makeMotion(0.0, 1.0, 1.0));
+  cache.insert(makeMotion(0.0, 1.0, 2.0));
+
+  trajectory_msgs::JointTrajectory traj;
+  ASSERT_TRUE(cache.find({0.0, 0.0}, {1.0, 0.0}, traj));
+  cache.insert(makeMotion(0.0, 1.0, 3.0));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(cache.find({0.0, 0.0}, {1.0, 0.0}, traj));
+  EXPECT_FALSE(cache.find({0.0, 0.0}, {2.0, 0.0}, traj));
+  EXPECT_TRUE(cache.find({0.0, 0.0}, {3.0, 0.0}, traj));
+
+  // Replanning the same motion replaces it
+  cache.insert(makeMotion(0.0, 0.5, 3.0));
+  EXPECT_EQ(2u, cache.size());
+  ASSERT_TRUE(cache.find({3.0, 0.0}, {0.0, 0.0}, traj));
+  EXPECT_EQ(0.5, traj.points[1].positions[0]);
+
+  cache.erase({0.0, 0.0}, {3.0, 0.0});
+  EXPECT_FALSE(cache.find({0.0, 0.0}, {3.0, 0.0}, traj));
+  EXPECT_EQ(1u, cache.size());
+}
+
+TEST(FreeMoveCache, zeroCapacityDisables)
+{
+  FreeMoveCache cache(0, 1e-3);
+  cache.insert(makeMotion(0.0, 1.0, 2.0));
+  trajectory_msgs::JointTrajectory traj;
+  EXPECT_FALSE(cache.find({0.0, 0.0}, {2.0, 0.0}, traj));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
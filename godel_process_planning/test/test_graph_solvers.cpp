@@ -0,0 +1,511 @@
+/*
+ * test_graph_solvers.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <boost/make_shared.hpp>
+#include "graph_solvers.h"
+#include "tool_axis_pt.h"
+
+using namespace godel_process_planning;
+
+typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > PoseVector;
+
+/* Planar two link arm in the xy plane; the tool z axis is always the world z axis */
+class PlanarArmModel : public descartes_core::RobotModel
+{
+public:
+  PlanarArmModel() : ik_calls(0) {}
+
+  virtual bool getAllIK(const Eigen::Affine3d& pose, std::vector<std::vector<double> >& joint_poses) const
+  {
+    ++ik_calls;
+    joint_poses.clear();
+    const double x = pose.translation().x(), y = pose.translation().y();
+    const double c2 = (x * x + y * y - L1 * L1 - L2 * L2) / (2 * L1 * L2);
+    if (std::abs(c2) > 1.0)
+    {
+      return false;
+    }
+    for (double sign : {1.0, -1.0})
+    {
+      const double q2 = sign * std::acos(c2);
+      const double q1 = std::atan2(y, x) - std::atan2(L2 * std::sin(q2), L1 + L2 * std::cos(q2));
+      joint_poses.push_back({q1, q2});
+    }
+    return true;
+  }
+
+  virtual bool getFK(const std::vector<double>& q, Eigen::Affine3d& pose) const
+  {
+    pose = Eigen::Translation3d(L1 * std::cos(q[0]) + L2 * std::cos(q[0] + q[1]),
+                                L1 * std::sin(q[0]) + L2 * std::sin(q[0] + q[1]), 0.0) *
+           Eigen::AngleAxisd(q[0] + q[1], Eigen::Vector3d::UnitZ());
+    return true;
+  }
+
+  virtual bool isValid(const std::vector<double>& q) const { return std::abs(q[0]) <= M_PI && std::abs(q[1]) <= M_PI; }
+
+  virtual bool getIK(const Eigen::Affine3d&, const std::vector<double>&, std::vector<double>&) const { return false; }
+  virtual int getDOF() const { return 2; }
+  virtual bool isValid(const Eigen::Affine3d&) const { return false; }
+  virtual bool initialize(const std::string&, const std::string&, const std::string&, const std::string&)
+  {
+    return true;
+  }
+  virtual bool isValidMove(const double*, const double*, double) const { return true; }
+  virtual std::vector<double> getJointVelocityLimits() const { return std::vector<double>(2, 1.0); }
+
+  static constexpr double L1 = 1.0;
+  static constexpr double L2 = 0.8;
+  mutable std::atomic<std::size_t> ik_calls;
+};
+
+constexpr double PlanarArmModel::L1;
+constexpr double PlanarArmModel::L2;
+
+/* A tool position free to rotate about z; sampled like AxialSymmetricPt, so every sample yields
+ * the same joint solutions */
+class PositionPt : public descartes_core::TrajectoryPt
+{
+public:
+  PositionPt(const Eigen::Vector3d& position, double dt = 0.0, int samples = 12)
+      : TrajectoryPt(descartes_core::TimingConstraint(dt)), position_(position), samples_(samples)
+  {
+  }
+
+  virtual void getJointPoses(const descartes_core::RobotModel& model,
+                             std::vector<std::vector<double> >& joint_poses) const
+  {
+    joint_poses.clear();
+    std::vector<std::vector<double> > sols;
+    for (int i = 0; i < samples_; ++i)
+    {
+      const Eigen::Affine3d pose = Eigen::Translation3d(position_) * Eigen::AngleAxisd(2 * M_PI * i / samples_,
+                                                                                       Eigen::Vector3d::UnitZ());
+      if (model.getAllIK(pose, sols))
+      {
+        joint_poses.insert(joint_poses.end(), sols.begin(), sols.end());
+      }
+    }
+  }
+
+  virtual bool getNominalCartPose(const std::vector<double>&, const descartes_core::RobotModel&,
+                                  Eigen::Affine3d& pose) const
+  {
+    pose = Eigen::Translation3d(position_) * Eigen::Quaterniond::Identity();
+    return true;
+  }
+
+  virtual bool getClosestCartPose(const std::vector<double>& seed, const descartes_core::RobotModel& model,
+                                  Eigen::Affine3d& pose) const
+  {
+    return getNominalCartPose(seed, model, pose);
+  }
+  virtual void getCartesianPoses(const descartes_core::RobotModel&, PoseVector&) const {}
+  virtual bool getClosestJointPose(const std::vector<double>&, const descartes_core::RobotModel&,
+                                   std::vector<double>&) const
+  {
+    return false;
+  }
+  virtual bool getNominalJointPose(const std::vector<double>&, const descartes_core::RobotModel&,
+                                   std::vector<double>&) const
+  {
+    return false;
+  }
+  virtual bool isValid(const descartes_core::RobotModel&) const { return true; }
+  virtual bool setDiscretization(const std::vector<double>&) { return false; }
+  virtual descartes_core::TrajectoryPtPtr copy() const { return boost::make_shared<PositionPt>(*this); }
+
+  const Eigen::Vector3d& position() const { return position_; }
+
+private:
+  Eigen::Vector3d position_;
+  int samples_;
+};
+
+static std::vector<descartes_core::TrajectoryPtPtr> makeLine(std::size_t n, double dt = 0.0)
+{
+  std::vector<descartes_core::TrajectoryPtPtr> traj;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const double s = static_cast<double>(i) / (n - 1);
+    traj.push_back(boost::make_shared<PositionPt>(Eigen::Vector3d(1.2, -0.5 + s, 0.0), dt));
+  }
+  return traj;
+}
+
+static std::vector<descartes_core::TrajectoryPtPtr> makeArc(std::size_t n, double radius)
+{
+  std::vector<descartes_core::TrajectoryPtPtr> traj;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const double a = M_PI * i / (n - 1);
+    traj.push_back(
+        boost::make_shared<PositionPt>(Eigen::Vector3d(1.2 + radius * std::cos(a), radius * std::sin(a), 0.0)));
+  }
+  return traj;
+}
+
+static double maxDeviation(const descartes_core::RobotModel& model,
+                           const std::vector<descartes_core::TrajectoryPtPtr>& traj, const JointPath& path)
+{
+  double deviation = 0.0;
+  for (std::size_t i = 0; i < traj.size(); ++i)
+  {
+    Eigen::Affine3d pose;
+    model.getFK(path[i], pose);
+    deviation =
+        std::max(deviation, (pose.translation() - static_cast<const PositionPt&>(*traj[i]).position()).norm());
+  }
+  return deviation;
+}
+
+static bool report_costs = false; // Set by --report_costs
+
+/* Wall clock time and IK calls of a solve */
+struct SolveCost
+{
+  double seconds;
+  std::size_t ik_calls;
+};
+
+/* One model and graph builder per test, and the measurements the solver comparisons share */
+class GraphSolvers : public testing::Test
+{
+protected:
+  GraphSolvers() { useModel(boost::make_shared<PlanarArmModel>()); }
+
+  void useModel(const boost::shared_ptr<PlanarArmModel>& model)
+  {
+    model_ = model;
+    builder_.reset(new ParallelGraphBuilder(std::vector<descartes_core::RobotModelPtr>(1, model)));
+  }
+
+  /* Resets the IK call counter and starts the clock */
+  void startSolve()
+  {
+    model_->ik_calls = 0;
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  /* Cost since the last startSolve() */
+  SolveCost endSolve() const
+  {
+    SolveCost cost;
+    cost.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    cost.ik_calls = model_->ik_calls;
+    return cost;
+  }
+
+  /* Prints the cost of a solve when run with --report_costs */
+  static void report(const std::string& label, const SolveCost& cost, const std::string& details = std::string())
+  {
+    if (report_costs)
+    {
+      std::cout << label << ": " << cost.seconds << " s, " << cost.ik_calls << " IK calls" << details << "\n";
+    }
+  }
+
+  void compareSparse(const std::vector<descartes_core::TrajectoryPtPtr>& traj, const SparsePlanningParameters& params,
+                     SparsePlanningStats& stats);
+
+  void compareCoarseToFine(const std::vector<descartes_core::TrajectoryPtPtr>& traj, CoarseToFinePlanningStats& stats,
+                           double& ik_ratio);
+
+  boost::shared_ptr<PlanarArmModel> model_;
+  std::unique_ptr<ParallelGraphBuilder> builder_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/* Solves 'traj' both ways and checks the sparse solution against the dense one */
+void GraphSolvers::compareSparse(const std::vector<descartes_core::TrajectoryPtPtr>& traj,
+                                 const SparsePlanningParameters& params, SparsePlanningStats& stats)
+{
+  const std::vector<double> start{0.0, 0.0};
+
+  JointPath dense, sparse;
+  double cost;
+  startSolve();
+  ASSERT_TRUE(denseSolve(*builder_, traj, start, dense, cost));
+  const SolveCost dense_cost = endSolve();
+
+  startSolve();
+  ASSERT_TRUE(sparseSolve(*builder_, *model_, traj, start, params, sparse, stats));
+  const SolveCost sparse_cost = endSolve();
+
+  ASSERT_EQ(traj.size(), sparse.size());
+  EXPECT_LE(maxDeviation(*model_, traj, sparse), params.max_position_deviation + 1e-9);
+  // Densified intervals solve the IK of their points again, once
+  EXPECT_LE(sparse_cost.ik_calls, dense_cost.ik_calls);
+  // Interpolating between optimal sparse solutions stays close to the optimal dense path
+  EXPECT_LE(jointPathCost(sparse), 1.01 * jointPathCost(dense));
+
+  report("Dense", dense_cost);
+  report("Sparse", sparse_cost, " (" + std::to_string(stats.sparse_points) + " sparse, " +
+                                    std::to_string(stats.interpolated_points) + " interpolated, " +
+                                    std::to_string(stats.densified_intervals) + " intervals densified)");
+}
+
+TEST_F(GraphSolvers, sparseMatchesDenseOnLine)
+{
+  SparsePlanningStats stats;
+  compareSparse(makeLine(201), SparsePlanningParameters(), stats);
+  EXPECT_EQ(0u, stats.densified_intervals);
+  EXPECT_EQ(180u, stats.interpolated_points);
+}
+
+TEST_F(GraphSolvers, sparseDensifiesWhereInterpolationStrays)
+{
+  // A tight arc: interpolating across a sparse interval cuts the corner
+  SparsePlanningStats stats;
+  compareSparse(makeArc(41, 0.1), SparsePlanningParameters(), stats);
+  EXPECT_GT(stats.densified_intervals, 0u);
+}
+
+TEST_F(GraphSolvers, sparseRespectsTiming)
+{
+  // 5 mm steps in 10 ms: fast enough that the joints must not be interpolated past the limits
+  const auto traj = makeLine(201, 0.01);
+
+  JointPath path;
+  SparsePlanningStats stats;
+  ASSERT_TRUE(
+      sparseSolve(*builder_, *model_, traj, std::vector<double>(), SparsePlanningParameters(), path, stats));
+  for (std::size_t i = 1; i < path.size(); ++i)
+  {
+    for (std::size_t j = 0; j < 2; ++j)
+    {
+      EXPECT_LE(std::abs(path[i][j] - path[i - 1][j]), 1.0 * 0.01 + 1e-9) << "point " << i;
+    }
+  }
+}
+
+TEST_F(GraphSolvers, strideOfOneIsDense)
+{
+  SparsePlanningParameters params;
+  params.stride = 1;
+  JointPath path;
+  SparsePlanningStats stats;
+  ASSERT_TRUE(sparseSolve(*builder_, *model_, makeLine(20), std::vector<double>(), params, path, stats));
+  EXPECT_EQ(20u, stats.sparse_points);
+  EXPECT_EQ(0u, stats.interpolated_points);
+}
+
+/* Planar arm with a third link along the tool x axis: how far the arm reaches depends on the
+ * rotation of the tool about z */
+class PlanarWristModel : public PlanarArmModel
+{
+public:
+  virtual bool getAllIK(const Eigen::Affine3d& pose, std::vector<std::vector<double> >& joint_poses) const
+  {
+    const double phi = std::atan2(pose.linear()(1, 0), pose.linear()(0, 0));
+    const Eigen::Affine3d wrist =
+        Eigen::Translation3d(pose.translation() - L3 * Eigen::Vector3d(std::cos(phi), std::sin(phi), 0.0)) *
+        Eigen::Quaterniond::Identity();
+    if (!PlanarArmModel::getAllIK(wrist, joint_poses))
+    {
+      return false;
+    }
+    for (auto& q : joint_poses)
+    {
+      q.push_back(std::remainder(phi - q[0] - q[1], 2 * M_PI));
+    }
+    return true;
+  }
+
+  virtual bool getFK(const std::vector<double>& q, Eigen::Affine3d& pose) const
+  {
+    const double phi = q[0] + q[1] + q[2];
+    pose = Eigen::Translation3d(L1 * std::cos(q[0]) + L2 * std::cos(q[0] + q[1]) + L3 * std::cos(phi),
+                                L1 * std::sin(q[0]) + L2 * std::sin(q[0] + q[1]) + L3 * std::sin(phi), 0.0) *
+           Eigen::AngleAxisd(phi, Eigen::Vector3d::UnitZ());
+    return true;
+  }
+
+  virtual bool isValid(const std::vector<double>& q) const
+  {
+    return PlanarArmModel::isValid(q) && std::abs(q[2]) <= M_PI;
+  }
+  virtual int getDOF() const { return 3; }
+  virtual std::vector<double> getJointVelocityLimits() const { return std::vector<double>(3, 1.0); }
+
+  static constexpr double L3 = 0.3;
+};
+
+constexpr double PlanarWristModel::L3;
+
+/* Points on an arc about the base, tool rotation free */
+static std::vector<descartes_core::TrajectoryPtPtr> makeToolAxisArc(double radius, double from, double to,
+                                                                    std::size_t n)
+{
+  std::vector<descartes_core::TrajectoryPtPtr> traj;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const double a = from + (to - from) * i / (n - 1);
+    const Eigen::Affine3d pose =
+        Eigen::Translation3d(radius * std::cos(a), radius * std::sin(a), 0.0) * Eigen::Quaterniond::Identity();
+    traj.push_back(descartes_core::TrajectoryPtPtr(new ToolAxisPt(pose, M_PI / 12.0)));
+  }
+  return traj;
+}
+
+/* Solves 'traj' with all fine rotations and coarse to fine, and checks that the two agree */
+void GraphSolvers::compareCoarseToFine(const std::vector<descartes_core::TrajectoryPtPtr>& traj,
+                                       CoarseToFinePlanningStats& stats, double& ik_ratio)
+{
+  useModel(boost::make_shared<PlanarWristModel>());
+  const std::vector<double> start{0.0, 0.0, 0.0};
+
+  JointPath dense, refined;
+  double cost;
+  startSolve();
+  ASSERT_TRUE(denseSolve(*builder_, traj, start, dense, cost));
+  const SolveCost dense_cost = endSolve();
+
+  startSolve();
+  ASSERT_TRUE(coarseToFineSolve(*builder_, *model_, traj, start, CoarseToFinePlanningParameters(), refined, stats));
+  const SolveCost refined_cost = endSolve();
+
+  ASSERT_EQ(traj.size(), refined.size());
+  for (std::size_t i = 0; i < traj.size(); ++i)
+  {
+    Eigen::Affine3d pose;
+    model_->getFK(refined[i], pose);
+    EXPECT_LT((pose.translation() - static_cast<const ToolAxisPt&>(*traj[i]).nominal().translation()).norm(), 1e-9);
+  }
+  // The input points keep their sampling
+  EXPECT_EQ(24u, static_cast<const ToolAxisPt&>(*traj.front()).angles().size());
+  EXPECT_LE(jointPathCost(refined), 1.01 * jointPathCost(dense));
+  ik_ratio = static_cast<double>(refined_cost.ik_calls) / dense_cost.ik_calls;
+
+  report("Fine", dense_cost);
+  report("Coarse to fine", refined_cost, " (" + std::to_string(stats.coarse_samples) + " coarse, " +
+                                             std::to_string(stats.fine_samples) + " fine rotations, " +
+                                             std::to_string(stats.widened_points) + " points widened)");
+}
+
+TEST_F(GraphSolvers, coarseToFineMatchesFine)
+{
+  CoarseToFinePlanningStats stats;
+  double ik_ratio;
+  compareCoarseToFine(makeToolAxisArc(1.5, -0.5, 0.5, 51), stats, ik_ratio);
+  EXPECT_EQ(0u, stats.widened_points);
+  EXPECT_EQ(51u * 8, stats.coarse_samples);
+  EXPECT_EQ(51u * 3, stats.fine_samples);
+  // 8 coarse and 3 fine rotations per point instead of 24
+  EXPECT_LT(ik_ratio, 0.5);
+}
+
+TEST_F(GraphSolvers, coarseToFineWidensUnreachablePoints)
+{
+  // At 2.08 m the tool must point within ~19.5 deg of straight out. Coarse rotations are 45 deg
+  // apart, so between 19.5 and 25.5 deg around the base none of them reaches; 15 deg rotations do.
+  // Widening builds the coarse graph a second time, so this saves less
+  CoarseToFinePlanningStats stats;
+  double ik_ratio;
+  compareCoarseToFine(makeToolAxisArc(2.08, 10.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 26), stats, ik_ratio);
+  EXPECT_EQ(6u, stats.widened_points);
+  EXPECT_LT(ik_ratio, 1.0);
+}
+
+TEST_F(GraphSolvers, coarseToFineFailsWhereFineFails)
+{
+  useModel(boost::make_shared<PlanarWristModel>());
+  JointPath path;
+  CoarseToFinePlanningStats stats;
+  EXPECT_FALSE(coarseToFineSolve(*builder_, *model_, makeToolAxisArc(2.2, 0.0, 0.5, 10), std::vector<double>(),
+                                 CoarseToFinePlanningParameters(), path, stats));
+}
+
+TEST_F(GraphSolvers, warmStartReusesUnchangedPath)
+{
+  const auto traj = makeLine(201);
+  const std::vector<double> start{0.0, 0.0};
+
+  JointPath previous, path;
+  double cost;
+  startSolve();
+  ASSERT_TRUE(denseSolve(*builder_, traj, start, previous, cost));
+  const SolveCost dense_cost = endSolve();
+
+  // Re-planning the same path, e.g. after a speed change
+  WarmStartStats stats;
+  startSolve();
+  ASSERT_TRUE(warmStartSolve(*builder_, *model_, traj, start, previous, WarmStartParameters(), path, stats));
+  const SolveCost warm_cost = endSolve();
+  EXPECT_EQ(201u, stats.reused_points);
+  EXPECT_EQ(0u, warm_cost.ik_calls);
+  EXPECT_EQ(previous, path);
+
+  report("Dense", dense_cost);
+  report("Warm start, unchanged", warm_cost);
+}
+
+TEST_F(GraphSolvers, warmStartReplansChangedPoints)
+{
+  const std::vector<double> start{0.0, 0.0};
+
+  JointPath previous;
+  double cost;
+  ASSERT_TRUE(denseSolve(*builder_, makeLine(201), start, previous, cost));
+
+  // A 2 cm bump in the middle of the line
+  auto traj = makeLine(201);
+  for (std::size_t i = 100; i < 110; ++i)
+  {
+    const Eigen::Vector3d p = static_cast<const PositionPt&>(*traj[i]).position();
+    traj[i] = boost::make_shared<PositionPt>(p + Eigen::Vector3d(0.02, 0.0, 0.0));
+  }
+
+  JointPath dense, path;
+  startSolve();
+  ASSERT_TRUE(denseSolve(*builder_, traj, start, dense, cost));
+  const SolveCost dense_cost = endSolve();
+
+  WarmStartStats stats;
+  startSolve();
+  ASSERT_TRUE(warmStartSolve(*builder_, *model_, traj, start, previous, WarmStartParameters(), path, stats));
+  const SolveCost warm_cost = endSolve();
+
+  EXPECT_EQ(20u, stats.replanned_points);
+  EXPECT_EQ(181u, stats.reused_points);
+  EXPECT_EQ(20u * 12, warm_cost.ik_calls);
+  EXPECT_LT(maxDeviation(*model_, traj, path), 1e-9);
+  EXPECT_LE(jointPathCost(path), 1.01 * jointPathCost(dense));
+
+  report("Dense", dense_cost);
+  report("Warm start, 10 points changed", warm_cost);
+}
+
+TEST_F(GraphSolvers, warmStartNeedsTheSamePoints)
+{
+  JointPath previous, path;
+  double cost;
+  ASSERT_TRUE(denseSolve(*builder_, makeLine(201), std::vector<double>(), previous, cost));
+
+  WarmStartStats stats;
+  // Rediscretized
+  EXPECT_FALSE(warmStartSolve(*builder_, *model_, makeLine(101), std::vector<double>(), previous,
+                              WarmStartParameters(), path, stats));
+  // Moved as a whole (e.g. a new z adjustment)
+  EXPECT_FALSE(warmStartSolve(*builder_, *model_, makeArc(201, 0.2), std::vector<double>(), previous,
+                              WarmStartParameters(), path, stats));
+  EXPECT_EQ(0u, stats.reused_points);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  for (int i = 1; i < argc; ++i)
+  {
+    report_costs |= std::string(argv[i]) == "--report_costs";
+  }
+  return RUN_ALL_TESTS();
+}
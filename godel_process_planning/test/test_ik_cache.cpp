@@ -0,0 +1,238 @@
+/*
+ * test_ik_cache.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <boost/make_shared.hpp>
+#include <godel_process_planning/ik_cache.h>
+
+using namespace godel_process_planning;
+
+typedef std::vector<std::vector<double> > Solutions;
+
+/* Planar two link arm in the xy plane with an elbow up and an elbow down solution. getIK returns
+ * the solution on the branch of the seed. */
+class PlanarArmModel : public descartes_core::RobotModel
+{
+public:
+  PlanarArmModel() : all_ik_calls(0), ik_calls(0) {}
+
+  virtual bool getAllIK(const Eigen::Affine3d& pose, Solutions& joint_poses) const
+  {
+    ++all_ik_calls;
+    return solve(pose, joint_poses);
+  }
+
+  virtual bool getIK(const Eigen::Affine3d& pose, const std::vector<double>& seed,
+                     std::vector<double>& joint_pose) const
+  {
+    ++ik_calls;
+    Solutions sols;
+    if (!solve(pose, sols))
+    {
+      return false;
+    }
+    joint_pose = seed[1] >= 0.0 ? sols[0] : sols[1];
+    return true;
+  }
+
+  virtual bool getFK(const std::vector<double>& q, Eigen::Affine3d& pose) const
+  {
+    pose = Eigen::Translation3d(L1 * std::cos(q[0]) + L2 * std::cos(q[0] + q[1]),
+                                L1 * std::sin(q[0]) + L2 * std::sin(q[0] + q[1]), 0.0) *
+           Eigen::Quaterniond::Identity();
+    return true;
+  }
+
+  virtual int getDOF() const { return 2; }
+  virtual bool isValid(const std::vector<double>&) const { return true; }
+  virtual bool isValid(const Eigen::Affine3d&) const { return true; }
+  virtual bool initialize(const std::string&, const std::string&, const std::string&, const std::string&)
+  {
+    return true;
+  }
+  virtual bool isValidMove(const double*, const double*, double) const { return true; }
+  virtual std::vector<double> getJointVelocityLimits() const { return std::vector<double>(2, 1.0); }
+
+  static constexpr double L1 = 1.0;
+  static constexpr double L2 = 0.8;
+  mutable std::size_t all_ik_calls;
+  mutable std::size_t ik_calls;
+
+private:
+  static bool solve(const Eigen::Affine3d& pose, Solutions& joint_poses)
+  {
+    joint_poses.clear();
+    const double x = pose.translation().x(), y = pose.translation().y();
+    const double c2 = (x * x + y * y - L1 * L1 - L2 * L2) / (2 * L1 * L2);
+    if (std::abs(c2) > 1.0)
+    {
+      return false;
+    }
+    for (double sign : {1.0, -1.0})
+    {
+      const double q2 = sign * std::acos(c2);
+      const double q1 = std::atan2(y, x) - std::atan2(L2 * std::sin(q2), L1 + L2 * std::cos(q2));
+      joint_poses.push_back({q1, q2});
+    }
+    return true;
+  }
+};
+
+constexpr double PlanarArmModel::L1;
+constexpr double PlanarArmModel::L2;
+
+static Eigen::Affine3d position(double x, double y)
+{
+  return Eigen::Translation3d(x, y, 0.0) * Eigen::Quaterniond::Identity();
+}
+
+static IkCacheParameters makeParams(IkCacheMode mode = IkCacheMode::EXACT)
+{
+  IkCacheParameters params;
+  params.position_resolution = 1e-3;
+  params.orientation_resolution = 1e-3;
+  params.mode = mode;
+  return params;
+}
+
+TEST(IkCache, rejectsNonPositiveResolution)
+{
+  IkCacheParameters params;
+  params.position_resolution = 0.0;
+  EXPECT_THROW(IkCache cache(params), std::invalid_argument);
+}
+
+TEST(IkCache, quantizedHitAndMiss)
+{
+  auto model = boost::make_shared<PlanarArmModel>();
+  CachedRobotModel cached(model, std::make_shared<IkCache>(makeParams()));
+
+  Solutions first, second;
+  ASSERT_TRUE(cached.getAllIK(position(1.2, 0.3), first));
+  EXPECT_EQ(1u, model->all_ik_calls);
+
+  // Within the resolution: the stored solutions of the first pose
+  ASSERT_TRUE(cached.getAllIK(position(1.2 + 2e-4, 0.3 - 2e-4), second));
+  EXPECT_EQ(1u, model->all_ik_calls);
+  EXPECT_EQ(first, second);
+
+  // A rotation within the resolution also hits
+  const Eigen::Affine3d rotated = position(1.2, 0.3) * Eigen::AngleAxisd(2e-4, Eigen::Vector3d::UnitZ());
+  ASSERT_TRUE(cached.getAllIK(rotated, second));
+  EXPECT_EQ(1u, model->all_ik_calls);
+
+  // Beyond it: solved again
+  ASSERT_TRUE(cached.getAllIK(position(1.2 + 2e-3, 0.3), second));
+  EXPECT_EQ(2u, model->all_ik_calls);
+  EXPECT_NE(first, second);
+
+  // Collision checking is part of the key
+  cached.setCheckCollisions(true);
+  ASSERT_TRUE(cached.getAllIK(position(1.2, 0.3), second));
+  EXPECT_EQ(3u, model->all_ik_calls);
+
+  const IkCacheStats stats = cached.cache()->stats();
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(3u, stats.misses);
+  EXPECT_EQ(3u, stats.size);
+}
+
+TEST(IkCache, evictsLeastRecentlyUsed)
+{
+  IkCacheParameters params = makeParams();
+  params.capacity = 2;
+  IkCache cache(params);
+  const IkCache::Key a = cache.makeKey(position(1.0, 0.0), false);
+  const IkCache::Key b = cache.makeKey(position(1.1, 0.0), false);
+  const IkCache::Key c = cache.makeKey(position(1.2, 0.0), false);
+
+  Solutions sols;
+  cache.insert(a, Solutions(1, {1.0, 0.0}));
+  cache.insert(b, Solutions(1, {2.0, 0.0}));
+  // Using a makes b the least recently used
+  ASSERT_TRUE(cache.lookup(a, sols));
+  cache.insert(c, Solutions(1, {3.0, 0.0}));
+
+  EXPECT_FALSE(cache.lookup(b, sols));
+  ASSERT_TRUE(cache.lookup(a, sols));
+  EXPECT_EQ(1.0, sols[0][0]);
+  ASSERT_TRUE(cache.lookup(c, sols));
+  EXPECT_EQ(3.0, sols[0][0]);
+
+  const IkCacheStats stats = cache.stats();
+  EXPECT_EQ(1u, stats.evictions);
+  EXPECT_EQ(2u, stats.size);
+
+  // Re-inserting a present key only refreshes it
+  cache.insert(a, Solutions(1, {4.0, 0.0}));
+  cache.insert(b, Solutions(1, {2.0, 0.0}));
+  EXPECT_FALSE(cache.lookup(c, sols));
+  ASSERT_TRUE(cache.lookup(a, sols));
+  EXPECT_EQ(1.0, sols[0][0]);
+}
+
+TEST(IkCache, nearestSeedRefinesOntoPose)
+{
+  auto model = boost::make_shared<PlanarArmModel>();
+  CachedRobotModel cached(model, std::make_shared<IkCache>(makeParams(IkCacheMode::NEAREST_SEED)));
+
+  Solutions stored, refined;
+  ASSERT_TRUE(cached.getAllIK(position(1.2, 0.3), stored));
+  ASSERT_EQ(2u, stored.size());
+
+  // A hit seeds getIK with each stored solution: the solutions are for the actual pose, on the
+  // branch of their seed
+  const Eigen::Affine3d pose = position(1.2 + 3e-4, 0.3 + 3e-4);
+  ASSERT_TRUE(cached.getAllIK(pose, refined));
+  EXPECT_EQ(1u, model->all_ik_calls);
+  EXPECT_EQ(2u, model->ik_calls);
+  ASSERT_EQ(2u, refined.size());
+  for (std::size_t i = 0; i < refined.size(); ++i)
+  {
+    Eigen::Affine3d fk;
+    model->getFK(refined[i], fk);
+    EXPECT_LT((fk.translation() - pose.translation()).norm(), 1e-12);
+    EXPECT_EQ(stored[i][1] >= 0.0, refined[i][1] >= 0.0);
+    EXPECT_LT(std::abs(refined[i][0] - stored[i][0]) + std::abs(refined[i][1] - stored[i][1]), 1e-2);
+  }
+
+  // In exact mode the same lookup returns the stored solutions unchanged
+  CachedRobotModel exact(model, std::make_shared<IkCache>(makeParams()));
+  ASSERT_TRUE(exact.getAllIK(position(1.2, 0.3), stored));
+  ASSERT_TRUE(exact.getAllIK(pose, refined));
+  EXPECT_EQ(stored, refined);
+  EXPECT_EQ(2u, model->ik_calls);
+}
+
+TEST(IkCache, batchSolvesOnlyMisses)
+{
+  auto model = boost::make_shared<PlanarArmModel>();
+  CachedRobotModel cached(model, std::make_shared<IkCache>(makeParams()));
+
+  Solutions sols;
+  ASSERT_TRUE(cached.getAllIK(position(1.2, 0.0), sols));
+
+  // The first pose is cached, the last is out of reach
+  const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > poses = {
+      position(1.2, 0.0), position(1.2, 0.1), position(3.0, 0.0)};
+  std::vector<double> joints;
+  std::vector<std::size_t> offsets;
+  EXPECT_FALSE(cached.getAllIKBatch(poses.data(), poses.size(), joints, offsets));
+  EXPECT_EQ(3u, model->all_ik_calls);
+
+  ASSERT_EQ(4u, offsets.size());
+  EXPECT_EQ(0u, offsets[0]);
+  EXPECT_EQ(2u, offsets[1]);
+  EXPECT_EQ(4u, offsets[2]);
+  EXPECT_EQ(4u, offsets[3]);
+  ASSERT_EQ(8u, joints.size());
+  EXPECT_EQ(sols[0], std::vector<double>(joints.begin(), joints.begin() + 2));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
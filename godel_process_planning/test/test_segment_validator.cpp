@@ -0,0 +1,75 @@
+/*
+ * test_segment_validator.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <random>
+#include "segment_validator_test_utils.h"
+
+using godel_process_planning::SegmentValidator;
+
+TEST(SegmentValidator, validTrajectory)
+{
+  // Obstacle beyond the end of the trajectory
+  auto models = makeModels(4, 100.0, 101.0);
+  SegmentValidator validator(models);
+  std::size_t first_invalid = 0;
+  EXPECT_TRUE(validator.validate(makeDiagonal(50, 0.3), 0.05, first_invalid));
+}
+
+TEST(SegmentValidator, firstInvalidSegment)
+{
+  // Samples inside (3.05, 3.25) on the diagonal are invalid: within segment 10 (3.0 to 3.3)
+  const auto traj = makeDiagonal(50, 0.3);
+  for (std::size_t threads = 1; threads <= 4; ++threads)
+  {
+    auto models = makeModels(threads, 3.05, 3.25);
+    SegmentValidator validator(models);
+    std::size_t first_invalid = 0;
+    EXPECT_FALSE(validator.validate(traj, 0.05, first_invalid));
+    EXPECT_EQ(10u, first_invalid) << threads << " threads";
+  }
+}
+
+TEST(SegmentValidator, matchesDiscreteSampling)
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> joint(-1.0, 1.0);
+  auto models = makeModels(3, 0.2, 0.4);
+  SegmentValidator validator(models);
+
+  for (int trial = 0; trial < 200; ++trial)
+  {
+    trajectory_msgs::JointTrajectory traj;
+    for (int i = 0; i < 20; ++i)
+    {
+      trajectory_msgs::JointTrajectoryPoint pt;
+      pt.positions = {joint(rng), joint(rng)};
+      traj.points.push_back(pt);
+    }
+
+    std::size_t expected_index = 0, index = 0;
+    const bool expected = validateReference(traj, *models.front(), 0.05, expected_index);
+    ASSERT_EQ(expected, validator.validate(traj, 0.05, index));
+    if (!expected)
+    {
+      EXPECT_EQ(expected_index, index);
+    }
+  }
+}
+
+TEST(SegmentValidator, identicalPoints)
+{
+  auto models = makeModels(2, -1.0, 1.0);
+  SegmentValidator validator(models);
+  std::size_t first_invalid = 0;
+  // Both points inside the obstacle, but waypoints are not checked and there is nothing between them
+  EXPECT_TRUE(validator.validate(makeDiagonal(2, 0.0), 0.05, first_invalid));
+  EXPECT_EQ(0u, totalChecks(models));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,173 @@
+/*
+ * test_time_parameterization.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <godel_process_planning/time_parameterization.h>
+
+using godel_process_planning::JointLimits;
+using godel_process_planning::timeParameterize;
+
+static JointLimits makeLimits(double velocity, double acceleration, std::size_t dof = 2)
+{
+  JointLimits limits;
+  limits.velocity.assign(dof, velocity);
+  limits.acceleration.assign(dof, acceleration);
+  return limits;
+}
+
+// Joint 0 moves from 'start' to 'stop' in steps of at most 'step'; joint 1 stays at 0
+static trajectory_msgs::JointTrajectory makeLine(double start, double stop, double step)
+{
+  trajectory_msgs::JointTrajectory traj;
+  const int n = static_cast<int>(std::ceil(std::abs(stop - start) / step));
+  for (int i = 0; i <= n; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint pt;
+    pt.positions = {start + (stop - start) * i / n, 0.0};
+    traj.points.push_back(pt);
+  }
+  return traj;
+}
+
+static void expectWithinLimits(const trajectory_msgs::JointTrajectory& traj, const JointLimits& limits)
+{
+  const double TOLERANCE = 1e-6;
+  for (std::size_t k = 1; k < traj.points.size(); ++k)
+  {
+    const double dt = (traj.points[k].time_from_start - traj.points[k - 1].time_from_start).toSec();
+    ASSERT_GT(dt, 0.0);
+    for (std::size_t j = 0; j < limits.velocity.size(); ++j)
+    {
+      const double v = (traj.points[k].positions[j] - traj.points[k - 1].positions[j]) / dt;
+      EXPECT_LE(std::abs(v), limits.velocity[j] + TOLERANCE) << "segment " << k;
+      EXPECT_LE(std::abs(traj.points[k].velocities[j]), limits.velocity[j] + TOLERANCE) << "point " << k;
+    }
+  }
+  for (std::size_t k = 0; k < traj.points.size(); ++k)
+  {
+    for (std::size_t j = 0; j < limits.acceleration.size(); ++j)
+    {
+      EXPECT_LE(std::abs(traj.points[k].accelerations[j]), limits.acceleration[j] + TOLERANCE) << "point " << k;
+    }
+  }
+}
+
+TEST(TimeParameterization, freeMotionIsNearTimeOptimal)
+{
+  const JointLimits limits = makeLimits(1.0, 2.0);
+  trajectory_msgs::JointTrajectory traj = makeLine(0.0, 1.0, M_PI / 180.0);
+  ASSERT_TRUE(timeParameterize(traj, limits));
+  expectWithinLimits(traj, limits);
+
+  // A trapezoidal profile takes distance / velocity + velocity / acceleration
+  const double optimal = 1.0 / 1.0 + 1.0 / 2.0;
+  const double duration = godel_process_planning::trajectoryDuration(traj);
+  EXPECT_GT(duration, 0.95 * optimal);
+  EXPECT_LT(duration, 1.1 * optimal);
+
+  // Starts and ends at rest
+  EXPECT_EQ(0.0, traj.points.front().velocities[0]);
+  EXPECT_EQ(0.0, traj.points.back().velocities[0]);
+  EXPECT_NEAR(1.0, traj.points[traj.points.size() / 2].velocities[0], 1e-6);
+}
+
+TEST(TimeParameterization, reversalComesToRest)
+{
+  const JointLimits limits = makeLimits(1.0, 2.0);
+  trajectory_msgs::JointTrajectory traj = makeLine(0.0, 1.0, 0.01);
+  trajectory_msgs::JointTrajectory back = makeLine(1.0, 0.0, 0.01);
+  traj.points.insert(traj.points.end(), back.points.begin() + 1, back.points.end());
+  ASSERT_TRUE(timeParameterize(traj, limits));
+  expectWithinLimits(traj, limits);
+
+  // Twice the single motion
+  EXPECT_GT(godel_process_planning::trajectoryDuration(traj), 2.0 * 0.95 * 1.5);
+}
+
+TEST(TimeParameterization, keepsRequestedDurations)
+{
+  // A process path: every segment should take 0.1 s, but the middle ones would be too fast for joint 0
+  const JointLimits limits = makeLimits(1.0, 100.0);
+  trajectory_msgs::JointTrajectory traj = makeLine(0.0, 0.2, 0.01);
+  traj.points[10].positions[0] += 0.1;
+  for (std::size_t k = 11; k < traj.points.size(); ++k)
+  {
+    traj.points[k].positions[0] += 0.2;
+  }
+  const std::vector<double> durations(traj.points.size(), 0.1);
+  ASSERT_TRUE(timeParameterize(traj, limits, durations, 0.5));
+  expectWithinLimits(traj, limits);
+
+  EXPECT_DOUBLE_EQ(0.5, traj.points.front().time_from_start.toSec());
+  for (std::size_t k = 1; k < traj.points.size(); ++k)
+  {
+    const double dt = (traj.points[k].time_from_start - traj.points[k - 1].time_from_start).toSec();
+    if (k == 10 || k == 11)
+    {
+      EXPECT_NEAR(0.11, dt, 0.005) << "segment " << k; // 0.11 rad at 1 rad/s, plus speeding up
+    }
+    else
+    {
+      EXPECT_NEAR(0.1, dt, 0.002) << "segment " << k;
+    }
+  }
+}
+
+TEST(TimeParameterization, repeatedFirstPoint)
+{
+  // Joint 0 moves, then joint 1, with a 90 degree corner between; the first point is repeated
+  const double positions[][2] = {{0.0, 0.0}, {0.0, 0.0}, {0.2, 0.0}, {0.4, 0.0}, {0.4, 0.2}, {0.4, 0.4}};
+  trajectory_msgs::JointTrajectory traj;
+  for (const auto& p : positions)
+  {
+    trajectory_msgs::JointTrajectoryPoint pt;
+    pt.positions = {p[0], p[1]};
+    traj.points.push_back(pt);
+  }
+  JointLimits limits;
+  limits.velocity = {0.5, 2.0};
+  limits.acceleration = {2.0, 2.0};
+  ASSERT_TRUE(timeParameterize(traj, limits));
+  expectWithinLimits(traj, limits);
+
+  // Stops at the corner
+  EXPECT_EQ(std::vector<double>(2, 0.0), traj.points[3].velocities);
+
+  // Timed like the same path without the repeated point, apart from the repeated point's own segment
+  trajectory_msgs::JointTrajectory once = traj;
+  once.points.erase(once.points.begin());
+  ASSERT_TRUE(timeParameterize(once, limits));
+  EXPECT_NEAR(godel_process_planning::trajectoryDuration(once), godel_process_planning::trajectoryDuration(traj),
+              0.01);
+}
+
+TEST(TimeParameterization, rejectsMismatchedSizes)
+{
+  trajectory_msgs::JointTrajectory traj = makeLine(0.0, 1.0, 0.5);
+  const trajectory_msgs::JointTrajectory original = traj;
+
+  EXPECT_FALSE(timeParameterize(traj, makeLimits(1.0, 1.0, 3)));
+  EXPECT_FALSE(timeParameterize(traj, makeLimits(1.0, 1.0), std::vector<double>(2, 0.1)));
+  EXPECT_FALSE(timeParameterize(traj, makeLimits(0.0, 1.0)));
+  EXPECT_EQ(original.points.size(), traj.points.size());
+  EXPECT_TRUE(traj.points.front().velocities.empty());
+}
+
+TEST(TimeParameterization, singlePoint)
+{
+  trajectory_msgs::JointTrajectory traj;
+  traj.points.resize(1);
+  traj.points[0].positions = {1.0, 0.0};
+  ASSERT_TRUE(timeParameterize(traj, makeLimits(1.0, 1.0), std::vector<double>(), 0.2));
+  EXPECT_DOUBLE_EQ(0.2, traj.points[0].time_from_start.toSec());
+  EXPECT_EQ(std::vector<double>(2, 0.0), traj.points[0].velocities);
+  EXPECT_EQ(0.0, godel_process_planning::trajectoryDuration(traj));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
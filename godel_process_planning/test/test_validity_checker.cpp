@@ -0,0 +1,298 @@
+/*
+ * test_validity_checker.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <boost/make_shared.hpp>
+#include <urdf/model.h>
+#include <srdfdom/model.h>
+#include <godel_process_planning/validity_checker.h>
+
+using namespace godel_process_planning;
+
+typedef std::vector<std::vector<double> > Solutions;
+
+/*
+ * Planar three link arm in the xy plane, each link 1 m long with a 0.8 m box, and joint limits of
+ * +/- 3 rad. A fixture that is part of the robot but not of the arm group stands 2.5 m out along x.
+ * Adjacent links never collide.
+ */
+static const std::string ARM_URDF =
+    "<robot name=\"planar_arm\">"
+    "  <link name=\"base_link\"/>"
+    "  <link name=\"fixture\">"
+    "    <collision><geometry><box size=\"0.2 0.2 0.2\"/></geometry></collision>"
+    "  </link>"
+    "  <joint name=\"fixture_joint\" type=\"fixed\">"
+    "    <parent link=\"base_link\"/><child link=\"fixture\"/><origin xyz=\"2.5 0 0\"/>"
+    "  </joint>"
+    "  <link name=\"link1\">"
+    "    <collision><origin xyz=\"0.5 0 0\"/><geometry><box size=\"0.8 0.1 0.1\"/></geometry></collision>"
+    "  </link>"
+    "  <link name=\"link2\">"
+    "    <collision><origin xyz=\"0.5 0 0\"/><geometry><box size=\"0.8 0.1 0.1\"/></geometry></collision>"
+    "  </link>"
+    "  <link name=\"link3\">"
+    "    <collision><origin xyz=\"0.5 0 0\"/><geometry><box size=\"0.8 0.1 0.1\"/></geometry></collision>"
+    "  </link>"
+    "  <joint name=\"joint1\" type=\"revolute\">"
+    "    <parent link=\"base_link\"/><child link=\"link1\"/><axis xyz=\"0 0 1\"/>"
+    "    <limit lower=\"-3\" upper=\"3\" effort=\"1\" velocity=\"1\"/>"
+    "  </joint>"
+    "  <joint name=\"joint2\" type=\"revolute\">"
+    "    <parent link=\"link1\"/><child link=\"link2\"/><origin xyz=\"1 0 0\"/><axis xyz=\"0 0 1\"/>"
+    "    <limit lower=\"-3\" upper=\"3\" effort=\"1\" velocity=\"1\"/>"
+    "  </joint>"
+    "  <joint name=\"joint3\" type=\"revolute\">"
+    "    <parent link=\"link2\"/><child link=\"link3\"/><origin xyz=\"1 0 0\"/><axis xyz=\"0 0 1\"/>"
+    "    <limit lower=\"-3\" upper=\"3\" effort=\"1\" velocity=\"1\"/>"
+    "  </joint>"
+    "</robot>";
+
+static const std::string ARM_SRDF =
+    "<robot name=\"planar_arm\">"
+    "  <group name=\"arm\"><joint name=\"joint1\"/><joint name=\"joint2\"/><joint name=\"joint3\"/></group>"
+    "  <disable_collisions link1=\"link1\" link2=\"link2\" reason=\"Adjacent\"/>"
+    "  <disable_collisions link1=\"link2\" link2=\"link3\" reason=\"Adjacent\"/>"
+    "</robot>";
+
+// Straight out along y, clear of everything
+static const std::vector<double> FREE = {1.5, 0.0, 0.0};
+// Second joint past its limit
+static const std::vector<double> OUT_OF_LIMITS = {0.0, 3.1, 0.0};
+// Folded so that link3 crosses link1
+static const std::vector<double> GROUP_COLLISION = {0.0, 2.5, 2.5};
+// Straight out along x, link3 through the fixture
+static const std::vector<double> ENVIRONMENT_COLLISION = {0.0, 0.0, 0.0};
+
+static moveit::core::RobotModelConstPtr makeRobotModel()
+{
+  urdf::Model* urdf_model = new urdf::Model();
+  urdf::ModelInterfaceSharedPtr urdf_ptr(urdf_model);
+  if (!urdf_model->initString(ARM_URDF))
+  {
+    return moveit::core::RobotModelConstPtr();
+  }
+  srdf::ModelSharedPtr srdf_model(new srdf::Model());
+  if (!srdf_model->initString(*urdf_model, ARM_SRDF))
+  {
+    return moveit::core::RobotModelConstPtr();
+  }
+  return moveit::core::RobotModelConstPtr(new moveit::core::RobotModel(urdf_ptr, srdf_model));
+}
+
+/* A 3 x 3 x 3 grid within the joint limits, which includes the named configurations, and one
+ * configuration past the limits */
+static Solutions makeConfigurations()
+{
+  Solutions configurations = {OUT_OF_LIMITS};
+  for (double q1 : {-1.0, 0.0, 1.5})
+  {
+    for (double q2 : {0.0, 1.0, 2.5})
+    {
+      for (double q3 : {-2.5, 0.0, 2.5})
+      {
+        configurations.push_back({q1, q2, q3});
+      }
+    }
+  }
+  return configurations;
+}
+
+TEST(ValidityChecker, stagesRejectWhatTheyShould)
+{
+  ValidityChecker checker(makeRobotModel(), "arm");
+  moveit::core::RobotState state = checker.makeState();
+
+  EXPECT_TRUE(checker.isValid(state, FREE, true));
+  EXPECT_FALSE(checker.isValid(state, OUT_OF_LIMITS, true));
+  EXPECT_FALSE(checker.isValid(state, GROUP_COLLISION, true));
+  EXPECT_FALSE(checker.isValid(state, ENVIRONMENT_COLLISION, true));
+  // Wrong number of joints
+  EXPECT_FALSE(checker.isValid(state, std::vector<double>(2, 0.0), true));
+
+  const ValidityStats stats = checker.stats();
+  EXPECT_EQ(5u, stats.checks);
+  EXPECT_EQ(2u, stats.limit_rejections);
+  EXPECT_EQ(1u, stats.group_collision_rejections);
+  EXPECT_EQ(1u, stats.environment_collision_rejections);
+
+  // Without collision checking only the limits apply
+  EXPECT_TRUE(checker.isValid(state, GROUP_COLLISION, false));
+  EXPECT_TRUE(checker.isValid(state, ENVIRONMENT_COLLISION, false));
+  EXPECT_FALSE(checker.isValid(state, OUT_OF_LIMITS, false));
+
+  checker.resetStats();
+  EXPECT_EQ(0u, checker.stats().checks);
+}
+
+TEST(ValidityChecker, memoizedMatchesUncached)
+{
+  const moveit::core::RobotModelConstPtr model = makeRobotModel();
+  ValidityCheckerParameters uncached_params;
+  uncached_params.cache_capacity = 0;
+  ValidityChecker uncached(model, "arm", uncached_params);
+  ValidityChecker memoized(model, "arm");
+  moveit::core::RobotState state = memoized.makeState();
+
+  const Solutions configurations = makeConfigurations();
+  std::size_t valid = 0;
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    for (const auto& q : configurations)
+    {
+      const bool expected = uncached.isValid(state, q, true);
+      EXPECT_EQ(expected, memoized.isValid(state, q, true));
+      valid += expected;
+    }
+  }
+  // Both outcomes are covered
+  EXPECT_GT(valid, 0u);
+  EXPECT_LT(valid, 2 * configurations.size());
+
+  // Every configuration within the limits is memoized on the first pass and looked up on the second
+  EXPECT_EQ(0u, uncached.stats().cache_hits);
+  EXPECT_EQ(configurations.size() - 1, memoized.stats().cache_hits);
+  EXPECT_EQ(uncached.stats().group_collision_rejections, 2 * memoized.stats().group_collision_rejections);
+
+  // Configurations within the resolution share a result
+  EXPECT_TRUE(memoized.isValid(state, {FREE[0] + 2e-5, FREE[1] - 2e-5, FREE[2]}, true));
+  EXPECT_EQ(configurations.size(), memoized.stats().cache_hits);
+
+  memoized.clearCache();
+  EXPECT_TRUE(memoized.isValid(state, FREE, true));
+  EXPECT_EQ(configurations.size(), memoized.stats().cache_hits);
+}
+
+TEST(ValidityChecker, memoClearsWhenFull)
+{
+  ValidityCheckerParameters params;
+  params.cache_capacity = 2;
+  ValidityChecker checker(makeRobotModel(), "arm", params);
+  moveit::core::RobotState state = checker.makeState();
+
+  const std::vector<double> a = {1.5, 0.0, 0.0};
+  const std::vector<double> b = {1.5, 0.5, 0.0};
+  const std::vector<double> c = {1.5, 0.5, 0.5};
+  EXPECT_TRUE(checker.isValid(state, a, true));
+  EXPECT_TRUE(checker.isValid(state, b, true));
+  EXPECT_TRUE(checker.isValid(state, a, true));
+  EXPECT_EQ(1u, checker.stats().cache_hits);
+
+  // The third result does not fit: the memo starts over with only c
+  EXPECT_TRUE(checker.isValid(state, c, true));
+  EXPECT_TRUE(checker.isValid(state, c, true));
+  EXPECT_EQ(2u, checker.stats().cache_hits);
+  EXPECT_TRUE(checker.isValid(state, a, true));
+  EXPECT_TRUE(checker.isValid(state, b, true));
+  EXPECT_EQ(2u, checker.stats().cache_hits);
+}
+
+/* Descartes model whose IK returns a fixed list of configurations per pose; pose i is the one at
+ * x = i. Joint limits and collisions are left to the checker. */
+class TableModel : public descartes_core::RobotModel, public godel_utils::BatchIkSolver
+{
+public:
+  explicit TableModel(const std::vector<Solutions>& table) : table_(table) {}
+
+  virtual bool getAllIK(const Eigen::Affine3d& pose, Solutions& joint_poses) const
+  {
+    joint_poses = table_[static_cast<std::size_t>(std::lround(pose.translation().x()))];
+    return !joint_poses.empty();
+  }
+
+  virtual bool getAllIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses, std::vector<double>& joints,
+                             std::vector<std::size_t>& offsets) const
+  {
+    joints.clear();
+    offsets.assign(1, 0);
+    bool all_solved = true;
+    Solutions sols;
+    for (std::size_t i = 0; i < n_poses; ++i)
+    {
+      all_solved &= getAllIK(poses[i], sols);
+      for (const auto& sol : sols)
+      {
+        joints.insert(joints.end(), sol.begin(), sol.end());
+      }
+      offsets.push_back(joints.size() / 3);
+    }
+    return all_solved;
+  }
+
+  virtual bool getIK(const Eigen::Affine3d&, const std::vector<double>&, std::vector<double>&) const { return false; }
+  virtual bool getFK(const std::vector<double>&, Eigen::Affine3d&) const { return false; }
+  virtual int getDOF() const { return 3; }
+  virtual bool isValid(const std::vector<double>&) const { return true; }
+  virtual bool isValid(const Eigen::Affine3d&) const { return true; }
+  virtual bool initialize(const std::string&, const std::string&, const std::string&, const std::string&)
+  {
+    return true;
+  }
+  virtual bool isValidMove(const double*, const double*, double) const { return true; }
+  virtual std::vector<double> getJointVelocityLimits() const { return std::vector<double>(3, 1.0); }
+
+private:
+  std::vector<Solutions> table_;
+};
+
+TEST(ValidityChecker, batchCompactionKeepsOffsets)
+{
+  const std::vector<double> free2 = {1.5, 0.5, 0.0};
+  const std::vector<double> free3 = {-1.0, 1.0, 0.0};
+  const std::vector<Solutions> table = {{FREE, ENVIRONMENT_COLLISION, free2},
+                                        {OUT_OF_LIMITS},
+                                        {GROUP_COLLISION, free3},
+                                        {}};
+  auto table_model = boost::make_shared<TableModel>(table);
+  table_model->setCheckCollisions(true);
+  ValidityCheckedRobotModel model(table_model, std::make_shared<ValidityChecker>(makeRobotModel(), "arm"));
+  // Collisions are checked by the decorator only
+  EXPECT_TRUE(model.getCheckCollisions());
+  EXPECT_FALSE(table_model->getCheckCollisions());
+
+  std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > poses;
+  for (int i = 0; i < 4; ++i)
+  {
+    poses.push_back(Eigen::Affine3d(Eigen::Translation3d(i, 0.0, 0.0)));
+  }
+
+  std::vector<double> joints;
+  std::vector<std::size_t> offsets;
+  EXPECT_FALSE(model.getAllIKBatch(poses.data(), poses.size(), joints, offsets));
+  ASSERT_EQ(5u, offsets.size());
+  EXPECT_EQ(0u, offsets[0]);
+  EXPECT_EQ(2u, offsets[1]);
+  EXPECT_EQ(2u, offsets[2]);
+  EXPECT_EQ(3u, offsets[3]);
+  EXPECT_EQ(3u, offsets[4]);
+  ASSERT_EQ(9u, joints.size());
+  EXPECT_EQ(FREE, std::vector<double>(joints.begin(), joints.begin() + 3));
+  EXPECT_EQ(free2, std::vector<double>(joints.begin() + 3, joints.begin() + 6));
+  EXPECT_EQ(free3, std::vector<double>(joints.begin() + 6, joints.end()));
+
+  // Same solutions as the per-pose path
+  for (std::size_t i = 0; i < poses.size(); ++i)
+  {
+    Solutions sols;
+    EXPECT_EQ(offsets[i + 1] > offsets[i], model.getAllIK(poses[i], sols));
+    ASSERT_EQ(offsets[i + 1] - offsets[i], sols.size());
+    for (std::size_t s = 0; s < sols.size(); ++s)
+    {
+      EXPECT_EQ(sols[s], std::vector<double>(joints.begin() + (offsets[i] + s) * 3,
+                                             joints.begin() + (offsets[i] + s + 1) * 3));
+    }
+  }
+
+  // All poses solvable once the unsolvable ones are left out
+  poses = {poses[0], poses[2]};
+  EXPECT_TRUE(model.getAllIKBatch(poses.data(), poses.size(), joints, offsets));
+  EXPECT_EQ(3u, offsets.back());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
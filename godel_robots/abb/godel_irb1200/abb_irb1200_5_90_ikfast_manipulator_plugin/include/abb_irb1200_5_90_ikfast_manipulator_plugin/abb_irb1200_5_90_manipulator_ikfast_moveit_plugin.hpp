@@ -60,7 +60,7 @@ enum SEARCH_MODE
   OPTIMIZE_MAX_JOINT = 2
 };
 
-namespace ikfast_kinematics_plugin
+namespace abb_irb1200_5_90_ikfast_manipulator_plugin
 {
 #define IKFAST_NO_MAIN  // Don't include main() from IKFast
 
@@ -137,10 +137,11 @@ enum IkParameterizationType
 };
 
 // Code generated by IKFast56/61
-#include "abb_irb1200_5_90_manipulator_ikfast_solver.cpp"
+#include "abb_irb1200_5_90_ikfast_manipulator_plugin/abb_irb1200_5_90_manipulator_ikfast_solver.hpp"
 
 class IKFastKinematicsPlugin : public kinematics::KinematicsBase
 {
+protected:
   std::vector<std::string> joint_names_;
   std::vector<double> joint_min_vector_;
   std::vector<double> joint_max_vector_;
@@ -285,7 +286,7 @@ public:
    */
   bool setRedundantJoints(const std::vector<unsigned int>& redundant_joint_indices);
 
-private:
+protected:
   bool initialize(const std::string& robot_description, const std::string& group_name, const std::string& base_name,
                   const std::string& tip_name, double search_discretization);
 
@@ -1257,7 +1258,3 @@ bool IKFastKinematicsPlugin::sampleRedundantJoint(kinematics::DiscretizationMeth
 }
 
 }  // end namespace
-
-// register IKFastKinematicsPlugin as a KinematicsBase implementation
-#include <pluginlib/class_list_macros.h>
-PLUGINLIB_EXPORT_CLASS(ikfast_kinematics_plugin::IKFastKinematicsPlugin, kinematics::KinematicsBase);
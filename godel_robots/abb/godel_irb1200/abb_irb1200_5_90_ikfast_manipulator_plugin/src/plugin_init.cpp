@@ -0,0 +1,6 @@
+
+// register IKFastKinematicsPlugin as a KinematicsBase implementation
+#include <abb_irb1200_5_90_ikfast_manipulator_plugin/abb_irb1200_5_90_manipulator_ikfast_moveit_plugin.hpp>
+#include <pluginlib/class_list_macros.h>
+PLUGINLIB_EXPORT_CLASS(abb_irb1200_5_90_ikfast_manipulator_plugin::IKFastKinematicsPlugin,
+                       kinematics::KinematicsBase);
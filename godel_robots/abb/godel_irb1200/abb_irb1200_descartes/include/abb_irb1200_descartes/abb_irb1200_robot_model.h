@@ -0,0 +1,67 @@
+/*
+  Copyright Feb, 2015 Southwest Research Institute
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+          http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef ABB_IRB1200_ROBOT_MODEL_H
+#define ABB_IRB1200_ROBOT_MODEL_H
+
+#include <descartes_moveit/moveit_state_adapter.h>
+#include <godel_utils/batch_ik_solver.h>
+#include <godel_utils/ikfast_batch.h>
+#include <abb_irb1200_5_90_ikfast_manipulator_plugin/abb_irb1200_5_90_manipulator_ikfast_moveit_plugin.hpp>
+
+namespace abb_irb1200_descartes
+{
+class AbbIrb1200RobotModel : public descartes_moveit::MoveitStateAdapter,
+                             public abb_irb1200_5_90_ikfast_manipulator_plugin::IKFastKinematicsPlugin,
+                             public godel_utils::BatchIkSolver
+{
+public:
+  AbbIrb1200RobotModel();
+
+  virtual bool initialize(const std::string& robot_description, const std::string& group_name,
+                          const std::string& world_frame, const std::string& tcp_frame);
+
+  virtual bool getAllIK(const Eigen::Affine3d& pose,
+                        std::vector<std::vector<double> >& joint_poses) const;
+
+  /**
+   * @brief Batched form of getAllIK; see godel_utils::solveIKBatch
+   */
+  virtual bool getAllIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses, std::vector<double>& joints,
+                             std::vector<std::size_t>& offsets) const;
+
+  virtual descartes_core::RobotModelPtr clone() const
+  {
+    descartes_core::RobotModelPtr ptr(new AbbIrb1200RobotModel());
+    ptr->initialize("robot_description", descartes_moveit::MoveitStateAdapter::group_name_,
+                    world_frame_, tool_frame_);
+    return ptr;
+  }
+
+protected:
+  /**
+   * @brief Appends every IKFast solution of 'pose' to 'raw' (DOF values per solution). No validity
+   * checks are applied.
+   */
+  void appendSolutions(const Eigen::Affine3d& pose, std::vector<double>& raw) const;
+
+  descartes_core::Frame world_to_base_; // world to arm base
+  descartes_core::Frame tool_to_tip_;   // from urdf tool to arm tool
+  godel_utils::IkFastChain chain_;       // joint limits and the wrapping joint 6
+};
+}
+
+#endif // ABB_IRB1200_ROBOT_MODEL_H
@@ -0,0 +1,117 @@
+/*
+  Copyright Feb, 2015 Southwest Research Institute
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+          http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <abb_irb1200_descartes/abb_irb1200_robot_model.h>
+#include <eigen_conversions/eigen_kdl.h>
+#include <pluginlib/class_list_macros.h>
+
+static const std::string ABB_IRB1200_BASE_LINK = "base_link";
+static const std::string ABB_IRB1200_TOOL_LINK = "tool0";
+static const double JOINT_LIMIT_TOLERANCE = .0000001f;
+
+using namespace descartes_moveit;
+using namespace abb_irb1200_5_90_ikfast_manipulator_plugin;
+
+namespace abb_irb1200_descartes
+{
+AbbIrb1200RobotModel::AbbIrb1200RobotModel()
+    : world_to_base_(Eigen::Affine3d::Identity()), tool_to_tip_(Eigen::Affine3d::Identity())
+{
+}
+
+bool AbbIrb1200RobotModel::initialize(const std::string& robot_description,
+                                      const std::string& group_name, const std::string& world_frame,
+                                      const std::string& tcp_frame)
+{
+  MoveitStateAdapter::initialize(robot_description, group_name, world_frame, tcp_frame);
+  abb_irb1200_5_90_ikfast_manipulator_plugin::IKFastKinematicsPlugin::initialize(
+      robot_description, group_name, ABB_IRB1200_BASE_LINK, ABB_IRB1200_TOOL_LINK, 0.001);
+
+  chain_.dof = num_joints_;
+  chain_.wrap_joint = 5;
+  chain_.has_limits = joint_has_limits_vector_;
+  chain_.lower.resize(num_joints_);
+  chain_.upper.resize(num_joints_);
+  for (std::size_t j = 0; j < num_joints_; ++j)
+  {
+    chain_.lower[j] = joint_min_vector_[j] - JOINT_LIMIT_TOLERANCE;
+    chain_.upper[j] = joint_max_vector_[j] + JOINT_LIMIT_TOLERANCE;
+  }
+
+  // initialize world transformations
+  if (tcp_frame != getTipFrame())
+  {
+    tool_to_tip_ = descartes_core::Frame(robot_state_->getFrameTransform(tcp_frame).inverse() *
+                                         robot_state_->getFrameTransform(getTipFrame()));
+  }
+
+  if (world_frame != getBaseFrame())
+  {
+    world_to_base_ = descartes_core::Frame(world_to_root_.frame *
+                                           robot_state_->getFrameTransform(getBaseFrame()));
+  }
+
+  return true;
+}
+
+bool AbbIrb1200RobotModel::getAllIK(const Eigen::Affine3d& pose,
+                                    std::vector<std::vector<double> >& joint_poses) const
+{
+  std::vector<double> joints;
+  std::vector<std::size_t> offsets;
+  getAllIKBatch(&pose, 1, joints, offsets);
+
+  joint_poses.clear();
+  for (std::size_t s = 0; s < offsets[1]; ++s)
+  {
+    joint_poses.push_back(std::vector<double>(joints.begin() + s * num_joints_,
+                                              joints.begin() + (s + 1) * num_joints_));
+  }
+
+  return !joint_poses.empty();
+}
+
+void AbbIrb1200RobotModel::appendSolutions(const Eigen::Affine3d& pose, std::vector<double>& raw) const
+{
+  std::vector<double> vfree(free_params_.size(), 0.0);
+  KDL::Frame frame;
+  Eigen::Affine3d tool_pose = world_to_base_.frame_inv * pose * tool_to_tip_.frame;
+  tf::transformEigenToKDL(tool_pose, frame);
+
+  ikfast::IkSolutionList<IkReal> solutions;
+
+  int numsol = solve(frame, vfree, solutions);
+
+  std::vector<double> sol;
+  for (int s = 0; s < numsol; ++s)
+  {
+    getSolution(solutions, s, sol);
+    raw.insert(raw.end(), sol.begin(), sol.end());
+  }
+}
+
+bool AbbIrb1200RobotModel::getAllIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses,
+                                         std::vector<double>& joints, std::vector<std::size_t>& offsets) const
+{
+  return godel_utils::solveIKBatch(
+      poses, n_poses, chain_,
+      [this](const Eigen::Affine3d& pose, std::vector<double>& raw) { appendSolutions(pose, raw); },
+      [this](const std::vector<double>& sol) { return isValid(sol); }, joints, offsets);
+}
+
+}
+
+PLUGINLIB_EXPORT_CLASS(abb_irb1200_descartes::AbbIrb1200RobotModel, descartes_core::RobotModel)
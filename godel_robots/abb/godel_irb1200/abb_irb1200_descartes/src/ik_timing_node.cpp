@@ -0,0 +1,105 @@
+/*
+ * Compares the getAllIK timing of two Descartes robot model plugins on the same random, reachable
+ * tool poses. Poses are generated by forward kinematics of random valid joint states, so every
+ * pose has at least one solution.
+ */
+
+#include <random>
+
+#include <descartes_core/robot_model.h>
+#include <pluginlib/class_loader.h>
+#include <ros/ros.h>
+
+struct TimingResult
+{
+  double seconds;
+  std::size_t solved;
+  std::size_t solutions;
+};
+
+static TimingResult timeGetAllIK(const descartes_core::RobotModel& model,
+                                 const std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> >& poses)
+{
+  TimingResult result = {0.0, 0, 0};
+  std::vector<std::vector<double> > solutions;
+
+  ros::WallTime start = ros::WallTime::now();
+  for (const auto& pose : poses)
+  {
+    if (model.getAllIK(pose, solutions))
+    {
+      ++result.solved;
+      result.solutions += solutions.size();
+    }
+  }
+  result.seconds = (ros::WallTime::now() - start).toSec();
+  return result;
+}
+
+static void report(const std::string& name, const TimingResult& result, std::size_t n_poses)
+{
+  ROS_INFO("%s: %f s total, %f ms per pose, %lu/%lu poses solved, %f solutions per pose", name.c_str(),
+           result.seconds, 1000.0 * result.seconds / n_poses, result.solved, n_poses,
+           result.solved ? static_cast<double>(result.solutions) / result.solved : 0.0);
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "ik_timing");
+  ros::NodeHandle pnh("~");
+
+  std::string group, world_frame, tcp_frame, plugin, reference_plugin;
+  int samples, seed;
+  pnh.param<std::string>("group", group, "manipulator");
+  pnh.param<std::string>("world_frame", world_frame, "base_link");
+  pnh.param<std::string>("tcp_frame", tcp_frame, "tool0");
+  pnh.param<std::string>("plugin", plugin, "abb_irb1200_descartes/AbbIrb1200RobotModel");
+  pnh.param<std::string>("reference_plugin", reference_plugin, "descartes_moveit/MoveitStateAdapter");
+  pnh.param<int>("samples", samples, 1000);
+  pnh.param<int>("seed", seed, 0);
+
+  pluginlib::ClassLoader<descartes_core::RobotModel> loader("descartes_core", "descartes_core::RobotModel");
+  descartes_core::RobotModelPtr model, reference;
+  try
+  {
+    model = loader.createInstance(plugin);
+    reference = loader.createInstance(reference_plugin);
+  }
+  catch (const pluginlib::PluginlibException& ex)
+  {
+    ROS_ERROR("Could not load robot model plugin: %s", ex.what());
+    return 1;
+  }
+
+  if (!model->initialize("robot_description", group, world_frame, tcp_frame) ||
+      !reference->initialize("robot_description", group, world_frame, tcp_frame))
+  {
+    ROS_ERROR("Could not initialize robot models for group '%s'", group.c_str());
+    return 1;
+  }
+  model->setCheckCollisions(false);
+  reference->setCheckCollisions(false);
+
+  // Random valid joint states; MoveitStateAdapter::isValid checks the joint limits
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > poses;
+  std::vector<double> joints(reference->getDOF());
+  while (poses.size() < static_cast<std::size_t>(samples))
+  {
+    for (auto& joint : joints)
+    {
+      joint = angle(rng);
+    }
+
+    Eigen::Affine3d pose;
+    if (reference->isValid(joints) && reference->getFK(joints, pose))
+    {
+      poses.push_back(pose);
+    }
+  }
+
+  report(reference_plugin, timeGetAllIK(*reference, poses), poses.size());
+  report(plugin, timeGetAllIK(*model, poses), poses.size());
+  return 0;
+}
@@ -18,12 +18,15 @@
 #define ABB_IRB2400_ROBOT_MODEL_H
 
 #include <descartes_moveit/moveit_state_adapter.h>
+#include <godel_utils/batch_ik_solver.h>
+#include <godel_utils/ikfast_batch.h>
 #include <irb2400_ikfast_manipulator_plugin/abb_irb2400_manipulator_ikfast_moveit_plugin.hpp>
 
 namespace abb_irb2400_descartes
 {
 class AbbIrb2400RobotModel : public descartes_moveit::MoveitStateAdapter,
-                             public irb2400_ikfast_manipulator_plugin::IKFastKinematicsPlugin
+                             public irb2400_ikfast_manipulator_plugin::IKFastKinematicsPlugin,
+                             public godel_utils::BatchIkSolver
 {
 public:
   AbbIrb2400RobotModel();
@@ -34,6 +37,12 @@ public:
   virtual bool getAllIK(const Eigen::Affine3d& pose,
                         std::vector<std::vector<double> >& joint_poses) const;
 
+  /**
+   * @brief Batched form of getAllIK; see godel_utils::solveIKBatch
+   */
+  virtual bool getAllIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses, std::vector<double>& joints,
+                             std::vector<std::size_t>& offsets) const;
+
   virtual descartes_core::RobotModelPtr clone() const
   {
     descartes_core::RobotModelPtr ptr(new AbbIrb2400RobotModel());
@@ -43,9 +52,16 @@ public:
   }
 
 protected:
+  /**
+   * @brief Appends every IKFast solution of 'pose' to 'raw' (DOF values per solution). No validity
+   * checks are applied.
+   */
+  void appendSolutions(const Eigen::Affine3d& pose, std::vector<double>& raw) const;
+
   descartes_core::Frame world_to_base_; // world to arm base
   descartes_core::Frame tool_to_tip_;   // from urdf tool to arm tool
+  godel_utils::IkFastChain chain_;       // joint limits and the wrapping joint 6
 };
 }
 
-#endif // MOTOMAN_SIA20D_ROBOT_MODEL
+#endif // ABB_IRB2400_ROBOT_MODEL_H
@@ -40,6 +40,17 @@ bool AbbIrb2400RobotModel::initialize(const std::string& robot_description,
   irb2400_ikfast_manipulator_plugin::IKFastKinematicsPlugin::initialize(
       robot_description, group_name, MOTOMAN_SIA20D_BASE_LINK, MOTOMAN_SIA20D_TOOL_LINK, 0.001);
 
+  chain_.dof = num_joints_;
+  chain_.wrap_joint = 5;
+  chain_.has_limits = joint_has_limits_vector_;
+  chain_.lower.resize(num_joints_);
+  chain_.upper.resize(num_joints_);
+  for (std::size_t j = 0; j < num_joints_; ++j)
+  {
+    chain_.lower[j] = joint_min_vector_[j] - JOINT_LIMIT_TOLERANCE;
+    chain_.upper[j] = joint_max_vector_[j] + JOINT_LIMIT_TOLERANCE;
+  }
+
   // initialize world transformations
   if (tcp_frame != getTipFrame())
   {
@@ -58,6 +69,22 @@ bool AbbIrb2400RobotModel::initialize(const std::string& robot_description,
 
 bool AbbIrb2400RobotModel::getAllIK(const Eigen::Affine3d& pose,
                                     std::vector<std::vector<double> >& joint_poses) const
+{
+  std::vector<double> joints;
+  std::vector<std::size_t> offsets;
+  getAllIKBatch(&pose, 1, joints, offsets);
+
+  joint_poses.clear();
+  for (std::size_t s = 0; s < offsets[1]; ++s)
+  {
+    joint_poses.push_back(std::vector<double>(joints.begin() + s * num_joints_,
+                                              joints.begin() + (s + 1) * num_joints_));
+  }
+
+  return !joint_poses.empty();
+}
+
+void AbbIrb2400RobotModel::appendSolutions(const Eigen::Affine3d& pose, std::vector<double>& raw) const
 {
   std::vector<double> vfree(free_params_.size(), 0.0);
   KDL::Frame frame;
@@ -68,35 +95,21 @@ bool AbbIrb2400RobotModel::getAllIK(const Eigen::Affine3d& pose,
 
   int numsol = solve(frame, vfree, solutions);
 
-  joint_poses.clear();
-
-  if (numsol)
+  std::vector<double> sol;
+  for (int s = 0; s < numsol; ++s)
   {
-    for (int s = 0; s < numsol; ++s)
-    {
-      std::vector<double> sol;
-      getSolution(solutions, s, sol);
-
-      if (isValid(sol))
-        joint_poses.push_back(sol);
-
-      // So, IKFast returns the unique configurations of the robot (e.g. elbow up, wrist down)
-      // and the solutions have joint values between -pi and +pi. If the robot can rotate more
-      // than this, then we need to check to see if we have extra solutions that have the same
-      // configuration but a different joint position. In our case, joint 6 has this kind of
-      // extra motion, so here we check for valid solutions 360 degrees from each solution.
-      sol[5] += 2 * M_PI;
-      if (isValid(sol))
-        joint_poses.push_back(sol);
-
-      sol[5] -= 2 * 2 * M_PI;
-      if (isValid(sol))
-        joint_poses.push_back(sol);
-
-    }
+    getSolution(solutions, s, sol);
+    raw.insert(raw.end(), sol.begin(), sol.end());
   }
+}
 
-  return !joint_poses.empty();
+bool AbbIrb2400RobotModel::getAllIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses,
+                                         std::vector<double>& joints, std::vector<std::size_t>& offsets) const
+{
+  return godel_utils::solveIKBatch(
+      poses, n_poses, chain_,
+      [this](const Eigen::Affine3d& pose, std::vector<double>& raw) { appendSolutions(pose, raw); },
+      [this](const std::vector<double>& sol) { return isValid(sol); }, joints, offsets);
 }
 
 }
@@ -37,6 +37,7 @@
 #include <godel_msgs/PathPlanning.h>
 #include <godel_msgs/PathPlanningParameters.h>
 
+#include <godel_msgs/BatchProcessPlanningAction.h>
 #include <godel_msgs/ProcessExecutionAction.h>
 #include <godel_msgs/ProcessPlanningAction.h>
 #include <godel_msgs/SelectMotionPlanAction.h>
@@ -135,6 +136,15 @@ private:
   godel_surface_detection::TrajectoryLibrary
   generateMotionLibrary(const godel_msgs::PathPlanningParameters& params);
 
+  // Plans all 'paths' with one batch planning goal, one result per path; false if the batch
+  // planner is not available. 'seeds' holds a previous plan per path to warm start from (or an
+  // empty plan).
+  bool generateProcessPlans(const std::vector<const ProcessPathResult::value_type*>& paths,
+                            const godel_msgs::BlendingPlanParameters& params,
+                            const godel_msgs::ScanPlanParameters& scan_params,
+                            const std::vector<godel_msgs::ProcessPlan>& seeds,
+                            std::vector<ProcessPlanResult>& plans);
+
 
   bool generateProcessPath(const int& id, ProcessPathResult& result);
 
@@ -163,7 +173,8 @@ private:
   ProcessPlanResult generateProcessPlan(const std::string& name,
                                         const std::vector<geometry_msgs::PoseArray> &path,
                                         const godel_msgs::BlendingPlanParameters& params,
-                                        const godel_msgs::ScanPlanParameters& scan_params);
+                                        const godel_msgs::ScanPlanParameters& scan_params,
+                                        const godel_msgs::ProcessPlan& seed_plan);
 
 
   bool getMotionPlansCallback(godel_msgs::GetAvailableMotionPlans::Request& req,
@@ -211,6 +222,7 @@ private:
   // Actions subscribed to by this class
   actionlib::SimpleActionClient<godel_msgs::ProcessExecutionAction> blend_exe_client_;
   actionlib::SimpleActionClient<godel_msgs::ProcessExecutionAction> scan_exe_client_;
+  actionlib::SimpleActionClient<godel_msgs::BatchProcessPlanningAction> batch_planning_client_;
 
   // Current state publishers
   ros::Publisher selected_surf_changed_pub_;
@@ -258,6 +270,8 @@ private:
   sensor_msgs::PointCloud2 region_cloud_msg_;
 
   godel_surface_detection::TrajectoryLibrary trajectory_library_;
+  // Execution order of the plans in trajectory_library_, as sequenced by generateMotionLibrary
+  std::vector<std::string> motion_plan_order_;
   int marker_counter_;
 
   // Parameter loading and saving
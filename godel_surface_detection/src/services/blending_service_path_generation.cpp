@@ -9,9 +9,14 @@
 #include <segmentation/surface_segmentation.h>
 #include <eigen_conversions/eigen_msg.h>
 #include <path_planning_plugins_base/path_planning_base.h>
+#include <godel_process_path_generation/sequence_optimizer.h>
 
 #include <swri_profiler/profiler.h>
 
+#include <atomic>
+#include <sstream>
+#include <thread>
+
 // Temporary constants for storing blending path `planning parameters
 // Will be replaced by loadable, savable parameters
 const static std::string BLEND_TRAJECTORY_BAGFILE = "blend_trajectory.bag";
@@ -52,6 +57,10 @@ const static std::string BLENDING_SPD_PARAM = PARAM_BASE + BLEND_PARAM_BASE + "b
 const static std::string RETRACT_SPD_PARAM = PARAM_BASE + BLEND_PARAM_BASE + "retract_speed";
 const static std::string TRAVERSE_SPD_PARAM = PARAM_BASE + BLEND_PARAM_BASE + "traverse_speed";
 const static std::string Z_ADJUST_PARAM = PARAM_BASE + BLEND_PARAM_BASE + "z_adjust";
+const static std::string PLANNING_MODE_PARAM = PARAM_BASE + BLEND_PARAM_BASE + "planning_mode";
+const static std::string OPTIMIZE_SEQUENCE_PARAM = PARAM_BASE + "optimize_sequence";
+const static std::string PLANNING_CONCURRENCY_PARAM = PARAM_BASE + "planning_concurrency";
+const static std::string WARM_START_PARAM = PARAM_BASE + "warm_start";
 
 const static std::string APPROACH_DISTANCE_PARAM = PARAM_BASE + SCAN_PARAM_BASE + "approach_distance";
 const static std::string QUALITY_METRIC_PARAM = PARAM_BASE + SCAN_PARAM_BASE + "quality_metric";
@@ -316,6 +325,98 @@ SurfaceBlendingService::generateProcessPath(const int& id,
   return result.paths.size() > 0;
 }
 
+static Eigen::Vector3d toEigen(const geometry_msgs::Pose& pose)
+{
+  return Eigen::Vector3d(pose.position.x, pose.position.y, pose.position.z);
+}
+
+/**
+ * Reorders (and where worthwhile reverses) the segments of a multi-segment blend path
+ */
+static void sequenceSegments(std::vector<geometry_msgs::PoseArray>& segments,
+                             const godel_process_path::sequencing::TravelCostParameters& cost_params)
+{
+  using namespace godel_process_path::sequencing;
+
+  std::vector<SequenceItem> items(segments.size());
+  for (std::size_t i = 0; i < segments.size(); ++i)
+  {
+    if (segments[i].poses.empty())
+      return;
+    const Eigen::Vector3d first = toEigen(segments[i].poses.front());
+    const Eigen::Vector3d last = toEigen(segments[i].poses.back());
+    items[i].options.push_back(EntryOption(first, last));
+    items[i].options.push_back(EntryOption(last, first));
+  }
+
+  SequenceResult result = SequenceOptimizer(cost_params).solve(items);
+  if (result.steps.size() != segments.size())
+    return;
+
+  std::vector<geometry_msgs::PoseArray> ordered;
+  for (const auto& step : result.steps)
+  {
+    ordered.push_back(segments[step.item]);
+    if (step.option == 1)
+      std::reverse(ordered.back().poses.begin(), ordered.back().poses.end());
+  }
+  segments.swap(ordered);
+
+  ROS_INFO("Sequenced %lu blend segments: estimated travel time %.2f s -> %.2f s",
+           segments.size(), result.initial_cost, result.cost);
+}
+
+/**
+ * Orders the surfaces so that the tool travels as little as possible between the end of one
+ * surface's paths and the start of the next. Paths within a surface keep their order.
+ */
+static void sequenceSurfaces(std::vector<ProcessPathResult>& surfaces,
+                             const godel_process_path::sequencing::TravelCostParameters& cost_params)
+{
+  using namespace godel_process_path::sequencing;
+
+  for (auto& surface : surfaces)
+  {
+    for (auto& path : surface.paths)
+    {
+      if (isBlendingPath(path.first) && path.second.size() > 1)
+        sequenceSegments(path.second, cost_params);
+    }
+  }
+
+  if (surfaces.size() < 2)
+    return;
+
+  std::vector<SequenceItem> items(surfaces.size());
+  for (std::size_t i = 0; i < surfaces.size(); ++i)
+  {
+    const std::vector<geometry_msgs::PoseArray>& first = surfaces[i].paths.front().second;
+    const std::vector<geometry_msgs::PoseArray>& last = surfaces[i].paths.back().second;
+    if (first.empty() || first.front().poses.empty() || last.empty() || last.back().poses.empty())
+    {
+      ROS_WARN("Empty process path found, surfaces will be planned in selection order");
+      return;
+    }
+    items[i].options.push_back(EntryOption(toEigen(first.front().poses.front()),
+                                           toEigen(last.back().poses.back())));
+  }
+
+  SequenceResult result = SequenceOptimizer(cost_params).solve(items);
+  if (result.steps.size() != surfaces.size())
+  {
+    ROS_WARN("Could not sequence surfaces, they will be planned in selection order");
+    return;
+  }
+
+  std::vector<ProcessPathResult> ordered;
+  for (const auto& step : result.steps)
+    ordered.push_back(surfaces[step.item]);
+  surfaces.swap(ordered);
+
+  ROS_INFO("Sequenced %lu surfaces: estimated travel time %.2f s -> %.2f s (%.2f s saved)",
+           surfaces.size(), result.initial_cost, result.cost, result.initial_cost - result.cost);
+}
+
 godel_surface_detection::TrajectoryLibrary SurfaceBlendingService::generateMotionLibrary(
     const godel_msgs::PathPlanningParameters& params)
 {
@@ -328,7 +429,10 @@ godel_surface_detection::TrajectoryLibrary SurfaceBlendingService::generateMotio
   process_path_results_.blend_poses_.clear();
   process_path_results_.edge_poses_.clear();
   process_path_results_.scan_poses_.clear();
+  motion_plan_order_.clear();
 
+  // Generate the paths of every surface up front so that they can be sequenced before planning
+  std::vector<ProcessPathResult> surface_paths;
   for (const auto& id : selected_ids)
   {
     // Generate motion plan
@@ -339,7 +443,56 @@ godel_surface_detection::TrajectoryLibrary SurfaceBlendingService::generateMotio
     if(paths.paths.size() == 0)
       continue;
 
-    // Add new path to result
+    surface_paths.push_back(paths);
+  }
+
+  ros::NodeHandle nh;
+
+  godel_msgs::BlendingPlanParameters blend_params;
+  blend_params.margin = params.margin;
+  blend_params.overlap = params.overlap;
+  blend_params.tool_radius = params.tool_radius;
+  blend_params.discretization = params.discretization;
+  blend_params.safe_traverse_height = params.traverse_height;
+  nh.getParam(SPINDLE_SPEED_PARAM, blend_params.spindle_speed);
+  nh.getParam(APPROACH_SPD_PARAM, blend_params.approach_spd);
+  nh.getParam(BLENDING_SPD_PARAM, blend_params.blending_spd);
+  nh.getParam(RETRACT_SPD_PARAM, blend_params.retract_spd);
+  nh.getParam(TRAVERSE_SPD_PARAM, blend_params.traverse_spd);
+  nh.getParam(Z_ADJUST_PARAM, blend_params.z_adjust);
+  nh.getParam(PLANNING_MODE_PARAM, blend_params.planning_mode);
+
+  godel_msgs::ScanPlanParameters scan_params;
+  scan_params.scan_width = params.scan_width;
+  scan_params.margin = params.margin;
+  scan_params.overlap = params.overlap;
+  scan_params.scan_width = params.scan_width;
+  nh.getParam(APPROACH_DISTANCE_PARAM, scan_params.approach_distance);
+  nh.getParam(TRAVERSE_SPD_PARAM, scan_params.traverse_spd);
+  nh.getParam(QUALITY_METRIC_PARAM, scan_params.quality_metric);
+  nh.getParam(WINDOW_WIDTH_PARAM, scan_params.window_width);
+  nh.getParam(MIN_QA_VALUE_PARAM, scan_params.min_qa_value);
+  nh.getParam(MAX_QA_VALUE_PARAM, scan_params.min_qa_value);
+//  nh.getParam(Z_ADJUST_PARAM, scan_params.z_adjust);
+  scan_params.z_adjust = 0.0; // Until we fix these parameters and do not share them among the
+                              // different processes, I'm only applying this to blend paths.
+
+  bool optimize_sequence = true;
+  nh.param(OPTIMIZE_SEQUENCE_PARAM, optimize_sequence, true);
+  if (optimize_sequence)
+  {
+    SWRI_PROFILE("sequencing");
+    godel_process_path::sequencing::TravelCostParameters cost_params;
+    cost_params.traverse_height = blend_params.safe_traverse_height;
+    cost_params.traverse_speed = blend_params.traverse_spd;
+    cost_params.approach_speed = blend_params.approach_spd;
+    cost_params.retract_speed = blend_params.retract_spd;
+    sequenceSurfaces(surface_paths, cost_params);
+  }
+
+  // Add new paths to result, in the order they will be executed
+  for (const auto& paths : surface_paths)
+  {
     for(const auto& vt: paths.paths)
     {
       if(isBlendingPath(vt.first))
@@ -354,48 +507,74 @@ godel_surface_detection::TrajectoryLibrary SurfaceBlendingService::generateMotio
       else
         ROS_ERROR_STREAM("Tried to process an unrecognized path type: " << vt.first);
     }
+  }
 
-    ros::NodeHandle nh;
-
-    godel_msgs::BlendingPlanParameters blend_params;
-    blend_params.margin = params.margin;
-    blend_params.overlap = params.overlap;
-    blend_params.tool_radius = params.tool_radius;
-    blend_params.discretization = params.discretization;
-    blend_params.safe_traverse_height = params.traverse_height;
-    nh.getParam(SPINDLE_SPEED_PARAM, blend_params.spindle_speed);
-    nh.getParam(APPROACH_SPD_PARAM, blend_params.approach_spd);
-    nh.getParam(BLENDING_SPD_PARAM, blend_params.blending_spd);
-    nh.getParam(RETRACT_SPD_PARAM, blend_params.retract_spd);
-    nh.getParam(TRAVERSE_SPD_PARAM, blend_params.traverse_spd);
-    nh.getParam(Z_ADJUST_PARAM, blend_params.z_adjust);
-
-    godel_msgs::ScanPlanParameters scan_params;
-    scan_params.scan_width = params.scan_width;
-    scan_params.margin = params.margin;
-    scan_params.overlap = params.overlap;
-    scan_params.scan_width = params.scan_width;
-    nh.getParam(APPROACH_DISTANCE_PARAM, scan_params.approach_distance);
-    nh.getParam(TRAVERSE_SPD_PARAM, scan_params.traverse_spd);
-    nh.getParam(QUALITY_METRIC_PARAM, scan_params.quality_metric);
-    nh.getParam(WINDOW_WIDTH_PARAM, scan_params.window_width);
-    nh.getParam(MIN_QA_VALUE_PARAM, scan_params.min_qa_value);
-    nh.getParam(MAX_QA_VALUE_PARAM, scan_params.min_qa_value);
-//    nh.getParam(Z_ADJUST_PARAM, scan_params.z_adjust);
-    scan_params.z_adjust = 0.0; // Until we fix these parameters and do not share them among the
-                                // different processes, I'm only applying this to blend paths.
-
-    // Generate trajectory plans from motion plan
+  // Generate trajectory plans from motion plan. The paths are independent, so they are planned
+  // concurrently; the results are collected in sequence order.
+  std::vector<const ProcessPathResult::value_type*> jobs;
+  for (const auto& paths : surface_paths)
+  {
+    for (const auto& path : paths.paths)
     {
-      SWRI_PROFILE("motion-planning");
-      for (std::size_t j = 0; j < paths.paths.size(); ++j)
+      jobs.push_back(&path);
+    }
+  }
+
+  // Paths that were planned before (by name) are re-planned starting from their previous plan
+  bool warm_start = true;
+  nh.param(WARM_START_PARAM, warm_start, true);
+  std::vector<godel_msgs::ProcessPlan> seeds(jobs.size());
+  if (warm_start)
+  {
+    const godel_surface_detection::TrajectoryLibrary::TrajectoryMap& previous = trajectory_library_.get();
+    for (std::size_t i = 0; i < jobs.size(); ++i)
+    {
+      auto it = previous.find(jobs[i]->first);
+      if (it != previous.end())
       {
-        ProcessPlanResult plan = generateProcessPlan(paths.paths[j].first, paths.paths[j].second, blend_params,
-                                                     scan_params);
+        seeds[i] = it->second;
+      }
+    }
+  }
+
+  std::vector<ProcessPlanResult> plans;
+  if (!generateProcessPlans(jobs, blend_params, scan_params, seeds, plans))
+  {
+    ROS_WARN("Batch process planning is not available; planning each path with its own request");
+
+    int concurrency = 4;
+    nh.param(PLANNING_CONCURRENCY_PARAM, concurrency, 4);
+    concurrency = std::max(1, std::min(concurrency, static_cast<int>(jobs.size())));
 
-        for (std::size_t k = 0; k < plan.plans.size(); ++k)
-          lib.get()[plan.plans[k].first] = plan.plans[k].second;
+    plans.assign(jobs.size(), ProcessPlanResult());
+    SWRI_PROFILE("motion-planning");
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]()
+    {
+      for (std::size_t i = next++; i < jobs.size(); i = next++)
+      {
+        plans[i] = generateProcessPlan(jobs[i]->first, jobs[i]->second, blend_params, scan_params, seeds[i]);
       }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < concurrency; ++t)
+    {
+      workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers)
+    {
+      thread.join();
+    }
+  }
+
+  for (const auto& plan : plans)
+  {
+    for (std::size_t k = 0; k < plan.plans.size(); ++k)
+    {
+      lib.get()[plan.plans[k].first] = plan.plans[k].second;
+      motion_plan_order_.push_back(plan.plans[k].first);
     }
   }
 
@@ -403,11 +582,68 @@ godel_surface_detection::TrajectoryLibrary SurfaceBlendingService::generateMotio
 }
 
 
+bool SurfaceBlendingService::generateProcessPlans(const std::vector<const ProcessPathResult::value_type*>& paths,
+                                                  const godel_msgs::BlendingPlanParameters& params,
+                                                  const godel_msgs::ScanPlanParameters& scan_params,
+                                                  const std::vector<godel_msgs::ProcessPlan>& seeds,
+                                                  std::vector<ProcessPlanResult>& plans)
+{
+  if (!batch_planning_client_.isServerConnected() && !batch_planning_client_.waitForServer(ros::Duration(1.0)))
+  {
+    return false;
+  }
+
+  SWRI_PROFILE("motion-planning");
+  godel_msgs::BatchProcessPlanningGoal goal;
+  goal.blend_params = params;
+  goal.scan_params = scan_params;
+  for (std::size_t i = 0; i < paths.size(); ++i)
+  {
+    const auto* path = paths[i];
+    godel_msgs::NamedProcessPath named;
+    named.name = path->first;
+    named.type = isBlendingPath(path->first) || isEdgePath(path->first) ? named.BLEND_TYPE : named.SCAN_TYPE;
+    named.path.segments = path->second;
+    named.seed_plan = seeds[i];
+    goal.paths.push_back(named);
+  }
+
+  // Results arrive as feedback while the remaining paths are planned
+  auto feedback = [this](const godel_msgs::BatchProcessPlanningFeedbackConstPtr& fb)
+  {
+    std::ostringstream ss;
+    ss << (fb->succeeded ? "Planned " : "Failed to plan ") << fb->name << " (" << fb->completed << " of "
+       << fb->total << ")";
+    process_planning_feedback_.last_completed = ss.str();
+    process_planning_server_.publishFeedback(process_planning_feedback_);
+  };
+  typedef actionlib::SimpleActionClient<godel_msgs::BatchProcessPlanningAction> BatchClient;
+  batch_planning_client_.sendGoal(goal, BatchClient::SimpleDoneCallback(), BatchClient::SimpleActiveCallback(),
+                                  feedback);
+  batch_planning_client_.waitForResult();
+
+  godel_msgs::BatchProcessPlanningResultConstPtr result = batch_planning_client_.getResult();
+  plans.assign(paths.size(), ProcessPlanResult());
+  for (std::size_t i = 0; i < paths.size(); ++i)
+  {
+    if (result && i < result->succeeded.size() && result->succeeded[i])
+    {
+      plans[i].plans.push_back(ProcessPlanResult::value_type(paths[i]->first, result->plans[i]));
+    }
+    else
+    {
+      ROS_ERROR_STREAM("Failed to plan for: " << paths[i]->first);
+    }
+  }
+  return true;
+}
+
 ProcessPlanResult
 SurfaceBlendingService::generateProcessPlan(const std::string& name,
                                             const std::vector<geometry_msgs::PoseArray>& poses,
                                             const godel_msgs::BlendingPlanParameters& params,
-                                            const godel_msgs::ScanPlanParameters& scan_params)
+                                            const godel_msgs::ScanPlanParameters& scan_params,
+                                            const godel_msgs::ProcessPlan& seed_plan)
 {
   ProcessPlanResult result;
 
@@ -420,6 +656,7 @@ SurfaceBlendingService::generateProcessPlan(const std::string& name,
     godel_msgs::BlendProcessPlanning srv;
     srv.request.path.segments = poses;
     srv.request.params = params;
+    srv.request.seed_plan = seed_plan;
 
     success = blend_planning_client_.call(srv);
     process_plan = srv.response.plan;
@@ -429,6 +666,7 @@ SurfaceBlendingService::generateProcessPlan(const std::string& name,
     godel_msgs::BlendProcessPlanning srv;
     srv.request.path.segments = poses;
     srv.request.params = params;
+    srv.request.seed_plan = seed_plan;
 
     success = blend_planning_client_.call(srv);
     process_plan = srv.response.plan;
@@ -438,6 +676,7 @@ SurfaceBlendingService::generateProcessPlan(const std::string& name,
     godel_msgs::KeyenceProcessPlanning srv;
     srv.request.path.segments = poses;
     srv.request.params = scan_params;
+    srv.request.seed_plan = seed_plan;
 
     success = keyence_planning_client_.call(srv);
     process_plan = srv.response.plan;
@@ -66,11 +66,13 @@ const static std::string BLEND_EXE_ACTION_SERVER_NAME = "blend_process_execution
 const static std::string SCAN_EXE_ACTION_SERVER_NAME = "scan_process_execution_as";
 const static std::string PROCESS_PLANNING_ACTION_SERVER_NAME = "process_planning_as";
 const static std::string SELECT_MOTION_PLAN_ACTION_SERVER_NAME = "select_motion_plan_as";
+const static std::string BATCH_PLANNING_ACTION_SERVER_NAME = "batch_process_planning";
 const static int PROCESS_EXE_BUFFER = 5;  // Additional time [s] buffer between when blending should end and timeout
 
 SurfaceBlendingService::SurfaceBlendingService() : publish_region_point_cloud_(false), save_data_(false),
   blend_exe_client_(BLEND_EXE_ACTION_SERVER_NAME, true),
   scan_exe_client_(SCAN_EXE_ACTION_SERVER_NAME, true),
+  batch_planning_client_(BATCH_PLANNING_ACTION_SERVER_NAME, true),
   process_planning_server_(nh_, PROCESS_PLANNING_ACTION_SERVER_NAME,
                            boost::bind(&SurfaceBlendingService::processPlanningActionCallback, this, _1), false),
   select_motion_plan_server_(nh_, SELECT_MOTION_PLAN_ACTION_SERVER_NAME,
@@ -731,9 +733,21 @@ bool SurfaceBlendingService::getMotionPlansCallback(
     godel_msgs::GetAvailableMotionPlans::Response& res)
 {
   typedef godel_surface_detection::TrajectoryLibrary::TrajectoryMap::const_iterator MapIter;
-  for (MapIter it = trajectory_library_.get().begin(); it != trajectory_library_.get().end(); ++it)
+  const godel_surface_detection::TrajectoryLibrary::TrajectoryMap& plans = trajectory_library_.get();
+
+  // Plans are reported in their sequenced execution order, followed by any others (e.g. loaded
+  // from file)
+  for (std::size_t i = 0; i < motion_plan_order_.size(); ++i)
+  {
+    if (plans.find(motion_plan_order_[i]) != plans.end())
+      res.names.push_back(motion_plan_order_[i]);
+  }
+
+  for (MapIter it = plans.begin(); it != plans.end(); ++it)
   {
-    res.names.push_back(it->first);
+    if (std::find(motion_plan_order_.begin(), motion_plan_order_.end(), it->first) ==
+        motion_plan_order_.end())
+      res.names.push_back(it->first);
   }
   return true;
 }
@@ -746,6 +760,7 @@ bool SurfaceBlendingService::loadSaveMotionPlanCallback(
   {
   case godel_msgs::LoadSaveMotionPlan::Request::MODE_LOAD:
     trajectory_library_.load(req.path);
+    motion_plan_order_.clear();
     break;
 
   case godel_msgs::LoadSaveMotionPlan::Request::MODE_SAVE:
@@ -0,0 +1,33 @@
+#ifndef GODEL_UTILS_BATCH_IK_SOLVER_H
+#define GODEL_UTILS_BATCH_IK_SOLVER_H
+
+#include <vector>
+#include <Eigen/Geometry>
+
+namespace godel_utils
+{
+
+/**
+ * Optional interface for robot models that can solve the IK of many poses in one call into flat
+ * buffers. Planners discover it with dynamic_cast and fall back to per-pose getAllIK otherwise.
+ */
+class BatchIkSolver
+{
+public:
+  virtual ~BatchIkSolver() {}
+
+  /**
+   * @brief Computes all valid IK solutions of poses[0 .. n_poses)
+   * @param joints Output; solutions stored back to back, DOF values each. Cleared first; pass the
+   *        same buffer on every call to avoid reallocating it.
+   * @param offsets Output; n_poses + 1 entries. The solutions of pose i are solutions
+   *        offsets[i] .. offsets[i + 1] - 1 of 'joints'.
+   * @return True if every pose has at least one solution
+   */
+  virtual bool getAllIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses, std::vector<double>& joints,
+                             std::vector<std::size_t>& offsets) const = 0;
+};
+
+} // namespace godel_utils
+
+#endif // GODEL_UTILS_BATCH_IK_SOLVER_H
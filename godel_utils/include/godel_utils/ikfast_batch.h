@@ -0,0 +1,128 @@
+#ifndef GODEL_UTILS_IKFAST_BATCH_H
+#define GODEL_UTILS_IKFAST_BATCH_H
+
+#include <cmath>
+#include <vector>
+#include <Eigen/Geometry>
+
+namespace godel_utils
+{
+
+/**
+ * The joints of an IKFast solver, as needed to expand and filter its raw solutions. IKFast returns
+ * the unique configurations of the robot (e.g. elbow up, wrist down) with joint values between -pi
+ * and +pi; a joint that can turn further has extra solutions with the same configuration 2 pi away.
+ */
+struct IkFastChain
+{
+  IkFastChain() : dof(0), wrap_joint(0) {}
+  std::size_t dof;
+  std::size_t wrap_joint;           /**<Joint whose solutions are repeated at +/- 2 pi */
+  std::vector<bool> has_limits;     /**<Per joint; joints without limits are not filtered */
+  std::vector<double> lower, upper; /**<Per joint, including any tolerance */
+};
+
+/**
+ * @brief Appends every solution in 'raw' (dof values each), each followed by its variants with
+ * the wrap joint at +/- 2 pi, to 'candidates'. No validity checks are applied.
+ */
+inline void appendJointVariants(const std::vector<double>& raw, const IkFastChain& chain,
+                                std::vector<double>& candidates)
+{
+  for (std::size_t first = 0; first + chain.dof <= raw.size(); first += chain.dof)
+  {
+    const std::size_t start = candidates.size();
+    for (int variant = 0; variant < 3; ++variant)
+    {
+      candidates.insert(candidates.end(), raw.begin() + first, raw.begin() + first + chain.dof);
+    }
+    candidates[start + chain.dof + chain.wrap_joint] += 2 * M_PI;
+    candidates[start + 2 * chain.dof + chain.wrap_joint] -= 2 * M_PI;
+  }
+}
+
+/**
+ * @brief Clears keep[c] for every candidate c outside the joint limits; a joint-major loop over
+ * the flat buffer
+ */
+inline void filterJointLimits(const std::vector<double>& candidates, const IkFastChain& chain,
+                              std::vector<char>& keep)
+{
+  const std::size_t n = candidates.size() / chain.dof;
+  for (std::size_t j = 0; j < chain.dof; ++j)
+  {
+    if (!chain.has_limits[j])
+    {
+      continue;
+    }
+    const double lower = chain.lower[j];
+    const double upper = chain.upper[j];
+    const double* value = &candidates[j];
+    for (std::size_t c = 0; c < n; ++c, value += chain.dof)
+    {
+      keep[c] &= (*value >= lower) & (*value <= upper);
+    }
+  }
+}
+
+/**
+ * @brief BatchIkSolver::getAllIKBatch for IKFast based robot models. All raw solutions (and their
+ * wrap joint variants) are gathered into one flat buffer, filtered against the joint limits in a
+ * single pass, and only the survivors go through the full validity check.
+ * @param solve Called as solve(pose, raw) for every pose: appends the IKFast solutions of the pose
+ *        to 'raw', dof values each
+ * @param is_valid Called as is_valid(solution) with a std::vector<double>: the full validity check
+ * @return True if every pose has at least one solution
+ */
+template <class Solve, class IsValid>
+bool solveIKBatch(const Eigen::Affine3d* poses, std::size_t n_poses, const IkFastChain& chain, Solve solve,
+                  IsValid is_valid, std::vector<double>& joints, std::vector<std::size_t>& offsets)
+{
+  joints.clear();
+  offsets.assign(1, 0);
+
+  // 1 - Raw solutions of every pose into one buffer
+  std::vector<double> raw;
+  std::vector<double> candidates;
+  std::vector<std::size_t> candidate_offsets(n_poses + 1, 0);
+  candidates.reserve(n_poses * 24 * chain.dof); // IKFast gives at most 8 solutions, 3 variants each
+  for (std::size_t i = 0; i < n_poses; ++i)
+  {
+    raw.clear();
+    solve(poses[i], raw);
+    appendJointVariants(raw, chain, candidates);
+    candidate_offsets[i + 1] = candidates.size() / chain.dof;
+  }
+
+  // 2 - Cheap limit check on everything
+  std::vector<char> keep(candidate_offsets.back(), 1);
+  filterJointLimits(candidates, chain, keep);
+
+  // 3 - Full validity check (limits again, plus collisions when enabled) only on survivors
+  bool all_solved = true;
+  std::vector<double> sol(chain.dof);
+  joints.reserve(candidates.size());
+  for (std::size_t i = 0; i < n_poses; ++i)
+  {
+    for (std::size_t c = candidate_offsets[i]; c < candidate_offsets[i + 1]; ++c)
+    {
+      if (!keep[c])
+      {
+        continue;
+      }
+      sol.assign(candidates.begin() + c * chain.dof, candidates.begin() + (c + 1) * chain.dof);
+      if (is_valid(sol))
+      {
+        joints.insert(joints.end(), sol.begin(), sol.end());
+      }
+    }
+    offsets.push_back(joints.size() / chain.dof);
+    all_solved &= offsets[i + 1] > offsets[i];
+  }
+
+  return all_solved;
+}
+
+} // namespace godel_utils
+
+#endif // GODEL_UTILS_IKFAST_BATCH_H
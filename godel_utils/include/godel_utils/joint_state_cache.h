@@ -0,0 +1,69 @@
+#ifndef GODEL_UTILS_JOINT_STATE_CACHE_H
+#define GODEL_UTILS_JOINT_STATE_CACHE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+#include <sensor_msgs/JointState.h>
+
+namespace godel_utils
+{
+
+/**
+ * Keeps the latest message of a sensor_msgs/JointState topic. The subscription lives as long as
+ * the cache, so asking for the robot's state costs a lock rather than a new subscription and a
+ * wait for the next message. Messages are received on a thread of the cache's own: it works
+ * whether or not (and however) the node spins, including from within a service callback.
+ */
+class JointStateCache
+{
+public:
+  JointStateCache(ros::NodeHandle& nh, const std::string& topic);
+
+  /**@brief A cache without a subscription; states only arrive through update() */
+  JointStateCache();
+
+  ~JointStateCache();
+
+  /**@brief Stores 'state' as the latest and wakes everyone waiting for one */
+  void update(const sensor_msgs::JointStateConstPtr& state);
+
+  /**
+   * @brief The latest state if it was received no more than 'max_age' ago; otherwise the next one
+   * to arrive within 'timeout'
+   * @return Null if there is no state that fresh and none arrived in time
+   */
+  sensor_msgs::JointStateConstPtr latest(const ros::Duration& max_age, const ros::Duration& timeout) const;
+
+  /**
+   * @brief Waits up to 'timeout' for a state received after this call, e.g. to follow a moving
+   * robot without comparing the same state twice
+   * @return Null if none arrived in time
+   */
+  sensor_msgs::JointStateConstPtr next(const ros::Duration& timeout) const;
+
+private:
+  // Waits for 'count_' to move past 'seen'; the caller holds 'lock'
+  sensor_msgs::JointStateConstPtr waitForUpdate(std::unique_lock<std::mutex>& lock, std::uint64_t seen,
+                                                const ros::Duration& timeout) const;
+
+  mutable std::mutex mutex_;
+  mutable std::condition_variable updated_;
+  sensor_msgs::JointStateConstPtr state_;
+  ros::Time received_;
+  std::uint64_t count_; // states received so far
+
+  ros::CallbackQueue queue_;
+  std::unique_ptr<ros::AsyncSpinner> spinner_;
+  ros::Subscriber sub_;
+};
+
+typedef std::shared_ptr<JointStateCache> JointStateCachePtr;
+
+} // namespace godel_utils
+
+#endif // GODEL_UTILS_JOINT_STATE_CACHE_H
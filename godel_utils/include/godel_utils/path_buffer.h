@@ -0,0 +1,96 @@
+#ifndef GODEL_UTILS_PATH_BUFFER_H
+#define GODEL_UTILS_PATH_BUFFER_H
+
+#include <vector>
+#include <geometry_msgs/PoseArray.h>
+#include <Eigen/Geometry>
+
+namespace godel_utils
+{
+
+/**
+ * Tool path stored as structure-of-arrays: positions (x, y, z), orientations (x, y, z, w) and an
+ * integer tag per pose, each in its own contiguous array. Whole-path operations run as batch
+ * kernels over these arrays instead of converting every pose to an Eigen::Affine3d and back.
+ * ROS messages should only be produced at node boundaries (toPoseArray/fromPoseArray).
+ *
+ * Tags are free for the caller to use, e.g. to mark process vs. transition motion.
+ */
+class PathBuffer
+{
+public:
+  typedef Eigen::Map<Eigen::Matrix3Xd> PositionArray;
+  typedef Eigen::Map<const Eigen::Matrix3Xd> ConstPositionArray;
+
+  PathBuffer() {}
+
+  std::size_t size() const { return tags_.size(); }
+  bool empty() const { return tags_.empty(); }
+  void clear();
+  void reserve(std::size_t n);
+
+  void push_back(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation, int tag = 0);
+  void push_back(const Eigen::Affine3d& pose, int tag = 0);
+  void pop_back();
+
+  /**@brief Appends poses [first, other.size()) of other */
+  void append(const PathBuffer& other, std::size_t first = 0);
+
+  Eigen::Map<Eigen::Vector3d> position(std::size_t i) { return Eigen::Map<Eigen::Vector3d>(&positions_[3 * i]); }
+  Eigen::Map<const Eigen::Vector3d> position(std::size_t i) const
+  {
+    return Eigen::Map<const Eigen::Vector3d>(&positions_[3 * i]);
+  }
+  Eigen::Map<Eigen::Quaterniond> orientation(std::size_t i)
+  {
+    return Eigen::Map<Eigen::Quaterniond>(&orientations_[4 * i]);
+  }
+  Eigen::Map<const Eigen::Quaterniond> orientation(std::size_t i) const
+  {
+    return Eigen::Map<const Eigen::Quaterniond>(&orientations_[4 * i]);
+  }
+  int& tag(std::size_t i) { return tags_[i]; }
+  int tag(std::size_t i) const { return tags_[i]; }
+
+  Eigen::Affine3d pose(std::size_t i) const;
+  Eigen::Affine3d front() const { return pose(0); }
+  Eigen::Affine3d back() const { return pose(size() - 1); }
+
+  /**@brief All positions as a 3xN matrix (one column per pose) */
+  PositionArray positions() { return PositionArray(positions_.data(), 3, size()); }
+  ConstPositionArray positions() const { return ConstPositionArray(positions_.data(), 3, size()); }
+
+  /**@brief Pre-multiplies every pose by t (i.e. re-expresses the path in the frame t maps into) */
+  void transform(const Eigen::Affine3d& t);
+
+  /**@brief Post-multiplies every pose by t (i.e. applies t in each pose's own frame) */
+  void transformLocal(const Eigen::Affine3d& t);
+
+  /**@brief Overwrites the orientation of every pose */
+  void setOrientation(const Eigen::Quaterniond& q);
+
+  void reverse();
+
+  /**
+   * @brief Appends poses linearly interpolated from start to stop (both included). Orientation is
+   * slerped; the number of steps is chosen so that no step exceeds ds (m) in translation or
+   * dt (rad) in rotation.
+   */
+  void appendInterpolated(const Eigen::Affine3d& start, const Eigen::Affine3d& stop, double ds, double dt,
+                          int tag = 0);
+
+  /**@brief Appends the poses of msg, all with the given tag */
+  void fromPoseArray(const geometry_msgs::PoseArray& msg, int tag = 0);
+
+  /**@brief Writes every pose into msg.poses, replacing its contents; the header is untouched */
+  void toPoseArray(geometry_msgs::PoseArray& msg) const;
+
+private:
+  std::vector<double> positions_;    /**<x, y, z per pose */
+  std::vector<double> orientations_; /**<x, y, z, w per pose (Eigen's quaternion storage order) */
+  std::vector<int> tags_;
+};
+
+} // namespace godel_utils
+
+#endif // GODEL_UTILS_PATH_BUFFER_H
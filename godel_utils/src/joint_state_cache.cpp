@@ -0,0 +1,62 @@
+#include <godel_utils/joint_state_cache.h>
+
+#include <chrono>
+
+godel_utils::JointStateCache::JointStateCache(ros::NodeHandle& nh, const std::string& topic) : count_(0)
+{
+  ros::NodeHandle cache_nh(nh);
+  cache_nh.setCallbackQueue(&queue_);
+  sub_ = cache_nh.subscribe(topic, 1, &JointStateCache::update, this);
+
+  spinner_.reset(new ros::AsyncSpinner(1, &queue_));
+  spinner_->start();
+}
+
+godel_utils::JointStateCache::JointStateCache() : count_(0) {}
+
+godel_utils::JointStateCache::~JointStateCache()
+{
+  // No callbacks may run once members start being destroyed
+  sub_.shutdown();
+  if (spinner_)
+  {
+    spinner_->stop();
+  }
+}
+
+void godel_utils::JointStateCache::update(const sensor_msgs::JointStateConstPtr& state)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_ = state;
+    received_ = ros::Time::now();
+    ++count_;
+  }
+  updated_.notify_all();
+}
+
+sensor_msgs::JointStateConstPtr godel_utils::JointStateCache::latest(const ros::Duration& max_age,
+                                                                    const ros::Duration& timeout) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (state_ && ros::Time::now() - received_ <= max_age)
+  {
+    return state_;
+  }
+  return waitForUpdate(lock, count_, timeout);
+}
+
+sensor_msgs::JointStateConstPtr godel_utils::JointStateCache::next(const ros::Duration& timeout) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  return waitForUpdate(lock, count_, timeout);
+}
+
+sensor_msgs::JointStateConstPtr godel_utils::JointStateCache::waitForUpdate(std::unique_lock<std::mutex>& lock,
+                                                                           std::uint64_t seen,
+                                                                           const ros::Duration& timeout) const
+{
+  const bool updated = updated_.wait_for(lock, std::chrono::nanoseconds(timeout.toNSec()),
+                                         [this, seen] { return count_ != seen; });
+  return updated ? state_ : sensor_msgs::JointStateConstPtr();
+}
@@ -0,0 +1,198 @@
+#include <godel_utils/path_buffer.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace godel_utils
+{
+
+void PathBuffer::clear()
+{
+  positions_.clear();
+  orientations_.clear();
+  tags_.clear();
+}
+
+void PathBuffer::reserve(std::size_t n)
+{
+  positions_.reserve(3 * n);
+  orientations_.reserve(4 * n);
+  tags_.reserve(n);
+}
+
+void PathBuffer::push_back(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation, int tag)
+{
+  positions_.insert(positions_.end(), position.data(), position.data() + 3);
+  orientations_.insert(orientations_.end(), orientation.coeffs().data(), orientation.coeffs().data() + 4);
+  tags_.push_back(tag);
+}
+
+void PathBuffer::push_back(const Eigen::Affine3d& pose, int tag)
+{
+  push_back(pose.translation(), Eigen::Quaterniond(pose.rotation()), tag);
+}
+
+void PathBuffer::pop_back()
+{
+  positions_.resize(positions_.size() - 3);
+  orientations_.resize(orientations_.size() - 4);
+  tags_.pop_back();
+}
+
+void PathBuffer::append(const PathBuffer& other, std::size_t first)
+{
+  if (first >= other.size())
+  {
+    return;
+  }
+  positions_.insert(positions_.end(), other.positions_.begin() + 3 * first, other.positions_.end());
+  orientations_.insert(orientations_.end(), other.orientations_.begin() + 4 * first, other.orientations_.end());
+  tags_.insert(tags_.end(), other.tags_.begin() + first, other.tags_.end());
+}
+
+Eigen::Affine3d PathBuffer::pose(std::size_t i) const
+{
+  Eigen::Affine3d result;
+  result = Eigen::Translation3d(position(i)) * Eigen::Quaterniond(orientation(i));
+  return result;
+}
+
+void PathBuffer::transform(const Eigen::Affine3d& t)
+{
+  const Eigen::Matrix3d r = t.linear();
+  const Eigen::Vector3d p = t.translation();
+  const Eigen::Quaterniond q(t.rotation());
+
+  PositionArray pos = positions();
+  for (std::size_t i = 0; i < size(); ++i)
+  {
+    pos.col(i) = r * pos.col(i) + p;
+  }
+  for (std::size_t i = 0; i < size(); ++i)
+  {
+    orientation(i) = q * orientation(i);
+  }
+}
+
+void PathBuffer::transformLocal(const Eigen::Affine3d& t)
+{
+  const Eigen::Vector3d p = t.translation();
+  const Eigen::Quaterniond q(t.rotation());
+
+  for (std::size_t i = 0; i < size(); ++i)
+  {
+    Eigen::Map<Eigen::Quaterniond> qi = orientation(i);
+    position(i) += qi._transformVector(p);
+    qi = qi * q;
+  }
+}
+
+void PathBuffer::setOrientation(const Eigen::Quaterniond& q)
+{
+  for (std::size_t i = 0; i < size(); ++i)
+  {
+    orientation(i) = q;
+  }
+}
+
+void PathBuffer::reverse()
+{
+  const std::size_t n = size();
+  for (std::size_t i = 0; i < n / 2; ++i)
+  {
+    const std::size_t j = n - 1 - i;
+    std::swap_ranges(positions_.begin() + 3 * i, positions_.begin() + 3 * i + 3, positions_.begin() + 3 * j);
+    std::swap_ranges(orientations_.begin() + 4 * i, orientations_.begin() + 4 * i + 4,
+                     orientations_.begin() + 4 * j);
+  }
+  std::reverse(tags_.begin(), tags_.end());
+}
+
+void PathBuffer::appendInterpolated(const Eigen::Affine3d& start, const Eigen::Affine3d& stop, double ds,
+                                    double dt, int tag)
+{
+  const Eigen::Vector3d start_pos = start.translation();
+  const Eigen::Vector3d delta_translation = stop.translation() - start_pos;
+  const Eigen::AngleAxisd delta_rotation((start.inverse() * stop).rotation());
+
+  const unsigned steps_translation = static_cast<unsigned>(delta_translation.norm() / ds) + 1;
+  const unsigned steps_rotation = static_cast<unsigned>(delta_rotation.angle() / dt) + 1;
+  const unsigned steps = std::max(steps_translation, steps_rotation);
+
+  const std::size_t offset = size();
+  positions_.resize(3 * (offset + steps + 1));
+  orientations_.resize(4 * (offset + steps + 1));
+  tags_.resize(offset + steps + 1, tag);
+
+  // Positions: start + k * step
+  const Eigen::Vector3d step = delta_translation / steps;
+  PositionArray pos = positions();
+  for (unsigned k = 0; k <= steps; ++k)
+  {
+    pos.col(offset + k) = start_pos + step * k;
+  }
+
+  // Orientations: slerp with the angle computed once for the whole run (same weights as
+  // Eigen::Quaterniond::slerp, which recomputes them per call)
+  const Eigen::Vector4d q0 = Eigen::Quaterniond(start.rotation()).coeffs();
+  const Eigen::Vector4d q1 = Eigen::Quaterniond(stop.rotation()).coeffs();
+  const double d = q0.dot(q1);
+  const double abs_d = std::abs(d);
+  const double sign = d < 0.0 ? -1.0 : 1.0;
+  const bool linear = abs_d >= 1.0 - Eigen::NumTraits<double>::dummy_precision();
+  const double theta = linear ? 0.0 : std::acos(abs_d);
+  const double sin_theta = linear ? 1.0 : std::sin(theta);
+
+  Eigen::Map<Eigen::Matrix4Xd> ori(orientations_.data(), 4, size());
+  for (unsigned k = 0; k <= steps; ++k)
+  {
+    const double s = static_cast<double>(k) / steps;
+    double w0, w1;
+    if (linear)
+    {
+      w0 = 1.0 - s;
+      w1 = s;
+    }
+    else
+    {
+      w0 = std::sin((1.0 - s) * theta) / sin_theta;
+      w1 = std::sin(s * theta) / sin_theta;
+    }
+    ori.col(offset + k) = w0 * q0 + (sign * w1) * q1;
+  }
+}
+
+void PathBuffer::fromPoseArray(const geometry_msgs::PoseArray& msg, int tag)
+{
+  reserve(size() + msg.poses.size());
+  for (std::size_t i = 0; i < msg.poses.size(); ++i)
+  {
+    const geometry_msgs::Pose& p = msg.poses[i];
+    positions_.push_back(p.position.x);
+    positions_.push_back(p.position.y);
+    positions_.push_back(p.position.z);
+    orientations_.push_back(p.orientation.x);
+    orientations_.push_back(p.orientation.y);
+    orientations_.push_back(p.orientation.z);
+    orientations_.push_back(p.orientation.w);
+    tags_.push_back(tag);
+  }
+}
+
+void PathBuffer::toPoseArray(geometry_msgs::PoseArray& msg) const
+{
+  msg.poses.resize(size());
+  for (std::size_t i = 0; i < size(); ++i)
+  {
+    geometry_msgs::Pose& p = msg.poses[i];
+    p.position.x = positions_[3 * i];
+    p.position.y = positions_[3 * i + 1];
+    p.position.z = positions_[3 * i + 2];
+    p.orientation.x = orientations_[4 * i];
+    p.orientation.y = orientations_[4 * i + 1];
+    p.orientation.z = orientations_[4 * i + 2];
+    p.orientation.w = orientations_[4 * i + 3];
+  }
+}
+
+} // namespace godel_utils
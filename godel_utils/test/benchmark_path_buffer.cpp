@@ -0,0 +1,90 @@
+/*
+ * benchmark_path_buffer.cpp
+ *
+ * Microbenchmarks of the SoA kernels against the equivalent per-pose Affine3d loops; built with
+ * the tests but not run with them:
+ *   rosrun godel_utils godel_utils-benchmark
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include "path_buffer_test_utils.h"
+
+using godel_utils::PathBuffer;
+
+static double seconds(std::chrono::steady_clock::time_point t0)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+TEST(PathBufferBenchmark, transform)
+{
+  const std::size_t n = 100000;
+  const int reps = 10;
+  PathBuffer path;
+  path.reserve(n);
+  PoseVector poses;
+  poses.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    poses.push_back(makePose(1e-5 * i, 0., 0., 1e-4 * i, Eigen::Vector3d::UnitZ()));
+    path.push_back(poses.back());
+  }
+  Eigen::Affine3d t = makePose(0.5, -0.3, 1.2, 1e-3, Eigen::Vector3d(0.2, 1., 0.3));
+
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; ++r)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      poses[i] = t * poses[i];
+    }
+  }
+  double affine_time = seconds(t0);
+
+  t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; ++r)
+  {
+    path.transform(t);
+  }
+  double buffer_time = seconds(t0);
+
+  expectPoseNear(poses[n / 2], path.pose(n / 2), 1e-6);
+  std::cout << "[ BENCH    ] transform " << n << " poses x " << reps << ": Affine3d " << affine_time
+            << " s, PathBuffer " << buffer_time << " s" << std::endl;
+}
+
+TEST(PathBufferBenchmark, interpolate)
+{
+  const int reps = 200;
+  Eigen::Affine3d start = makePose(0., 0., 0., 0.1, Eigen::Vector3d(0., 1., 0.));
+  Eigen::Affine3d stop = makePose(1., 0.5, -0.2, 2.5, Eigen::Vector3d(1., 0., 1.));
+
+  std::size_t reference_size = 0;
+  std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; ++r)
+  {
+    reference_size += interpolateReference(start, stop, 0.001, 0.01).size();
+  }
+  double affine_time = seconds(t0);
+
+  PathBuffer path;
+  t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; ++r)
+  {
+    path.clear();
+    path.appendInterpolated(start, stop, 0.001, 0.01);
+  }
+  double buffer_time = seconds(t0);
+
+  EXPECT_EQ(reference_size, reps * path.size());
+  std::cout << "[ BENCH    ] interpolate " << path.size() << " poses x " << reps << ": Affine3d "
+            << affine_time << " s, PathBuffer " << buffer_time << " s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
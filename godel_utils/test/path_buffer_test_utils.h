@@ -0,0 +1,53 @@
+/*
+ * path_buffer_test_utils.h
+ *
+ * Poses and reference implementations shared by the path buffer tests and benchmarks
+ */
+
+#ifndef GODEL_UTILS_PATH_BUFFER_TEST_UTILS_H
+#define GODEL_UTILS_PATH_BUFFER_TEST_UTILS_H
+
+#include <algorithm>
+#include <vector>
+#include <gtest/gtest.h>
+#include <godel_utils/path_buffer.h>
+
+typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > PoseVector;
+
+inline Eigen::Affine3d makePose(double x, double y, double z, double angle, const Eigen::Vector3d& axis)
+{
+  Eigen::Affine3d pose;
+  pose = Eigen::Translation3d(x, y, z) * Eigen::AngleAxisd(angle, axis.normalized());
+  return pose;
+}
+
+inline void expectPoseNear(const Eigen::Affine3d& a, const Eigen::Affine3d& b, double tol)
+{
+  EXPECT_TRUE(a.translation().isApprox(b.translation(), tol)) << a.translation().transpose() << " vs "
+                                                              << b.translation().transpose();
+  EXPECT_TRUE(a.linear().isApprox(b.linear(), tol));
+}
+
+/* Reference implementation: the per-pose Affine3d interpolation used before PathBuffer */
+inline PoseVector interpolateReference(const Eigen::Affine3d& start, const Eigen::Affine3d& stop, double ds,
+                                       double dt)
+{
+  Eigen::Vector3d delta_translation = stop.translation() - start.translation();
+  Eigen::AngleAxisd delta_rotation((start.inverse() * stop).rotation());
+  unsigned steps = std::max(static_cast<unsigned>(delta_translation.norm() / ds) + 1,
+                            static_cast<unsigned>(delta_rotation.angle() / dt) + 1);
+
+  Eigen::Quaterniond start_q(start.rotation());
+  Eigen::Quaterniond stop_q(stop.rotation());
+  PoseVector result;
+  for (unsigned i = 0; i <= steps; ++i)
+  {
+    Eigen::Affine3d pose;
+    pose = Eigen::Translation3d(start.translation() + delta_translation / steps * i) *
+           start_q.slerp(1.0 / steps * i, stop_q);
+    result.push_back(pose);
+  }
+  return result;
+}
+
+#endif
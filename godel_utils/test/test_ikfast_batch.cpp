@@ -0,0 +1,100 @@
+/*
+ * test_ikfast_batch.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <godel_utils/ikfast_batch.h>
+
+using godel_utils::IkFastChain;
+
+// Two joints; the second wraps and is limited to [-4, 4]
+static IkFastChain makeChain()
+{
+  IkFastChain chain;
+  chain.dof = 2;
+  chain.wrap_joint = 1;
+  chain.has_limits = {false, true};
+  chain.lower = {0.0, -4.0};
+  chain.upper = {0.0, 4.0};
+  return chain;
+}
+
+TEST(IkFastBatch, appendJointVariants)
+{
+  std::vector<double> candidates;
+  godel_utils::appendJointVariants({1.0, 0.5, 2.0, -1.0}, makeChain(), candidates);
+  ASSERT_EQ(12u, candidates.size());
+  EXPECT_EQ(1.0, candidates[0]);
+  EXPECT_EQ(0.5, candidates[1]);
+  EXPECT_EQ(1.0, candidates[2]);
+  EXPECT_DOUBLE_EQ(0.5 + 2 * M_PI, candidates[3]);
+  EXPECT_DOUBLE_EQ(0.5 - 2 * M_PI, candidates[5]);
+  EXPECT_EQ(2.0, candidates[6]);
+  EXPECT_DOUBLE_EQ(-1.0 - 2 * M_PI, candidates[11]);
+}
+
+TEST(IkFastBatch, filterJointLimits)
+{
+  // The unlimited first joint is never filtered
+  const std::vector<double> candidates = {100.0, 0.0, 0.0, 4.5, 0.0, -4.0, 0.0, -4.5};
+  std::vector<char> keep(4, 1);
+  godel_utils::filterJointLimits(candidates, makeChain(), keep);
+  EXPECT_EQ(1, keep[0]);
+  EXPECT_EQ(0, keep[1]);
+  EXPECT_EQ(1, keep[2]);
+  EXPECT_EQ(0, keep[3]);
+}
+
+TEST(IkFastBatch, solveIKBatch)
+{
+  // Pose i has i solutions (x, 0.1 * k); solutions with a negative x are invalid
+  std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > poses;
+  for (double x : {1.0, -1.0, 2.0})
+  {
+    poses.push_back(Eigen::Affine3d(Eigen::Translation3d(x, 0.0, 0.0)));
+  }
+  std::size_t solve_calls = 0;
+  auto solve = [&solve_calls](const Eigen::Affine3d& pose, std::vector<double>& raw)
+  {
+    const double x = pose.translation().x();
+    for (int k = 0; k < static_cast<int>(std::abs(x)); ++k)
+    {
+      raw.push_back(x);
+      raw.push_back(0.1 * k);
+    }
+    ++solve_calls;
+  };
+  std::size_t valid_calls = 0;
+  auto is_valid = [&valid_calls](const std::vector<double>& sol)
+  {
+    ++valid_calls;
+    return sol[0] > 0.0;
+  };
+
+  std::vector<double> joints;
+  std::vector<std::size_t> offsets;
+  EXPECT_FALSE(godel_utils::solveIKBatch(poses.data(), poses.size(), makeChain(), solve, is_valid, joints, offsets));
+  EXPECT_EQ(3u, solve_calls);
+  // Of the three variants of every raw solution, only the unwrapped one is within [-4, 4]
+  EXPECT_EQ(4u, valid_calls);
+
+  ASSERT_EQ(4u, offsets.size());
+  EXPECT_EQ(0u, offsets[0]);
+  EXPECT_EQ(1u, offsets[1]);
+  EXPECT_EQ(1u, offsets[2]);
+  EXPECT_EQ(3u, offsets[3]);
+  ASSERT_EQ(6u, joints.size());
+  EXPECT_EQ(2.0, joints[4]);
+  EXPECT_DOUBLE_EQ(0.1, joints[5]);
+
+  // All poses solved
+  poses.erase(poses.begin() + 1);
+  EXPECT_TRUE(godel_utils::solveIKBatch(poses.data(), poses.size(), makeChain(), solve, is_valid, joints, offsets));
+  EXPECT_EQ(3u, offsets.size());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,79 @@
+/*
+ * test_joint_state_cache.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <godel_utils/joint_state_cache.h>
+
+using godel_utils::JointStateCache;
+
+static sensor_msgs::JointStateConstPtr makeState(double position)
+{
+  sensor_msgs::JointStatePtr state(new sensor_msgs::JointState);
+  state->position.assign(6, position);
+  return state;
+}
+
+TEST(JointStateCache, timesOutWithoutState)
+{
+  JointStateCache cache;
+  EXPECT_FALSE(cache.latest(ros::Duration(1.0), ros::Duration(0.01)));
+  EXPECT_FALSE(cache.next(ros::Duration(0.01)));
+}
+
+TEST(JointStateCache, returnsFreshStateWithoutWaiting)
+{
+  JointStateCache cache;
+  cache.update(makeState(1.0));
+
+  const ros::WallTime start = ros::WallTime::now();
+  sensor_msgs::JointStateConstPtr state = cache.latest(ros::Duration(1.0), ros::Duration(5.0));
+  ASSERT_TRUE(state);
+  EXPECT_EQ(1.0, state->position[0]);
+  EXPECT_LT((ros::WallTime::now() - start).toSec(), 0.1);
+}
+
+TEST(JointStateCache, waitsWhenStateIsStale)
+{
+  JointStateCache cache;
+  cache.update(makeState(1.0));
+  ros::WallDuration(0.05).sleep();
+
+  // Too old to be returned, and nothing new arrives
+  EXPECT_FALSE(cache.latest(ros::Duration(0.01), ros::Duration(0.01)));
+
+  std::thread publisher([&cache]()
+  {
+    ros::WallDuration(0.05).sleep();
+    cache.update(makeState(2.0));
+  });
+  sensor_msgs::JointStateConstPtr state = cache.latest(ros::Duration(0.01), ros::Duration(5.0));
+  publisher.join();
+  ASSERT_TRUE(state);
+  EXPECT_EQ(2.0, state->position[0]);
+}
+
+TEST(JointStateCache, nextSkipsTheCurrentState)
+{
+  JointStateCache cache;
+  cache.update(makeState(1.0));
+
+  std::thread publisher([&cache]()
+  {
+    ros::WallDuration(0.05).sleep();
+    cache.update(makeState(2.0));
+  });
+  sensor_msgs::JointStateConstPtr state = cache.next(ros::Duration(5.0));
+  publisher.join();
+  ASSERT_TRUE(state);
+  EXPECT_EQ(2.0, state->position[0]);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  // Wall clock time without a node
+  ros::Time::init();
+  return RUN_ALL_TESTS();
+}
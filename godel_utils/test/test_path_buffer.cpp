@@ -0,0 +1,90 @@
+/*
+ * test_path_buffer.cpp
+ */
+
+#include <gtest/gtest.h>
+#include "path_buffer_test_utils.h"
+
+using godel_utils::PathBuffer;
+
+TEST(PathBufferTest, pushAndConvert)
+{
+  PathBuffer path;
+  Eigen::Affine3d a = makePose(1., 2., 3., 0.3, Eigen::Vector3d(1., 1., 0.));
+  Eigen::Affine3d b = makePose(-1., 0., 0.5, 2.0, Eigen::Vector3d(0., 0., 1.));
+  path.push_back(a, 7);
+  path.push_back(b);
+
+  ASSERT_EQ(2u, path.size());
+  EXPECT_EQ(7, path.tag(0));
+  EXPECT_EQ(0, path.tag(1));
+  expectPoseNear(a, path.front(), 1e-12);
+  expectPoseNear(b, path.back(), 1e-12);
+
+  geometry_msgs::PoseArray msg;
+  path.toPoseArray(msg);
+  ASSERT_EQ(2u, msg.poses.size());
+  EXPECT_DOUBLE_EQ(2., msg.poses[0].position.y);
+
+  PathBuffer copy;
+  copy.fromPoseArray(msg, 3);
+  ASSERT_EQ(2u, copy.size());
+  EXPECT_EQ(3, copy.tag(1));
+  expectPoseNear(b, copy.pose(1), 1e-12);
+
+  copy.reverse();
+  expectPoseNear(a, copy.back(), 1e-12);
+}
+
+TEST(PathBufferTest, transformMatchesAffine)
+{
+  PathBuffer path;
+  PoseVector poses;
+  for (int i = 0; i < 20; ++i)
+  {
+    poses.push_back(makePose(0.1 * i, std::sin(i), 0.01 * i * i, 0.2 * i, Eigen::Vector3d(1., i, 2.)));
+    path.push_back(poses.back(), i);
+  }
+
+  Eigen::Affine3d world = makePose(0.5, -0.3, 1.2, 1.1, Eigen::Vector3d(0.2, 1., 0.3));
+  Eigen::Affine3d tool = makePose(0., 0., 0.01, M_PI, Eigen::Vector3d::UnitY());
+  path.transform(world);
+  path.transformLocal(tool);
+
+  for (std::size_t i = 0; i < poses.size(); ++i)
+  {
+    expectPoseNear(world * poses[i] * tool, path.pose(i), 1e-9);
+    EXPECT_EQ(static_cast<int>(i), path.tag(i));
+  }
+}
+
+TEST(PathBufferTest, interpolationMatchesSlerp)
+{
+  Eigen::Affine3d start = makePose(0., 0., 0., 0.1, Eigen::Vector3d(0., 1., 0.));
+  Eigen::Affine3d stop = makePose(0.3, 0.1, -0.2, 2.5, Eigen::Vector3d(1., 0., 1.));
+
+  PathBuffer path;
+  path.push_back(start, 1);
+  path.appendInterpolated(start, stop, 0.01, 0.05, 2);
+  PoseVector expected = interpolateReference(start, stop, 0.01, 0.05);
+
+  ASSERT_EQ(expected.size() + 1, path.size());
+  EXPECT_EQ(1, path.tag(0));
+  for (std::size_t i = 0; i < expected.size(); ++i)
+  {
+    expectPoseNear(expected[i], path.pose(i + 1), 1e-9);
+    EXPECT_EQ(2, path.tag(i + 1));
+  }
+
+  // Identical orientations take the linear branch
+  PathBuffer line;
+  line.appendInterpolated(start, start * Eigen::Translation3d(0., 0., 0.1), 0.03, 0.05);
+  ASSERT_EQ(5u, line.size());
+  expectPoseNear(start * Eigen::Translation3d(0., 0., 0.05), line.pose(2), 1e-9);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
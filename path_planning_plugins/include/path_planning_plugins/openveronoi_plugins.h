@@ -13,6 +13,7 @@ const static std::string OVERLAP = DEFAULT_PARAM_PREFIX + "overlap";
 const static std::string SAFE_TRAVERSE_HEIGHT = DEFAULT_PARAM_PREFIX + "safe_traverse_height";
 const static std::string SCAN_WIDTH = DEFAULT_PARAM_PREFIX + "scan_width";
 const static std::string TOOL_RADIUS = DEFAULT_PARAM_PREFIX + "tool_radius";
+const static std::string SCAN_ALIGN_WITH_LONGEST_EDGE = DEFAULT_PARAM_PREFIX + "scan_align_with_longest_edge";
 const static double MIN_BOUNDARY_LENGTH = 0.1; // 10 cm
 
 namespace path_planning_plugins
@@ -0,0 +1,30 @@
+#ifndef RASTER_PLUGINS_H
+#define RASTER_PLUGINS_H
+
+#include <path_planning_plugins/openveronoi_plugins.h>
+
+const static std::string RASTER_COMPARE_WITH_OFFSET = DEFAULT_PARAM_PREFIX + "raster_compare_with_offset";
+
+namespace path_planning_plugins
+{
+namespace raster
+{
+  /**
+   * Blend planner which covers each surface with zig-zag raster passes instead of
+   * concentric offsets. Passes within a cell are joined on the surface, so the tool
+   * only retracts between cells.
+   */
+  class BlendPlanner : public path_planning_plugins_base::PathPlanningBase
+  {
+  private:
+    pcl::PolygonMesh mesh_;
+
+  public:
+    BlendPlanner() {}
+    void init(pcl::PolygonMesh mesh);
+    bool generatePath(std::vector<geometry_msgs::PoseArray>& path);
+  };
+}
+}
+
+#endif // RASTER_PLUGINS_H
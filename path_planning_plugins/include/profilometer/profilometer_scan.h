@@ -18,10 +18,29 @@ namespace path_planning_plugins
 namespace scan
 {
 
+/**
+ * Options controlling how the scan passes are oriented over the surface
+ */
+struct ScanPathOptions
+{
+  ScanPathOptions() : align_with_longest_edge(false), scan_speed(0.05) {}
+
+  // If true, passes always run parallel to the longest edge of the surface's convex hull.
+  // Otherwise the candidate orientation with the shortest estimated scan time is used.
+  bool align_with_longest_edge;
+  // (m/s) Tool speed used to estimate the scan time of each candidate orientation
+  double scan_speed;
+};
+
 std::vector<godel_process_path::PolygonPt>
 generateProfilometerScanPath(const godel_process_path::PolygonBoundary& boundary,
                              const godel_msgs::PathPlanningParameters& params);
 
+std::vector<godel_process_path::PolygonPt>
+generateProfilometerScanPath(const godel_process_path::PolygonBoundary& boundary,
+                             const godel_msgs::PathPlanningParameters& params,
+                             const ScanPathOptions& options);
+
 } // end namespace scan
 } // end namespace path_planning_plugins
 
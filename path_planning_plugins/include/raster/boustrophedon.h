@@ -0,0 +1,79 @@
+/**
+ * This defines some utilities for generating raster (boustrophedon) blend
+ * paths from a collection of polygon boundaries.
+ *
+ * The input is a PolygonBoundaryCollection expressed in the local plane frame
+ * of a surface; interior boundaries are treated as holes (even-odd rule).
+ *
+ * The surface is swept by passes parallel to the local x axis. Each maximal run
+ * of passes with one-to-one connectivity between neighbouring scanlines forms a
+ * cell which is covered by a single zig-zag segment; consecutive passes within a
+ * cell are connected on the surface so the tool is only lifted between cells.
+ */
+#ifndef BOUSTROPHEDON_H
+#define BOUSTROPHEDON_H
+
+#include <godel_process_path_generation/polygon_pts.hpp>
+#include <geometry_msgs/PoseArray.h>
+#include <godel_msgs/PathPlanningParameters.h>
+
+namespace path_planning_plugins
+{
+namespace raster
+{
+
+typedef std::vector<godel_process_path::PolygonPt> RasterSegment;
+
+/**
+ * Speeds and heights used to estimate the time required to execute a blend path
+ */
+struct ProcessTimeParameters
+{
+  ProcessTimeParameters()
+    : blending_speed(0.3), traverse_speed(0.05), approach_speed(0.005), retract_speed(0.02),
+      traverse_height(0.05)
+  {}
+
+  double blending_speed;  // (m/s) speed while in contact with the surface
+  double traverse_speed;  // (m/s) speed of moves between segments at traverse height
+  double approach_speed;  // (m/s) speed of the descent onto the surface
+  double retract_speed;   // (m/s) speed of the lift off the surface
+  double traverse_height; // (m) height above the surface used between segments
+};
+
+/**
+ * @brief Generates raster coverage segments for a surface
+ * @param boundaries Surface boundaries in the local plane frame
+ * @param params Pass spacing is tool_radius - overlap; the tool center is kept
+ *               tool_radius + margin away from every boundary. Points are spaced
+ *               no more than 'discretization' apart.
+ * @return One segment per cell, ordered greedily to shorten the moves between them.
+ *         Empty if the surface is too small to fit a single pass.
+ */
+std::vector<RasterSegment>
+generateBoustrophedonPath(const godel_process_path::PolygonBoundaryCollection& boundaries,
+                          const godel_msgs::PathPlanningParameters& params);
+
+/**
+ * @brief Estimates the time (s) needed to execute a set of segments. Each segment
+ * is approached from and retracted to traverse height, and the planar distance
+ * between consecutive segments is covered at traverse speed.
+ */
+double estimateProcessTime(const std::vector<RasterSegment>& segments,
+                           const ProcessTimeParameters& params);
+
+/**
+ * @brief Extracts the on-surface segments of a path returned by a path planning
+ * service, so that it can be estimated like a raster path.
+ * @param path Poses expressed in the local plane frame of the surface
+ * @param starts, ends Index ranges [start, end) of the poses of each segment
+ * @param segments One segment per range, in the same order
+ * @return False if the ranges are missing, mismatched or out of bounds
+ */
+bool extractPathSegments(const geometry_msgs::PoseArray& path, const std::vector<uint32_t>& starts,
+                         const std::vector<uint32_t>& ends, std::vector<RasterSegment>& segments);
+
+} // end namespace raster
+} // end namespace path_planning_plugins
+
+#endif
@@ -3,6 +3,7 @@
 #include <geometry_msgs/Pose.h>
 #include <geometry_msgs/PoseArray.h>
 #include <godel_msgs/PathPlanning.h>
+#include <godel_utils/path_buffer.h>
 #include <mesh_importer/mesh_importer.h>
 #include <path_planning_plugins/openveronoi_plugins.h>
 #include <pluginlib/class_list_macros.h>
@@ -71,34 +72,19 @@ bool openveronoi::BlendPlanner::generatePath(std::vector<geometry_msgs::PoseArra
     }
 
     // blend process path calculations suceeded. Save data into results.
-    geometry_msgs::PoseArray blend_poses;
-    geometry_msgs::PoseArray path_local = srv.response.poses;
-    geometry_msgs::Pose p;
-    p.orientation.x = 0.0;
-    p.orientation.y = 0.0;
-    p.orientation.z = 0.0;
-    p.orientation.w = 1.0;
-
     // Transform points to world frame and generate pose
     Eigen::Affine3d boundary_pose_eigen;
-    Eigen::Affine3d eigen_p;
-    Eigen::Affine3d result;
-
+    Eigen::Quaterniond boundary_orientation;
     tf::poseMsgToEigen(boundary_pose, boundary_pose_eigen);
+    tf::quaternionMsgToEigen(boundary_pose.orientation, boundary_orientation);
 
-    for (const auto& pose : path_local.poses)
-    {
-      p.position.x = pose.position.x;
-      p.position.y = pose.position.y;
-      p.position.z = pose.position.z;
-
-      tf::poseMsgToEigen(p, eigen_p);
-      result = boundary_pose_eigen*eigen_p;
-      tf::poseEigenToMsg(result, p);
-      p.orientation = boundary_pose.orientation;
-      blend_poses.poses.push_back(p);
-    }
+    godel_utils::PathBuffer blend_path;
+    blend_path.fromPoseArray(srv.response.poses);
+    blend_path.transform(boundary_pose_eigen);
+    blend_path.setOrientation(boundary_orientation);
 
+    geometry_msgs::PoseArray blend_poses;
+    blend_path.toPoseArray(blend_poses);
     path.push_back(blend_poses);
     return true;
   }
@@ -14,6 +14,9 @@
 const static int SCAN_APPROACH_STEP_COUNT = 5;
 const static double SCAN_APPROACH_STEP_DISTANCE = 0.01; // 1cm
 
+// Scan speed used by the process planner; used here to estimate scan times
+const static std::string SCAN_TRAVERSE_SPEED = "/process_planning_params/scan_params/traverse_speed";
+
 namespace path_planning_plugins
 {
 // Scan Planner
@@ -34,6 +37,7 @@ bool openveronoi::ScanPlanner::generatePath(std::vector<geometry_msgs::PoseArray
 
   ros::NodeHandle nh;
   godel_msgs::PathPlanningParameters params;
+  scan::ScanPathOptions scan_options;
   try
   {
     nh.getParam(DISCRETIZATION, params.discretization);
@@ -42,6 +46,8 @@ bool openveronoi::ScanPlanner::generatePath(std::vector<geometry_msgs::PoseArray
     nh.getParam(SAFE_TRAVERSE_HEIGHT, params.traverse_height);
     nh.getParam(SCAN_WIDTH, params.scan_width);
     nh.getParam(TOOL_RADIUS, params.tool_radius);
+    nh.getParam(SCAN_ALIGN_WITH_LONGEST_EDGE, scan_options.align_with_longest_edge);
+    nh.getParam(SCAN_TRAVERSE_SPEED, scan_options.scan_speed);
   }
   catch(const std::exception& e)
   {
@@ -66,7 +72,8 @@ bool openveronoi::ScanPlanner::generatePath(std::vector<geometry_msgs::PoseArray
     geometry_msgs::PoseArray scan_poses;
 
     // 4 - Generate scan polygon boundary
-    PolygonBoundary scan_boundary = scan::generateProfilometerScanPath(filtered_boundaries.front(), params);
+    PolygonBoundary scan_boundary = scan::generateProfilometerScanPath(filtered_boundaries.front(), params,
+                                                                       scan_options);
 
     // 5 - Get boundary pose eigen
     Eigen::Affine3d boundary_pose_eigen;
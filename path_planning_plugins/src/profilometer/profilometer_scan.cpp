@@ -1,5 +1,9 @@
 #include <profilometer/profilometer_scan.h>
 #include <ros/io.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <limits>
+#include <string>
 
 // Factor by which the length and width of the bounding box are
 // multiplied to generate a scan path that covers the entire object
@@ -60,6 +64,142 @@ RotatedRect simpleBoundingBox(const Boundary& boundary)
   return result;
 }
 
+/**
+ * Computes the convex hull of the boundary using Andrew's monotone chain.
+ * The result is ordered counter-clockwise and contains no collinear points.
+ */
+std::vector<Pt> convexHull(const Boundary& boundary)
+{
+  std::vector<Pt> pts (boundary.begin(), boundary.end());
+  std::sort(pts.begin(), pts.end(), [](const Pt& a, const Pt& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  });
+  pts.erase(std::unique(pts.begin(), pts.end()), pts.end());
+
+  if (pts.size() < 3)
+    return pts;
+
+  std::vector<Pt> hull (2 * pts.size());
+  std::size_t k = 0;
+
+  // lower hull
+  for (std::size_t i = 0; i < pts.size(); ++i)
+  {
+    while (k >= 2 && (hull[k - 1] - hull[k - 2]).cross(pts[i] - hull[k - 2]) <= 0.0)
+      --k;
+    hull[k++] = pts[i];
+  }
+
+  // upper hull
+  for (std::size_t i = pts.size() - 1, t = k + 1; i > 0; --i)
+  {
+    while (k >= t && (hull[k - 1] - hull[k - 2]).cross(pts[i - 1] - hull[k - 2]) <= 0.0)
+      --k;
+    hull[k++] = pts[i - 1];
+  }
+
+  hull.resize(k - 1); // last point is a repeat of the first
+  return hull;
+}
+
+/**
+ * Computes the bounding box of the (convex) point set whose long axis 'w' points
+ * along the direction 'angle'. Scan passes run parallel to this axis.
+ */
+RotatedRect orientedBoundingBox(const std::vector<Pt>& hull, double angle)
+{
+  const Pt u (std::cos(angle), std::sin(angle));
+  const Pt v (-u.y, u.x);
+
+  double min_u = std::numeric_limits<double>::max(), max_u = -min_u;
+  double min_v = min_u, max_v = -min_u;
+  for (const auto& pt : hull)
+  {
+    min_u = std::min(min_u, pt.dot(u));
+    max_u = std::max(max_u, pt.dot(u));
+    min_v = std::min(min_v, pt.dot(v));
+    max_v = std::max(max_v, pt.dot(v));
+  }
+
+  const Pt center = u * ((min_u + max_u) / 2.0) + v * ((min_v + max_v) / 2.0);
+
+  RotatedRect result;
+  result.a = angle;
+  result.x = center.x;
+  result.y = center.y;
+  result.w = (max_u - min_u) * GROWTH_FACTOR;
+  result.h = (max_v - min_v) * GROWTH_FACTOR;
+  return result;
+}
+
+/**
+ * Rotating calipers: one side of the minimum-area enclosing rectangle of a convex
+ * polygon is collinear with one of its edges. For each hull edge we advance three
+ * calipers (max along the edge, min along the edge, max away from the edge) which
+ * only ever move forward, so the whole search is linear in the hull size.
+ * @return The angle of the hull edge supporting the minimum-area rectangle
+ */
+double minAreaRectangleAngle(const std::vector<Pt>& hull)
+{
+  const std::size_t n = hull.size();
+  std::size_t r = 0, t = 0, l = 0; // caliper indices
+  double best_area = std::numeric_limits<double>::max();
+  double best_angle = 0.0;
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const Pt& p0 = hull[i];
+    const Pt edge = hull[(i + 1) % n] - p0;
+    const Pt u = edge * (1.0 / edge.norm());
+    const Pt v (-u.y, u.x); // hull is CCW, so v points into the polygon
+
+    if (i == 0)
+    {
+      for (std::size_t j = 1; j < n; ++j)
+      {
+        if (hull[j].dot(u) > hull[r].dot(u)) r = j;
+        if (hull[j].dot(v) > hull[t].dot(v)) t = j;
+        if (hull[j].dot(u) < hull[l].dot(u)) l = j;
+      }
+    }
+    else
+    {
+      while (hull[(r + 1) % n].dot(u) > hull[r].dot(u)) r = (r + 1) % n;
+      while (hull[(t + 1) % n].dot(v) > hull[t].dot(v)) t = (t + 1) % n;
+      while (hull[(l + 1) % n].dot(u) < hull[l].dot(u)) l = (l + 1) % n;
+    }
+
+    const double width = hull[r].dot(u) - hull[l].dot(u);
+    const double height = hull[t].dot(v) - p0.dot(v);
+    if (width * height < best_area)
+    {
+      best_area = width * height;
+      best_angle = std::atan2(u.y, u.x);
+    }
+  }
+
+  return best_angle;
+}
+
+/**
+ * @return The angle of the longest edge of the given polygon
+ */
+double longestEdgeAngle(const std::vector<Pt>& hull)
+{
+  double best_length = 0.0;
+  double best_angle = 0.0;
+  for (std::size_t i = 0; i < hull.size(); ++i)
+  {
+    const Pt edge = hull[(i + 1) % hull.size()] - hull[i];
+    if (edge.norm() > best_length)
+    {
+      best_length = edge.norm();
+      best_angle = std::atan2(edge.y, edge.x);
+    }
+  }
+  return best_angle;
+}
+
 // Vertically or horizontally?
 std::vector<RotatedRect> sliceBoundingBox(const RotatedRect& bbox, double slice_width,
                                           double overlap)
@@ -187,8 +327,38 @@ std::vector<Pt> stitchAndFlatten(const std::vector<std::vector<Pt> >& paths, dou
 }
 
 
+double pathLength(const std::vector<Pt>& pts)
+{
+  double length = 0.0;
+  for (std::size_t i = 1; i < pts.size(); ++i)
+    length += pts[i].dist(pts[i - 1]);
+  return length;
+}
+
+std::vector<Pt> scanBoundingBox(const RotatedRect& bbox, const PlanningParams& params)
+{
+  // Slice bounding box into strips
+  std::vector<RotatedRect> slices = sliceBoundingBox(bbox, params.scan_width, params.overlap);
+
+  // Generate set of dense points along center of each strip
+  std::vector<std::vector<Pt> > slice_points;
+  slice_points.reserve(slices.size());
+  for (std::size_t i = 0; i < slices.size(); ++i)
+    slice_points.push_back(interpolateAlongAxis(slices[i], SCAN_DISCRETIZATION));
+
+  // Connect slices together
+  return stitchAndFlatten(slice_points, SCAN_DISCRETIZATION);
+}
+
 std::vector<Pt>
 generateProfilometerScanPath(const Boundary& boundary, const PlanningParams& params)
+{
+  return generateProfilometerScanPath(boundary, params, ScanPathOptions());
+}
+
+std::vector<Pt>
+generateProfilometerScanPath(const Boundary& boundary, const PlanningParams& params,
+                             const ScanPathOptions& options)
 {
   std::vector<Pt> pts;
   if (boundary.empty())
@@ -197,20 +367,47 @@ generateProfilometerScanPath(const Boundary& boundary, const PlanningParams& par
     return pts;
   }
 
-  // Step 1 -> compute axis-aligned bounding box; we rely on our reference pose for orientation
-  RotatedRect bbox = simpleBoundingBox(boundary);
+  // Step 1 -> compute candidate bounding boxes in the local plane frame
+  std::vector<Pt> hull = convexHull(boundary);
+  std::vector<std::pair<std::string, RotatedRect> > candidates;
 
-  // Step 2 -> slice bounding box into strips
-  std::vector<RotatedRect> slices = sliceBoundingBox(bbox, params.scan_width, params.overlap);
+  if (hull.size() < 3)
+  {
+    // Degenerate surface; fall back to the axis-aligned box
+    candidates.push_back(std::make_pair("axis-aligned", simpleBoundingBox(boundary)));
+  }
+  else if (options.align_with_longest_edge)
+  {
+    candidates.push_back(std::make_pair("longest-edge", orientedBoundingBox(hull, longestEdgeAngle(hull))));
+  }
+  else
+  {
+    const double min_area_angle = minAreaRectangleAngle(hull);
+    candidates.push_back(std::make_pair("axis-aligned", simpleBoundingBox(boundary)));
+    candidates.push_back(std::make_pair("axis-aligned-transverse", orientedBoundingBox(hull, M_PI_2)));
+    candidates.push_back(std::make_pair("min-area", orientedBoundingBox(hull, min_area_angle)));
+    candidates.push_back(std::make_pair("min-area-transverse", orientedBoundingBox(hull, min_area_angle + M_PI_2)));
+    candidates.push_back(std::make_pair("longest-edge", orientedBoundingBox(hull, longestEdgeAngle(hull))));
+  }
 
-  // Step 3 -> generate set of dense points along center of each strip
-  std::vector<std::vector<Pt> > slice_points;
-  slice_points.reserve(slices.size());
-  for (std::size_t i = 0; i < slices.size(); ++i)
-    slice_points.push_back(interpolateAlongAxis(slices[i], SCAN_DISCRETIZATION));
+  // Step 2 -> generate the scan path for each candidate and keep the one that is fastest to execute
+  const double scan_speed = options.scan_speed > 0.0 ? options.scan_speed : ScanPathOptions().scan_speed;
+  double best_time = std::numeric_limits<double>::max();
+  for (const auto& candidate : candidates)
+  {
+    std::vector<Pt> candidate_pts = scanBoundingBox(candidate.second, params);
+    const double scan_time = pathLength(candidate_pts) / scan_speed;
+
+    ROS_INFO_STREAM("Scan orientation '" << candidate.first << "' (" << candidate.second.a * 180.0 / M_PI
+                    << " deg): " << candidate_pts.size() << " points, estimated scan time " << scan_time
+                    << " s");
 
-  // Step 4 -> connect slices together
-  pts = stitchAndFlatten(slice_points, SCAN_DISCRETIZATION);
+    if (scan_time < best_time)
+    {
+      best_time = scan_time;
+      pts = std::move(candidate_pts);
+    }
+  }
 
   return pts;
 }
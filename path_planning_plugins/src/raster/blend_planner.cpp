@@ -0,0 +1,170 @@
+#include <eigen_conversions/eigen_msg.h>
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/Pose.h>
+#include <geometry_msgs/PoseArray.h>
+#include <godel_msgs/PathPlanning.h>
+#include <godel_utils/path_buffer.h>
+#include <mesh_importer/mesh_importer.h>
+#include <path_planning_plugins/raster_plugins.h>
+#include <pluginlib/class_list_macros.h>
+#include <raster/boustrophedon.h>
+#include <ros/node_handle.h>
+#include <tf/transform_datatypes.h>
+
+const static std::string PATH_GENERATION_SERVICE = "process_path_generator";
+
+const static std::string BLEND_PARAM_PREFIX = "/process_planning_params/blend_params/";
+const static std::string BLENDING_SPEED = BLEND_PARAM_PREFIX + "blending_speed";
+const static std::string TRAVERSE_SPEED = BLEND_PARAM_PREFIX + "traverse_speed";
+const static std::string APPROACH_SPEED = BLEND_PARAM_PREFIX + "approach_speed";
+const static std::string RETRACT_SPEED = BLEND_PARAM_PREFIX + "retract_speed";
+
+
+namespace path_planning_plugins
+{
+
+/**
+ * Estimates the time of the concentric offset path the openveronoi blend planner
+ * would generate for the same surface. That path comes back as a single pose array
+ * along with the index ranges of its chains of loops; it is split there so that
+ * both paths are estimated segment by segment, with the same approach, retract
+ * and traverse costs.
+ */
+static bool estimateOffsetProcessTime(const godel_msgs::PathPlanning::Request& req,
+                                      const raster::ProcessTimeParameters& time_params,
+                                      double& time)
+{
+  ros::NodeHandle nh;
+  ros::ServiceClient process_path_client = nh.serviceClient<godel_msgs::PathPlanning>(PATH_GENERATION_SERVICE);
+
+  godel_msgs::PathPlanning srv;
+  srv.request = req;
+  if (!process_path_client.call(srv))
+  {
+    return false;
+  }
+
+  std::vector<raster::RasterSegment> segments;
+  if (!raster::extractPathSegments(srv.response.poses, srv.response.segment_starts,
+                                   srv.response.segment_ends, segments))
+  {
+    ROS_WARN_STREAM("Offset blend path does not report its segments");
+    return false;
+  }
+  time = raster::estimateProcessTime(segments, time_params);
+  return true;
+}
+
+void raster::BlendPlanner::init(pcl::PolygonMesh mesh)
+{
+  mesh_ = mesh;
+}
+
+bool raster::BlendPlanner::generatePath(std::vector<geometry_msgs::PoseArray>& path)
+{
+  using godel_process_path::PolygonBoundaryCollection;
+
+  path.clear();
+
+  std::unique_ptr<mesh_importer::MeshImporter> mesh_importer_ptr(new mesh_importer::MeshImporter(false));
+  ros::NodeHandle nh;
+  godel_msgs::PathPlanningParameters params;
+  raster::ProcessTimeParameters time_params;
+  bool compare_with_offset = false;
+  try
+  {
+    nh.getParam(DISCRETIZATION, params.discretization);
+    nh.getParam(MARGIN, params.margin);
+    nh.getParam(OVERLAP, params.overlap);
+    nh.getParam(SAFE_TRAVERSE_HEIGHT, params.traverse_height);
+    nh.getParam(SCAN_WIDTH, params.scan_width);
+    nh.getParam(TOOL_RADIUS, params.tool_radius);
+    nh.getParam(RASTER_COMPARE_WITH_OFFSET, compare_with_offset);
+
+    nh.getParam(BLENDING_SPEED, time_params.blending_speed);
+    nh.getParam(TRAVERSE_SPEED, time_params.traverse_speed);
+    nh.getParam(APPROACH_SPEED, time_params.approach_speed);
+    nh.getParam(RETRACT_SPEED, time_params.retract_speed);
+    time_params.traverse_height = params.traverse_height;
+  }
+  catch(const std::exception& e)
+  {
+    ROS_ERROR_STREAM("Unable to populate path planning parameters" << e.what());
+    return false;
+  }
+
+  // Calculate boundaries for a surface
+  if (!mesh_importer_ptr->calculateSimpleBoundary(mesh_))
+  {
+    ROS_WARN_STREAM("Could not calculate boundary for mesh");
+    return false;
+  }
+
+  // Read & filter boundaries that are ill-formed or too small
+  PolygonBoundaryCollection filtered_boundaries =
+      openveronoi::filterPolygonBoundaries(mesh_importer_ptr->getBoundaries());
+
+  // Read pose
+  geometry_msgs::Pose boundary_pose;
+  mesh_importer_ptr->getPose(boundary_pose);
+
+  // Passes run along the local x axis, which the mesh importer aligns with the
+  // major principal axis of the surface
+  std::vector<raster::RasterSegment> segments = raster::generateBoustrophedonPath(filtered_boundaries, params);
+  if (segments.empty())
+  {
+    ROS_WARN_STREAM("Raster blend planner could not fit any passes on the surface");
+    return false;
+  }
+
+  double raster_time = raster::estimateProcessTime(segments, time_params);
+  ROS_INFO_STREAM("Raster blend path: " << segments.size() << " segments, estimated process time "
+                  << raster_time << " s");
+
+  if (compare_with_offset)
+  {
+    godel_msgs::PathPlanning::Request req;
+    req.params = params;
+    godel_process_path::utils::translations::godelToGeometryMsgs(req.surface.boundaries, filtered_boundaries);
+    tf::poseTFToMsg(tf::Transform::getIdentity(), req.surface.pose);
+
+    double offset_time;
+    if (estimateOffsetProcessTime(req, time_params, offset_time))
+    {
+      ROS_INFO_STREAM("Offset blend path estimated process time " << offset_time << " s, raster saves "
+                      << (offset_time - raster_time) << " s");
+    }
+    else
+    {
+      ROS_WARN_STREAM("Could not generate offset blend path for comparison");
+    }
+  }
+
+  // Transform points to world frame and generate pose
+  Eigen::Affine3d boundary_pose_eigen;
+  Eigen::Quaterniond boundary_orientation;
+  tf::poseMsgToEigen(boundary_pose, boundary_pose_eigen);
+  tf::quaternionMsgToEigen(boundary_pose.orientation, boundary_orientation);
+
+  godel_utils::PathBuffer blend_path;
+  for (const auto& segment : segments)
+  {
+    blend_path.clear();
+    blend_path.reserve(segment.size());
+    for (const auto& pt : segment)
+    {
+      blend_path.push_back(Eigen::Vector3d(pt.x, pt.y, 0.0), Eigen::Quaterniond::Identity());
+    }
+    blend_path.transform(boundary_pose_eigen);
+    blend_path.setOrientation(boundary_orientation);
+
+    geometry_msgs::PoseArray blend_poses;
+    blend_path.toPoseArray(blend_poses);
+    path.push_back(blend_poses);
+  }
+
+  return true;
+}
+} // end namespace
+
+PLUGINLIB_EXPORT_CLASS(path_planning_plugins::raster::BlendPlanner, path_planning_plugins_base::PathPlanningBase)
@@ -0,0 +1,395 @@
+#include <raster/boustrophedon.h>
+#include <godel_process_path_generation/utils.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <limits>
+
+// Number of scanlines sampled across the tool footprint when eroding the
+// surface by the tool clearance. Must be odd so the pass itself is sampled.
+static const int EROSION_SAMPLES = 5;
+
+// Used when no usable discretization is provided
+static const double DEFAULT_DISCRETIZATION = 0.01; // 1 cm
+
+namespace path_planning_plugins
+{
+namespace raster
+{
+
+typedef godel_process_path::PolygonPt Pt;
+typedef godel_process_path::PolygonBoundaryCollection BoundaryCollection;
+typedef godel_msgs::PathPlanningParameters PlanningParams;
+
+/**
+ * A reachable span [lo, hi] of the tool center along a single scanline
+ */
+struct Interval
+{
+  Interval(double lo, double hi) : lo(lo), hi(hi) {}
+  double lo, hi;
+};
+
+/**
+ * A run of passes, one per consecutive scanline, covered by a single zig-zag
+ */
+struct Cell
+{
+  std::vector<double> ys;
+  std::vector<Interval> passes;
+};
+
+static bool overlaps(const Interval& a, const Interval& b)
+{
+  return a.lo <= b.hi && b.lo <= a.hi;
+}
+
+/**
+ * Returns the spans of the line y = const that lie inside the surface, using the
+ * even-odd rule so that interior boundaries act as holes.
+ */
+static std::vector<Interval> scanlineIntervals(const BoundaryCollection& boundaries, double y)
+{
+  std::vector<double> xs;
+  for (std::size_t i = 0; i < boundaries.size(); ++i)
+  {
+    const godel_process_path::PolygonBoundary& bnd = boundaries[i];
+    for (std::size_t j = 0; j < bnd.size(); ++j)
+    {
+      const Pt& p = bnd[j];
+      const Pt& q = bnd[(j + 1) % bnd.size()];
+      if ((p.y > y) != (q.y > y))
+      {
+        xs.push_back(p.x + (y - p.y) * (q.x - p.x) / (q.y - p.y));
+      }
+    }
+  }
+
+  std::sort(xs.begin(), xs.end());
+
+  std::vector<Interval> intervals;
+  for (std::size_t i = 0; i + 1 < xs.size(); i += 2)
+  {
+    intervals.push_back(Interval(xs[i], xs[i + 1]));
+  }
+  return intervals;
+}
+
+static std::vector<Interval> shrink(const std::vector<Interval>& intervals, double d)
+{
+  std::vector<Interval> result;
+  for (std::size_t i = 0; i < intervals.size(); ++i)
+  {
+    if (intervals[i].hi - intervals[i].lo >= 2.0 * d)
+    {
+      result.push_back(Interval(intervals[i].lo + d, intervals[i].hi - d));
+    }
+  }
+  return result;
+}
+
+static std::vector<Interval> intersect(const std::vector<Interval>& a, const std::vector<Interval>& b)
+{
+  std::vector<Interval> result;
+  std::size_t i = 0, j = 0;
+  while (i < a.size() && j < b.size())
+  {
+    double lo = std::max(a[i].lo, b[j].lo);
+    double hi = std::min(a[i].hi, b[j].hi);
+    if (lo <= hi)
+    {
+      result.push_back(Interval(lo, hi));
+    }
+
+    if (a[i].hi < b[j].hi)
+      ++i;
+    else
+      ++j;
+  }
+  return result;
+}
+
+/**
+ * Returns the spans along y where a disc of radius 'clearance' centered on the
+ * scanline fits inside the surface. The disc is approximated by sampling a few
+ * neighbouring scanlines, each shrunk by the half-chord of the disc at that offset.
+ */
+static std::vector<Interval> erodedIntervals(const BoundaryCollection& boundaries, double y,
+                                             double clearance)
+{
+  std::vector<Interval> result = shrink(scanlineIntervals(boundaries, y), clearance);
+  if (clearance <= 0.0)
+  {
+    return result;
+  }
+
+  const int half = EROSION_SAMPLES / 2;
+  for (int i = -half; i <= half && !result.empty(); ++i)
+  {
+    if (i == 0)
+      continue;
+
+    double dy = clearance * static_cast<double>(i) / static_cast<double>(half);
+    double half_chord = std::sqrt(std::max(0.0, clearance * clearance - dy * dy));
+    result = intersect(result, shrink(scanlineIntervals(boundaries, y + dy), half_chord));
+  }
+  return result;
+}
+
+/**
+ * Groups the passes on each scanline into cells. A pass continues the cell of
+ * the pass below it only if each is the other's sole overlapping neighbour;
+ * any split or merge of the free space starts new cells.
+ */
+static std::vector<Cell> decompose(const std::vector<double>& ys,
+                                   const std::vector<std::vector<Interval> >& lines)
+{
+  std::vector<Cell> cells;
+  std::vector<std::size_t> prev_ids;
+
+  for (std::size_t k = 0; k < lines.size(); ++k)
+  {
+    const std::vector<Interval>& cur = lines[k];
+    std::vector<std::size_t> cur_ids(cur.size());
+
+    for (std::size_t j = 0; j < cur.size(); ++j)
+    {
+      std::size_t match = 0;
+      int count = 0;
+      if (k > 0)
+      {
+        for (std::size_t i = 0; i < lines[k - 1].size(); ++i)
+        {
+          if (overlaps(lines[k - 1][i], cur[j]))
+          {
+            match = i;
+            ++count;
+          }
+        }
+      }
+
+      bool continues = false;
+      if (count == 1)
+      {
+        int back_count = 0;
+        for (std::size_t m = 0; m < cur.size(); ++m)
+        {
+          if (overlaps(lines[k - 1][match], cur[m]))
+            ++back_count;
+        }
+        continues = back_count == 1;
+      }
+
+      if (continues)
+      {
+        cur_ids[j] = prev_ids[match];
+      }
+      else
+      {
+        cur_ids[j] = cells.size();
+        cells.push_back(Cell());
+      }
+      cells[cur_ids[j]].ys.push_back(ys[k]);
+      cells[cur_ids[j]].passes.push_back(cur[j]);
+    }
+    prev_ids = cur_ids;
+  }
+  return cells;
+}
+
+/**
+ * Builds the zig-zag through a cell. 'reverse' walks the passes from the last
+ * scanline to the first, 'from_left' selects the direction of the first pass.
+ */
+static std::vector<Pt> cellVertices(const Cell& cell, bool reverse, bool from_left)
+{
+  std::vector<Pt> vertices;
+  const std::size_t n = cell.passes.size();
+  bool left_to_right = from_left;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    std::size_t idx = reverse ? n - 1 - i : i;
+    const Interval& pass = cell.passes[idx];
+    double y = cell.ys[idx];
+    if (left_to_right)
+    {
+      vertices.push_back(Pt(pass.lo, y));
+      vertices.push_back(Pt(pass.hi, y));
+    }
+    else
+    {
+      vertices.push_back(Pt(pass.hi, y));
+      vertices.push_back(Pt(pass.lo, y));
+    }
+    left_to_right = !left_to_right;
+  }
+  return vertices;
+}
+
+static RasterSegment discretize(const std::vector<Pt>& vertices, double max_sep)
+{
+  RasterSegment segment;
+  for (std::size_t i = 0; i + 1 < vertices.size(); ++i)
+  {
+    std::vector<Pt> pts =
+        godel_process_path::utils::geometry::discretizeLinear(vertices[i], vertices[i + 1], max_sep);
+    segment.insert(segment.end(), pts.begin(), pts.end());
+  }
+  if (!vertices.empty())
+  {
+    segment.push_back(vertices.back());
+  }
+  return segment;
+}
+
+static double pathLength(const RasterSegment& segment)
+{
+  double length = 0.0;
+  for (std::size_t i = 1; i < segment.size(); ++i)
+  {
+    length += segment[i - 1].dist(segment[i]);
+  }
+  return length;
+}
+
+std::vector<RasterSegment> generateBoustrophedonPath(const BoundaryCollection& boundaries,
+                                                     const PlanningParams& params)
+{
+  std::vector<RasterSegment> segments;
+
+  const double spacing = params.tool_radius - params.overlap;
+  const double clearance = params.tool_radius + params.margin;
+  const double discretization =
+      params.discretization > 0.0 ? params.discretization : DEFAULT_DISCRETIZATION;
+
+  if (spacing <= 0.0)
+  {
+    ROS_ERROR_STREAM("Raster pass spacing must be positive (tool_radius: "
+                     << params.tool_radius << ", overlap: " << params.overlap << ")");
+    return segments;
+  }
+
+  double min_y = std::numeric_limits<double>::max();
+  double max_y = -std::numeric_limits<double>::max();
+  for (std::size_t i = 0; i < boundaries.size(); ++i)
+  {
+    for (std::size_t j = 0; j < boundaries[i].size(); ++j)
+    {
+      min_y = std::min(min_y, boundaries[i][j].y);
+      max_y = std::max(max_y, boundaries[i][j].y);
+    }
+  }
+
+  const double span = (max_y - min_y) - 2.0 * clearance;
+  if (boundaries.empty() || span < 0.0)
+  {
+    ROS_WARN_STREAM("Surface is too narrow for a raster pass");
+    return segments;
+  }
+
+  // Center the passes between the first and last admissible scanline
+  const std::size_t n_lines = static_cast<std::size_t>(std::floor(span / spacing)) + 1;
+  const double first_y = min_y + clearance + 0.5 * (span - (n_lines - 1) * spacing);
+
+  std::vector<double> ys(n_lines);
+  std::vector<std::vector<Interval> > lines(n_lines);
+  for (std::size_t k = 0; k < n_lines; ++k)
+  {
+    ys[k] = first_y + k * spacing;
+    lines[k] = erodedIntervals(boundaries, ys[k], clearance);
+  }
+
+  std::vector<Cell> cells = decompose(ys, lines);
+
+  // Visit cells greedily, entering each at whichever corner is nearest to the
+  // exit of the previous one
+  std::vector<bool> visited(cells.size(), false);
+  std::vector<Pt> vertices;
+  if (!cells.empty())
+  {
+    visited[0] = true;
+    vertices = cellVertices(cells[0], false, true);
+    segments.push_back(discretize(vertices, discretization));
+  }
+
+  for (std::size_t c = 1; c < cells.size(); ++c)
+  {
+    const Pt position = vertices.back();
+    double best_dist = std::numeric_limits<double>::max();
+    std::size_t best_cell = 0;
+
+    for (std::size_t i = 0; i < cells.size(); ++i)
+    {
+      if (visited[i])
+        continue;
+
+      for (int option = 0; option < 4; ++option)
+      {
+        std::vector<Pt> candidate = cellVertices(cells[i], option & 1, option & 2);
+        double d = position.dist(candidate.front());
+        if (d < best_dist)
+        {
+          best_dist = d;
+          best_cell = i;
+          vertices.swap(candidate);
+        }
+      }
+    }
+
+    visited[best_cell] = true;
+    segments.push_back(discretize(vertices, discretization));
+  }
+
+  ROS_INFO_STREAM("Raster path: " << n_lines << " scanlines decomposed into " << cells.size()
+                                  << " cells");
+  return segments;
+}
+
+double estimateProcessTime(const std::vector<RasterSegment>& segments,
+                           const ProcessTimeParameters& params)
+{
+  double time = 0.0;
+  for (std::size_t i = 0; i < segments.size(); ++i)
+  {
+    if (segments[i].empty())
+      continue;
+
+    time += pathLength(segments[i]) / params.blending_speed;
+    time += params.traverse_height / params.approach_speed;
+    time += params.traverse_height / params.retract_speed;
+
+    if (i > 0 && !segments[i - 1].empty())
+    {
+      time += segments[i - 1].back().dist(segments[i].front()) / params.traverse_speed;
+    }
+  }
+  return time;
+}
+
+bool extractPathSegments(const geometry_msgs::PoseArray& path, const std::vector<uint32_t>& starts,
+                         const std::vector<uint32_t>& ends, std::vector<RasterSegment>& segments)
+{
+  segments.clear();
+  if (starts.empty() || starts.size() != ends.size())
+    return false;
+
+  for (std::size_t i = 0; i < starts.size(); ++i)
+  {
+    if (starts[i] >= ends[i] || ends[i] > path.poses.size())
+    {
+      segments.clear();
+      return false;
+    }
+
+    RasterSegment segment;
+    segment.reserve(ends[i] - starts[i]);
+    for (uint32_t j = starts[i]; j < ends[i]; ++j)
+    {
+      segment.push_back(Pt(path.poses[j].position.x, path.poses[j].position.y));
+    }
+    segments.push_back(segment);
+  }
+  return true;
+}
+
+} // end namespace raster
+} // end namespace path_planning_plugins
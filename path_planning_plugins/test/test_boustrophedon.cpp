@@ -0,0 +1,208 @@
+/*
+ * test_boustrophedon.cpp
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <map>
+#include <raster/boustrophedon.h>
+#include <godel_process_path_generation/process_path_generator.h>
+
+using godel_process_path::PolygonBoundary;
+using godel_process_path::PolygonBoundaryCollection;
+using godel_process_path::PolygonPt;
+using path_planning_plugins::raster::RasterSegment;
+
+/* Axis aligned rectangle [x0, x1] x [y0, y1] */
+static PolygonBoundary rectangle(double x0, double y0, double x1, double y1)
+{
+  PolygonBoundary bnd;
+  bnd.push_back(PolygonPt(x0, y0));
+  bnd.push_back(PolygonPt(x1, y0));
+  bnd.push_back(PolygonPt(x1, y1));
+  bnd.push_back(PolygonPt(x0, y1));
+  return bnd;
+}
+
+/* Widely spaced discretization, so that segments contain only the pass end points */
+static godel_msgs::PathPlanningParameters makeParams()
+{
+  godel_msgs::PathPlanningParameters params;
+  params.discretization = 1.0;
+  params.margin = 0.0;
+  params.overlap = 0.0;
+  params.tool_radius = 0.01;
+  return params;
+}
+
+/* Scanline heights of all points, rounded to 1e-9 */
+static std::vector<double> scanlines(const std::vector<RasterSegment>& segments)
+{
+  std::map<long long, double> ys;
+  for (const auto& segment : segments)
+  {
+    for (const auto& pt : segment)
+    {
+      ys[std::llround(pt.y * 1e9)] = pt.y;
+    }
+  }
+  std::vector<double> result;
+  for (const auto& y : ys)
+  {
+    result.push_back(y.second);
+  }
+  return result;
+}
+
+TEST(Boustrophedon, lineSpacing)
+{
+  const godel_msgs::PathPlanningParameters params = makeParams();
+  std::vector<RasterSegment> segments =
+      path_planning_plugins::raster::generateBoustrophedonPath(PolygonBoundaryCollection(1, rectangle(0, 0, 0.2, 0.1)),
+                                                               params);
+  ASSERT_EQ(1u, segments.size());
+
+  // Passes are tool_radius - overlap apart, centered between the admissible scanlines
+  std::vector<double> ys = scanlines(segments);
+  ASSERT_EQ(9u, ys.size());
+  EXPECT_NEAR(0.01, ys.front(), 1e-9);
+  EXPECT_NEAR(0.09, ys.back(), 1e-9);
+  for (std::size_t i = 1; i < ys.size(); ++i)
+  {
+    EXPECT_NEAR(params.tool_radius - params.overlap, ys[i] - ys[i - 1], 1e-9);
+  }
+
+  // The tool stays inside the boundary
+  for (const auto& pt : segments.front())
+  {
+    EXPECT_GE(pt.x, 0.01 - 1e-9);
+    EXPECT_LE(pt.x, 0.19 + 1e-9);
+  }
+
+  // Overlap brings the passes closer together
+  godel_msgs::PathPlanningParameters overlapping = params;
+  overlapping.overlap = 0.005;
+  segments = path_planning_plugins::raster::generateBoustrophedonPath(
+      PolygonBoundaryCollection(1, rectangle(0, 0, 0.2, 0.1)), overlapping);
+  EXPECT_EQ(17u, scanlines(segments).size());
+}
+
+TEST(Boustrophedon, alternatingDirection)
+{
+  std::vector<RasterSegment> segments = path_planning_plugins::raster::generateBoustrophedonPath(
+      PolygonBoundaryCollection(1, rectangle(0, 0, 0.2, 0.1)), makeParams());
+  ASSERT_EQ(1u, segments.size());
+
+  // Each pass is two points on one scanline; consecutive passes run in opposite directions and
+  // are joined at the same end
+  const RasterSegment& segment = segments.front();
+  ASSERT_EQ(18u, segment.size());
+  for (std::size_t i = 0; i + 1 < segment.size(); i += 2)
+  {
+    EXPECT_DOUBLE_EQ(segment[i].y, segment[i + 1].y);
+    const double direction = segment[i + 1].x - segment[i].x;
+    EXPECT_GT(std::abs(direction), 0.1);
+    if (i >= 2)
+    {
+      const double previous = segment[i - 1].x - segment[i - 2].x;
+      EXPECT_LT(direction * previous, 0.0);
+      EXPECT_DOUBLE_EQ(segment[i - 1].x, segment[i].x);
+    }
+  }
+}
+
+TEST(Boustrophedon, clipsToHoles)
+{
+  // A hole through the middle splits the passes beside it into separate cells
+  PolygonBoundaryCollection boundaries;
+  boundaries.push_back(rectangle(0, 0, 0.2, 0.1));
+  boundaries.push_back(rectangle(0.08, 0.03, 0.12, 0.07));
+  const godel_msgs::PathPlanningParameters params = makeParams();
+  std::vector<RasterSegment> segments = path_planning_plugins::raster::generateBoustrophedonPath(boundaries, params);
+  EXPECT_EQ(4u, segments.size());
+
+  // No pass beside the hole comes within the tool clearance of it
+  for (const auto& segment : segments)
+  {
+    for (std::size_t i = 0; i + 1 < segment.size(); ++i)
+    {
+      const PolygonPt& a = segment[i];
+      const PolygonPt& b = segment[i + 1];
+      if (a.y != b.y || a.y < 0.03 - 1e-9 || a.y > 0.07 + 1e-9)
+      {
+        continue;
+      }
+      EXPECT_TRUE(std::max(a.x, b.x) <= 0.07 + 1e-9 || std::min(a.x, b.x) >= 0.13 - 1e-9)
+          << "pass at y = " << a.y << " from x = " << a.x << " to " << b.x;
+    }
+  }
+}
+
+TEST(Boustrophedon, tooNarrow)
+{
+  EXPECT_TRUE(path_planning_plugins::raster::generateBoustrophedonPath(
+                  PolygonBoundaryCollection(1, rectangle(0, 0, 0.2, 0.015)), makeParams())
+                  .empty());
+}
+
+TEST(Boustrophedon, splitsOffsetPathByChain)
+{
+  // Two islands, each covered by a chain of two loops stepping out from the inner one. As in the
+  // path generator node, the path stays on the surface between chains.
+  PolygonBoundaryCollection loops;
+  loops.push_back(rectangle(0.02, 0.02, 0.08, 0.08));
+  loops.push_back(rectangle(0.01, 0.01, 0.09, 0.09));
+  loops.push_back(rectangle(0.22, 0.02, 0.28, 0.08));
+  loops.push_back(rectangle(0.21, 0.01, 0.29, 0.09));
+  std::vector<double> offsets = {0.02, 0.01, 0.02, 0.01};
+
+  godel_process_path::ProcessPathGenerator ppg;
+  ppg.setDiscretizationDistance(0.01);
+  ppg.setToolRadius(0.01);
+  ppg.setTraverseHeight(0.0);
+  ASSERT_TRUE(ppg.setPathPolygons(&loops, &offsets));
+  ASSERT_TRUE(ppg.createProcessPath());
+  const geometry_msgs::PoseArray path = ppg.getProcessPath().asPoseArray();
+
+  std::vector<uint32_t> starts, ends;
+  for (const auto& range : ppg.getChainRanges())
+  {
+    starts.push_back(range.first);
+    ends.push_back(range.second);
+  }
+  std::vector<RasterSegment> segments;
+  ASSERT_TRUE(path_planning_plugins::raster::extractPathSegments(path, starts, ends, segments));
+  ASSERT_EQ(2u, segments.size());
+  for (std::size_t i = 0; i < segments.size(); ++i)
+  {
+    const double x0 = i == 0 ? 0.0 : 0.2;
+    for (const auto& pt : segments[i])
+    {
+      EXPECT_TRUE(pt.x > x0 && pt.x < x0 + 0.1) << "segment " << i << " point at x = " << pt.x;
+    }
+  }
+
+  // Each segment is approached and retracted on its own, and the move between them is a traverse
+  path_planning_plugins::raster::ProcessTimeParameters time_params;
+  RasterSegment joined = segments[0];
+  joined.insert(joined.end(), segments[1].begin(), segments[1].end());
+  const double gap = segments[0].back().dist(segments[1].front());
+  const double split_time = path_planning_plugins::raster::estimateProcessTime(segments, time_params);
+  const double joined_time =
+      path_planning_plugins::raster::estimateProcessTime(std::vector<RasterSegment>(1, joined), time_params);
+  EXPECT_NEAR(time_params.traverse_height / time_params.approach_speed +
+                  time_params.traverse_height / time_params.retract_speed +
+                  gap / time_params.traverse_speed - gap / time_params.blending_speed,
+              split_time - joined_time, 1e-6);
+
+  // Ranges that do not fit the path are rejected
+  ends.back() = path.poses.size() + 1;
+  EXPECT_FALSE(path_planning_plugins::raster::extractPathSegments(path, starts, ends, segments));
+  EXPECT_FALSE(path_planning_plugins::raster::extractPathSegments(path, {}, {}, segments));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}